@@ -0,0 +1,4265 @@
+// OPC UA服务器模拟器的基准测试程序
+// 直接包含 server.c 以测量其中的内部函数；只有本程序启用可替换的内存分配函数
+#define OPCUA_SERVER_NO_MAIN
+#include "../server.c"
+
+// ==================== 基准测试 ====================
+#define BENCHMARK_PORT 48401
+
+// 单线程依次计算所有模拟组（模拟内核基准测试的对照）
+static void simulationEngineStep(SimulationEngine *engine, double t)
+{
+    for (size_t g = 0; g < engine->groupCount; g++)
+        simulationGroupStep(engine->groups[g], t, 0);
+}
+
+// 只统计服务器线程在测量窗口内的堆分配次数
+static pthread_t g_benchServerThreadId;
+static volatile UA_Boolean g_benchServerRunning;
+static UA_Boolean g_benchCountAllocs;
+static UA_UInt64 g_benchAllocCount;
+static UA_UInt64 g_benchAllocBytes;
+
+static void benchCountAllocation(size_t size)
+{
+    if (__atomic_load_n(&g_benchCountAllocs, __ATOMIC_RELAXED) &&
+        pthread_equal(pthread_self(), g_benchServerThreadId))
+    {
+        __atomic_add_fetch(&g_benchAllocCount, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&g_benchAllocBytes, size, __ATOMIC_RELAXED);
+    }
+}
+
+static void *benchMalloc(size_t size)
+{
+    benchCountAllocation(size);
+    return malloc(size);
+}
+
+static void *benchCalloc(size_t nelem, size_t elsize)
+{
+    benchCountAllocation(nelem * elsize);
+    return calloc(nelem, elsize);
+}
+
+// 只统计新增的内存，原地扩展或缩小的部分不重复计入
+static void *benchRealloc(void *ptr, size_t size)
+{
+    size_t usable = ptr ? malloc_usable_size(ptr) : 0;
+    benchCountAllocation(size > usable ? size - usable : 0);
+    return realloc(ptr, size);
+}
+
+static void *benchServerThread(void *arg)
+{
+    UA_Server_run((UA_Server *)arg, (volatile UA_Boolean *)&g_benchServerRunning);
+    return NULL;
+}
+
+// 连接配置为NULL时使用客户端默认的缓冲区大小
+static UA_Client *benchConnectClientWith(const UA_ConnectionConfig *connectionConfig)
+{
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig *clientConfig = UA_Client_getConfig(client);
+    UA_ClientConfig_setDefault(clientConfig);
+    clientConfig->logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+    if (connectionConfig)
+        clientConfig->localConnectionConfig = *connectionConfig;
+
+    char url[64];
+    snprintf(url, sizeof(url), "opc.tcp://localhost:%d", BENCHMARK_PORT);
+
+    // 服务器线程刚启动时可能尚未开始监听
+    for (int attempt = 0; attempt < 100; attempt++)
+    {
+        if (UA_Client_connect(client, url) == UA_STATUSCODE_GOOD)
+            return client;
+        usleep(20 * 1000);
+    }
+
+    UA_Client_delete(client);
+    return NULL;
+}
+
+static UA_Client *benchConnectClient(void)
+{
+    return benchConnectClientWith(NULL);
+}
+
+// 返回每次Read服务调用在服务器线程上的平均堆分配次数
+static double benchMeasureReadAllocs(UA_Client *client, UA_ReadValueId *items,
+                                     size_t itemCount, int iterations)
+{
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = items;
+    request.nodesToReadSize = itemCount;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+
+    // 预热，排除首次调用的一次性分配
+    UA_ReadResponse response = UA_Client_Service_read(client, request);
+    UA_ReadResponse_clear(&response);
+
+    __atomic_store_n(&g_benchAllocCount, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_benchCountAllocs, true, __ATOMIC_RELAXED);
+
+    for (int i = 0; i < iterations; i++)
+    {
+        response = UA_Client_Service_read(client, request);
+        if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD ||
+            response.resultsSize != itemCount || !response.results[0].hasValue)
+        {
+            logMessage(LOG_LEVEL_ERROR, "基准测试读取失败: %s",
+                       UA_StatusCode_name(response.responseHeader.serviceResult));
+            UA_ReadResponse_clear(&response);
+            __atomic_store_n(&g_benchCountAllocs, false, __ATOMIC_RELAXED);
+            return -1.0;
+        }
+        UA_ReadResponse_clear(&response);
+    }
+
+    __atomic_store_n(&g_benchCountAllocs, false, __ATOMIC_RELAXED);
+    return (double)__atomic_load_n(&g_benchAllocCount, __ATOMIC_RELAXED) / iterations;
+}
+
+// 对比两种读取模式下每个标量值的堆分配次数
+static int runReadAllocBenchmark(int tagCount, int iterations)
+{
+    static const int typeIndices[] = {UA_TYPES_INT32, UA_TYPES_UINT32, UA_TYPES_FLOAT,
+                                      UA_TYPES_DOUBLE, UA_TYPES_BOOLEAN, UA_TYPES_DATETIME};
+    static const ReadMode modes[] = {READ_MODE_COPY, READ_MODE_ZERO_COPY};
+    static const char *modeNames[] = {"copy", "zero-copy"};
+    double perValueAllocs[2] = {0};
+
+    if (tagCount < 2)
+    {
+        logMessage(LOG_LEVEL_ERROR, "变量数量至少为2");
+        return EXIT_FAILURE;
+    }
+
+    UA_mallocSingleton = benchMalloc;
+    UA_callocSingleton = benchCalloc;
+    UA_reallocSingleton = benchRealloc;
+
+    printf("Read服务分配基准: %d个定长标量变量, 每组%d次调用\n", tagCount, iterations);
+
+    for (int m = 0; m < 2; m++)
+    {
+        g_serverContext.readMode = modes[m];
+
+        UA_ServerConfig config;
+        memset(&config, 0, sizeof(UA_ServerConfig));
+        config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+        UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+        UA_Server *server = UA_Server_newWithConfig(&config);
+
+        UA_ReadValueId *items = (UA_ReadValueId *)UA_calloc(tagCount, sizeof(UA_ReadValueId));
+        for (int i = 0; i < tagCount; i++)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "BenchTag%d", i);
+            const UA_DataType *type = &UA_TYPES[typeIndices[i % 6]];
+            ScalarValue initial;
+            memset(&initial, 0, sizeof(initial));
+            // 使用数值型NodeId，避免请求解码时为字符串标识符分配内存
+            items[i].nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 50000 + i), name, type,
+                                              &initial, SIMULATION_NONE, 0, 0, 0);
+            items[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        }
+
+        g_benchServerRunning = true;
+        pthread_create(&g_benchServerThreadId, NULL, benchServerThread, server);
+
+        UA_Client *client = benchConnectClient();
+        double single = -1.0, batch = -1.0;
+        if (client)
+        {
+            single = benchMeasureReadAllocs(client, items, 1, iterations);
+            batch = benchMeasureReadAllocs(client, items, (size_t)tagCount, iterations);
+            UA_Client_disconnect(client);
+            UA_Client_delete(client);
+        }
+
+        g_benchServerRunning = false;
+        pthread_join(g_benchServerThreadId, NULL);
+        UA_Server_delete(server);
+        UA_free(items);
+
+        cleanupSimulationEngine(&g_serverContext.simulationEngine);
+        cleanupTagRegistry(&g_serverContext.tags);
+
+        if (single < 0 || batch < 0)
+        {
+            logMessage(LOG_LEVEL_ERROR, "基准测试失败 (模式: %s)", modeNames[m]);
+            return EXIT_FAILURE;
+        }
+
+        // 每多读取一个值所增加的分配次数，与请求本身的固定开销无关
+        perValueAllocs[m] = (batch - single) / (tagCount - 1);
+        printf("  %-10s 每次调用分配: 1个值 %.2f, %d个值 %.2f, 每个值 %.2f\n",
+               modeNames[m], single, tagCount, batch, perValueAllocs[m]);
+    }
+
+    UA_mallocSingleton = malloc;
+    UA_callocSingleton = calloc;
+    UA_reallocSingleton = realloc;
+
+    return perValueAllocs[1] < 0.5 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// 互斥锁保护的值单元，作为无锁值单元的对照
+typedef struct
+{
+    pthread_mutex_t mutex;
+    ScalarValue value;
+} MutexValueCell;
+
+typedef struct
+{
+    UA_Boolean useMutex;
+    MutexValueCell mutexCell;
+    ValueCell cell;
+    volatile UA_Boolean stop;
+    UA_UInt64 reads;
+    UA_UInt64 writes;
+    UA_UInt64 tornReads;
+} ValueCellBench;
+
+// 写者写入高低32位相同的值，读者据此检测撕裂读
+static void *benchValueCellWriter(void *arg)
+{
+    ValueCellBench *bench = (ValueCellBench *)arg;
+    UA_UInt64 writes = 0;
+    while (!bench->stop)
+    {
+        UA_UInt32 half = (UA_UInt32)writes;
+        ScalarValue next;
+        next.bits = ((UA_UInt64)half << 32) | half;
+        if (bench->useMutex)
+        {
+            pthread_mutex_lock(&bench->mutexCell.mutex);
+            bench->mutexCell.value = next;
+            pthread_mutex_unlock(&bench->mutexCell.mutex);
+        }
+        else
+        {
+            valueCellStore(&bench->cell, next);
+        }
+        writes++;
+    }
+    __atomic_add_fetch(&bench->writes, writes, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static void *benchValueCellReader(void *arg)
+{
+    ValueCellBench *bench = (ValueCellBench *)arg;
+    UA_UInt64 reads = 0, torn = 0;
+    while (!bench->stop)
+    {
+        ScalarValue current;
+        if (bench->useMutex)
+        {
+            pthread_mutex_lock(&bench->mutexCell.mutex);
+            current = bench->mutexCell.value;
+            pthread_mutex_unlock(&bench->mutexCell.mutex);
+        }
+        else
+        {
+            current = valueCellLoad(&bench->cell);
+        }
+        if ((UA_UInt32)(current.bits >> 32) != (UA_UInt32)current.bits)
+            torn++;
+        reads++;
+    }
+    __atomic_add_fetch(&bench->reads, reads, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bench->tornReads, torn, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// 字符串写者每次写入同一字符重复组成的值，读者据此检测读到已释放或混合的内容
+static void *benchValueCellStringWriter(void *arg)
+{
+    ValueCellBench *bench = (ValueCellBench *)arg;
+    UA_Byte data[32];
+    UA_UInt64 writes = 0;
+    while (!bench->stop)
+    {
+        memset(data, 'a' + (int)(writes % 26), sizeof(data));
+        UA_String value = {sizeof(data), data};
+        if (valueCellWriteString(&bench->cell, &value) != UA_STATUSCODE_GOOD)
+            break;
+        writes++;
+    }
+    __atomic_add_fetch(&bench->writes, writes, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static void *benchValueCellStringReader(void *arg)
+{
+    ValueCellBench *bench = (ValueCellBench *)arg;
+    UA_UInt64 reads = 0, torn = 0;
+    while (!bench->stop)
+    {
+        UA_String current;
+        if (valueCellReadString(&bench->cell, &current) != UA_STATUSCODE_GOOD)
+            continue;
+        for (size_t i = 1; i < current.length; i++)
+        {
+            if (current.data[i] != current.data[0])
+            {
+                torn++;
+                break;
+            }
+        }
+        UA_String_clear(&current);
+        reads++;
+    }
+    __atomic_add_fetch(&bench->reads, reads, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bench->tornReads, torn, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// 1个写者与N个读者竞争同一个值单元，对比互斥锁与无锁实现
+static int runValueCellBenchmark(int maxReaders, int durationMs)
+{
+    static const char *cellNames[] = {"mutex", "lock-free"};
+    UA_UInt64 totalTorn = 0;
+
+    printf("值单元竞争基准: 1个写者, 1-%d个读者, 每组%dms\n", maxReaders, durationMs);
+
+    pthread_t *readerThreads = (pthread_t *)malloc((size_t)maxReaders * sizeof(pthread_t));
+    if (!readerThreads)
+        return EXIT_FAILURE;
+    for (int readers = 1; readers <= maxReaders; readers *= 2)
+    {
+        for (int m = 0; m < 2; m++)
+        {
+            ValueCellBench bench;
+            memset(&bench, 0, sizeof(bench));
+            bench.useMutex = (m == 0);
+            pthread_mutex_init(&bench.mutexCell.mutex, NULL);
+
+            pthread_t writer;
+            pthread_create(&writer, NULL, benchValueCellWriter, &bench);
+            for (int r = 0; r < readers; r++)
+                pthread_create(&readerThreads[r], NULL, benchValueCellReader, &bench);
+
+            usleep(durationMs * 1000);
+            bench.stop = true;
+
+            pthread_join(writer, NULL);
+            for (int r = 0; r < readers; r++)
+                pthread_join(readerThreads[r], NULL);
+            pthread_mutex_destroy(&bench.mutexCell.mutex);
+
+            double seconds = durationMs / 1000.0;
+            printf("  %-10s 读者=%-3d 读取 %8.2f M/s  写入 %8.2f M/s  撕裂读 %llu\n",
+                   cellNames[m], readers, bench.reads / seconds / 1e6, bench.writes / seconds / 1e6,
+                   (unsigned long long)bench.tornReads);
+            totalTorn += bench.tornReads;
+        }
+    }
+
+    // 读者持续重叠时写者只等待旧值的读者，不能被饿死
+    ValueCellBench bench;
+    memset(&bench, 0, sizeof(bench));
+    bench.cell.string = UA_String_new();
+    pthread_t writer;
+    pthread_create(&writer, NULL, benchValueCellStringWriter, &bench);
+    for (int r = 0; r < maxReaders; r++)
+        pthread_create(&readerThreads[r], NULL, benchValueCellStringReader, &bench);
+
+    usleep(durationMs * 1000);
+    bench.stop = true;
+
+    pthread_join(writer, NULL);
+    for (int r = 0; r < maxReaders; r++)
+        pthread_join(readerThreads[r], NULL);
+    UA_String_delete(bench.cell.string);
+
+    double seconds = durationMs / 1000.0;
+    printf("  %-10s 读者=%-3d 读取 %8.2f M/s  写入 %8.2f M/s  撕裂读 %llu\n",
+           "string", maxReaders, bench.reads / seconds / 1e6, bench.writes / seconds / 1e6,
+           (unsigned long long)bench.tornReads);
+    totalTorn += bench.tornReads;
+
+    free(readerThreads);
+    return totalTorn == 0 && bench.writes > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static double benchElapsedSeconds(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// 创建大量变量并测量注册、遍历和按NodeId查找的耗时
+static int runTagRegistryBenchmark(int tagCount)
+{
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+    UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+    UA_Server *server = UA_Server_newWithConfig(&config);
+
+    printf("变量注册表基准: %d个变量\n", tagCount);
+
+    // 仅注册表（不创建地址空间节点）
+    TagRegistry standalone;
+    memset(&standalone, 0, sizeof(TagRegistry));
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < tagCount; i++)
+    {
+        VariableContext *context = tagRegistryAllocate(&standalone);
+        UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 100000 + i);
+        if (!context || tagRegistryCommit(&standalone, context, &nodeId) != UA_STATUSCODE_GOOD)
+            break;
+    }
+    double registerSeconds = benchElapsedSeconds(&start);
+    cleanupTagRegistry(&standalone);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < tagCount; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "Tag%d", i);
+        UA_Double initial = 0.0;
+        addVariableNode(server, UA_NODEID_NUMERIC(1, 100000 + i), name, &UA_TYPES[UA_TYPES_DOUBLE],
+                        &initial, SIMULATION_SINE_WAVE, 0.1, 10.0, 0.0);
+    }
+    double createSeconds = benchElapsedSeconds(&start);
+
+    TagRegistry *registry = &g_serverContext.tags;
+    double now = simulationTime();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t c = 0; c < registry->chunkCount; c++)
+    {
+        VariableContext *chunk = registry->chunks[c];
+        size_t remaining = registry->count - (c << TAG_CHUNK_SHIFT);
+        size_t n = remaining < TAG_CHUNK_SIZE ? remaining : TAG_CHUNK_SIZE;
+        for (size_t i = 0; i < n; i++)
+            updateSimulatedValue(&chunk[i], now, 0);
+    }
+    double sweepSeconds = benchElapsedSeconds(&start);
+
+    size_t found = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < tagCount; i++)
+    {
+        UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 100000 + i);
+        VariableContext *context = tagRegistryFind(registry, &nodeId);
+        if (context && context == tagRegistryAt(registry, context->index))
+            found++;
+    }
+    double lookupSeconds = benchElapsedSeconds(&start);
+
+    printf("  仅注册表             %8.3f s  %10.0f 个/s\n", registerSeconds, tagCount / registerSeconds);
+    printf("  创建 (含地址空间节点) %8.3f s  %10.0f 个/s\n", createSeconds, tagCount / createSeconds);
+    printf("  模拟遍历             %8.3f s  %10.0f 个/s\n", sweepSeconds, tagCount / sweepSeconds);
+    printf("  按NodeId查找         %8.3f s  %10.0f 次/s (命中 %zu)\n", lookupSeconds,
+           tagCount / lookupSeconds, found);
+
+    UA_Server_delete(server);
+    cleanupSimulationEngine(&g_serverContext.simulationEngine);
+    cleanupTagRegistry(registry);
+    return found == (size_t)tagCount ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// 逐个分组比较批量内核与 updateSimulatedValue 的吞吐量，并校验正弦结果
+static int runSimulationKernelBenchmark(int tagsPerGroup, int iterations)
+{
+    static const struct
+    {
+        const char *name;
+        SimulationType simulation;
+        int typeIndex;
+        double param1, param2, param3;
+    } kernels[SIMULATION_GROUP_COUNT] = {
+        {"sine/float", SIMULATION_SINE_WAVE, UA_TYPES_FLOAT, 0.1, 10.0, 20.0},
+        {"sine/double", SIMULATION_SINE_WAVE, UA_TYPES_DOUBLE, 0.05, 100.0, 0.0},
+        {"random/int32", SIMULATION_RANDOM, UA_TYPES_INT32, 0.0, 0.0, 100.0},
+        {"random/float", SIMULATION_RANDOM, UA_TYPES_FLOAT, 0.0, 0.0, 1.0},
+        {"counter/int32", SIMULATION_COUNTER, UA_TYPES_INT32, 1.0, 0.0, 0.0},
+        {"counter/uint32", SIMULATION_COUNTER, UA_TYPES_UINT32, 1.0, 0.0, 0.0},
+        {"square/boolean", SIMULATION_SQUARE_WAVE, UA_TYPES_BOOLEAN, 10.0, 0.0, 0.0},
+        {"gaussian/float", SIMULATION_GAUSSIAN_NOISE, UA_TYPES_FLOAT, 0.0, 0.0, 1.0},
+        {"gaussian/double", SIMULATION_GAUSSIAN_NOISE, UA_TYPES_DOUBLE, 0.0, 50.0, 2.0},
+    };
+
+    printf("模拟内核基准: 每组%d个变量, %d轮\n", tagsPerGroup, iterations);
+    printf("  %-16s %14s %14s %14s\n", "内核", "逐个 (个/s)", "批量 (个/s)", "仅内核 (个/s)");
+
+    int result = EXIT_SUCCESS;
+    for (int k = 0; k < SIMULATION_GROUP_COUNT; k++)
+    {
+        TagRegistry registry;
+        SimulationEngine engine;
+        memset(&registry, 0, sizeof(TagRegistry));
+        memset(&engine, 0, sizeof(SimulationEngine));
+
+        for (int i = 0; i < tagsPerGroup; i++)
+        {
+            VariableContext *context = tagRegistryAllocate(&registry);
+            if (!context)
+                break;
+            context->type = &UA_TYPES[kernels[k].typeIndex];
+            context->simulation = kernels[k].simulation;
+            // 每个变量使用不同频率，避免所有结果相同
+            context->simulationParam1 = kernels[k].param1 * (1.0 + (i % 7));
+            context->simulationParam2 = kernels[k].param2;
+            context->simulationParam3 = kernels[k].param3;
+            UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 200000 + i);
+            if (tagRegistryCommit(&registry, context, &nodeId) != UA_STATUSCODE_GOOD ||
+                simulationEngineAdd(&engine, context) != UA_STATUSCODE_GOOD)
+                break;
+        }
+        size_t count = registry.count;
+        double now = simulationTime();
+
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int it = 0; it < iterations; it++)
+        {
+            for (size_t c = 0; c < registry.chunkCount; c++)
+            {
+                VariableContext *chunk = registry.chunks[c];
+                size_t remaining = count - (c << TAG_CHUNK_SHIFT);
+                size_t n = remaining < TAG_CHUNK_SIZE ? remaining : TAG_CHUNK_SIZE;
+                for (size_t i = 0; i < n; i++)
+                    updateSimulatedValue(&chunk[i], now + it, 0);
+            }
+        }
+        double scalarSeconds = benchElapsedSeconds(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int it = 0; it < iterations; it++)
+            simulationEngineStep(&engine, now + it);
+        double batchSeconds = benchElapsedSeconds(&start);
+
+        // 只运行内核计算，不写回值单元
+        SimulationGroup *group = engine.groups[0];
+        double out[SIMULATION_BLOCK_SIZE];
+        UA_UInt32 counters[SIMULATION_BLOCK_SIZE];
+        UA_Byte flags[SIMULATION_BLOCK_SIZE];
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int it = 0; it < iterations; it++)
+        {
+            for (size_t begin = 0; begin < count; begin += SIMULATION_BLOCK_SIZE)
+            {
+                size_t n = count - begin < SIMULATION_BLOCK_SIZE ? count - begin : SIMULATION_BLOCK_SIZE;
+                if (group->frequency)
+                    sineKernel(n, now + it, group->phase + begin, group->frequency + begin,
+                               group->amplitude + begin, group->offset + begin, out);
+                else if (group->mean)
+                    gaussianKernel(n, g_serverContext.runSeed, group->rngStream + begin,
+                                   group->rngCounter + begin, out);
+                else if (group->rngCounter)
+                    uniformKernel(n, g_serverContext.runSeed, group->rngStream + begin,
+                                  group->rngCounter + begin, out);
+                else if (group->increment)
+                    counterKernel(n, group->increment + begin, group->increment + begin, counters);
+                else
+                    squareKernel(n, now + it, group->period + begin, flags);
+            }
+        }
+        double kernelSeconds = benchElapsedSeconds(&start);
+
+        printf("  %-16s %14.0f %14.0f %14.0f\n", kernels[k].name,
+               count * (double)iterations / scalarSeconds, count * (double)iterations / batchSeconds,
+               count * (double)iterations / kernelSeconds);
+
+        // 正弦内核与libm结果比较（相对于振幅）
+        if (kernels[k].simulation == SIMULATION_SINE_WAVE)
+        {
+            double last = now + iterations - 1;
+            double maxError = 0.0;
+            for (size_t i = 0; i < count; i++)
+            {
+                VariableContext *context = tagRegistryAt(&registry, i);
+                double expected = sin(2 * M_PI * context->simulationParam1 * last / 60.0);
+                ScalarValue value = valueCellLoad(&context->cell);
+                double actual = context->type == &UA_TYPES[UA_TYPES_FLOAT] ? value.floatValue
+                                                                           : value.doubleValue;
+                double error = fabs((actual - context->simulationParam3) / context->simulationParam2 - expected);
+                if (error > maxError)
+                    maxError = error;
+            }
+            printf("  %-16s 最大误差 %.3g\n", "", maxError);
+            if (maxError > 1e-6)
+                result = EXIT_FAILURE;
+        }
+
+        cleanupSimulationEngine(&engine);
+        cleanupTagRegistry(&registry);
+    }
+
+    return result;
+}
+
+// 创建按给定周期轮流分配的计数器变量，计数值即触发次数
+static void benchAddTimedCounters(TagRegistry *registry, int count, const UA_UInt32 *periods, size_t periodCount)
+{
+    for (int i = 0; i < count; i++)
+    {
+        VariableContext *context = tagRegistryAllocate(registry);
+        if (!context)
+            return;
+        context->type = &UA_TYPES[UA_TYPES_UINT32];
+        context->simulation = SIMULATION_COUNTER;
+        context->simulationParam1 = 1;
+        context->updatePeriodMs = periods[i % periodCount];
+        UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 300000 + i);
+        tagRegistryCommit(registry, context, &nodeId);
+    }
+}
+
+// 先用虚拟时间校验各层时间轮的触发次数，再实时运行测量唤醒抖动
+static int runTimingWheelBenchmark(int tagCount)
+{
+    static const UA_UInt32 virtualPeriods[] = {10, 1000, 60000, 3600000};
+    static const UA_UInt32 realtimePeriods[] = {10, 100, 1000, 10000};
+    const UA_UInt64 virtualTicks = 400000;
+    int result = EXIT_SUCCESS;
+
+    TimingWheel *wheel = (TimingWheel *)UA_calloc(1, sizeof(TimingWheel));
+    TagRegistry registry;
+    memset(&registry, 0, sizeof(TagRegistry));
+    benchAddTimedCounters(&registry, 16, virtualPeriods, 4);
+    timingWheelScheduleAll(wheel, &registry, NULL, SIMULATION_ENGINE_SCALAR);
+    for (UA_UInt64 tick = 1; tick <= virtualTicks; tick++)
+        timingWheelAdvance(wheel, tick, 0.0);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < registry.count; i++)
+    {
+        VariableContext *context = tagRegistryAt(&registry, i);
+        UA_UInt64 expected = (virtualTicks - 1) / simulationPeriodTicks(context->updatePeriodMs) + 1;
+        if (valueCellLoad(&context->cell).uint32 != expected)
+            mismatches++;
+    }
+    printf("时间轮基准: 周期粒度 %dms\n", SIMULATION_TICK_MS);
+    printf("  虚拟时间 %llu 个周期 (10ms-1h): 触发次数不符 %zu 个变量\n",
+           (unsigned long long)virtualTicks, mismatches);
+    if (mismatches > 0)
+        result = EXIT_FAILURE;
+    cleanupTagRegistry(&registry);
+
+    memset(wheel, 0, sizeof(TimingWheel));
+    memset(&registry, 0, sizeof(TagRegistry));
+    benchAddTimedCounters(&registry, tagCount, realtimePeriods, 4);
+    timingWheelScheduleAll(wheel, &registry, NULL, SIMULATION_ENGINE_SCALAR);
+    runSimulationScheduler(wheel, 1.0);
+
+    // 10ms变量每次推进都应触发一次（迟到的周期合并处理）
+    VariableContext *fastest = tagRegistryAt(&registry, 0);
+    UA_UInt32 fastestCount = valueCellLoad(&fastest->cell).uint32;
+    printf("  实时 %d个变量 (10ms/100ms/1s/10s): 周期数 %llu, 每周期处理 %.1f 个变量\n", tagCount,
+           (unsigned long long)wheel->ticks, wheel->ticks ? (double)wheel->firedTimers / wheel->ticks : 0.0);
+    printf("  抖动 平均 %.1fus 最大 %.1fus, 超时 %llu次 (合并周期 %llu)\n",
+           wheel->ticks ? wheel->totalJitterNs / 1e3 / wheel->ticks : 0.0, wheel->maxJitterNs / 1e3,
+           (unsigned long long)wheel->overruns, (unsigned long long)wheel->missedTicks);
+    if (fastestCount != wheel->ticks)
+    {
+        printf("  10ms变量触发 %u 次，期望 %llu 次\n", fastestCount, (unsigned long long)wheel->ticks);
+        result = EXIT_FAILURE;
+    }
+
+    cleanupTagRegistry(&registry);
+    UA_free(wheel->fired);
+    UA_free(wheel);
+    return result;
+}
+
+// 比较急切模式每个周期计算全部变量与惰性模式只为被读取变量求值的开销
+static int runLazySimulationBenchmark(int tagCount)
+{
+    static const struct
+    {
+        SimulationType simulation;
+        int typeIndex;
+        double param1, param2, param3;
+    } mix[] = {
+        {SIMULATION_SINE_WAVE, UA_TYPES_DOUBLE, 0.1, 10.0, 0.0},
+        {SIMULATION_SQUARE_WAVE, UA_TYPES_BOOLEAN, 10.0, 0.0, 0.0},
+        {SIMULATION_COUNTER, UA_TYPES_UINT32, 1.0, 0.0, 0.0},
+        {SIMULATION_RANDOM, UA_TYPES_INT32, 0.0, 0.0, 100.0},
+    };
+    const size_t mixCount = sizeof(mix) / sizeof(mix[0]);
+
+    // 取整秒中点，避免周期序号落在边界上
+    double now = floor(simulationTime()) + 0.5;
+    TagRegistry registry;
+    memset(&registry, 0, sizeof(TagRegistry));
+    for (int i = 0; i < tagCount; i++)
+    {
+        VariableContext *context = tagRegistryAllocate(&registry);
+        if (!context)
+            break;
+        context->type = &UA_TYPES[mix[i % mixCount].typeIndex];
+        context->simulation = mix[i % mixCount].simulation;
+        context->simulationParam1 = mix[i % mixCount].param1;
+        context->simulationParam2 = mix[i % mixCount].param2;
+        context->simulationParam3 = mix[i % mixCount].param3;
+        context->updatePeriodMs = SIMULATION_INTERVAL_MS;
+        context->lazyStep = simulationStepAt(context, now);
+        UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 400000 + i);
+        tagRegistryCommit(&registry, context, &nodeId);
+    }
+    size_t count = registry.count;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < count; i++)
+        updateSimulatedValue(tagRegistryAt(&registry, i), now, 0);
+    double eagerSeconds = benchElapsedSeconds(&start);
+
+    // 下一个周期内读取1%的变量
+    size_t reads = count / 100 ? count / 100 : 1;
+    double later = now + SIMULATION_INTERVAL_MS / 1000.0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t r = 0; r < reads; r++)
+        evaluateSimulatedValue(tagRegistryAt(&registry, (r * 7919) % count), later);
+    double lazySeconds = benchElapsedSeconds(&start);
+
+    // 计数器经过1000个周期后一次追赶
+    VariableContext *counter = tagRegistryAt(&registry, 2);
+    counter->lazyStep = simulationStepAt(counter, now);
+    UA_UInt32 before = valueCellLoad(&counter->cell).uint32;
+    evaluateSimulatedValue(counter, now + 1000 * (SIMULATION_INTERVAL_MS / 1000.0));
+    UA_UInt32 gained = valueCellLoad(&counter->cell).uint32 - before;
+
+    printf("惰性模拟基准: %zu个变量, 更新周期 %dms\n", count, SIMULATION_INTERVAL_MS);
+    printf("  急切: 每个周期计算全部变量 %8.3f ms\n", eagerSeconds * 1e3);
+    printf("  惰性: 每个周期读取 %zu 个变量 %8.3f ms (单次求值 %.0f ns)\n", reads, lazySeconds * 1e3,
+           lazySeconds * 1e9 / reads);
+    printf("  计数器追赶1000个周期: 增加 %u\n", gained);
+
+    cleanupTagRegistry(&registry);
+    return gained == 1000 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// 比较全部变量周期计算与只计算5%被读取变量时推进时间轮的开销
+static int runObservedSetBenchmark(int tagCount)
+{
+    static const UA_UInt32 period[] = {SIMULATION_INTERVAL_MS};
+    const UA_UInt64 ticksPerPeriod = simulationPeriodTicks(SIMULATION_INTERVAL_MS);
+    int result = EXIT_SUCCESS;
+
+    TagRegistry registry;
+    memset(&registry, 0, sizeof(TagRegistry));
+    benchAddTimedCounters(&registry, tagCount, period, 1);
+    size_t count = registry.count;
+    double now = floor(simulationTime()) + 0.5;
+
+    // 全部变量
+    TimingWheel *wheel = (TimingWheel *)UA_calloc(1, sizeof(TimingWheel));
+    timingWheelScheduleAll(wheel, &registry, NULL, SIMULATION_ENGINE_SCALAR);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    timingWheelAdvance(wheel, ticksPerPeriod, now);
+    double fullSeconds = benchElapsedSeconds(&start);
+
+    // 观察集合：读取5%的变量后只计算这些变量
+    memset(wheel, 0, sizeof(TimingWheel));
+    for (size_t i = 0; i < count; i++)
+        tagRegistryAt(&registry, i)->lazyStep = simulationStepAt(tagRegistryAt(&registry, i), now);
+    g_serverContext.simulationEngineMode = SIMULATION_ENGINE_SCALAR;
+    g_serverContext.observedSet.enabled = true;
+    size_t observedCount = count / 20 ? count / 20 : 1;
+    for (size_t i = 0; i < observedCount; i++)
+        observedSetOnRead(tagRegistryAt(&registry, i * 20), now);
+    observedSetDrain(wheel);
+    size_t activeAfterRead = g_serverContext.observedSet.activeCount;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    timingWheelAdvance(wheel, ticksPerPeriod, now);
+    double observedSeconds = benchElapsedSeconds(&start);
+
+    // 超出观察窗口后全部移出，之后的读取按经过的周期补算
+    double expired = now + g_serverContext.observedSet.windowMs / 1000.0 + 1.0;
+    timingWheelAdvance(wheel, wheel->currentTick + ticksPerPeriod, expired);
+    size_t activeAfterWindow = g_serverContext.observedSet.activeCount;
+
+    VariableContext *tag = tagRegistryAt(&registry, 0);
+    UA_UInt32 before = valueCellLoad(&tag->cell).uint32;
+    observedSetOnRead(tag, expired + 5 * (SIMULATION_INTERVAL_MS / 1000.0));
+    UA_UInt32 caughtUp = valueCellLoad(&tag->cell).uint32 - before;
+    observedSetDrain(wheel);
+
+    printf("观察集合基准: %zu个变量, 观察 %zu 个\n", count, observedCount);
+    printf("  全部计算: 每个更新周期 %8.3f ms\n", fullSeconds * 1e3);
+    printf("  观察集合: 每个更新周期 %8.3f ms (集合大小 %zu)\n", observedSeconds * 1e3, activeAfterRead);
+    printf("  超出观察窗口后集合大小 %zu, 重新读取时补算 %u 个周期\n", activeAfterWindow, caughtUp);
+    if (activeAfterRead != observedCount || activeAfterWindow != 0 || caughtUp != 5)
+        result = EXIT_FAILURE;
+
+    g_serverContext.observedSet.enabled = false;
+    cleanupTagRegistry(&registry);
+    UA_free(wheel->fired);
+    UA_free(wheel);
+    return result;
+}
+
+// 按逆序分块生成，模拟分片在不同线程上以任意顺序计算
+static void benchGenerateBlocks(UA_Boolean gaussian, size_t count, UA_UInt64 seed,
+                                const UA_UInt32 *stream, UA_UInt64 *counter, double *out)
+{
+    const size_t block = 777;
+    for (size_t end = count; end > 0;)
+    {
+        size_t begin = end > block ? end - block : 0;
+        if (gaussian)
+            gaussianKernel(end - begin, seed, stream + begin, counter + begin, out + begin);
+        else
+            uniformKernel(end - begin, seed, stream + begin, counter + begin, out + begin);
+        end = begin;
+    }
+}
+
+// 计数器随机数：整组批量、逆序分块与逐个生成的结果逐位一致，并与rand()比较吞吐量
+static int runRandomBenchmark(int count)
+{
+    const int rounds = 20;
+    const UA_UInt64 seed = 20240601;
+    int result = EXIT_SUCCESS;
+
+    UA_UInt32 *stream = (UA_UInt32 *)UA_malloc(count * sizeof(UA_UInt32));
+    UA_UInt64 *counterWhole = (UA_UInt64 *)UA_calloc(count, sizeof(UA_UInt64));
+    UA_UInt64 *counterBlocks = (UA_UInt64 *)UA_calloc(count, sizeof(UA_UInt64));
+    double *whole = (double *)UA_malloc(count * sizeof(double));
+    double *blocks = (double *)UA_malloc(count * sizeof(double));
+    for (int i = 0; i < count; i++)
+        stream[i] = (UA_UInt32)i;
+
+    printf("计数器随机数基准: %d个变量流, %d轮\n", count, rounds);
+    for (int g = 0; g < 2; g++)
+    {
+        UA_Boolean gaussian = (g == 1);
+        memset(counterWhole, 0, count * sizeof(UA_UInt64));
+        memset(counterBlocks, 0, count * sizeof(UA_UInt64));
+
+        size_t mismatches = 0;
+        double sum = 0.0, sumSquares = 0.0;
+        struct timespec start;
+        double kernelSeconds = 0.0;
+        for (int r = 0; r < rounds; r++)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            if (gaussian)
+                gaussianKernel(count, seed, stream, counterWhole, whole);
+            else
+                uniformKernel(count, seed, stream, counterWhole, whole);
+            kernelSeconds += benchElapsedSeconds(&start);
+
+            benchGenerateBlocks(gaussian, count, seed, stream, counterBlocks, blocks);
+            for (int i = 0; i < count; i++)
+            {
+                double single = gaussian ? philoxGaussian(seed, stream[i], (UA_UInt64)r)
+                                         : philoxUniform(seed, stream[i], (UA_UInt64)r);
+                if (memcmp(&whole[i], &blocks[i], sizeof(double)) != 0 ||
+                    memcmp(&whole[i], &single, sizeof(double)) != 0)
+                    mismatches++;
+                sum += whole[i];
+                sumSquares += whole[i] * whole[i];
+            }
+        }
+
+        double samples = (double)count * rounds;
+        double mean = sum / samples;
+        double variance = sumSquares / samples - mean * mean;
+        double expectedMean = gaussian ? 0.0 : 0.5;
+        double expectedVariance = gaussian ? 1.0 : 1.0 / 12.0;
+        printf("  %-8s %12.0f 个/s  均值 %.4f  方差 %.4f  不一致 %zu\n", gaussian ? "正态" : "均匀",
+               samples / kernelSeconds, mean, variance, mismatches);
+        if (mismatches > 0 || fabs(mean - expectedMean) > 0.01 ||
+            fabs(variance - expectedVariance) > 0.02 * expectedVariance)
+            result = EXIT_FAILURE;
+    }
+
+    // 对比libc rand()（全局状态，只能串行生成）
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < count; i++)
+            whole[i] = (double)rand() / RAND_MAX;
+    printf("  %-8s %12.0f 个/s\n", "rand()", (double)count * rounds / benchElapsedSeconds(&start));
+
+    // 不同种子产生不同序列
+    uniformKernel(1, seed + 1, stream, counterWhole, blocks);
+    uniformKernel(1, seed, stream, counterBlocks, whole);
+    if (blocks[0] == whole[0])
+        result = EXIT_FAILURE;
+
+    UA_free(stream);
+    UA_free(counterWhole);
+    UA_free(counterBlocks);
+    UA_free(whole);
+    UA_free(blocks);
+    return result;
+}
+
+// 重置模拟状态，使不同线程数从相同起点计算
+static void benchResetSimulation(TagRegistry *registry, SimulationEngine *engine)
+{
+    ScalarValue zero = {0};
+    for (size_t i = 0; i < registry->count; i++)
+    {
+        VariableContext *context = tagRegistryAt(registry, i);
+        valueCellStore(&context->cell, zero);
+        context->rngCounter = 0;
+    }
+    for (size_t g = 0; g < engine->groupCount; g++)
+    {
+        SimulationGroup *group = engine->groups[g];
+        if (group->rngCounter)
+            memset(group->rngCounter, 0, group->count * sizeof(UA_UInt64));
+    }
+}
+
+static UA_UInt64 benchChecksum(const TagRegistry *registry)
+{
+    UA_UInt64 hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < registry->count; i++)
+        hash = (hash ^ valueCellLoad(&tagRegistryAt(registry, i)->cell).bits) * 1099511628211ULL;
+    return hash;
+}
+
+// 与模拟线程池并发读取所有计数器的同一周期快照：同一周期内各计数器的累加次数相同，
+// 不同则读到了两个周期的值。遍历期间发布了新周期时快照无效，重新读取
+typedef struct
+{
+    VariableContext **counters;
+    size_t count;
+    volatile UA_Boolean running;
+    UA_UInt64 snapshots;
+    UA_UInt64 retries;
+    UA_UInt64 mixed;
+} BenchSnapshotReader;
+
+static void *benchSnapshotReaderThread(void *arg)
+{
+    BenchSnapshotReader *reader = (BenchSnapshotReader *)arg;
+    const UA_UInt64 *epoch = g_serverContext.simulationEpoch;
+    while (reader->running)
+    {
+        UA_UInt64 completed = __atomic_load_n(epoch, __ATOMIC_ACQUIRE);
+        UA_Int32 ticks = 0;
+        UA_Boolean mixed = false;
+        for (size_t i = 0; i < reader->count; i++)
+        {
+            VariableContext *context = reader->counters[i];
+            UA_Int32 n = valueCellReadAt(&context->cell, completed).int32 / (UA_Int32)context->simulationParam1;
+            if (i == 0)
+                ticks = n;
+            else if (n != ticks)
+                mixed = true;
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(epoch, __ATOMIC_RELAXED) != completed)
+        {
+            reader->retries++;
+        }
+        else
+        {
+            __atomic_add_fetch(&reader->snapshots, 1, __ATOMIC_RELAXED);
+            if (mixed)
+                reader->mixed++;
+        }
+        // 单核机器上让计算线程运行，之后的快照可能落在周期计算中途
+        sched_yield();
+    }
+    return NULL;
+}
+
+static int runSimulationThreadsBenchmark(int count)
+{
+    static const struct
+    {
+        SimulationType simulation;
+        int typeIndex;
+        double param1, param2, param3;
+    } kinds[] = {
+        {SIMULATION_SINE_WAVE, UA_TYPES_DOUBLE, 0.05, 100.0, 0.0},
+        {SIMULATION_GAUSSIAN_NOISE, UA_TYPES_DOUBLE, 0.0, 50.0, 2.0},
+        {SIMULATION_COUNTER, UA_TYPES_INT32, 1.0, 0.0, 0.0},
+        {SIMULATION_RANDOM, UA_TYPES_FLOAT, 0.0, 0.0, 1.0},
+        {SIMULATION_SQUARE_WAVE, UA_TYPES_BOOLEAN, 10.0, 0.0, 0.0},
+    };
+    const size_t kindCount = sizeof(kinds) / sizeof(kinds[0]);
+    const int rounds = 50;
+
+    TagRegistry registry;
+    SimulationEngine engine;
+    memset(&registry, 0, sizeof(TagRegistry));
+    memset(&engine, 0, sizeof(SimulationEngine));
+
+    // 重的内核（正弦、正态）与轻的计数器连续分布，静态均分会导致负载不均
+    for (int i = 0; i < count; i++)
+    {
+        size_t k = (size_t)i * kindCount / count;
+        VariableContext *context = tagRegistryAllocate(&registry);
+        if (!context)
+            break;
+        context->type = &UA_TYPES[kinds[k].typeIndex];
+        context->simulation = kinds[k].simulation;
+        context->simulationParam1 = kinds[k].param1 * (1.0 + (i % 7));
+        context->simulationParam2 = kinds[k].param2;
+        context->simulationParam3 = kinds[k].param3;
+        UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 400000 + i);
+        if (tagRegistryCommit(&registry, context, &nodeId) != UA_STATUSCODE_GOOD ||
+            simulationEngineAdd(&engine, context) != UA_STATUSCODE_GOOD)
+            break;
+    }
+
+    // 批量模式每个分组一个定时器，逐个模式每个变量一个定时器
+    size_t tagCount = registry.count;
+    SimulationTimer *timers = (SimulationTimer *)UA_calloc(tagCount + engine.groupCount, sizeof(SimulationTimer));
+    SimulationTimer **tagFired = (SimulationTimer **)UA_malloc(tagCount * sizeof(SimulationTimer *));
+    SimulationTimer **groupFired = (SimulationTimer **)UA_malloc(engine.groupCount * sizeof(SimulationTimer *));
+    for (size_t i = 0; i < tagCount; i++)
+    {
+        timers[i].tag = tagRegistryAt(&registry, i);
+        tagFired[i] = &timers[i];
+    }
+    for (size_t g = 0; g < engine.groupCount; g++)
+    {
+        timers[tagCount + g].group = engine.groups[g];
+        groupFired[g] = &timers[tagCount + g];
+    }
+
+    int maxThreads = defaultSimulationThreads() + 1;
+    if (maxThreads < 4)
+        maxThreads = 4;
+    printf("并行模拟基准: %zu个变量, %d个分组, 每种线程数%d个周期\n", tagCount, (int)engine.groupCount, rounds);
+    printf("  %-8s %14s %14s %10s\n", "线程数", "批量 (周期/s)", "逐个 (周期/s)", "窃取任务");
+
+    int result = EXIT_SUCCESS;
+    UA_UInt64 reference[2] = {0, 0};
+    double base = simulationTime();
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        SimulationPool pool;
+        simulationPoolStart(&pool, threads);
+        double ticksPerSecond[2];
+        for (int mode = 0; mode < 2; mode++)
+        {
+            SimulationTimer **fired = mode == 0 ? groupFired : tagFired;
+            size_t firedCount = mode == 0 ? engine.groupCount : tagCount;
+            benchResetSimulation(&registry, &engine);
+
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (int r = 0; r < rounds; r++)
+            {
+                UA_UInt64 epoch = simulationNextEpoch();
+                simulationPoolRun(&pool, fired, firedCount, base + r * 0.01, epoch);
+                simulationPublishEpoch(epoch);
+            }
+            ticksPerSecond[mode] = rounds / benchElapsedSeconds(&start);
+
+            // 结果只取决于周期和变量，与线程数和任务调度顺序无关
+            UA_UInt64 checksum = benchChecksum(&registry);
+            if (threads == 1)
+                reference[mode] = checksum;
+            else if (checksum != reference[mode])
+                result = EXIT_FAILURE;
+        }
+        printf("  %-8d %14.1f %14.1f %10llu%s\n", pool.threadCount, ticksPerSecond[0], ticksPerSecond[1],
+               (unsigned long long)pool.steals, pool.threadCount == threads ? "" : " (线程创建失败)");
+        simulationPoolStop(&pool);
+    }
+    if (result != EXIT_SUCCESS)
+        printf("  多线程结果与单线程不一致\n");
+
+    // 周期计算期间另一线程反复读取全部计数器，每次读到的都应属于同一个完整周期
+    BenchSnapshotReader reader;
+    memset(&reader, 0, sizeof(reader));
+    reader.counters = (VariableContext **)UA_malloc(tagCount * sizeof(VariableContext *));
+    for (size_t i = 0; reader.counters && i < tagCount; i++)
+    {
+        VariableContext *context = tagRegistryAt(&registry, i);
+        if (context->simulation == SIMULATION_COUNTER)
+            reader.counters[reader.count++] = context;
+    }
+    SimulationPool pool;
+    simulationPoolStart(&pool, maxThreads);
+    UA_UInt64 snapshots[2] = {0, 0};
+    UA_UInt64 retries[2] = {0, 0};
+    UA_UInt64 mixed[2] = {0, 0};
+    for (int mode = 0; mode < 2 && reader.count > 0; mode++)
+    {
+        SimulationTimer **fired = mode == 0 ? groupFired : tagFired;
+        size_t firedCount = mode == 0 ? engine.groupCount : tagCount;
+        benchResetSimulation(&registry, &engine);
+        reader.running = true;
+        reader.snapshots = 0;
+        reader.retries = 0;
+        reader.mixed = 0;
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, benchSnapshotReaderThread, &reader) != 0)
+        {
+            result = EXIT_FAILURE;
+            break;
+        }
+        // 读取方至少完成一次快照后才开始计算
+        while (__atomic_load_n(&reader.snapshots, __ATOMIC_RELAXED) == 0)
+            sched_yield();
+        // 周期之间留出间隔，读取方既能在两次发布之间完成快照，也会与周期计算交错
+        for (int r = 0; r < rounds; r++)
+        {
+            UA_UInt64 epoch = simulationNextEpoch();
+            simulationPoolRun(&pool, fired, firedCount, base + r * 0.01, epoch);
+            simulationPublishEpoch(epoch);
+            usleep(1000);
+        }
+        reader.running = false;
+        pthread_join(thread, NULL);
+        snapshots[mode] = reader.snapshots;
+        retries[mode] = reader.retries;
+        mixed[mode] = reader.mixed;
+    }
+    simulationPoolStop(&pool);
+    printf("  并发读取%zu个计数器的快照 (%d个线程):\n", reader.count, maxThreads);
+    for (int mode = 0; mode < 2; mode++)
+        printf("    %s: 快照 %llu 次, 遍历期间发布新周期而重读 %llu 次, 混合周期 %llu 次\n", mode == 0 ? "批量" : "逐个",
+               (unsigned long long)snapshots[mode], (unsigned long long)retries[mode],
+               (unsigned long long)mixed[mode]);
+    if (reader.count == 0 || mixed[0] > 0 || mixed[1] > 0)
+    {
+        printf("  读取方看到了不同周期的值\n");
+        result = EXIT_FAILURE;
+    }
+    UA_free(reader.counters);
+
+    UA_free(timers);
+    UA_free(tagFired);
+    UA_free(groupFired);
+    cleanupSimulationEngine(&engine);
+    cleanupTagRegistry(&registry);
+    return result;
+}
+
+static UA_UInt64 *g_benchPushUpdateNs; // 每个变量最近一次更新的时间
+static UA_UInt64 g_benchPushNotifications;
+static double g_benchPushLatencySum;
+static double g_benchPushLatencyMax;
+
+static UA_UInt64 benchMonotonicNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (UA_UInt64)now.tv_sec * 1000000000ULL + (UA_UInt64)now.tv_nsec;
+}
+
+static void benchPushCallback(UA_Server *server, UA_UInt32 monitoredItemId, void *monitoredItemContext,
+                              const UA_NodeId *nodeId, void *nodeContext, UA_UInt32 attributeId,
+                              const UA_DataValue *value)
+{
+    UA_UInt64 updated = g_benchPushUpdateNs[(size_t)(uintptr_t)monitoredItemContext];
+    if (!updated)
+        return; // 创建监视项时的首次采样
+    double latencyMs = (benchMonotonicNs() - updated) / 1e6;
+    g_benchPushNotifications++;
+    g_benchPushLatencySum += latencyMs;
+    if (latencyMs > g_benchPushLatencyMax)
+        g_benchPushLatencyMax = latencyMs;
+}
+
+// 在当前线程驱动服务器主循环到指定时间
+static void benchIterateUntil(UA_Server *server, UA_UInt64 deadlineNs)
+{
+    while (benchMonotonicNs() < deadlineNs)
+    {
+        UA_Server_run_iterate(server, false);
+        struct timespec pause = {0, 500000};
+        nanosleep(&pause, NULL);
+    }
+}
+
+static int runChangePushBenchmark(int tagCount)
+{
+    static const char *modeNames[] = {"采样", "推送"};
+    const int ticks = 100; // 每个周期更新10%的变量，每个变量每100ms变化一次
+    const double samplingIntervalMs = 100.0;
+    int result = EXIT_SUCCESS;
+    double latency[2] = {0};
+
+    printf("变化推送基准: %d个被监视的计数器变量, 采样间隔 %.0fms, %d个10ms周期\n", tagCount,
+           samplingIntervalMs, ticks);
+    printf("  %-6s %10s %10s %10s %14s %14s\n", "模式", "变化", "读取", "通知", "平均延迟(ms)", "最大延迟(ms)");
+
+    g_benchPushUpdateNs = (UA_UInt64 *)UA_malloc(tagCount * sizeof(UA_UInt64));
+    VariableContext **updated = (VariableContext **)UA_malloc(tagCount * sizeof(VariableContext *));
+    for (int m = 0; m < 2; m++)
+    {
+        UA_Boolean push = (m == 1);
+        g_serverContext.changePush.enabled = push;
+        memset(g_benchPushUpdateNs, 0, tagCount * sizeof(UA_UInt64));
+        g_benchPushNotifications = 0;
+        g_benchPushLatencySum = 0.0;
+        g_benchPushLatencyMax = 0.0;
+
+        UA_ServerConfig config;
+        memset(&config, 0, sizeof(UA_ServerConfig));
+        config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+        UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+        config.monitoredItemRegisterCallback = onMonitoredItemRegister;
+        UA_Server *server = UA_Server_newWithConfig(&config);
+        // 服务器在本线程中运行，不需要eventfd唤醒
+        if (push)
+        {
+            changePushInit(&g_serverContext.changePush, false);
+            changePushAttach(server, UA_Server_getConfig(server));
+        }
+
+        VariableContext **contexts = (VariableContext **)UA_malloc(tagCount * sizeof(VariableContext *));
+        for (int i = 0; i < tagCount; i++)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "PushTag%d", i);
+            UA_UInt32 initial = 0;
+            UA_NodeId nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 60000 + i), name,
+                                               &UA_TYPES[UA_TYPES_UINT32], &initial,
+                                               SIMULATION_COUNTER, 1, 0, 0);
+            contexts[i] = tagRegistryFind(&g_serverContext.tags, &nodeId);
+        }
+
+        UA_Server_run_startup(server);
+        for (int i = 0; i < tagCount; i++)
+        {
+            UA_MonitoredItemCreateRequest request = UA_MonitoredItemCreateRequest_default(contexts[i]->nodeId);
+            request.requestedParameters.samplingInterval = samplingIntervalMs;
+            UA_Server_createDataChangeMonitoredItem(server, UA_TIMESTAMPSTORETURN_BOTH, request,
+                                                    (void *)(uintptr_t)i, benchPushCallback);
+        }
+
+        UA_UInt64 readsBefore = g_serverContext.totalRequests;
+        UA_UInt64 changes = 0;
+        UA_UInt64 deadline = benchMonotonicNs();
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            double t = simulationTime();
+            size_t updatedCount = 0;
+            for (int i = tick % 10; i < tagCount; i += 10)
+            {
+                updateSimulatedValue(contexts[i], t, 0);
+                g_benchPushUpdateNs[i] = benchMonotonicNs();
+                updated[updatedCount++] = contexts[i];
+            }
+            changes += updatedCount;
+            changePushTags(updated, updatedCount, t);
+
+            deadline += SIMULATION_TICK_MS * 1000000ULL;
+            benchIterateUntil(server, deadline);
+        }
+        // 等待最后的变化被采样或推送
+        benchIterateUntil(server, deadline + (UA_UInt64)(samplingIntervalMs * 2e6));
+        UA_UInt64 reads = g_serverContext.totalRequests - readsBefore;
+
+        latency[m] = g_benchPushNotifications ? g_benchPushLatencySum / g_benchPushNotifications : 0.0;
+        printf("  %-6s %10llu %10llu %10llu %14.2f %14.2f\n", modeNames[m], (unsigned long long)changes,
+               (unsigned long long)reads, (unsigned long long)g_benchPushNotifications, latency[m],
+               g_benchPushLatencyMax);
+
+        // 推送模式：不再读取变量，每次变化恰好产生一个通知
+        if (push && (reads != 0 || g_benchPushNotifications != changes))
+            result = EXIT_FAILURE;
+        if (!push && reads == 0)
+            result = EXIT_FAILURE;
+
+        UA_Server_run_shutdown(server);
+        UA_Server_delete(server);
+        if (push)
+            cleanupChangePush(&g_serverContext.changePush);
+        UA_free(contexts);
+        cleanupSimulationEngine(&g_serverContext.simulationEngine);
+        cleanupTagRegistry(&g_serverContext.tags);
+    }
+    if (latency[1] >= latency[0])
+        result = EXIT_FAILURE;
+
+    g_serverContext.changePush.enabled = false;
+    UA_free(updated);
+    UA_free(g_benchPushUpdateNs);
+    return result;
+}
+
+typedef struct
+{
+    ChangePush *push;
+    UA_UInt32 producer;
+    UA_UInt64 count;
+    size_t batch;
+} ChangeQueueProducer;
+
+// 生产者按序写入，队列满时等待消费者而不丢弃，以便校验完整性
+static void *benchChangeQueueProducer(void *arg)
+{
+    ChangeQueueProducer *producer = (ChangeQueueProducer *)arg;
+    ChangeRecord records[CHANGE_PUSH_BATCH];
+    for (UA_UInt64 next = 0; next < producer->count;)
+    {
+        size_t n = 0;
+        for (; n < producer->batch && next < producer->count; n++, next++)
+        {
+            records[n].tag = producer->producer;
+            records[n].value.bits = next;
+            records[n].time = 0.0;
+        }
+        while (!changePushEnqueue(producer->push, records, n))
+            sched_yield();
+    }
+    return NULL;
+}
+
+static int benchChangeQueueThroughput(int producers, UA_UInt64 perProducer, size_t batch)
+{
+    ChangePush push;
+    memset(&push, 0, sizeof(push));
+    if (changePushInit(&push, false) != UA_STATUSCODE_GOOD)
+        return EXIT_FAILURE;
+
+    ChangeQueueProducer *threads = (ChangeQueueProducer *)UA_calloc(producers, sizeof(ChangeQueueProducer));
+    pthread_t *ids = (pthread_t *)UA_calloc(producers, sizeof(pthread_t));
+    UA_UInt64 *expected = (UA_UInt64 *)UA_calloc(producers, sizeof(UA_UInt64));
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int p = 0; p < producers; p++)
+    {
+        threads[p].push = &push;
+        threads[p].producer = (UA_UInt32)p;
+        threads[p].count = perProducer;
+        threads[p].batch = batch;
+        pthread_create(&ids[p], NULL, benchChangeQueueProducer, &threads[p]);
+    }
+
+    // 消费者：每个生产者的记录必须完整且保持顺序
+    UA_UInt64 total = (UA_UInt64)producers * perProducer, received = 0, errors = 0;
+    ChangeRecord record;
+    while (received < total)
+    {
+        UA_UInt64 depth = __atomic_load_n(&push.enqueuePos, __ATOMIC_RELAXED) - push.dequeuePos;
+        if (depth > push.maxDepth)
+            push.maxDepth = depth;
+        if (!changePushDequeue(&push, &record))
+        {
+            sched_yield();
+            continue;
+        }
+        if (record.tag >= (UA_UInt32)producers || record.value.bits != expected[record.tag]++)
+            errors++;
+        received++;
+    }
+    double seconds = benchElapsedSeconds(&start);
+    for (int p = 0; p < producers; p++)
+        pthread_join(ids[p], NULL);
+
+    printf("  %d个生产者 批量%-3zu %12.0f 条/s  最大深度 %6llu  错误 %llu\n", producers, batch,
+           total / seconds, (unsigned long long)push.maxDepth, (unsigned long long)errors);
+
+    UA_free(threads);
+    UA_free(ids);
+    UA_free(expected);
+    cleanupChangePush(&push);
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// 服务器主循环在独立线程中运行，测量从写入队列到通知监视项的延迟
+static double benchChangeQueueLatency(UA_Boolean useWakeup, int updates)
+{
+    ChangePush *push = &g_serverContext.changePush;
+    memset(push, 0, sizeof(*push));
+    push->enabled = true;
+    if (changePushInit(push, useWakeup) != UA_STATUSCODE_GOOD)
+        return -1.0;
+
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+    UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+    config.monitoredItemRegisterCallback = onMonitoredItemRegister;
+    UA_Server *server = UA_Server_newWithConfig(&config);
+    changePushAttach(server, UA_Server_getConfig(server));
+
+    UA_UInt32 initial = 0;
+    UA_NodeId nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 70000), "QueueTag",
+                                       &UA_TYPES[UA_TYPES_UINT32], &initial, SIMULATION_COUNTER, 1, 0, 0);
+    VariableContext *context = tagRegistryFind(&g_serverContext.tags, &nodeId);
+    UA_MonitoredItemCreateRequest request = UA_MonitoredItemCreateRequest_default(nodeId);
+    request.requestedParameters.samplingInterval = 1000.0;
+    g_benchPushUpdateNs = (UA_UInt64 *)UA_calloc(1, sizeof(UA_UInt64));
+    UA_Server_createDataChangeMonitoredItem(server, UA_TIMESTAMPSTORETURN_BOTH, request, NULL,
+                                            benchPushCallback);
+
+    g_benchServerRunning = true;
+    pthread_create(&g_benchServerThreadId, NULL, benchServerThread, server);
+    struct timespec pause = {0, 3000000};
+    nanosleep(&pause, NULL);
+    for (int i = 0; i < updates; i++)
+    {
+        updateSimulatedValue(context, simulationTime(), 0);
+        changePushTags(&context, 1, simulationTime());
+        nanosleep(&pause, NULL);
+    }
+    // 等待至少两个处理周期，确保仅周期处理时最后一条变化也被通知
+    struct timespec drain = {0, 2 * SIMULATION_TICK_MS * 1000000L};
+    nanosleep(&drain, NULL);
+    g_benchServerRunning = false;
+    pthread_join(g_benchServerThreadId, NULL);
+
+    UA_UInt64 notifications = push->notifications;
+    double latencyUs = notifications ? (double)push->totalLatencyUs / notifications : -1.0;
+    printf("  %-12s 通知 %4llu/%d  唤醒 %4llu  批次 %4llu  平均延迟 %8.1fus  最大延迟 %6lluus\n",
+           useWakeup ? "eventfd唤醒" : "仅周期处理", (unsigned long long)notifications, updates,
+           (unsigned long long)push->wakeups, (unsigned long long)push->batches, latencyUs,
+           (unsigned long long)push->maxLatencyUs);
+    if (notifications != (UA_UInt64)updates)
+        latencyUs = -1.0;
+
+    UA_Server_delete(server);
+    UA_free(g_benchPushUpdateNs);
+    g_benchPushUpdateNs = NULL;
+    cleanupChangePush(push);
+    push->enabled = false;
+    cleanupSimulationEngine(&g_serverContext.simulationEngine);
+    cleanupTagRegistry(&g_serverContext.tags);
+    return latencyUs;
+}
+
+static int runChangeQueueBenchmark(int recordsPerProducer)
+{
+    int result = EXIT_SUCCESS;
+    printf("变化推送队列基准: 每个生产者%d条记录, 队列容量%d\n", recordsPerProducer, 1 << CHANGE_RING_BITS);
+    for (int producers = 1; producers <= 4; producers *= 2)
+    {
+        if (benchChangeQueueThroughput(producers, (UA_UInt64)recordsPerProducer, 1) != EXIT_SUCCESS ||
+            benchChangeQueueThroughput(producers, (UA_UInt64)recordsPerProducer, CHANGE_PUSH_BATCH) != EXIT_SUCCESS)
+            result = EXIT_FAILURE;
+    }
+
+    double timerOnly = benchChangeQueueLatency(false, 200);
+    double wakeup = benchChangeQueueLatency(true, 200);
+    if (timerOnly < 0 || wakeup < 0 || wakeup >= timerOnly)
+        result = EXIT_FAILURE;
+    return result;
+}
+
+#define BENCH_CONNECT_WAVE 64 // 每轮同时发起的连接数，低于监听队列长度
+
+static void benchPutUInt32(UA_Byte *p, UA_UInt32 v)
+{
+    p[0] = (UA_Byte)v;
+    p[1] = (UA_Byte)(v >> 8);
+    p[2] = (UA_Byte)(v >> 16);
+    p[3] = (UA_Byte)(v >> 24);
+}
+
+// 发送OPC UA Hello消息，服务器应答Acknowledge
+static UA_Boolean benchSendHello(int fd)
+{
+    char url[64];
+    int urlLength = snprintf(url, sizeof(url), "opc.tcp://127.0.0.1:%d", BENCHMARK_PORT);
+    UA_Byte message[128];
+    UA_UInt32 size = 32 + (UA_UInt32)urlLength;
+    memcpy(message, "HELF", 4);
+    benchPutUInt32(message + 4, size);
+    benchPutUInt32(message + 8, 0);      // 协议版本
+    benchPutUInt32(message + 12, 65535); // 接收缓冲区
+    benchPutUInt32(message + 16, 65535); // 发送缓冲区
+    benchPutUInt32(message + 20, 0);     // 最大消息长度
+    benchPutUInt32(message + 24, 0);     // 最大分块数
+    benchPutUInt32(message + 28, (UA_UInt32)urlLength);
+    memcpy(message + 32, url, (size_t)urlLength);
+    return send(fd, message, size, 0) == (ssize_t)size;
+}
+
+// 同一进程内的服务器分别使用select、epoll和io_uring网络层，测量连接风暴的接受、空闲连接下的单次循环开销和Hello往返延迟
+static int runNetworkBenchmark(int connections)
+{
+    static const NetworkMode modes[] = {NETWORK_MODE_SELECT, NETWORK_MODE_EPOLL, NETWORK_MODE_URING};
+    const int idleIterations = 1000;
+    const int helloCount = connections < 100 ? connections : 100;
+    int result = EXIT_SUCCESS;
+    UA_UInt64 stormIterations[3] = {0};
+    UA_Boolean ran[3] = {false};
+
+    printf("网络层基准: %d个连接, 每轮发起%d个连接\n", connections, BENCH_CONNECT_WAVE);
+    printf("  %-8s %12s %12s %16s %16s\n", "网络层", "接受(ms)", "接受循环数", "空闲循环(us)", "Hello往返(us)");
+
+    // 客户端和服务器端套接字都在本进程中
+    raiseFileLimit((rlim_t)connections * 2 + 128);
+    int *fds = (int *)UA_malloc((size_t)connections * sizeof(int));
+    for (int m = 0; m < 3; m++)
+    {
+        const char *modeName = networkModeName(modes[m]);
+        if (modes[m] == NETWORK_MODE_SELECT && connections * 2 + 32 > FD_SETSIZE)
+        {
+            printf("  %-8s 连接数超过FD_SETSIZE (%d)，跳过\n", modeName, FD_SETSIZE);
+            continue;
+        }
+
+        UA_ServerConfig config;
+        memset(&config, 0, sizeof(UA_ServerConfig));
+        config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+        UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+        if (useNetworkLayer(&config, modes[m], BENCHMARK_PORT, NETWORK_MAX_CONNECTIONS) != modes[m])
+        {
+            printf("  %-8s 不可用，跳过\n", modeName);
+            UA_ServerConfig_clean(&config);
+            if (modes[m] != NETWORK_MODE_URING)
+                result = EXIT_FAILURE;
+            continue;
+        }
+        UA_Server *server = UA_Server_newWithConfig(&config);
+        UA_Server_run_startup(server);
+        ran[m] = true;
+
+        // 连接风暴：分轮发起非阻塞连接，每轮等服务器全部接受后再发起下一轮
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(BENCHMARK_PORT);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int opened = 0;
+        UA_UInt64 start = benchMonotonicNs();
+        UA_UInt64 timeout = start + 10000000000ULL;
+        while (opened < connections && benchMonotonicNs() < timeout)
+        {
+            int wave = connections - opened < BENCH_CONNECT_WAVE ? connections - opened : BENCH_CONNECT_WAVE;
+            for (int i = 0; i < wave; i++)
+            {
+                fds[opened + i] = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                connect(fds[opened + i], (struct sockaddr *)&address, sizeof(address));
+            }
+            opened += wave;
+            while (UA_Server_getStatistics(server).ns.currentConnectionCount < (size_t)opened &&
+                   benchMonotonicNs() < timeout)
+            {
+                UA_Server_run_iterate(server, false);
+                stormIterations[m]++;
+            }
+        }
+        double stormMs = (double)(benchMonotonicNs() - start) / 1e6;
+        size_t accepted = UA_Server_getStatistics(server).ns.currentConnectionCount;
+
+        // 所有连接空闲时的单次循环开销
+        start = benchMonotonicNs();
+        for (int i = 0; i < idleIterations; i++)
+            UA_Server_run_iterate(server, false);
+        double idleUs = (double)(benchMonotonicNs() - start) / 1e3 / idleIterations;
+
+        // 在部分连接上依次完成Hello/Acknowledge往返
+        int acknowledged = 0;
+        double helloUs = 0.0;
+        for (int i = 0; i < helloCount && accepted == (size_t)connections; i++)
+        {
+            int fd = fds[(size_t)i * (size_t)connections / (size_t)helloCount];
+            start = benchMonotonicNs();
+            if (!benchSendHello(fd))
+                break;
+            UA_Byte reply[64];
+            ssize_t received = 0;
+            timeout = start + 1000000000ULL;
+            while (received < 8 && benchMonotonicNs() < timeout)
+            {
+                UA_Server_run_iterate(server, false);
+                ssize_t ret = recv(fd, reply + received, sizeof(reply) - (size_t)received, 0);
+                if (ret > 0)
+                    received += ret;
+                else if (ret == 0)
+                    break;
+            }
+            if (received < 8 || memcmp(reply, "ACKF", 4) != 0)
+                break;
+            helloUs += (double)(benchMonotonicNs() - start) / 1e3;
+            acknowledged++;
+        }
+        if (acknowledged)
+            helloUs /= acknowledged;
+
+        printf("  %-8s %12.2f %12llu %16.2f %16.2f\n", modeName, stormMs,
+               (unsigned long long)stormIterations[m], idleUs, helloUs);
+        if (accepted != (size_t)connections || acknowledged != helloCount)
+        {
+            printf("  %s: 接受 %zu/%d 个连接, 应答 %d/%d 个Hello\n", modeName, accepted, connections,
+                   acknowledged, helloCount);
+            result = EXIT_FAILURE;
+        }
+
+        UA_Server_run_shutdown(server);
+        UA_Server_delete(server);
+        for (int i = 0; i < opened; i++)
+            close(fds[i]);
+    }
+    UA_free(fds);
+
+    // epoll和io_uring每次唤醒接受全部排队的连接，select每次循环只接受一个
+    for (int m = 1; m < 3; m++)
+    {
+        if (ran[0] && ran[m] && stormIterations[m] >= stormIterations[0])
+            result = EXIT_FAILURE;
+    }
+    return result;
+}
+
+// 只统计服务器线程的系统调用：线程安装seccomp过滤器，每次系统调用通知计数线程后继续执行
+typedef struct
+{
+    UA_Server *server;
+    volatile UA_Boolean running;
+    volatile UA_Boolean ready;
+    int listener; // seccomp通知描述符，-1表示无法计数
+    volatile UA_Boolean counting;
+    UA_UInt64 waits; // select/poll/epoll_wait/io_uring_enter
+    UA_UInt64 io;    // recv/send/read/write
+    UA_UInt64 other;
+} BenchSyscallCounter;
+
+static void *benchSyscallServerThread(void *arg)
+{
+    BenchSyscallCounter *counter = (BenchSyscallCounter *)arg;
+    UA_Server_run_startup(counter->server);
+
+    struct sock_filter filter[] = {BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_USER_NOTIF)};
+    struct sock_fprog program = {1, filter};
+    counter->listener = -1;
+    if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == 0)
+        counter->listener = (int)syscall(__NR_seccomp, SECCOMP_SET_MODE_FILTER,
+                                         SECCOMP_FILTER_FLAG_NEW_LISTENER, &program);
+    __atomic_store_n(&counter->ready, true, __ATOMIC_RELEASE);
+
+    while (counter->running)
+        UA_Server_run_iterate(counter->server, true);
+    UA_Server_run_shutdown(counter->server);
+    return NULL;
+}
+
+static void *benchSyscallSupervisorThread(void *arg)
+{
+    BenchSyscallCounter *counter = (BenchSyscallCounter *)arg;
+    struct seccomp_notif request;
+    struct seccomp_notif_resp response;
+    for (;;)
+    {
+        // 服务器线程退出后描述符挂断
+        struct pollfd pfd = {counter->listener, POLLIN, 0};
+        if (poll(&pfd, 1, 1000) < 0 || (pfd.revents & (POLLHUP | POLLERR)))
+            break;
+        if (!(pfd.revents & POLLIN))
+            continue;
+        memset(&request, 0, sizeof(request));
+        if (ioctl(counter->listener, SECCOMP_IOCTL_NOTIF_RECV, &request) != 0)
+            continue;
+        if (counter->counting)
+        {
+            switch (request.data.nr)
+            {
+            case __NR_select:
+            case __NR_pselect6:
+            case __NR_poll:
+            case __NR_ppoll:
+            case __NR_epoll_wait:
+            case __NR_epoll_pwait:
+            case __NR_io_uring_enter:
+                counter->waits++;
+                break;
+            case __NR_read:
+            case __NR_write:
+            case __NR_recvfrom:
+            case __NR_sendto:
+            case __NR_recvmsg:
+            case __NR_sendmsg:
+            case __NR_readv:
+            case __NR_writev:
+                counter->io++;
+                break;
+            default:
+                counter->other++;
+                break;
+            }
+        }
+        memset(&response, 0, sizeof(response));
+        response.id = request.id;
+        response.flags = SECCOMP_USER_NOTIF_FLAG_CONTINUE;
+        ioctl(counter->listener, SECCOMP_IOCTL_NOTIF_SEND, &response);
+    }
+    return NULL;
+}
+
+// 每次Read请求在服务器线程上的系统调用次数：select、epoll与io_uring网络层对比
+static int runNetworkSyscallsBenchmark(int reads)
+{
+    static const NetworkMode modes[] = {NETWORK_MODE_SELECT, NETWORK_MODE_EPOLL, NETWORK_MODE_URING};
+    int result = EXIT_SUCCESS;
+    double perRead[3] = {0};
+    UA_Boolean counted[3] = {false};
+
+    printf("网络层系统调用基准: 每种网络层%d次Read请求 (单个变量)\n", reads);
+    printf("  %-10s %10s %10s %10s %10s\n", "网络层", "等待/次", "收发/次", "其他/次", "合计/次");
+
+    for (int m = 0; m < 3; m++)
+    {
+        UA_ServerConfig config;
+        memset(&config, 0, sizeof(UA_ServerConfig));
+        config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+        UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+        NetworkMode used = useNetworkLayer(&config, modes[m], BENCHMARK_PORT, NETWORK_MAX_CONNECTIONS);
+        if (used != modes[m])
+        {
+            printf("  %-10s 不可用，跳过\n", networkModeName(modes[m]));
+            UA_ServerConfig_clean(&config);
+            continue;
+        }
+
+        BenchSyscallCounter counter;
+        memset(&counter, 0, sizeof(counter));
+        counter.server = UA_Server_newWithConfig(&config);
+        counter.running = true;
+        pthread_t serverThread, supervisorThread;
+        pthread_create(&serverThread, NULL, benchSyscallServerThread, &counter);
+        while (!__atomic_load_n(&counter.ready, __ATOMIC_ACQUIRE))
+            usleep(1000);
+        UA_Boolean supervised = counter.listener >= 0 &&
+                                pthread_create(&supervisorThread, NULL, benchSyscallSupervisorThread, &counter) == 0;
+
+        UA_Client *client = benchConnectClient();
+        int succeeded = 0;
+        if (client)
+        {
+            UA_Variant value;
+            UA_NodeId nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME);
+            for (int i = 0; i < 20; i++) // 预热
+            {
+                UA_Variant_init(&value);
+                UA_Client_readValueAttribute(client, nodeId, &value);
+                UA_Variant_clear(&value);
+            }
+            counter.counting = true;
+            for (int i = 0; i < reads; i++)
+            {
+                UA_Variant_init(&value);
+                if (UA_Client_readValueAttribute(client, nodeId, &value) == UA_STATUSCODE_GOOD)
+                    succeeded++;
+                UA_Variant_clear(&value);
+            }
+            counter.counting = false;
+            UA_Client_disconnect(client);
+            UA_Client_delete(client);
+        }
+
+        counter.running = false;
+        pthread_join(serverThread, NULL);
+        if (supervised)
+            pthread_join(supervisorThread, NULL);
+        if (counter.listener >= 0)
+            close(counter.listener);
+        UA_Server_delete(counter.server);
+
+        if (succeeded != reads)
+        {
+            printf("  %-10s 只完成 %d/%d 次Read\n", networkModeName(modes[m]), succeeded, reads);
+            result = EXIT_FAILURE;
+            continue;
+        }
+        if (!supervised)
+        {
+            printf("  %-10s 无法计数系统调用 (seccomp不可用)\n", networkModeName(modes[m]));
+            continue;
+        }
+        counted[m] = true;
+        perRead[m] = (double)(counter.waits + counter.io + counter.other) / reads;
+        printf("  %-10s %10.2f %10.2f %10.2f %10.2f\n", networkModeName(modes[m]), (double)counter.waits / reads,
+               (double)counter.io / reads, (double)counter.other / reads, perRead[m]);
+    }
+
+    // io_uring在一次io_uring_enter中提交应答并等待下一个请求
+    if (counted[0] && counted[2] && perRead[2] >= perRead[0])
+        result = EXIT_FAILURE;
+    return result;
+}
+
+// 收发缓冲区池：select和epoll网络层每次Read请求在服务器线程上的堆分配次数，
+// 对比禁用缓冲区池、启用缓冲区池和使用大页的缓冲区池
+static int runBufferPoolBenchmark(int reads)
+{
+    static const NetworkMode modes[] = {NETWORK_MODE_SELECT, NETWORK_MODE_EPOLL};
+    static const struct
+    {
+        const char *name;
+        size_t maxRetained;
+        UA_Boolean hugePages;
+    } pools[] = {{"禁用", 0, false},
+                 {"启用", (size_t)BUFFER_POOL_DEFAULT_KIB * 1024, false},
+                 {"大页", (size_t)BUFFER_POOL_DEFAULT_KIB * 1024, true}};
+    int result = EXIT_SUCCESS;
+
+    UA_mallocSingleton = benchMalloc;
+    UA_callocSingleton = benchCalloc;
+    UA_reallocSingleton = benchRealloc;
+    g_serverContext.readMode = READ_MODE_ZERO_COPY;
+
+    printf("收发缓冲区池基准: 每种配置%d次Read请求 (单个变量)\n", reads);
+    printf("  %-8s %-6s %10s %10s %10s %10s %10s\n", "网络层", "缓冲池", "分配/次", "命中", "未命中", "超限释放",
+           "保留KiB");
+
+    for (int m = 0; m < 2; m++)
+    {
+        double disabledAllocs = -1.0;
+        for (int p = 0; p < 3; p++)
+        {
+            UA_ServerConfig config;
+            memset(&config, 0, sizeof(UA_ServerConfig));
+            config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+            UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+            NetworkMode used = useNetworkLayer(&config, modes[m], BENCHMARK_PORT, NETWORK_MAX_CONNECTIONS);
+            if (used != modes[m])
+            {
+                printf("  %-8s 不可用，跳过\n", networkModeName(modes[m]));
+                UA_ServerConfig_clean(&config);
+                break;
+            }
+            useBufferPool(&config, used, pools[p].maxRetained, pools[p].hugePages);
+            UA_Server *server = UA_Server_newWithConfig(&config);
+
+            ScalarValue initial;
+            memset(&initial, 0, sizeof(initial));
+            UA_ReadValueId item;
+            UA_ReadValueId_init(&item);
+            item.nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 50000), "BenchTag0", &UA_TYPES[UA_TYPES_DOUBLE],
+                                          &initial, SIMULATION_NONE, 0, 0, 0);
+            item.attributeId = UA_ATTRIBUTEID_VALUE;
+
+            g_benchServerRunning = true;
+            pthread_create(&g_benchServerThreadId, NULL, benchServerThread, server);
+            UA_Client *client = benchConnectClient();
+            double allocs = -1.0;
+            if (client)
+            {
+                allocs = benchMeasureReadAllocs(client, &item, 1, reads);
+                UA_Client_disconnect(client);
+                UA_Client_delete(client);
+            }
+            g_benchServerRunning = false;
+            pthread_join(g_benchServerThreadId, NULL);
+
+            UA_BufferPoolStatistics stats;
+            UA_ServerNetworkLayerTCP_getBufferPoolStatistics(&UA_Server_getConfig(server)->networkLayers[0], &stats);
+            UA_Server_delete(server);
+            cleanupSimulationEngine(&g_serverContext.simulationEngine);
+            cleanupTagRegistry(&g_serverContext.tags);
+
+            if (allocs < 0)
+            {
+                printf("  %-8s %-6s 读取失败\n", networkModeName(modes[m]), pools[p].name);
+                result = EXIT_FAILURE;
+                continue;
+            }
+            printf("  %-8s %-6s %10.2f %10llu %10llu %10llu %10zu%s\n", networkModeName(modes[m]), pools[p].name,
+                   allocs, (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+                   (unsigned long long)stats.drops, stats.retainedBytes / 1024,
+                   pools[p].hugePages && !stats.hugePages ? " (无大页，使用堆内存)" : "");
+
+            // 启用缓冲区池后每次Read省去接收和发送缓冲区两次分配
+            if (p == 0)
+                disabledAllocs = allocs;
+            else if (disabledAllocs >= 0 && (allocs > disabledAllocs - 1.5 || stats.hits < (UA_UInt64)reads))
+                result = EXIT_FAILURE;
+        }
+    }
+
+    UA_mallocSingleton = malloc;
+    UA_callocSingleton = calloc;
+    UA_reallocSingleton = realloc;
+    return result;
+}
+
+// 分块接收：客户端以不同的块大小写入大字符串，统计服务器线程上每次Write请求的堆分配次数
+// 和新分配的字节数（相对消息大小）。块在接收缓冲区中原地解码，分配次数不应随块数增长
+static int runRecvChunksBenchmark(int messageKiB)
+{
+    static const UA_UInt32 chunkSizes[] = {8192, 65535};
+    const int writes = 20;
+    int result = EXIT_SUCCESS;
+    double allocsPerWrite[2] = {0};
+
+    UA_mallocSingleton = benchMalloc;
+    UA_callocSingleton = benchCalloc;
+    UA_reallocSingleton = benchRealloc;
+
+    printf("分块接收基准: 每次Write %d KiB字符串, 每种块大小%d次\n", messageKiB, writes);
+    printf("  %-8s %8s %12s %14s %12s\n", "块大小", "块/消息", "分配/次", "分配KiB/次", "分配/消息大小");
+
+    UA_String payload;
+    payload.length = (size_t)messageKiB * 1024;
+    payload.data = (UA_Byte *)malloc(payload.length);
+    memset(payload.data, 'x', payload.length);
+
+    for (size_t c = 0; c < sizeof(chunkSizes) / sizeof(chunkSizes[0]); c++)
+    {
+        UA_ServerConfig config;
+        memset(&config, 0, sizeof(UA_ServerConfig));
+        config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+        UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+        UA_Server *server = UA_Server_newWithConfig(&config);
+
+        UA_String initial = UA_STRING("");
+        UA_NodeId nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 60000), "BenchString",
+                                           &UA_TYPES[UA_TYPES_STRING], &initial, SIMULATION_NONE, 0, 0, 0);
+
+        g_benchServerRunning = true;
+        pthread_create(&g_benchServerThreadId, NULL, benchServerThread, server);
+
+        // 客户端发送的块大小由客户端的发送缓冲区决定
+        UA_ConnectionConfig connectionConfig = UA_ConnectionConfig_default;
+        connectionConfig.sendBufferSize = chunkSizes[c];
+        UA_Client *client = benchConnectClientWith(&connectionConfig);
+
+        int succeeded = 0;
+        if (client)
+        {
+            UA_Variant value;
+            UA_Variant_setScalar(&value, &payload, &UA_TYPES[UA_TYPES_STRING]);
+            UA_Client_writeValueAttribute(client, nodeId, &value); // 预热
+
+            __atomic_store_n(&g_benchAllocCount, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&g_benchAllocBytes, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&g_benchCountAllocs, true, __ATOMIC_RELAXED);
+            for (int i = 0; i < writes; i++)
+            {
+                if (UA_Client_writeValueAttribute(client, nodeId, &value) == UA_STATUSCODE_GOOD)
+                    succeeded++;
+            }
+            __atomic_store_n(&g_benchCountAllocs, false, __ATOMIC_RELAXED);
+            UA_Client_disconnect(client);
+            UA_Client_delete(client);
+        }
+
+        g_benchServerRunning = false;
+        pthread_join(g_benchServerThreadId, NULL);
+        UA_Server_delete(server);
+        cleanupSimulationEngine(&g_serverContext.simulationEngine);
+        cleanupTagRegistry(&g_serverContext.tags);
+
+        if (succeeded != writes)
+        {
+            printf("  %-8u 只完成 %d/%d 次Write\n", chunkSizes[c], succeeded, writes);
+            result = EXIT_FAILURE;
+            continue;
+        }
+        double allocs = (double)__atomic_load_n(&g_benchAllocCount, __ATOMIC_RELAXED) / writes;
+        allocsPerWrite[c] = allocs;
+        double bytes = (double)__atomic_load_n(&g_benchAllocBytes, __ATOMIC_RELAXED) / writes;
+        printf("  %-8u %8zu %12.1f %14.1f %12.2f\n", chunkSizes[c], (payload.length + chunkSizes[c] - 1) / chunkSizes[c],
+               allocs, bytes / 1024, bytes / (double)payload.length);
+    }
+
+    free(payload.data);
+    UA_mallocSingleton = malloc;
+    UA_callocSingleton = calloc;
+    UA_reallocSingleton = realloc;
+
+    // 8KiB块的消息约是64KiB块的8倍块数，每块不应再有单独的分配
+    if (result == EXIT_SUCCESS && allocsPerWrite[0] - allocsPerWrite[1] >= 8.0)
+        result = EXIT_FAILURE;
+    return result;
+}
+
+static int compareDouble(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// 批量发送基准的一次运行：count为真时在seccomp计数下测量每次Read的收发系统调用，
+// 否则测量Read往返延迟的中位数和P99
+static UA_Boolean benchSendBatchingRun(NetworkMode mode, UA_Boolean batching, int values, int reads,
+                                       UA_Boolean count, double *ioPerRead, double *p50Us, double *p99Us)
+{
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+    UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+    if (useNetworkLayer(&config, mode, BENCHMARK_PORT, NETWORK_MAX_CONNECTIONS) != mode)
+    {
+        UA_ServerConfig_clean(&config);
+        return false;
+    }
+    UA_ServerNetworkLayerTCP_setSendBatching(&config.networkLayers[0], batching);
+
+    BenchSyscallCounter counter;
+    memset(&counter, 0, sizeof(counter));
+    counter.server = UA_Server_newWithConfig(&config);
+    UA_ReadValueId *items = (UA_ReadValueId *)UA_calloc((size_t)values, sizeof(UA_ReadValueId));
+    for (int i = 0; i < values; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "BenchTag%d", i);
+        ScalarValue initial;
+        memset(&initial, 0, sizeof(initial));
+        initial.doubleValue = i;
+        items[i].nodeId = addVariableNode(counter.server, UA_NODEID_NUMERIC(1, 70000 + i), name,
+                                          &UA_TYPES[UA_TYPES_DOUBLE], &initial, SIMULATION_NONE, 0, 0, 0);
+        items[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+
+    pthread_t serverThread, supervisorThread;
+    UA_Boolean supervised = false;
+    if (count)
+    {
+        counter.running = true;
+        pthread_create(&serverThread, NULL, benchSyscallServerThread, &counter);
+        while (!__atomic_load_n(&counter.ready, __ATOMIC_ACQUIRE))
+            usleep(1000);
+        supervised = counter.listener >= 0 &&
+                     pthread_create(&supervisorThread, NULL, benchSyscallSupervisorThread, &counter) == 0;
+    }
+    else
+    {
+        g_benchServerRunning = true;
+        pthread_create(&serverThread, NULL, benchServerThread, counter.server);
+    }
+
+    // 客户端的接收缓冲区决定服务器应答的块大小
+    UA_ConnectionConfig connectionConfig = UA_ConnectionConfig_default;
+    connectionConfig.recvBufferSize = 8192;
+    UA_Client *client = benchConnectClientWith(&connectionConfig);
+    int succeeded = 0;
+    double *latencies = (double *)UA_calloc((size_t)reads, sizeof(double));
+    if (client)
+    {
+        UA_ReadRequest request;
+        UA_ReadRequest_init(&request);
+        request.nodesToRead = items;
+        request.nodesToReadSize = (size_t)values;
+        request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+        for (int i = 0; i < 5; i++) // 预热
+        {
+            UA_ReadResponse response = UA_Client_Service_read(client, request);
+            UA_ReadResponse_clear(&response);
+        }
+        counter.counting = true;
+        for (int i = 0; i < reads; i++)
+        {
+            UA_UInt64 start = benchMonotonicNs();
+            UA_ReadResponse response = UA_Client_Service_read(client, request);
+            latencies[i] = (double)(benchMonotonicNs() - start) / 1e3;
+            if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == (size_t)values)
+                succeeded++;
+            UA_ReadResponse_clear(&response);
+        }
+        counter.counting = false;
+        UA_Client_disconnect(client);
+        UA_Client_delete(client);
+    }
+
+    if (count)
+    {
+        counter.running = false;
+        pthread_join(serverThread, NULL);
+        if (supervised)
+            pthread_join(supervisorThread, NULL);
+        if (counter.listener >= 0)
+            close(counter.listener);
+    }
+    else
+    {
+        g_benchServerRunning = false;
+        pthread_join(serverThread, NULL);
+    }
+    UA_Server_delete(counter.server);
+    cleanupSimulationEngine(&g_serverContext.simulationEngine);
+    cleanupTagRegistry(&g_serverContext.tags);
+    UA_free(items);
+
+    qsort(latencies, (size_t)reads, sizeof(double), compareDouble);
+    *p50Us = latencies[reads / 2];
+    *p99Us = latencies[(reads * 99) / 100];
+    *ioPerRead = supervised ? (double)counter.io / reads : -1.0;
+    UA_free(latencies);
+    return succeeded == reads && (!count || supervised);
+}
+
+// 批量发送：应答分成多个8KiB块时，每块一次send与整条应答一次sendmsg对比
+static int runSendBatchingBenchmark(int values)
+{
+    static const NetworkMode modes[] = {NETWORK_MODE_SELECT, NETWORK_MODE_EPOLL};
+    const int reads = 200;
+    int result = EXIT_SUCCESS;
+
+    printf("批量发送基准: 每次Read %d个Double变量, 应答块大小8KiB, %d次Read\n", values, reads);
+    printf("  %-8s %-6s %12s %12s %12s\n", "网络层", "批量", "收发/次", "中位数us", "P99us");
+    for (int m = 0; m < 2; m++)
+    {
+        double io[2] = {0};
+        for (int b = 0; b < 2; b++)
+        {
+            double p50, p99, unused;
+            if (!benchSendBatchingRun(modes[m], b == 1, values, reads, true, &io[b], &unused, &unused) ||
+                !benchSendBatchingRun(modes[m], b == 1, values, reads, false, &unused, &p50, &p99))
+            {
+                printf("  %-8s %-6s 运行失败 (网络层或seccomp不可用)\n", networkModeName(modes[m]), b ? "开" : "关");
+                result = EXIT_FAILURE;
+                continue;
+            }
+            printf("  %-8s %-6s %12.2f %12.1f %12.1f\n", networkModeName(modes[m]), b ? "开" : "关", io[b], p50,
+                   p99);
+        }
+        // 批量发送时整条应答只剩一次发送，剩余的是接收请求的调用
+        if (result == EXIT_SUCCESS && io[1] >= io[0])
+            result = EXIT_FAILURE;
+    }
+    return result;
+}
+
+// 服务工作线程基准的浏览负载：不断浏览包含全部变量的ObjectsFolder，每次浏览后紧接着流水线发送一个Write。
+// Write在服务器线程中执行，须排在同一通道的浏览之后，但不能让服务器线程停下来等待浏览完成
+typedef struct
+{
+    volatile UA_Boolean running;
+    UA_NodeId writeNodeId;
+    UA_UInt64 browses;
+    int pending;
+    UA_Boolean failed;
+} BenchBrowseLoad;
+
+static void benchBrowseLoadBrowsed(UA_Client *client, void *userdata, UA_UInt32 requestId,
+                                   UA_BrowseResponse *response)
+{
+    BenchBrowseLoad *load = (BenchBrowseLoad *)userdata;
+    if (response->responseHeader.serviceResult != UA_STATUSCODE_GOOD || response->resultsSize != 1)
+        load->failed = true;
+    else
+        __atomic_add_fetch(&load->browses, 1, __ATOMIC_RELAXED);
+    load->pending--;
+}
+
+static void benchBrowseLoadWritten(UA_Client *client, void *userdata, UA_UInt32 requestId,
+                                   UA_WriteResponse *response)
+{
+    BenchBrowseLoad *load = (BenchBrowseLoad *)userdata;
+    if (response->responseHeader.serviceResult != UA_STATUSCODE_GOOD || response->resultsSize != 1 ||
+        response->results[0] != UA_STATUSCODE_GOOD)
+        load->failed = true;
+    load->pending--;
+}
+
+static void *benchBrowseLoadThread(void *arg)
+{
+    BenchBrowseLoad *load = (BenchBrowseLoad *)arg;
+    UA_Client *client = benchConnectClient();
+    if (!client)
+    {
+        load->failed = true;
+        return NULL;
+    }
+
+    UA_BrowseDescription description;
+    UA_BrowseDescription_init(&description);
+    description.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    description.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    description.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    description.includeSubtypes = true;
+    description.resultMask = UA_BROWSERESULTMASK_ALL;
+    UA_BrowseRequest request;
+    UA_BrowseRequest_init(&request);
+    request.nodesToBrowse = &description;
+    request.nodesToBrowseSize = 1;
+
+    UA_Double written = 0.0;
+    UA_Variant value;
+    UA_Variant_setScalar(&value, &written, &UA_TYPES[UA_TYPES_DOUBLE]);
+    while (load->running && !load->failed)
+    {
+        written += 1.0;
+        load->pending = 2;
+        if (UA_Client_sendAsyncBrowseRequest(client, &request, benchBrowseLoadBrowsed, load, NULL) !=
+                UA_STATUSCODE_GOOD ||
+            UA_Client_writeValueAttribute_async(client, load->writeNodeId, &value, benchBrowseLoadWritten, load,
+                                                NULL) != UA_STATUSCODE_GOOD)
+        {
+            load->failed = true;
+            break;
+        }
+        UA_UInt64 deadline = benchMonotonicNs() + 5000000000ULL;
+        while (load->pending > 0 && benchMonotonicNs() < deadline)
+            UA_Client_run_iterate(client, 10);
+        if (load->pending > 0)
+            load->failed = true;
+    }
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+    return NULL;
+}
+
+// 吞吐量负载：每个客户端在截止时间前不断读取同一组变量
+typedef struct
+{
+    UA_ReadValueId *items;
+    int itemCount;
+    UA_UInt64 deadlineNs;
+    UA_UInt64 reads;
+    UA_Boolean failed;
+} BenchReadLoad;
+
+static void *benchReadLoadThread(void *arg)
+{
+    BenchReadLoad *load = (BenchReadLoad *)arg;
+    UA_Client *client = benchConnectClient();
+    if (!client)
+    {
+        load->failed = true;
+        return NULL;
+    }
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = load->items;
+    request.nodesToReadSize = (size_t)load->itemCount;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    while (benchMonotonicNs() < load->deadlineNs)
+    {
+        UA_ReadResponse response = UA_Client_Service_read(client, request);
+        if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD ||
+            response.resultsSize != (size_t)load->itemCount)
+            load->failed = true;
+        else
+            load->reads++;
+        UA_ReadResponse_clear(&response);
+    }
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+    return NULL;
+}
+
+// 顺序检查：同一通道上流水线发送Read、Write、Read，应答须按请求顺序到达
+typedef struct
+{
+    UA_UInt32 requestIds[3];
+    int received;
+    UA_Boolean outOfOrder;
+    UA_Boolean failed;
+    UA_Double lastRead;
+} BenchOrdering;
+
+static void benchOrderingRecord(BenchOrdering *ordering, UA_UInt32 requestId)
+{
+    if (ordering->received >= 3 || ordering->requestIds[ordering->received] != requestId)
+        ordering->outOfOrder = true;
+    ordering->received++;
+}
+
+static void benchOrderingRead(UA_Client *client, void *userdata, UA_UInt32 requestId, UA_StatusCode status,
+                              UA_DataValue *value)
+{
+    BenchOrdering *ordering = (BenchOrdering *)userdata;
+    benchOrderingRecord(ordering, requestId);
+    if (status != UA_STATUSCODE_GOOD || !value->hasValue ||
+        !UA_Variant_hasScalarType(&value->value, &UA_TYPES[UA_TYPES_DOUBLE]))
+        ordering->failed = true;
+    else
+        ordering->lastRead = *(UA_Double *)value->value.data;
+}
+
+static void benchOrderingWrite(UA_Client *client, void *userdata, UA_UInt32 requestId, UA_WriteResponse *wr)
+{
+    BenchOrdering *ordering = (BenchOrdering *)userdata;
+    benchOrderingRecord(ordering, requestId);
+    if (wr->responseHeader.serviceResult != UA_STATUSCODE_GOOD || wr->resultsSize != 1 ||
+        wr->results[0] != UA_STATUSCODE_GOOD)
+        ordering->failed = true;
+}
+
+// 返回应答全部按序到达且第二次读取看到写入值的轮数
+static int benchServiceOrdering(UA_Client *client, UA_NodeId nodeId, int rounds)
+{
+    int passed = 0;
+    for (int round = 0; round < rounds; round++)
+    {
+        BenchOrdering ordering;
+        memset(&ordering, 0, sizeof(ordering));
+        UA_Double written = round + 0.5;
+        UA_Variant value;
+        UA_Variant_setScalar(&value, &written, &UA_TYPES[UA_TYPES_DOUBLE]);
+        if (UA_Client_readValueAttribute_async(client, nodeId, benchOrderingRead, &ordering,
+                                               &ordering.requestIds[0]) != UA_STATUSCODE_GOOD ||
+            UA_Client_writeValueAttribute_async(client, nodeId, &value, benchOrderingWrite, &ordering,
+                                                &ordering.requestIds[1]) != UA_STATUSCODE_GOOD ||
+            UA_Client_readValueAttribute_async(client, nodeId, benchOrderingRead, &ordering,
+                                               &ordering.requestIds[2]) != UA_STATUSCODE_GOOD)
+            break;
+        UA_UInt64 deadline = benchMonotonicNs() + 5000000000ULL;
+        while (ordering.received < 3 && benchMonotonicNs() < deadline)
+            UA_Client_run_iterate(client, 10);
+        if (ordering.received == 3 && !ordering.outOfOrder && !ordering.failed && ordering.lastRead == written)
+            passed++;
+    }
+    return passed;
+}
+
+typedef struct
+{
+    double p50Us;
+    double p99Us;
+    double maxUs;
+    UA_UInt64 browses;
+    int orderedRounds;
+    double readsPerSecond;
+    UA_UInt64 dispatched;
+    UA_UInt64 parked;
+    double stallUs;
+} BenchServiceWorkersResult;
+
+// 慢方法：在工作线程中执行时只阻塞调用它的通道
+#define BENCH_SLOW_METHOD_MS 200
+
+static UA_StatusCode benchSlowMethod(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                                     const UA_NodeId *methodId, void *methodContext, const UA_NodeId *objectId,
+                                     void *objectContext, size_t inputSize, const UA_Variant *input,
+                                     size_t outputSize, UA_Variant *output)
+{
+    usleep(BENCH_SLOW_METHOD_MS * 1000);
+    return UA_STATUSCODE_GOOD;
+}
+
+// 同一通道上慢方法调用之后的Write须在调用之后应答
+typedef struct
+{
+    int received;
+    UA_Boolean callFirst;
+    UA_Boolean failed;
+} BenchSlowCall;
+
+static void benchSlowCallDone(UA_Client *client, void *userdata, UA_UInt32 requestId, UA_CallResponse *cr)
+{
+    BenchSlowCall *call = (BenchSlowCall *)userdata;
+    if (cr->responseHeader.serviceResult != UA_STATUSCODE_GOOD || cr->resultsSize != 1 ||
+        cr->results[0].statusCode != UA_STATUSCODE_GOOD)
+        call->failed = true;
+    call->callFirst = (call->received++ == 0);
+}
+
+static void benchSlowCallWritten(UA_Client *client, void *userdata, UA_UInt32 requestId, UA_WriteResponse *wr)
+{
+    BenchSlowCall *call = (BenchSlowCall *)userdata;
+    if (wr->responseHeader.serviceResult != UA_STATUSCODE_GOOD || wr->resultsSize != 1 ||
+        wr->results[0] != UA_STATUSCODE_GOOD)
+        call->failed = true;
+    call->received++;
+}
+
+// 一个客户端流水线发送慢方法调用和Write时，另一个客户端Read的最大延迟(us)，失败时返回负值
+static double benchSlowCallStall(UA_Client *caller, UA_Client *reader, UA_NodeId nodeId, int rounds)
+{
+    UA_ReadValueId item;
+    UA_ReadValueId_init(&item);
+    item.nodeId = nodeId;
+    item.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = &item;
+    request.nodesToReadSize = 1;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+
+    double maxUs = 0.0;
+    for (int round = 0; round < rounds; round++)
+    {
+        BenchSlowCall call;
+        memset(&call, 0, sizeof(call));
+        UA_Double written = round;
+        UA_Variant value;
+        UA_Variant_setScalar(&value, &written, &UA_TYPES[UA_TYPES_DOUBLE]);
+        if (UA_Client_call_async(caller, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NODEID_NUMERIC(1, 69999),
+                                 0, NULL, benchSlowCallDone, &call, NULL) != UA_STATUSCODE_GOOD ||
+            UA_Client_writeValueAttribute_async(caller, nodeId, &value, benchSlowCallWritten, &call, NULL) !=
+                UA_STATUSCODE_GOOD)
+            return -1.0;
+
+        // 等服务器收到两个请求后再读取（客户端未禁用Nagle算法，第二个请求可能被延迟确认推迟约40ms）
+        usleep(BENCH_SLOW_METHOD_MS * 1000 / 2);
+        UA_UInt64 start = benchMonotonicNs();
+        UA_ReadResponse response = UA_Client_Service_read(reader, request);
+        double us = (double)(benchMonotonicNs() - start) / 1e3;
+        UA_Boolean readOk = response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == 1;
+        UA_ReadResponse_clear(&response);
+        if (us > maxUs)
+            maxUs = us;
+
+        UA_UInt64 deadline = benchMonotonicNs() + 5000000000ULL;
+        while (call.received < 2 && benchMonotonicNs() < deadline)
+            UA_Client_run_iterate(caller, 10);
+        if (!readOk || call.received != 2 || !call.callFirst || call.failed)
+            return -1.0;
+    }
+    return maxUs;
+}
+
+// 服务工作线程基准的一次运行：workers为0时所有服务在服务器线程中执行
+static UA_Boolean benchServiceWorkersRun(int workers, int children, int samples, int rounds, int readers,
+                                         BenchServiceWorkersResult *result)
+{
+    const int readItems = 100;
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+    UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+    UA_Server *server = UA_Server_newWithConfig(&config);
+
+    UA_ReadValueId *items = (UA_ReadValueId *)UA_calloc((size_t)children, sizeof(UA_ReadValueId));
+    for (int i = 0; i < children; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "BenchTag%d", i);
+        ScalarValue initial;
+        memset(&initial, 0, sizeof(initial));
+        initial.doubleValue = i;
+        UA_ReadValueId_init(&items[i]);
+        items[i].nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 70000 + i), name,
+                                          &UA_TYPES[UA_TYPES_DOUBLE], &initial, SIMULATION_NONE, 0, 0, 0);
+        items[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+
+    UA_MethodAttributes methodAttributes = UA_MethodAttributes_default;
+    methodAttributes.executable = true;
+    methodAttributes.userExecutable = true;
+    UA_Server_addMethodNode(server, UA_NODEID_NUMERIC(1, 69999), UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                            UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), UA_QUALIFIEDNAME(1, "BenchSlowMethod"),
+                            methodAttributes, benchSlowMethod, 0, NULL, 0, NULL, NULL, NULL);
+
+    ServiceWorkers serviceWorkers;
+    memset(&serviceWorkers, 0, sizeof(serviceWorkers));
+    serviceWorkers.wakeupFd = -1;
+    UA_Boolean ok = true;
+    if (workers > 0)
+        ok = serviceWorkersAttach(&serviceWorkers, UA_Server_getConfig(server)) == UA_STATUSCODE_GOOD &&
+             serviceWorkersStart(&serviceWorkers, server, workers) == workers;
+
+    pthread_t serverThread;
+    g_benchServerRunning = true;
+    pthread_create(&serverThread, NULL, benchServerThread, server);
+
+    // (1) 浏览和写入负载下单值读取的延迟
+    BenchBrowseLoad browseLoad;
+    memset(&browseLoad, 0, sizeof(browseLoad));
+    browseLoad.running = true;
+    browseLoad.writeNodeId = items[children - 1].nodeId;
+    pthread_t browseThread;
+    pthread_create(&browseThread, NULL, benchBrowseLoadThread, &browseLoad);
+    double *latencies = (double *)UA_calloc((size_t)samples, sizeof(double));
+    int succeeded = 0;
+    UA_Client *client = benchConnectClient();
+    if (client)
+    {
+        // 等浏览负载开始后再测量
+        UA_UInt64 deadline = benchMonotonicNs() + 5000000000ULL;
+        while (__atomic_load_n(&browseLoad.browses, __ATOMIC_RELAXED) == 0 && !browseLoad.failed &&
+               benchMonotonicNs() < deadline)
+            usleep(1000);
+
+        UA_ReadRequest request;
+        UA_ReadRequest_init(&request);
+        request.nodesToRead = &items[0];
+        request.nodesToReadSize = 1;
+        request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+        for (int i = 0; i < samples; i++)
+        {
+            UA_UInt64 start = benchMonotonicNs();
+            UA_ReadResponse response = UA_Client_Service_read(client, request);
+            latencies[i] = (double)(benchMonotonicNs() - start) / 1e3;
+            if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == 1)
+                succeeded++;
+            UA_ReadResponse_clear(&response);
+            usleep(1000);
+        }
+
+        // (2) 浏览负载仍在运行时检查同一通道上的应答顺序
+        result->orderedRounds = benchServiceOrdering(client, items[0].nodeId, rounds);
+        UA_Client_disconnect(client);
+        UA_Client_delete(client);
+    }
+    browseLoad.running = false;
+    pthread_join(browseThread, NULL);
+    result->browses = browseLoad.browses;
+
+    // (3) 慢方法调用和排在它之后的Write不能让服务器线程停下来，其他客户端的Read照常应答
+    UA_Client *caller = benchConnectClient();
+    UA_Client *reader = benchConnectClient();
+    result->stallUs = (caller && reader) ? benchSlowCallStall(caller, reader, items[0].nodeId, 5) : -1.0;
+    if (caller)
+    {
+        UA_Client_disconnect(caller);
+        UA_Client_delete(caller);
+    }
+    if (reader)
+    {
+        UA_Client_disconnect(reader);
+        UA_Client_delete(reader);
+    }
+
+    // (4) 多个客户端并发读取的吞吐量
+    BenchReadLoad *loads = (BenchReadLoad *)UA_calloc((size_t)readers, sizeof(BenchReadLoad));
+    pthread_t *readThreads = (pthread_t *)UA_calloc((size_t)readers, sizeof(pthread_t));
+    UA_UInt64 start = benchMonotonicNs();
+    for (int i = 0; i < readers; i++)
+    {
+        loads[i].items = items;
+        loads[i].itemCount = children < readItems ? children : readItems;
+        loads[i].deadlineNs = start + 1000000000ULL;
+        pthread_create(&readThreads[i], NULL, benchReadLoadThread, &loads[i]);
+    }
+    UA_UInt64 reads = 0;
+    for (int i = 0; i < readers; i++)
+    {
+        pthread_join(readThreads[i], NULL);
+        reads += loads[i].reads;
+        ok = ok && !loads[i].failed;
+    }
+    result->readsPerSecond = (double)reads / ((double)(benchMonotonicNs() - start) / 1e9);
+
+    g_benchServerRunning = false;
+    pthread_join(serverThread, NULL);
+    UA_ServiceWorkerStatistics stats;
+    UA_Server_getServiceWorkerStatistics(server, &stats);
+    result->dispatched = stats.dispatched;
+    result->parked = stats.parked;
+    serviceWorkersStop(&serviceWorkers, server);
+    UA_Server_delete(server);
+    cleanupSimulationEngine(&g_serverContext.simulationEngine);
+    cleanupTagRegistry(&g_serverContext.tags);
+    UA_free(items);
+    UA_free(loads);
+    UA_free(readThreads);
+
+    qsort(latencies, (size_t)samples, sizeof(double), compareDouble);
+    result->p50Us = latencies[samples / 2];
+    result->p99Us = latencies[(samples * 99) / 100];
+    result->maxUs = latencies[samples - 1];
+    UA_free(latencies);
+    return ok && client && succeeded == samples && !browseLoad.failed && result->orderedRounds == rounds &&
+           result->stallUs >= 0.0 &&
+           (workers == 0 || (result->dispatched > 0 && result->parked > 0 &&
+                             result->stallUs < BENCH_SLOW_METHOD_MS * 1000.0 / 4));
+}
+
+// 服务工作线程：长时间的Browse不再阻塞其他通道的Read，同一通道的应答保持请求顺序
+static int runServiceWorkersBenchmark(int children)
+{
+    const int samples = 300, rounds = 200, readers = 4;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = cores > 2 ? (int)cores : 2;
+    int result = EXIT_SUCCESS;
+
+    printf("服务工作线程基准: ObjectsFolder下 %d 个变量被持续浏览并写入, 单值Read %d 次, 顺序检查 %d 轮, "
+           "%d 个客户端读取吞吐量\n",
+           children, samples, rounds, readers);
+    printf("  %-8s %10s %10s %10s %10s %10s %12s %10s %12s\n", "工作线程", "中位数us", "P99us", "最大us", "浏览次数",
+           "顺序正确", "读取/秒", "排队串行", "慢调用时us");
+    const int counts[] = {0, workers};
+    for (int w = 0; w < 2; w++)
+    {
+        BenchServiceWorkersResult run;
+        memset(&run, 0, sizeof(run));
+        UA_Boolean ok = benchServiceWorkersRun(counts[w], children, samples, rounds, readers, &run);
+        printf("  %-8d %10.1f %10.1f %10.1f %10llu %6d/%-3d %12.0f %10llu %12.1f%s\n", counts[w], run.p50Us,
+               run.p99Us, run.maxUs, (unsigned long long)run.browses, run.orderedRounds, rounds, run.readsPerSecond,
+               (unsigned long long)run.parked, run.stallUs, ok ? "" : "  失败");
+        if (!ok)
+            result = EXIT_FAILURE;
+    }
+    return result;
+}
+
+// 多反应器基准的轮询负载：每个线程轮流用自己的客户端发送Read，直到截止时间
+typedef struct
+{
+    UA_Client **clients;
+    int clientCount;
+    UA_ReadValueId *items;
+    int itemCount;
+    UA_UInt64 deadlineNs;
+    UA_UInt64 reads;
+    UA_UInt64 maxLatencyNs;
+    UA_Boolean failed;
+} BenchPollLoad;
+
+static void *benchPollLoadThread(void *arg)
+{
+    BenchPollLoad *load = (BenchPollLoad *)arg;
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = load->items;
+    request.nodesToReadSize = (size_t)load->itemCount;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    for (int c = 0; benchMonotonicNs() < load->deadlineNs; c = (c + 1) % load->clientCount)
+    {
+        UA_UInt64 start = benchMonotonicNs();
+        UA_ReadResponse response = UA_Client_Service_read(load->clients[c], request);
+        UA_UInt64 latency = benchMonotonicNs() - start;
+        if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD ||
+            response.resultsSize != (size_t)load->itemCount)
+            load->failed = true;
+        else
+            load->reads++;
+        if (latency > load->maxLatencyNs)
+            load->maxLatencyNs = latency;
+        UA_ReadResponse_clear(&response);
+    }
+    return NULL;
+}
+
+// 最多8个线程轮流用所有客户端发送Read 1秒，返回是否所有读取都成功
+static UA_Boolean benchPollClients(UA_Client **clients, int clientCount, UA_ReadValueId *items, int itemCount,
+                                   double *readsPerSecond, double *meanLatencyUs, double *maxLatencyUs)
+{
+    const int pollThreads = clientCount < 8 ? clientCount : 8;
+    BenchPollLoad loads[pollThreads];
+    pthread_t threads[pollThreads];
+    UA_UInt64 start = benchMonotonicNs();
+    for (int t = 0; t < pollThreads; t++)
+    {
+        memset(&loads[t], 0, sizeof(BenchPollLoad));
+        loads[t].clients = &clients[t * clientCount / pollThreads];
+        loads[t].clientCount = (t + 1) * clientCount / pollThreads - t * clientCount / pollThreads;
+        loads[t].items = items;
+        loads[t].itemCount = itemCount;
+        loads[t].deadlineNs = start + 1000000000ULL;
+        pthread_create(&threads[t], NULL, benchPollLoadThread, &loads[t]);
+    }
+    UA_Boolean ok = true;
+    UA_UInt64 reads = 0, maxLatencyNs = 0;
+    for (int t = 0; t < pollThreads; t++)
+    {
+        pthread_join(threads[t], NULL);
+        reads += loads[t].reads;
+        if (loads[t].maxLatencyNs > maxLatencyNs)
+            maxLatencyNs = loads[t].maxLatencyNs;
+        ok = ok && !loads[t].failed;
+    }
+    double seconds = (double)(benchMonotonicNs() - start) / 1e9;
+    *readsPerSecond = (double)reads / seconds;
+    *meanLatencyUs = reads ? seconds * pollThreads / (double)reads * 1e6 : 0.0;
+    *maxLatencyUs = (double)maxLatencyNs / 1e3;
+    return ok;
+}
+
+// 每个反应器当前的连接数
+static void benchReactorConnections(const Reactors *reactors, size_t *counts)
+{
+    for (int i = 0; i < reactors->count; i++)
+        counts[i] = UA_Server_getStatistics(reactors->list[i].server).ns.currentConnectionCount;
+}
+
+// 从指定的本地回环地址（0表示不绑定）建立连接并完成Hello往返，返回套接字，失败返回-1
+static int benchHelloFrom(UA_UInt32 sourceAddress)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    if (sourceAddress)
+    {
+        address.sin_addr.s_addr = htonl(sourceAddress);
+        if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    address.sin_port = htons(BENCHMARK_PORT);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    struct timeval timeout = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    UA_Byte reply[64];
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || !benchSendHello(fd) ||
+        recv(fd, reply, sizeof(reply), 0) < 8 || memcmp(reply, "ACKF", 4) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 按客户端地址分配：不同地址的连接分布到所有反应器，同一地址的连接都落在同一个反应器。
+// 返回是否符合预期，addressReactors和sameAddressReactors为收到连接的反应器数
+static UA_Boolean benchReactorAffinity(const Reactors *reactors, int *addressReactors, int *sameAddressReactors)
+{
+    const int perCheck = 2 * reactors->count;
+    size_t before[reactors->count], after[reactors->count];
+    int fds[2][perCheck];
+    UA_Boolean ok = true;
+    for (int check = 0; check < 2; check++)
+    {
+        benchReactorConnections(reactors, before);
+        for (int i = 0; i < perCheck; i++)
+        {
+            // 127.0.0.0/8都路由到本地回环
+            fds[check][i] = benchHelloFrom(check == 0 ? INADDR_LOOPBACK + 10 + (UA_UInt32)i : 0);
+            ok = ok && fds[check][i] >= 0;
+        }
+        benchReactorConnections(reactors, after);
+        int used = 0;
+        for (int r = 0; r < reactors->count; r++)
+            used += after[r] > before[r];
+        *(check == 0 ? addressReactors : sameAddressReactors) = used;
+    }
+    for (int check = 0; check < 2; check++)
+    {
+        for (int i = 0; i < perCheck; i++)
+        {
+            if (fds[check][i] >= 0)
+                close(fds[check][i]);
+        }
+    }
+    return ok && *addressReactors == reactors->count && *sameAddressReactors == 1;
+}
+
+typedef struct
+{
+    double readsPerSecond;
+    double meanLatencyUs;
+    double maxLatencyUs;
+    size_t minConnections; // 连接最少和最多的反应器上的连接数
+    size_t maxConnections;
+    int addressReactors;
+    int sameAddressReactors;
+} BenchReactorsResult;
+
+// 多反应器基准的一次运行：reactorCount个反应器在同一端口上监听，clients个客户端轮询读取。
+// clients为0时只检查按客户端地址分配
+static UA_Boolean benchReactorsRun(int reactorCount, UA_Boolean addressAffinity, int clients,
+                                   BenchReactorsResult *result)
+{
+    const int tagCount = 100, readItems = 10;
+    Reactors *reactors = &g_serverContext.reactors;
+    reactors->count = reactorCount;
+    reactors->addressAffinity = addressAffinity;
+    reactors->list = (Reactor *)calloc((size_t)reactorCount, sizeof(Reactor));
+    UA_ReadValueId *items = (UA_ReadValueId *)UA_calloc((size_t)readItems, sizeof(UA_ReadValueId));
+    UA_Boolean ok = true;
+    for (int r = 0; r < reactorCount; r++)
+    {
+        UA_ServerConfig config;
+        memset(&config, 0, sizeof(UA_ServerConfig));
+        config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+        UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+        useNetworkLayer(&config, NETWORK_MODE_EPOLL, BENCHMARK_PORT, NETWORK_MAX_CONNECTIONS);
+        UA_ServerNetworkLayerTCP_setReusePort(&config.networkLayers[0], reactorCount > 1,
+                                              addressAffinity ? (UA_UInt16)reactorCount : 0);
+        UA_Server *server = UA_Server_newWithConfig(&config);
+        reactors->list[r].server = server;
+        // 第一个反应器创建变量记录，其余反应器的同一节点引用这些记录
+        for (int t = 0; t < tagCount; t++)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "ReactorTag%d", t);
+            ScalarValue initial;
+            memset(&initial, 0, sizeof(initial));
+            initial.doubleValue = t;
+            UA_NodeId nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 80000 + t), name,
+                                               &UA_TYPES[UA_TYPES_DOUBLE], &initial, SIMULATION_NONE, 0, 0, 0);
+            ok = ok && !UA_NodeId_isNull(&nodeId);
+            if (t < readItems)
+            {
+                items[t].nodeId = nodeId;
+                items[t].attributeId = UA_ATTRIBUTEID_VALUE;
+            }
+        }
+    }
+
+    // 主服务器所在的反应器也在单独的线程中运行
+    g_benchServerRunning = true;
+    ok = ok && reactorsStart(reactors, (volatile UA_Boolean *)&g_benchServerRunning) == reactorCount - 1;
+    reactors->list[0].threadStarted = pthread_create(&reactors->list[0].thread, NULL, reactorThread,
+                                                     &reactors->list[0]) == 0;
+
+    if (addressAffinity && reactorCount > 1)
+    {
+        // 等待所有反应器开始监听
+        UA_Client *probe = benchConnectClient();
+        if (probe)
+        {
+            UA_Client_disconnect(probe);
+            UA_Client_delete(probe);
+        }
+        ok = probe && benchReactorAffinity(reactors, &result->addressReactors, &result->sameAddressReactors) && ok;
+    }
+
+    UA_Client **connected = (UA_Client **)UA_calloc((size_t)(clients > 0 ? clients : 1), sizeof(UA_Client *));
+    int connectedCount = 0;
+    while (connectedCount < clients && (connected[connectedCount] = benchConnectClient()) != NULL)
+        connectedCount++;
+    ok = ok && connectedCount == clients;
+
+    if (clients > 0 && ok)
+    {
+        size_t counts[reactorCount];
+        benchReactorConnections(reactors, counts);
+        result->minConnections = result->maxConnections = counts[0];
+        for (int r = 1; r < reactorCount; r++)
+        {
+            if (counts[r] < result->minConnections)
+                result->minConnections = counts[r];
+            if (counts[r] > result->maxConnections)
+                result->maxConnections = counts[r];
+        }
+
+        ok = benchPollClients(connected, clients, items, readItems, &result->readsPerSecond,
+                              &result->meanLatencyUs, &result->maxLatencyUs) && ok;
+    }
+    for (int c = 0; c < connectedCount; c++)
+    {
+        UA_Client_disconnect(connected[c]);
+        UA_Client_delete(connected[c]);
+    }
+    UA_free(connected);
+
+    g_benchServerRunning = false;
+    if (reactors->list[0].threadStarted)
+        pthread_join(reactors->list[0].thread, NULL);
+    UA_Server *mainServer = reactors->list[0].server;
+    reactorsStop(reactors);
+    UA_Server_delete(mainServer);
+    reactors->count = 1;
+    cleanupSimulationEngine(&g_serverContext.simulationEngine);
+    cleanupTagRegistry(&g_serverContext.tags);
+    UA_free(items);
+    return ok;
+}
+
+// 多反应器：同一端口上的多个独立事件循环分担大量轮询客户端，对比单个事件循环
+static int runReactorsBenchmark(int clients)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int reactorCount = cores > 2 ? (int)cores : 2;
+    int result = EXIT_SUCCESS;
+    raiseFileLimit((rlim_t)clients * 2 + 256);
+
+    printf("多反应器基准: %d 个客户端轮询读取10个变量 1秒\n", clients);
+    printf("  %-8s %10s %12s %12s %16s\n", "反应器", "读取/秒", "平均延迟us", "最大延迟us", "每反应器连接数");
+    const int counts[] = {1, reactorCount};
+    for (int i = 0; i < 2; i++)
+    {
+        BenchReactorsResult run;
+        memset(&run, 0, sizeof(run));
+        // 客户端都来自本地回环地址，按连接哈希分配
+        UA_Boolean ok = benchReactorsRun(counts[i], false, clients, &run);
+        // 单核机器上多个反应器不会提高吞吐量，这里只要求连接分布到多个反应器
+        if (counts[i] > 1 && clients >= 16 && run.minConnections == 0)
+            ok = false;
+        printf("  %-8d %10.0f %12.1f %12.1f %10zu-%-5zu%s\n", counts[i], run.readsPerSecond, run.meanLatencyUs,
+               run.maxLatencyUs, run.minConnections, run.maxConnections, ok ? "" : "  失败");
+        if (!ok)
+            result = EXIT_FAILURE;
+    }
+
+    BenchReactorsResult affinity;
+    memset(&affinity, 0, sizeof(affinity));
+    UA_Boolean ok = benchReactorsRun(reactorCount, true, 0, &affinity);
+    printf("  按客户端地址分配: %d 个不同地址分布在 %d/%d 个反应器, 同一地址的连接落在 %d 个反应器%s\n",
+           2 * reactorCount, affinity.addressReactors, reactorCount, affinity.sameAddressReactors,
+           ok ? "" : "  失败");
+    if (!ok)
+        result = EXIT_FAILURE;
+    return result;
+}
+
+// 从/proc/<pid>/smaps_rollup读取指定字段（KiB），失败返回0
+static size_t benchProcessMemoryKiB(pid_t pid, const char *field)
+{
+    char path[64], line[256];
+    snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", (int)pid);
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return 0;
+    size_t kib = 0, length = strlen(field);
+    while (fgets(line, sizeof(line), file))
+    {
+        if (strncmp(line, field, length) == 0 && line[length] == ':')
+        {
+            kib = strtoull(line + length + 1, NULL, 10);
+            break;
+        }
+    }
+    fclose(file);
+    return kib;
+}
+
+typedef struct
+{
+    double readsPerSecond;
+    double meanLatencyUs;
+    double maxLatencyUs;
+    int sharedReads;      // 读到主进程写入值的客户端数
+    size_t privateKiB;    // 每个工作进程平均的私有脏页
+    size_t supervisorKiB; // 主进程的常驻内存
+} BenchProcessesResult;
+
+// 多进程基准的一次运行：主进程构建tagCount个变量后派生processCount个工作进程监听同一端口，
+// 主进程充当模拟进程写入共享的变量记录，clients个客户端检查读到的值后轮询读取
+static UA_Boolean benchProcessesRun(int processCount, int tagCount, int clients, BenchProcessesResult *result)
+{
+    const int readItems = 10;
+    g_serverContext.tags.shared = true;
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+    UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+    useNetworkLayer(&config, NETWORK_MODE_EPOLL, BENCHMARK_PORT, NETWORK_MAX_CONNECTIONS);
+    UA_ServerNetworkLayerTCP_setReusePort(&config.networkLayers[0], processCount > 1, 0);
+    UA_Server *server = UA_Server_newWithConfig(&config);
+
+    UA_ReadValueId *items = (UA_ReadValueId *)UA_calloc((size_t)readItems, sizeof(UA_ReadValueId));
+    UA_Boolean ok = server != NULL && items != NULL;
+    for (int t = 0; t < tagCount && ok; t++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "ProcessTag%d", t);
+        ScalarValue initial;
+        memset(&initial, 0, sizeof(initial));
+        initial.doubleValue = t;
+        UA_NodeId nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 90000 + t), name,
+                                           &UA_TYPES[UA_TYPES_DOUBLE], &initial, SIMULATION_NONE, 0, 0, 0);
+        ok = !UA_NodeId_isNull(&nodeId);
+        if (t < readItems)
+        {
+            items[t].nodeId = nodeId;
+            items[t].attributeId = UA_ATTRIBUTEID_VALUE;
+        }
+    }
+
+    ProcessPool *pool = &g_serverContext.processes;
+    pool->count = processCount;
+    ok = ok && processPoolStart(pool, server, false) == processCount;
+
+    UA_Client **connected = (UA_Client **)UA_calloc((size_t)clients, sizeof(UA_Client *));
+    int connectedCount = 0;
+    while (ok && connectedCount < clients && (connected[connectedCount] = benchConnectClient()) != NULL)
+        connectedCount++;
+    ok = ok && connectedCount == clients;
+
+    if (ok)
+    {
+        // 写入在派生之后发生，只有共享内存中的变量记录能让所有工作进程读到
+        ScalarValue marker;
+        memset(&marker, 0, sizeof(marker));
+        marker.doubleValue = 1e6 + processCount;
+        valueCellStore(&tagRegistryFind(&g_serverContext.tags, &items[0].nodeId)->cell, marker);
+        for (int c = 0; c < clients; c++)
+        {
+            UA_Variant value;
+            UA_Variant_init(&value);
+            if (UA_Client_readValueAttribute(connected[c], items[0].nodeId, &value) == UA_STATUSCODE_GOOD &&
+                UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_DOUBLE]) &&
+                *(UA_Double *)value.data == marker.doubleValue)
+                result->sharedReads++;
+            UA_Variant_clear(&value);
+        }
+
+        ok = benchPollClients(connected, clients, items, readItems, &result->readsPerSecond,
+                              &result->meanLatencyUs, &result->maxLatencyUs) && ok;
+
+        size_t privateKiB = 0;
+        for (int i = 0; i < processCount; i++)
+            privateKiB += benchProcessMemoryKiB(pool->workers[i], "Private_Dirty");
+        result->privateKiB = privateKiB / (size_t)processCount;
+        result->supervisorKiB = benchProcessMemoryKiB(getpid(), "Rss");
+    }
+    for (int c = 0; c < connectedCount; c++)
+    {
+        UA_Client_disconnect(connected[c]);
+        UA_Client_delete(connected[c]);
+    }
+    UA_free(connected);
+
+    processPoolStop(pool);
+    pool->count = 0;
+    if (server)
+        UA_Server_delete(server);
+    cleanupSimulationEngine(&g_serverContext.simulationEngine);
+    cleanupTagRegistry(&g_serverContext.tags);
+    UA_free(items);
+    return ok;
+}
+
+// 多进程：1个与每核一个工作进程的读取吞吐量、工作进程的私有内存，并校验工作进程读到共享的变量值
+static int runProcessesBenchmark(int tagCount)
+{
+    const int clients = 32;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int processCount = cores > 2 ? (int)cores : 2;
+    int result = EXIT_SUCCESS;
+    raiseFileLimit((rlim_t)clients * 2 + 256);
+
+    printf("多进程基准: %d 个变量, %d 个客户端轮询读取10个变量 1秒\n", tagCount, clients);
+    printf("  %-8s %10s %12s %12s %10s %16s %14s\n", "工作进程", "读取/秒", "平均延迟us", "最大延迟us", "共享值",
+           "每进程私有KiB", "主进程RSS KiB");
+    const int counts[] = {1, processCount};
+    for (int i = 0; i < 2; i++)
+    {
+        BenchProcessesResult run;
+        memset(&run, 0, sizeof(run));
+        UA_Boolean ok = benchProcessesRun(counts[i], tagCount, clients, &run) && run.sharedReads == clients;
+        // 地址空间在派生后写时复制共享，工作进程只复制被写入的页面
+        if (run.privateKiB >= run.supervisorKiB / 2)
+            ok = false;
+        printf("  %-8d %10.0f %12.1f %12.1f %7d/%-3d %16zu %14zu%s\n", counts[i], run.readsPerSecond,
+               run.meanLatencyUs, run.maxLatencyUs, run.sharedReads, clients, run.privateKiB, run.supervisorKiB,
+               ok ? "" : "  失败");
+        if (!ok)
+            result = EXIT_FAILURE;
+    }
+    return result;
+}
+
+static UA_UInt64 g_benchSharedNotifications;
+
+static void benchSharedSamplingCallback(UA_Server *server, UA_UInt32 monitoredItemId, void *monitoredItemContext,
+                                        const UA_NodeId *nodeId, void *nodeContext, UA_UInt32 attributeId,
+                                        const UA_DataValue *value)
+{
+    g_benchSharedNotifications++;
+}
+
+// 共享采样的访问检查：第一个激活的会话没有读取权限，第二个变量的AccessLevel不可读
+static int g_benchDeniedSessionMarker;
+static UA_StatusCode (*g_benchActivateSessionDefault)(UA_Server *, UA_AccessControl *,
+                                                      const UA_EndpointDescription *, const UA_ByteString *,
+                                                      const UA_NodeId *, const UA_ExtensionObject *, void **);
+static void (*g_benchCloseSessionDefault)(UA_Server *, UA_AccessControl *, const UA_NodeId *, void *);
+static UA_Boolean g_benchDeniedSessionActivated;
+
+static UA_StatusCode benchAccessActivateSession(UA_Server *server, UA_AccessControl *ac,
+                                                const UA_EndpointDescription *endpointDescription,
+                                                const UA_ByteString *secureChannelRemoteCertificate,
+                                                const UA_NodeId *sessionId,
+                                                const UA_ExtensionObject *userIdentityToken, void **sessionContext)
+{
+    UA_StatusCode status = g_benchActivateSessionDefault(server, ac, endpointDescription,
+                                                         secureChannelRemoteCertificate, sessionId,
+                                                         userIdentityToken, sessionContext);
+    if (status == UA_STATUSCODE_GOOD && !g_benchDeniedSessionActivated)
+    {
+        *sessionContext = &g_benchDeniedSessionMarker;
+        g_benchDeniedSessionActivated = true;
+    }
+    return status;
+}
+
+static void benchAccessCloseSession(UA_Server *server, UA_AccessControl *ac, const UA_NodeId *sessionId,
+                                    void *sessionContext)
+{
+    if (sessionContext != &g_benchDeniedSessionMarker)
+        g_benchCloseSessionDefault(server, ac, sessionId, sessionContext);
+}
+
+static UA_Byte benchAccessUserAccessLevel(UA_Server *server, UA_AccessControl *ac, const UA_NodeId *sessionId,
+                                          void *sessionContext, const UA_NodeId *nodeId, void *nodeContext)
+{
+    return sessionContext == &g_benchDeniedSessionMarker ? (UA_Byte)UA_ACCESSLEVELMASK_WRITE : 0xFF;
+}
+
+typedef struct
+{
+    UA_StatusCode expected; // 期望的状态，GOOD表示期望收到值
+    UA_UInt64 values;
+    UA_UInt64 statuses;
+    UA_UInt64 unexpected;
+} BenchAccessItem;
+
+static void benchAccessCallback(UA_Client *client, UA_UInt32 subId, void *subContext, UA_UInt32 monId,
+                                void *monContext, UA_DataValue *value)
+{
+    BenchAccessItem *item = (BenchAccessItem *)monContext;
+    UA_StatusCode status = value->hasStatus ? value->status : UA_STATUSCODE_GOOD;
+    if (status != item->expected || (status == UA_STATUSCODE_GOOD) != value->hasValue)
+        item->unexpected++;
+    else if (value->hasValue)
+        item->values++;
+    else
+        item->statuses++;
+}
+
+// 两个会话以相同的采样参数监视同一组变量（共用采样器），各自只能得到自己有权读取的值
+static UA_Boolean benchSharedSamplingAccess(void)
+{
+    const double samplingIntervalMs = 50.0;
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+    UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+    config.shareMonitoredItemSampling = true;
+    g_benchActivateSessionDefault = config.accessControl.activateSession;
+    g_benchCloseSessionDefault = config.accessControl.closeSession;
+    g_benchDeniedSessionActivated = false;
+    config.accessControl.activateSession = benchAccessActivateSession;
+    config.accessControl.closeSession = benchAccessCloseSession;
+    config.accessControl.getUserAccessLevel = benchAccessUserAccessLevel;
+    UA_Server *server = UA_Server_newWithConfig(&config);
+
+    VariableContext *contexts[2];
+    UA_MonitoredItemCreateRequest items[2];
+    for (int i = 0; i < 2; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "AccessTag%d", i);
+        UA_UInt32 initial = 0;
+        UA_NodeId nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 190000 + i), name,
+                                           &UA_TYPES[UA_TYPES_UINT32], &initial, SIMULATION_COUNTER, 1, 0, 0);
+        contexts[i] = tagRegistryFind(&g_serverContext.tags, &nodeId);
+        items[i] = UA_MonitoredItemCreateRequest_default(nodeId);
+        items[i].requestedParameters.samplingInterval = samplingIntervalMs;
+    }
+    UA_Server_writeAccessLevel(server, contexts[1]->nodeId, UA_ACCESSLEVELMASK_WRITE);
+
+    g_benchServerRunning = true;
+    pthread_create(&g_benchServerThreadId, NULL, benchServerThread, server);
+
+    // 第一个连接的会话被拒绝读取
+    BenchAccessItem access[2][2] = {
+        {{UA_STATUSCODE_BADUSERACCESSDENIED, 0, 0, 0}, {UA_STATUSCODE_BADNOTREADABLE, 0, 0, 0}},
+        {{UA_STATUSCODE_GOOD, 0, 0, 0}, {UA_STATUSCODE_BADNOTREADABLE, 0, 0, 0}}};
+    UA_Client *clients[2] = {NULL, NULL};
+    UA_Boolean ok = true;
+    for (int c = 0; c < 2 && ok; c++)
+    {
+        clients[c] = benchConnectClient();
+        if (!clients[c])
+        {
+            ok = false;
+            break;
+        }
+        UA_Client_getConfig(clients[c])->logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+        UA_CreateSubscriptionRequest subRequest = UA_CreateSubscriptionRequest_default();
+        subRequest.requestedPublishingInterval = samplingIntervalMs;
+        UA_CreateSubscriptionResponse subResponse = UA_Client_Subscriptions_create(clients[c], subRequest, NULL,
+                                                                                   NULL, NULL);
+        UA_CreateMonitoredItemsRequest monRequest;
+        UA_CreateMonitoredItemsRequest_init(&monRequest);
+        monRequest.subscriptionId = subResponse.subscriptionId;
+        monRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+        monRequest.itemsToCreate = items;
+        monRequest.itemsToCreateSize = 2;
+        UA_Client_DataChangeNotificationCallback callbacks[2] = {benchAccessCallback, benchAccessCallback};
+        void *contextsOf[2] = {&access[c][0], &access[c][1]};
+        UA_CreateMonitoredItemsResponse monResponse =
+            UA_Client_MonitoredItems_createDataChanges(clients[c], monRequest, contextsOf, callbacks, NULL);
+        ok = subResponse.responseHeader.serviceResult == UA_STATUSCODE_GOOD &&
+             monResponse.responseHeader.serviceResult == UA_STATUSCODE_GOOD && monResponse.resultsSize == 2;
+        UA_CreateMonitoredItemsResponse_clear(&monResponse);
+    }
+
+    // 计数器每10ms加一，两个客户端轮流处理发布应答
+    UA_UInt64 deadline = benchMonotonicNs() + 1000000000ULL, nextTick = benchMonotonicNs();
+    while (ok && benchMonotonicNs() < deadline)
+    {
+        if (benchMonotonicNs() >= nextTick)
+        {
+            for (int i = 0; i < 2; i++)
+            {
+                ScalarValue value = valueCellLoad(&contexts[i]->cell);
+                value.uint32++;
+                valueCellStore(&contexts[i]->cell, value);
+            }
+            nextTick += SIMULATION_TICK_MS * 1000000ULL;
+        }
+        for (int c = 0; c < 2; c++)
+            UA_Client_run_iterate(clients[c], 1);
+    }
+
+    for (int c = 0; c < 2; c++)
+    {
+        if (!clients[c])
+            continue;
+        UA_Client_disconnect(clients[c]);
+        UA_Client_delete(clients[c]);
+    }
+    g_benchServerRunning = false;
+    pthread_join(g_benchServerThreadId, NULL);
+    UA_Server_delete(server);
+    cleanupSimulationEngine(&g_serverContext.simulationEngine);
+    cleanupTagRegistry(&g_serverContext.tags);
+
+    printf("  访问检查: 无权会话 值 %llu 拒绝 %llu, 有权会话 值 %llu, 不可读变量 拒绝 %llu/%llu, 错误 %llu\n",
+           (unsigned long long)access[0][0].values, (unsigned long long)access[0][0].statuses,
+           (unsigned long long)access[1][0].values, (unsigned long long)access[0][1].statuses,
+           (unsigned long long)access[1][1].statuses,
+           (unsigned long long)(access[0][0].unexpected + access[0][1].unexpected + access[1][0].unexpected +
+                                access[1][1].unexpected));
+    for (int c = 0; c < 2; c++)
+        for (int i = 0; i < 2; i++)
+            ok = ok && access[c][i].unexpected == 0 && (access[c][i].values > 0 || access[c][i].statuses > 0);
+    return ok && access[1][0].values > 0;
+}
+
+// 共享采样：每个变量被多个相同的监视项监视（如多个HMI订阅同一组变量），
+// 对比逐项采样与共享采样的读取次数、通知数和服务器线程的CPU时间
+static int runSharedSamplingBenchmark(int tagCount)
+{
+    static const char *modeNames[] = {"逐项", "共享"};
+    const int subscribers = 20;
+    const int ticks = 100; // 10ms周期，每个周期所有计数器加一
+    const double samplingIntervalMs = 100.0;
+    int result = EXIT_SUCCESS;
+    UA_UInt64 reads[2] = {0}, notifications[2] = {0};
+
+    printf("共享采样基准: %d个变量, 每个变量%d个监视项, 采样间隔 %.0fms, %d个10ms周期\n", tagCount, subscribers,
+           samplingIntervalMs, ticks);
+    printf("  %-6s %10s %10s %14s %16s\n", "模式", "读取", "通知", "服务器CPU(ms)", "每变量每秒读取");
+
+    for (int m = 0; m < 2; m++)
+    {
+        UA_ServerConfig config;
+        memset(&config, 0, sizeof(UA_ServerConfig));
+        config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+        UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+        config.maxMonitoredItems = 0; // 不限制
+        config.shareMonitoredItemSampling = (m == 1);
+        UA_Server *server = UA_Server_newWithConfig(&config);
+
+        VariableContext **contexts = (VariableContext **)UA_malloc(tagCount * sizeof(VariableContext *));
+        for (int i = 0; i < tagCount; i++)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "SharedTag%d", i);
+            UA_UInt32 initial = 0;
+            UA_NodeId nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 100000 + i), name,
+                                               &UA_TYPES[UA_TYPES_UINT32], &initial,
+                                               SIMULATION_COUNTER, 1, 0, 0);
+            contexts[i] = tagRegistryFind(&g_serverContext.tags, &nodeId);
+        }
+
+        UA_Server_run_startup(server);
+        for (int s = 0; s < subscribers; s++)
+        {
+            for (int i = 0; i < tagCount; i++)
+            {
+                UA_MonitoredItemCreateRequest request = UA_MonitoredItemCreateRequest_default(contexts[i]->nodeId);
+                request.requestedParameters.samplingInterval = samplingIntervalMs;
+                UA_Server_createDataChangeMonitoredItem(server, UA_TIMESTAMPSTORETURN_BOTH, request, NULL,
+                                                        benchSharedSamplingCallback);
+            }
+        }
+
+        // 创建监视项时的首次采样不计入
+        UA_UInt64 readsBefore = g_serverContext.totalRequests;
+        g_benchSharedNotifications = 0;
+        struct timespec cpuStart, cpuEnd;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuStart);
+        UA_UInt64 start = benchMonotonicNs(), deadline = start;
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            for (int i = 0; i < tagCount; i++)
+            {
+                ScalarValue value = valueCellLoad(&contexts[i]->cell);
+                value.uint32++;
+                valueCellStore(&contexts[i]->cell, value);
+            }
+            deadline += SIMULATION_TICK_MS * 1000000ULL;
+            benchIterateUntil(server, deadline);
+        }
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuEnd);
+        double seconds = (benchMonotonicNs() - start) / 1e9;
+        double cpuMs = (cpuEnd.tv_sec - cpuStart.tv_sec) * 1e3 + (cpuEnd.tv_nsec - cpuStart.tv_nsec) / 1e6;
+        reads[m] = g_serverContext.totalRequests - readsBefore;
+        notifications[m] = g_benchSharedNotifications;
+        printf("  %-6s %10llu %10llu %14.1f %16.1f\n", modeNames[m], (unsigned long long)reads[m],
+               (unsigned long long)notifications[m], cpuMs, reads[m] / seconds / tagCount);
+
+        UA_Server_run_shutdown(server);
+        UA_Server_delete(server);
+        UA_free(contexts);
+        cleanupSimulationEngine(&g_serverContext.simulationEngine);
+        cleanupTagRegistry(&g_serverContext.tags);
+    }
+
+    if (!benchSharedSamplingAccess())
+        result = EXIT_FAILURE;
+
+    // 共享模式下每个变量每个采样间隔只读取一次，每次读取到的变化通知所有监视项
+    double intervals = ticks * SIMULATION_TICK_MS / samplingIntervalMs;
+    if (reads[1] == 0 || reads[1] > (UA_UInt64)(tagCount * (intervals + 2)) ||
+        notifications[1] != reads[1] * subscribers || reads[0] < reads[1] * subscribers / 2)
+        result = EXIT_FAILURE;
+    return result;
+}
+
+static UA_UInt64 g_benchNotificationsReceived;
+static UA_UInt64 g_benchNotificationsInvalid;
+
+static void benchNotificationsCallback(UA_Client *client, UA_UInt32 subId, void *subContext, UA_UInt32 monId,
+                                       void *monContext, UA_DataValue *value)
+{
+    g_benchNotificationsReceived++;
+    // 预热期间所有计数器都已递增，内联存储的值必须完整送达
+    if (!value->hasValue || !UA_Variant_hasScalarType(&value->value, &UA_TYPES[UA_TYPES_UINT32]) ||
+        *(UA_UInt32 *)value->value.data == 0)
+        g_benchNotificationsInvalid++;
+}
+
+// 在当前线程处理客户端的发布响应，同时每10ms将所有计数器加一
+static void benchNotificationsDrive(UA_Client *client, VariableContext **contexts, int tagCount,
+                                    UA_UInt64 durationNs)
+{
+    UA_UInt64 deadline = benchMonotonicNs() + durationNs;
+    UA_UInt64 nextTick = benchMonotonicNs();
+    while (benchMonotonicNs() < deadline)
+    {
+        if (benchMonotonicNs() >= nextTick)
+        {
+            for (int i = 0; i < tagCount; i++)
+            {
+                ScalarValue value = valueCellLoad(&contexts[i]->cell);
+                value.uint32++;
+                valueCellStore(&contexts[i]->cell, value);
+            }
+            nextTick += SIMULATION_TICK_MS * 1000000ULL;
+        }
+        UA_Client_run_iterate(client, 1);
+    }
+}
+
+// 通知分配：订阅的监视项每次采样到变化都产生一个通知，发布间隔内多次采样时队列溢出丢弃旧通知。
+// 统计服务器线程上每次采样的堆分配次数（读取本身的值复制也计入）
+static int runNotificationsBenchmark(int tagCount)
+{
+    static const UA_UInt32 queueSizes[] = {1, 2};
+    static const UA_Boolean discardOldest[] = {true, false};
+    const double samplingIntervalMs = 50.0;
+    const double publishingIntervalMs = 200.0;
+    int result = EXIT_SUCCESS;
+
+    UA_mallocSingleton = benchMalloc;
+    UA_callocSingleton = benchCalloc;
+    UA_reallocSingleton = benchRealloc;
+
+    printf("通知分配基准: %d个被监视的计数器变量, 采样间隔 %.0fms, 发布间隔 %.0fms\n", tagCount,
+           samplingIntervalMs, publishingIntervalMs);
+    printf("  %-14s %10s %10s %10s %14s\n", "队列", "采样", "收到通知", "堆分配", "每次采样分配");
+
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+    UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+    config.maxMonitoredItems = 0; // 不限制
+    UA_Server *server = UA_Server_newWithConfig(&config);
+
+    VariableContext **contexts = (VariableContext **)UA_malloc(tagCount * sizeof(VariableContext *));
+    UA_MonitoredItemCreateRequest *items =
+        (UA_MonitoredItemCreateRequest *)UA_malloc(tagCount * sizeof(UA_MonitoredItemCreateRequest));
+    UA_Client_DataChangeNotificationCallback *callbacks = (UA_Client_DataChangeNotificationCallback *)UA_malloc(
+        tagCount * sizeof(UA_Client_DataChangeNotificationCallback));
+    for (int i = 0; i < tagCount; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "NotifyTag%d", i);
+        UA_UInt32 initial = 0;
+        UA_NodeId nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 140000 + i), name,
+                                           &UA_TYPES[UA_TYPES_UINT32], &initial, SIMULATION_COUNTER, 1, 0, 0);
+        contexts[i] = tagRegistryFind(&g_serverContext.tags, &nodeId);
+        items[i] = UA_MonitoredItemCreateRequest_default(nodeId);
+        items[i].requestedParameters.samplingInterval = samplingIntervalMs;
+        callbacks[i] = benchNotificationsCallback;
+    }
+
+    g_benchServerRunning = true;
+    pthread_create(&g_benchServerThreadId, NULL, benchServerThread, server);
+
+    // 每种队列配置使用新的会话，断开连接时服务器删除其订阅
+    for (int q = 0; q < 2; q++)
+    {
+        UA_Client *client = benchConnectClient();
+        if (!client)
+        {
+            result = EXIT_FAILURE;
+            break;
+        }
+        // 断开连接时未完成的发布请求会得到BadNoSubscription警告
+        UA_Client_getConfig(client)->logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+
+        UA_CreateSubscriptionRequest subRequest = UA_CreateSubscriptionRequest_default();
+        subRequest.requestedPublishingInterval = publishingIntervalMs;
+        UA_CreateSubscriptionResponse subResponse =
+            UA_Client_Subscriptions_create(client, subRequest, NULL, NULL, NULL);
+        if (subResponse.responseHeader.serviceResult != UA_STATUSCODE_GOOD)
+        {
+            UA_Client_disconnect(client);
+            UA_Client_delete(client);
+            result = EXIT_FAILURE;
+            break;
+        }
+
+        for (int i = 0; i < tagCount; i++)
+        {
+            items[i].requestedParameters.queueSize = queueSizes[q];
+            items[i].requestedParameters.discardOldest = discardOldest[q];
+        }
+        UA_CreateMonitoredItemsRequest monRequest;
+        UA_CreateMonitoredItemsRequest_init(&monRequest);
+        monRequest.subscriptionId = subResponse.subscriptionId;
+        monRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+        monRequest.itemsToCreate = items;
+        monRequest.itemsToCreateSize = (size_t)tagCount;
+        UA_CreateMonitoredItemsResponse monResponse =
+            UA_Client_MonitoredItems_createDataChanges(client, monRequest, NULL, callbacks, NULL);
+        UA_Boolean created = monResponse.responseHeader.serviceResult == UA_STATUSCODE_GOOD &&
+                             monResponse.resultsSize == (size_t)tagCount;
+        for (size_t i = 0; created && i < monResponse.resultsSize; i++)
+            created = monResponse.results[i].statusCode == UA_STATUSCODE_GOOD;
+        UA_CreateMonitoredItemsResponse_clear(&monResponse);
+
+        // 预热若干个发布周期后再开始统计
+        benchNotificationsDrive(client, contexts, tagCount, 500000000ULL);
+
+        UA_UInt64 readsBefore = __atomic_load_n(&g_serverContext.totalRequests, __ATOMIC_RELAXED);
+        g_benchNotificationsReceived = 0;
+        g_benchNotificationsInvalid = 0;
+        __atomic_store_n(&g_benchAllocCount, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&g_benchCountAllocs, true, __ATOMIC_RELAXED);
+        benchNotificationsDrive(client, contexts, tagCount, 2000000000ULL);
+        __atomic_store_n(&g_benchCountAllocs, false, __ATOMIC_RELAXED);
+        UA_UInt64 samples = __atomic_load_n(&g_serverContext.totalRequests, __ATOMIC_RELAXED) - readsBefore;
+        UA_UInt64 allocs = __atomic_load_n(&g_benchAllocCount, __ATOMIC_RELAXED);
+
+        char label[32];
+        snprintf(label, sizeof(label), "%u/%s", queueSizes[q], discardOldest[q] ? "丢弃最旧" : "丢弃最新");
+        double perSample = samples ? (double)allocs / samples : 0.0;
+        printf("  %-14s %10llu %10llu %10llu %14.2f\n", label, (unsigned long long)samples,
+               (unsigned long long)g_benchNotificationsReceived, (unsigned long long)allocs, perSample);
+
+        // 采样值的复制是唯一剩下的逐次分配，通知本身不再分配
+        if (!created || samples == 0 || g_benchNotificationsReceived == 0 || g_benchNotificationsInvalid > 0 ||
+            perSample >= 1.5)
+            result = EXIT_FAILURE;
+
+        UA_Client_disconnect(client);
+        UA_Client_delete(client);
+    }
+
+    g_benchServerRunning = false;
+    pthread_join(g_benchServerThreadId, NULL);
+    UA_Server_delete(server);
+    UA_free(callbacks);
+    UA_free(items);
+    UA_free(contexts);
+    cleanupSimulationEngine(&g_serverContext.simulationEngine);
+    cleanupTagRegistry(&g_serverContext.tags);
+
+    UA_mallocSingleton = malloc;
+    UA_callocSingleton = calloc;
+    UA_reallocSingleton = realloc;
+    return result;
+}
+
+static UA_UInt64 g_benchValueChanges;
+
+static void benchValueChangeCallback(UA_Server *server, UA_UInt32 monitoredItemId, void *monitoredItemContext,
+                                     const UA_NodeId *nodeId, void *nodeContext, UA_UInt32 attributeId,
+                                     const UA_DataValue *value)
+{
+    g_benchValueChanges++;
+}
+
+// 修改一个值单元：数值加一、布尔取反、字符串在长度不变时改写内容（changed为假时写入相同内容的新副本）
+static void benchValueChangeWrite(VariableContext *context, UA_Boolean changed)
+{
+    if (context->type == &UA_TYPES[UA_TYPES_STRING])
+    {
+        char text[] = "value-change-0";
+        if (changed)
+            text[sizeof(text) - 2] = '1';
+        UA_String value = UA_STRING(text);
+        valueCellWriteString(&context->cell, &value);
+        return;
+    }
+    if (!changed)
+        return;
+    ScalarValue value = valueCellLoad(&context->cell);
+    switch (context->type->typeKind)
+    {
+    case UA_DATATYPEKIND_BOOLEAN:
+        value.boolean = !value.boolean;
+        break;
+    case UA_DATATYPEKIND_INT32:
+        value.int32++;
+        break;
+    case UA_DATATYPEKIND_UINT32:
+        value.uint32++;
+        break;
+    case UA_DATATYPEKIND_FLOAT:
+        value.floatValue += 1.0f;
+        break;
+    case UA_DATATYPEKIND_DOUBLE:
+        value.doubleValue += 1.0;
+        break;
+    default:
+        value.dateTime += UA_DATETIME_MSEC;
+        break;
+    }
+    valueCellStore(&context->cell, value);
+}
+
+// 变化检测：每种类型的变量各有一组本地监视项，值不变时测量每次采样的服务器CPU时间，
+// 随后每个变量变化一次，校验每个监视项恰好产生一个通知
+static int runValueChangeBenchmark(int itemCount)
+{
+    static const int typeIndices[] = {UA_TYPES_INT32,   UA_TYPES_UINT32,   UA_TYPES_FLOAT, UA_TYPES_DOUBLE,
+                                      UA_TYPES_BOOLEAN, UA_TYPES_DATETIME, UA_TYPES_STRING};
+    const int typeCount = (int)(sizeof(typeIndices) / sizeof(typeIndices[0]));
+    const double samplingIntervalMs = 50.0;
+    const int perType = itemCount / typeCount;
+    int result = EXIT_SUCCESS;
+
+    if (perType < 1)
+    {
+        logMessage(LOG_LEVEL_ERROR, "监视项数量至少为%d", typeCount);
+        return EXIT_FAILURE;
+    }
+
+    printf("变化检测基准: 每种类型%d个本地监视项, 采样间隔 %.0fms\n", perType, samplingIntervalMs);
+    printf("  %-10s %10s %16s %18s %10s\n", "类型", "采样", "每次采样CPU(ns)", "单核每秒采样上限", "变化通知");
+
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+    UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+    config.maxMonitoredItems = 0; // 不限制
+    UA_Server *server = UA_Server_newWithConfig(&config);
+
+    VariableContext **contexts = (VariableContext **)UA_malloc(perType * sizeof(VariableContext *));
+    UA_UInt32 *monitoredItemIds = (UA_UInt32 *)UA_malloc(perType * sizeof(UA_UInt32));
+    UA_Server_run_startup(server);
+
+    for (int t = 0; t < typeCount; t++)
+    {
+        const UA_DataType *type = &UA_TYPES[typeIndices[t]];
+        for (int i = 0; i < perType; i++)
+        {
+            char name[48];
+            snprintf(name, sizeof(name), "ChangeTag%s%d", type->typeName, i);
+            ScalarValue initial;
+            memset(&initial, 0, sizeof(initial));
+            UA_String initialString = UA_STRING("value-change-0");
+            UA_NodeId nodeId =
+                addVariableNode(server, UA_NODEID_NUMERIC(1, 160000 + t * perType + i), name, type,
+                                type == &UA_TYPES[UA_TYPES_STRING] ? (void *)&initialString : (void *)&initial,
+                                SIMULATION_NONE, 0, 0, 0);
+            contexts[i] = tagRegistryFind(&g_serverContext.tags, &nodeId);
+
+            UA_MonitoredItemCreateRequest request = UA_MonitoredItemCreateRequest_default(nodeId);
+            request.requestedParameters.samplingInterval = samplingIntervalMs;
+            UA_MonitoredItemCreateResult created = UA_Server_createDataChangeMonitoredItem(
+                server, UA_TIMESTAMPSTORETURN_NEITHER, request, NULL, benchValueChangeCallback);
+            monitoredItemIds[i] = created.monitoredItemId;
+            if (created.statusCode != UA_STATUSCODE_GOOD)
+                result = EXIT_FAILURE;
+        }
+
+        // 值不变：字符串写入内容相同的新副本，比较不能依赖指针相等
+        for (int i = 0; i < perType; i++)
+            benchValueChangeWrite(contexts[i], false);
+        g_benchValueChanges = 0;
+        UA_UInt64 readsBefore = g_serverContext.totalRequests;
+        struct timespec cpuStart, cpuEnd;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuStart);
+        benchIterateUntil(server, benchMonotonicNs() + 1000000000ULL);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuEnd);
+        double cpuNs = (cpuEnd.tv_sec - cpuStart.tv_sec) * 1e9 + (cpuEnd.tv_nsec - cpuStart.tv_nsec);
+        UA_UInt64 samples = g_serverContext.totalRequests - readsBefore;
+        UA_UInt64 unchangedNotifications = g_benchValueChanges;
+
+        // 每个变量变化一次，等待两个采样间隔
+        for (int i = 0; i < perType; i++)
+            benchValueChangeWrite(contexts[i], true);
+        g_benchValueChanges = 0;
+        benchIterateUntil(server, benchMonotonicNs() + (UA_UInt64)(samplingIntervalMs * 2e6));
+
+        double perSampleNs = samples ? cpuNs / samples : 0.0;
+        printf("  %-10s %10llu %16.0f %18.0f %10llu\n", type->typeName, (unsigned long long)samples, perSampleNs,
+               perSampleNs > 0 ? 1e9 / perSampleNs : 0.0, (unsigned long long)g_benchValueChanges);
+        if (samples == 0 || unchangedNotifications != 0 || g_benchValueChanges != (UA_UInt64)perType)
+            result = EXIT_FAILURE;
+
+        for (int i = 0; i < perType; i++)
+            UA_Server_deleteMonitoredItem(server, monitoredItemIds[i]);
+    }
+
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    UA_free(monitoredItemIds);
+    UA_free(contexts);
+    cleanupSimulationEngine(&g_serverContext.simulationEngine);
+    cleanupTagRegistry(&g_serverContext.tags);
+    return result;
+}
+
+typedef struct
+{
+    double deadband; // 换算后的绝对死区
+    double lastReported;
+    UA_Boolean reported;
+} BenchDeadbandItem;
+
+static BenchDeadbandItem *g_benchDeadbandItems;
+static UA_UInt64 g_benchDeadbandNotifications;
+static UA_UInt64 g_benchDeadbandViolations;
+
+// 校验每个通知相对上次上报的值超出死区
+static void benchDeadbandCallback(UA_Server *server, UA_UInt32 monitoredItemId, void *monitoredItemContext,
+                                  const UA_NodeId *nodeId, void *nodeContext, UA_UInt32 attributeId,
+                                  const UA_DataValue *value)
+{
+    BenchDeadbandItem *item = &g_benchDeadbandItems[(uintptr_t)monitoredItemContext];
+    g_benchDeadbandNotifications++;
+    if (!value->hasValue || value->value.type != &UA_TYPES[UA_TYPES_DOUBLE])
+    {
+        g_benchDeadbandViolations++;
+        return;
+    }
+    double v = *(const UA_Double *)value->value.data;
+    if (item->reported && fabs(v - item->lastReported) <= item->deadband)
+        g_benchDeadbandViolations++;
+    item->lastReported = v;
+    item->reported = true;
+}
+
+// 百分比死区：正弦变量按振幅和偏移带有EURange，分别以无过滤和不同百分比死区监视，
+// 比较通知数量并校验每个通知都超出换算后的绝对死区；没有EURange的计数器必须被拒绝。
+// 每轮恰好一个正弦周期，通知数量与开始时的相位无关
+static int runDeadbandBenchmark(int itemCount)
+{
+    static const double percents[] = {0.0, 5.0, 20.0};
+    const int modeCount = (int)(sizeof(percents) / sizeof(percents[0]));
+    const double samplingIntervalMs = 50.0;
+    const UA_UInt64 durationNs = 2000000000ULL;
+    int result = EXIT_SUCCESS;
+
+    if (itemCount < 1)
+    {
+        logMessage(LOG_LEVEL_ERROR, "监视项数量至少为1");
+        return EXIT_FAILURE;
+    }
+
+    printf("百分比死区基准: %d个正弦变量, 采样间隔 %.0fms, 每轮 %.0fs\n", itemCount, samplingIntervalMs,
+           durationNs / 1e9);
+    printf("  %-10s %12s %16s %16s %10s\n", "死区", "通知", "每监视项通知", "每次采样CPU(ns)", "违反死区");
+
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+    UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+    config.maxMonitoredItems = 0; // 不限制
+    UA_Server *server = UA_Server_newWithConfig(&config);
+
+    VariableContext **contexts = (VariableContext **)UA_malloc(itemCount * sizeof(VariableContext *));
+    UA_NodeId *nodeIds = (UA_NodeId *)UA_malloc(itemCount * sizeof(UA_NodeId));
+    UA_UInt32 *monitoredItemIds = (UA_UInt32 *)UA_malloc(itemCount * sizeof(UA_UInt32));
+    g_benchDeadbandItems = (BenchDeadbandItem *)UA_malloc(itemCount * sizeof(BenchDeadbandItem));
+    UA_Server_run_startup(server);
+
+    // 周期2秒的正弦，振幅和偏移各不相同
+    for (int i = 0; i < itemCount; i++)
+    {
+        char name[48];
+        snprintf(name, sizeof(name), "DeadbandTag%d", i);
+        double amplitude = 1.0 + i % 10;
+        double offset = 10.0 * (i % 7);
+        UA_Double initial = offset;
+        nodeIds[i] = addVariableNode(server, UA_NODEID_NUMERIC(1, 170000 + i), name, &UA_TYPES[UA_TYPES_DOUBLE],
+                                     &initial, SIMULATION_SINE_WAVE, 30.0, amplitude, offset);
+        contexts[i] = tagRegistryFind(&g_serverContext.tags, &nodeIds[i]);
+    }
+    UA_Int32 counterInitial = 0;
+    UA_NodeId counterId = addVariableNode(server, UA_NODEID_NUMERIC(1, 169999), "DeadbandCounter",
+                                          &UA_TYPES[UA_TYPES_INT32], &counterInitial, SIMULATION_COUNTER, 0, 0, 0);
+
+    UA_DataChangeFilter filter;
+    UA_DataChangeFilter_init(&filter);
+    filter.trigger = UA_DATACHANGETRIGGER_STATUSVALUE;
+    filter.deadbandType = UA_DEADBANDTYPE_PERCENT;
+
+    // 没有EURange的变量不允许百分比死区
+    filter.deadbandValue = 1.0;
+    UA_MonitoredItemCreateRequest counterRequest = UA_MonitoredItemCreateRequest_default(counterId);
+    UA_ExtensionObject_setValue(&counterRequest.requestedParameters.filter, &filter,
+                                &UA_TYPES[UA_TYPES_DATACHANGEFILTER]);
+    UA_MonitoredItemCreateResult rejected = UA_Server_createDataChangeMonitoredItem(
+        server, UA_TIMESTAMPSTORETURN_NEITHER, counterRequest, NULL, benchDeadbandCallback);
+    if (rejected.statusCode != UA_STATUSCODE_BADFILTERNOTALLOWED)
+    {
+        printf("  计数器变量的百分比死区未被拒绝: %s\n", UA_StatusCode_name(rejected.statusCode));
+        if (rejected.statusCode == UA_STATUSCODE_GOOD)
+            UA_Server_deleteMonitoredItem(server, rejected.monitoredItemId);
+        result = EXIT_FAILURE;
+    }
+
+    UA_UInt64 notificationsWithoutFilter = 0;
+    for (int m = 0; m < modeCount; m++)
+    {
+        filter.deadbandValue = percents[m];
+        for (int i = 0; i < itemCount; i++)
+        {
+            double range = 2.0 * contexts[i]->simulationParam2;
+            g_benchDeadbandItems[i].deadband = percents[m] / 100.0 * range;
+            g_benchDeadbandItems[i].reported = false;
+
+            UA_MonitoredItemCreateRequest request = UA_MonitoredItemCreateRequest_default(nodeIds[i]);
+            request.requestedParameters.samplingInterval = samplingIntervalMs;
+            if (percents[m] > 0.0)
+                UA_ExtensionObject_setValue(&request.requestedParameters.filter, &filter,
+                                            &UA_TYPES[UA_TYPES_DATACHANGEFILTER]);
+            UA_MonitoredItemCreateResult created = UA_Server_createDataChangeMonitoredItem(
+                server, UA_TIMESTAMPSTORETURN_NEITHER, request, (void *)(uintptr_t)i, benchDeadbandCallback);
+            monitoredItemIds[i] = created.monitoredItemId;
+            if (created.statusCode != UA_STATUSCODE_GOOD)
+                result = EXIT_FAILURE;
+        }
+
+        g_benchDeadbandNotifications = 0;
+        g_benchDeadbandViolations = 0;
+        UA_UInt64 readsBefore = g_serverContext.totalRequests;
+        struct timespec cpuStart, cpuEnd;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuStart);
+        UA_UInt64 deadline = benchMonotonicNs() + durationNs;
+        while (benchMonotonicNs() < deadline)
+        {
+            double now = simulationTime();
+            for (int i = 0; i < itemCount; i++)
+                updateSimulatedValue(contexts[i], now, 0);
+            UA_Server_run_iterate(server, false);
+            struct timespec pause = {0, 500000};
+            nanosleep(&pause, NULL);
+        }
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuEnd);
+        double cpuNs = (cpuEnd.tv_sec - cpuStart.tv_sec) * 1e9 + (cpuEnd.tv_nsec - cpuStart.tv_nsec);
+        UA_UInt64 samples = g_serverContext.totalRequests - readsBefore;
+
+        char label[16] = "无";
+        if (percents[m] > 0.0)
+            snprintf(label, sizeof(label), "%.0f%%", percents[m]);
+        printf("  %-10s %12llu %16.1f %16.0f %10llu\n", label, (unsigned long long)g_benchDeadbandNotifications,
+               (double)g_benchDeadbandNotifications / itemCount, samples ? cpuNs / samples : 0.0,
+               (unsigned long long)g_benchDeadbandViolations);
+
+        if (percents[m] == 0.0)
+            notificationsWithoutFilter = g_benchDeadbandNotifications;
+        else if (g_benchDeadbandNotifications >= notificationsWithoutFilter)
+            result = EXIT_FAILURE;
+        if (samples == 0 || g_benchDeadbandNotifications < (UA_UInt64)itemCount || g_benchDeadbandViolations != 0)
+            result = EXIT_FAILURE;
+
+        for (int i = 0; i < itemCount; i++)
+            UA_Server_deleteMonitoredItem(server, monitoredItemIds[i]);
+    }
+
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    UA_free(g_benchDeadbandItems);
+    g_benchDeadbandItems = NULL;
+    UA_free(monitoredItemIds);
+    UA_free(nodeIds);
+    UA_free(contexts);
+    cleanupSimulationEngine(&g_serverContext.simulationEngine);
+    cleanupTagRegistry(&g_serverContext.tags);
+    return result;
+}
+
+static UA_UInt64 g_benchFanOutReceived;
+static UA_UInt64 g_benchFanOutInvalid;
+
+static void benchFanOutCallback(UA_Client *client, UA_UInt32 subId, void *subContext, UA_UInt32 monId,
+                                void *monContext, UA_DataValue *value)
+{
+    g_benchFanOutReceived++;
+    // 共用的编码必须解码为完整的字符串值和时间戳
+    if (!value->hasValue || !value->hasSourceTimestamp || !value->hasServerTimestamp ||
+        !UA_Variant_hasScalarType(&value->value, &UA_TYPES[UA_TYPES_STRING]) ||
+        ((UA_String *)value->value.data)->length < 8 ||
+        memcmp(((UA_String *)value->value.data)->data, "fan-out-", 8) != 0)
+        g_benchFanOutInvalid++;
+}
+
+// 每100ms改写所有字符串变量，同时轮流处理所有客户端的发布响应
+static void benchFanOutDrive(UA_Client **clients, int sessions, VariableContext **contexts, int tagCount,
+                             UA_UInt64 durationNs)
+{
+    static UA_UInt32 version;
+    UA_UInt64 deadline = benchMonotonicNs() + durationNs;
+    UA_UInt64 nextChange = benchMonotonicNs();
+    while (benchMonotonicNs() < deadline)
+    {
+        if (benchMonotonicNs() >= nextChange)
+        {
+            version++;
+            for (int i = 0; i < tagCount; i++)
+            {
+                char text[96];
+                snprintf(text, sizeof(text), "fan-out-%08u-tag-%04d-padding-to-a-typical-string-value-length",
+                         version, i);
+                UA_String value = UA_STRING(text);
+                valueCellWriteString(&contexts[i]->cell, &value);
+            }
+            nextChange += 100 * 1000000ULL;
+        }
+        for (int c = 0; c < sessions; c++)
+            UA_Client_run_iterate(clients[c], 0);
+        struct timespec pause = {0, 1000000};
+        nanosleep(&pause, NULL);
+    }
+}
+
+static double benchThreadCpuMs(pthread_t thread)
+{
+    clockid_t clock;
+    struct timespec ts;
+    if (pthread_getcpuclockid(thread, &clock) != 0 || clock_gettime(clock, &ts) != 0)
+        return 0.0;
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// 编码扇出：多个会话订阅相同的字符串变量，共享采样把每次变化分发给所有订阅。
+// 比较每个订阅各自编码与同一采样值只编码一次时服务器线程每个通知的CPU时间，并校验收到的值完整
+static int runFanOutBenchmark(int sessions)
+{
+    static const char *modeNames[] = {"逐订阅编码", "共享编码"};
+    const int tagCount = 20;
+    const double intervalMs = 100.0;
+    int result = EXIT_SUCCESS;
+
+    if (sessions < 1)
+    {
+        logMessage(LOG_LEVEL_ERROR, "会话数量至少为1");
+        return EXIT_FAILURE;
+    }
+
+    printf("编码扇出基准: %d个会话各订阅%d个字符串变量, 采样和发布间隔 %.0fms, 每100ms全部变化\n", sessions,
+           tagCount, intervalMs);
+    printf("  %-12s %12s %14s %16s %10s\n", "模式", "收到通知", "服务器CPU(ms)", "每通知CPU(us)", "无效值");
+
+    UA_Client **clients = (UA_Client **)UA_calloc(sessions, sizeof(UA_Client *));
+    VariableContext **contexts = (VariableContext **)UA_malloc(tagCount * sizeof(VariableContext *));
+    UA_MonitoredItemCreateRequest *items =
+        (UA_MonitoredItemCreateRequest *)UA_malloc(tagCount * sizeof(UA_MonitoredItemCreateRequest));
+    UA_Client_DataChangeNotificationCallback *callbacks = (UA_Client_DataChangeNotificationCallback *)UA_malloc(
+        tagCount * sizeof(UA_Client_DataChangeNotificationCallback));
+
+    for (int m = 0; m < 2 && result == EXIT_SUCCESS; m++)
+    {
+        UA_ServerConfig config;
+        memset(&config, 0, sizeof(UA_ServerConfig));
+        config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+        UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+        config.maxMonitoredItems = 0; // 不限制
+        config.maxSessions = (UA_UInt32)sessions + 1;
+        config.maxSecureChannels = (UA_UInt16)(sessions + 1);
+        config.shareMonitoredItemSampling = true;
+        config.shareNotificationEncoding = (m == 1);
+        UA_Server *server = UA_Server_newWithConfig(&config);
+
+        for (int i = 0; i < tagCount; i++)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "FanOutTag%d", i);
+            UA_String initial = UA_STRING("fan-out-initial");
+            UA_NodeId nodeId = addVariableNode(server, UA_NODEID_NUMERIC(1, 180000 + i), name,
+                                               &UA_TYPES[UA_TYPES_STRING], &initial, SIMULATION_NONE, 0, 0, 0);
+            contexts[i] = tagRegistryFind(&g_serverContext.tags, &nodeId);
+            items[i] = UA_MonitoredItemCreateRequest_default(nodeId);
+            items[i].requestedParameters.samplingInterval = intervalMs;
+            callbacks[i] = benchFanOutCallback;
+        }
+
+        g_benchServerRunning = true;
+        pthread_create(&g_benchServerThreadId, NULL, benchServerThread, server);
+
+        UA_Boolean ready = true;
+        for (int c = 0; c < sessions && ready; c++)
+        {
+            UA_Client *client = benchConnectClient();
+            if (!client)
+            {
+                ready = false;
+                break;
+            }
+            clients[c] = client;
+            // 断开连接时未完成的发布请求会得到BadNoSubscription警告
+            UA_Client_getConfig(client)->logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+
+            UA_CreateSubscriptionRequest subRequest = UA_CreateSubscriptionRequest_default();
+            subRequest.requestedPublishingInterval = intervalMs;
+            UA_CreateSubscriptionResponse subResponse =
+                UA_Client_Subscriptions_create(client, subRequest, NULL, NULL, NULL);
+            if (subResponse.responseHeader.serviceResult != UA_STATUSCODE_GOOD)
+            {
+                ready = false;
+                break;
+            }
+
+            UA_CreateMonitoredItemsRequest monRequest;
+            UA_CreateMonitoredItemsRequest_init(&monRequest);
+            monRequest.subscriptionId = subResponse.subscriptionId;
+            monRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+            monRequest.itemsToCreate = items;
+            monRequest.itemsToCreateSize = (size_t)tagCount;
+            UA_CreateMonitoredItemsResponse monResponse =
+                UA_Client_MonitoredItems_createDataChanges(client, monRequest, NULL, callbacks, NULL);
+            UA_Boolean created = monResponse.responseHeader.serviceResult == UA_STATUSCODE_GOOD &&
+                                 monResponse.resultsSize == (size_t)tagCount;
+            for (size_t i = 0; created && i < monResponse.resultsSize; i++)
+                created = monResponse.results[i].statusCode == UA_STATUSCODE_GOOD;
+            UA_CreateMonitoredItemsResponse_clear(&monResponse);
+            ready = created;
+        }
+
+        if (ready)
+        {
+            // 预热若干个发布周期后再开始统计
+            benchFanOutDrive(clients, sessions, contexts, tagCount, 500000000ULL);
+
+            g_benchFanOutReceived = 0;
+            g_benchFanOutInvalid = 0;
+            double cpuStart = benchThreadCpuMs(g_benchServerThreadId);
+            benchFanOutDrive(clients, sessions, contexts, tagCount, 2000000000ULL);
+            double cpuMs = benchThreadCpuMs(g_benchServerThreadId) - cpuStart;
+
+            double perNotification = g_benchFanOutReceived ? cpuMs * 1e3 / g_benchFanOutReceived : 0.0;
+            printf("  %-12s %12llu %14.1f %16.2f %10llu\n", modeNames[m],
+                   (unsigned long long)g_benchFanOutReceived, cpuMs, perNotification,
+                   (unsigned long long)g_benchFanOutInvalid);
+            if (g_benchFanOutReceived == 0 || g_benchFanOutInvalid > 0)
+                result = EXIT_FAILURE;
+        }
+        else
+        {
+            printf("  %-12s 建立会话和订阅失败\n", modeNames[m]);
+            result = EXIT_FAILURE;
+        }
+
+        for (int c = 0; c < sessions; c++)
+        {
+            if (!clients[c])
+                continue;
+            UA_Client_disconnect(clients[c]);
+            UA_Client_delete(clients[c]);
+            clients[c] = NULL;
+        }
+
+        g_benchServerRunning = false;
+        pthread_join(g_benchServerThreadId, NULL);
+        UA_Server_delete(server);
+        cleanupSimulationEngine(&g_serverContext.simulationEngine);
+        cleanupTagRegistry(&g_serverContext.tags);
+    }
+
+    UA_free(callbacks);
+    UA_free(items);
+    UA_free(contexts);
+    UA_free(clients);
+    return result;
+}
+
+// 发布调度基准的会话：不经客户端订阅管理，直接发送发布请求并读取应答中的发布时间
+typedef struct
+{
+    UA_Client *client;
+    int outstanding; // 未完成的发布请求
+} BenchPublishSession;
+
+static UA_DateTime *g_benchPublishCreated; // 按订阅ID索引的创建时间
+static UA_UInt32 *g_benchPublishCounts;
+static UA_UInt32 g_benchPublishSubscriptions;
+static UA_DateTime g_benchPublishInterval;
+static UA_Boolean g_benchPublishRecording;
+static double *g_benchPublishDeviations;
+static size_t g_benchPublishDeviationsSize;
+static size_t g_benchPublishDeviationsCapacity;
+static UA_UInt64 g_benchPublishErrors;
+
+static void benchPublishCallback(UA_Client *client, void *userdata, UA_UInt32 requestId, void *r)
+{
+    BenchPublishSession *session = (BenchPublishSession *)userdata;
+    UA_PublishResponse *response = (UA_PublishResponse *)r;
+    session->outstanding--;
+    if (!g_benchPublishRecording)
+        return;
+
+    UA_UInt32 id = response->subscriptionId;
+    if (response->responseHeader.serviceResult != UA_STATUSCODE_GOOD || id == 0 ||
+        id > g_benchPublishSubscriptions)
+    {
+        g_benchPublishErrors++;
+        return;
+    }
+    g_benchPublishCounts[id]++;
+
+    // 与订阅自身周期(创建时间加整数个发布间隔)的偏差
+    UA_DateTime sinceCreated = response->notificationMessage.publishTime - g_benchPublishCreated[id];
+    UA_DateTime cycles = (sinceCreated + g_benchPublishInterval / 2) / g_benchPublishInterval;
+    UA_DateTime deviation = sinceCreated - cycles * g_benchPublishInterval;
+    if (g_benchPublishDeviationsSize < g_benchPublishDeviationsCapacity)
+        g_benchPublishDeviations[g_benchPublishDeviationsSize++] =
+            (double)(deviation < 0 ? -deviation : deviation) / UA_DATETIME_MSEC;
+}
+
+// 每个会话保持比订阅数多的发布请求，使到期的订阅都能立即应答
+static void benchPublishDrive(BenchPublishSession *sessions, int sessionCount, int outstanding,
+                              UA_UInt64 durationNs)
+{
+    UA_UInt64 deadline = benchMonotonicNs() + durationNs;
+    while (benchMonotonicNs() < deadline)
+    {
+        for (int s = 0; s < sessionCount; s++)
+        {
+            while (sessions[s].outstanding < outstanding)
+            {
+                UA_PublishRequest request;
+                UA_PublishRequest_init(&request);
+                if (UA_Client_sendAsyncRequest(sessions[s].client, &request, &UA_TYPES[UA_TYPES_PUBLISHREQUEST],
+                                               benchPublishCallback, &UA_TYPES[UA_TYPES_PUBLISHRESPONSE],
+                                               &sessions[s], NULL) != UA_STATUSCODE_GOOD)
+                    break;
+                sessions[s].outstanding++;
+            }
+            UA_Client_run_iterate(sessions[s].client, 0);
+        }
+        struct timespec pause = {0, 1000000};
+        nanosleep(&pause, NULL);
+    }
+}
+
+// 发布调度：数千个只发送保活消息的订阅，比较每个订阅各自的发布回调与按间隔和相位槽合并的发布回调。
+// 统计服务器线程每次发布的CPU时间，以及发布时间相对订阅自身周期的偏差(中位数、P99和最大值)
+static int runPublishSchedulerBenchmark(int subscriptions)
+{
+    static const char *modeNames[] = {"逐订阅回调", "合并发布"};
+    const int sessionCount = 10;
+    const double intervalMs = 200.0;
+    const UA_UInt64 measureNs = 2000000000ULL;
+    int result = EXIT_SUCCESS;
+
+    if (subscriptions < sessionCount)
+    {
+        logMessage(LOG_LEVEL_ERROR, "订阅数量至少为%d", sessionCount);
+        return EXIT_FAILURE;
+    }
+    int perSession = subscriptions / sessionCount;
+    subscriptions = perSession * sessionCount;
+
+    printf("发布调度基准: %d个会话共%d个订阅, 发布间隔 %.0fms, 每个周期发送保活消息, 合并粒度 %.0fms\n",
+           sessionCount, subscriptions, intervalMs, PUBLISH_GRANULARITY_DEFAULT_MS);
+    printf("  %-12s %10s %14s %14s %10s %10s %10s\n", "模式", "发布次数", "服务器CPU(ms)", "每次发布(us)",
+           "偏差中位ms", "偏差P99ms", "最大ms");
+
+    BenchPublishSession *sessions = (BenchPublishSession *)UA_calloc(sessionCount, sizeof(BenchPublishSession));
+    g_benchPublishCreated = (UA_DateTime *)UA_calloc((size_t)subscriptions + 1, sizeof(UA_DateTime));
+    g_benchPublishCounts = (UA_UInt32 *)UA_calloc((size_t)subscriptions + 1, sizeof(UA_UInt32));
+    g_benchPublishDeviationsCapacity = (size_t)subscriptions * (size_t)(measureNs / 1000000 / intervalMs + 2);
+    g_benchPublishDeviations = (double *)UA_malloc(g_benchPublishDeviationsCapacity * sizeof(double));
+    g_benchPublishSubscriptions = (UA_UInt32)subscriptions;
+    g_benchPublishInterval = (UA_DateTime)(intervalMs * UA_DATETIME_MSEC);
+
+    for (int m = 0; m < 2 && result == EXIT_SUCCESS; m++)
+    {
+        UA_ServerConfig config;
+        memset(&config, 0, sizeof(UA_ServerConfig));
+        config.logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+        UA_ServerConfig_setMinimal(&config, BENCHMARK_PORT, NULL);
+        config.maxSessions = (UA_UInt32)sessionCount + 1;
+        config.maxSecureChannels = (UA_UInt16)(sessionCount + 1);
+        config.publishingGranularity = (m == 1) ? PUBLISH_GRANULARITY_DEFAULT_MS : 0.0;
+        UA_Server *server = UA_Server_newWithConfig(&config);
+
+        g_benchServerRunning = true;
+        pthread_create(&g_benchServerThreadId, NULL, benchServerThread, server);
+
+        memset(g_benchPublishCounts, 0, ((size_t)subscriptions + 1) * sizeof(UA_UInt32));
+        UA_Boolean ready = true;
+        for (int s = 0; s < sessionCount && ready; s++)
+        {
+            UA_Client *client = benchConnectClient();
+            if (!client)
+            {
+                ready = false;
+                break;
+            }
+            sessions[s].client = client;
+            sessions[s].outstanding = 0;
+            // 断开连接时未完成的发布请求会得到BadNoSubscription警告
+            UA_Client_getConfig(client)->logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_ERROR);
+
+            for (int i = 0; i < perSession && ready; i++)
+            {
+                UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
+                request.requestedPublishingInterval = intervalMs;
+                request.requestedMaxKeepAliveCount = 1;
+                UA_CreateSubscriptionResponse response;
+                __UA_Client_Service(client, &request, &UA_TYPES[UA_TYPES_CREATESUBSCRIPTIONREQUEST], &response,
+                                    &UA_TYPES[UA_TYPES_CREATESUBSCRIPTIONRESPONSE]);
+                UA_UInt32 id = response.subscriptionId;
+                ready = response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && id > 0 &&
+                        id <= (UA_UInt32)subscriptions && response.revisedPublishingInterval == intervalMs;
+                if (ready)
+                    g_benchPublishCreated[id] = response.responseHeader.timestamp;
+                UA_CreateSubscriptionResponse_clear(&response);
+            }
+        }
+
+        if (ready)
+        {
+            // 所有订阅至少经过一个周期后再开始统计
+            benchPublishDrive(sessions, sessionCount, perSession + 10, 1000000000ULL);
+
+            g_benchPublishErrors = 0;
+            g_benchPublishDeviationsSize = 0;
+            g_benchPublishRecording = true;
+            double cpuStart = benchThreadCpuMs(g_benchServerThreadId);
+            benchPublishDrive(sessions, sessionCount, perSession + 10, measureNs);
+            double cpuMs = benchThreadCpuMs(g_benchServerThreadId) - cpuStart;
+            g_benchPublishRecording = false;
+
+            int silent = 0;
+            for (int id = 1; id <= subscriptions; id++)
+                if (g_benchPublishCounts[id] == 0)
+                    silent++;
+
+            size_t publishes = g_benchPublishDeviationsSize;
+            double p50 = 0.0, p99 = 0.0, max = 0.0;
+            if (publishes > 0)
+            {
+                qsort(g_benchPublishDeviations, publishes, sizeof(double), compareDouble);
+                p50 = g_benchPublishDeviations[publishes / 2];
+                p99 = g_benchPublishDeviations[(publishes * 99) / 100];
+                max = g_benchPublishDeviations[publishes - 1];
+            }
+            printf("  %-12s %10zu %14.1f %14.2f %10.2f %10.2f %10.2f\n", modeNames[m], publishes, cpuMs,
+                   publishes ? cpuMs * 1e3 / publishes : 0.0, p50, p99, max);
+            if (publishes == 0 || silent > 0 || g_benchPublishErrors > 0)
+            {
+                printf("  %-12s %d个订阅未发布, %llu个错误应答\n", modeNames[m], silent,
+                       (unsigned long long)g_benchPublishErrors);
+                result = EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            printf("  %-12s 建立会话和订阅失败\n", modeNames[m]);
+            result = EXIT_FAILURE;
+        }
+
+        for (int s = 0; s < sessionCount; s++)
+        {
+            if (!sessions[s].client)
+                continue;
+            UA_Client_disconnect(sessions[s].client);
+            UA_Client_delete(sessions[s].client);
+            sessions[s].client = NULL;
+        }
+
+        g_benchServerRunning = false;
+        pthread_join(g_benchServerThreadId, NULL);
+        UA_Server_delete(server);
+    }
+
+    UA_free(g_benchPublishDeviations);
+    g_benchPublishDeviations = NULL;
+    UA_free(g_benchPublishCounts);
+    g_benchPublishCounts = NULL;
+    UA_free(g_benchPublishCreated);
+    g_benchPublishCreated = NULL;
+    UA_free(sessions);
+    return result;
+}
+
+// size 为0时使用默认规模
+static int runBenchmark(const char *name, int size)
+{
+    if (strcmp(name, "read-alloc") == 0)
+        return runReadAllocBenchmark(size ? size : 60, 200);
+    if (strcmp(name, "value-cell") == 0)
+        return runValueCellBenchmark(size ? size : 4, 200);
+    if (strcmp(name, "tag-registry") == 0)
+        return runTagRegistryBenchmark(size ? size : 100000);
+    if (strcmp(name, "sim-kernels") == 0)
+        return runSimulationKernelBenchmark(size ? size : 100000, 20);
+    if (strcmp(name, "timing-wheel") == 0)
+        return runTimingWheelBenchmark(size ? size : 100000);
+    if (strcmp(name, "lazy-sim") == 0)
+        return runLazySimulationBenchmark(size ? size : 1000000);
+    if (strcmp(name, "observed-set") == 0)
+        return runObservedSetBenchmark(size ? size : 1000000);
+    if (strcmp(name, "rng") == 0)
+        return runRandomBenchmark(size ? size : 1000000);
+    if (strcmp(name, "sim-threads") == 0)
+        return runSimulationThreadsBenchmark(size ? size : 200000);
+    if (strcmp(name, "push") == 0)
+        return runChangePushBenchmark(size ? size : 10000);
+    if (strcmp(name, "change-queue") == 0)
+        return runChangeQueueBenchmark(size ? size : 1000000);
+    if (strcmp(name, "network") == 0)
+        return runNetworkBenchmark(size ? size : 400);
+    if (strcmp(name, "network-syscalls") == 0)
+        return runNetworkSyscallsBenchmark(size ? size : 1000);
+    if (strcmp(name, "buffer-pool") == 0)
+        return runBufferPoolBenchmark(size ? size : 1000);
+    if (strcmp(name, "recv-chunks") == 0)
+        return runRecvChunksBenchmark(size ? size : 1024);
+    if (strcmp(name, "send-batching") == 0)
+        return runSendBatchingBenchmark(size ? size : 10000);
+    if (strcmp(name, "service-workers") == 0)
+        return runServiceWorkersBenchmark(size ? size : 20000);
+    if (strcmp(name, "reactors") == 0)
+        return runReactorsBenchmark(size ? size : 256);
+    if (strcmp(name, "processes") == 0)
+        return runProcessesBenchmark(size ? size : 20000);
+    if (strcmp(name, "shared-sampling") == 0)
+        return runSharedSamplingBenchmark(size ? size : 5000);
+    if (strcmp(name, "notifications") == 0)
+        return runNotificationsBenchmark(size ? size : 2000);
+    if (strcmp(name, "value-change") == 0)
+        return runValueChangeBenchmark(size ? size : 14000);
+    if (strcmp(name, "deadband") == 0)
+        return runDeadbandBenchmark(size ? size : 3000);
+    if (strcmp(name, "fan-out") == 0)
+        return runFanOutBenchmark(size ? size : 100);
+    if (strcmp(name, "publish-scheduler") == 0)
+        return runPublishSchedulerBenchmark(size ? size : 2000);
+
+    printf("未知基准测试: %s\n", name);
+    return EXIT_FAILURE;
+}
+
+// ==================== 主函数 ====================
+static void printUsage(const char *program)
+{
+    printf("用法: %s <名称> [规模]\n", program);
+    printf("基准测试: read-alloc, value-cell, tag-registry, sim-kernels,\n"
+           "          timing-wheel, lazy-sim, observed-set, rng, sim-threads, push,\n"
+           "          change-queue, network, network-syscalls, buffer-pool, recv-chunks,\n"
+           "          send-batching, service-workers, reactors, processes,\n"
+           "          shared-sampling, notifications, value-change, deadband,\n"
+           "          fan-out, publish-scheduler\n");
+    printf("规模省略或为0时使用各基准测试的默认规模\n");
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || strcmp(argv[1], "--help") == 0)
+    {
+        printUsage(argv[0]);
+        return argc < 2 ? EXIT_FAILURE : 0;
+    }
+
+    // 设置信号处理
+    signal(SIGINT, stopHandler);
+    signal(SIGTERM, stopHandler);
+
+    initializeServerContext();
+    g_serverContext.logLevel = LOG_LEVEL_WARNING;
+
+    int size = (argc > 2) ? atoi(argv[2]) : 0;
+    return runBenchmark(argv[1], size > 0 ? size : 0);
+}
@@ -1722,10 +1722,20 @@ typedef struct UA_Chunk {
     UA_UInt32 requestId;
     UA_Boolean copied; /* Do the bytes point to a buffer from the network or was
                         * memory allocated for the chunk separately */
+    UA_Boolean inRecvBuffer; /* The bytes point into the receive buffer of the
+                              * SecureChannel */
 } UA_Chunk;
 
 typedef SIMPLEQ_HEAD(UA_ChunkQueue, UA_Chunk) UA_ChunkQueue;
 
+/* Memory block of the receive buffer. Replaced blocks are kept in a list until
+ * no chunk can point into them anymore. */
+typedef struct UA_RecvBlock {
+    struct UA_RecvBlock *next;
+    size_t size;
+    UA_Byte data[];
+} UA_RecvBlock;
+
 typedef enum {
     UA_SECURECHANNELRENEWSTATE_NORMAL,
 
@@ -1791,12 +1801,29 @@ struct UA_SecureChannel {
      * problems in the client in the past.) */
     UA_ChunkQueue completeChunks; /* Received full chunks that have not been
                                    * decrypted so far */
-    UA_ChunkQueue decryptedChunks; /* Received chunks that were decrypted but
-                                    * not processed */
+    UA_ChunkQueue freeChunks;     /* Recycled chunk structures */
+    size_t freeChunksCount;
+    /* The payload of decrypted intermediate chunks is appended to the message
+     * until the final chunk arrives */
+    UA_ByteString decryptedMessage;
+    size_t decryptedMessageCapacity;
+    UA_UInt32 decryptedRequestId;
+    UA_MessageType decryptedMessageType;
     size_t decryptedChunksCount;
     size_t decryptedChunksLength;
-    UA_ByteString incompleteChunk; /* A half-received chunk (TCP is a
-                                    * streaming protocol) is stored here */
+
+    /* A half-received chunk (TCP is a streaming protocol) is stored in the
+     * receive buffer. The following bytes are appended and the chunks are
+     * decoded in place. Chunks keep pointing into the buffer until they are
+     * processed. The bytes are only moved if the end of the buffer is
+     * reached. */
+    UA_RecvBlock *recvBlock;
+    size_t recvParsed;   /* Start of the incomplete chunk */
+    size_t recvEnd;      /* End of the received bytes */
+    size_t recvChunks;   /* Chunks pointing into the receive buffer */
+    size_t recvDepth;    /* Chunks are being processed. The buffer must not move
+                          * in a nested call of UA_SecureChannel_processBuffer */
+    UA_RecvBlock *recvRetired;
 
     UA_CertificateVerification *certificateVerification;
     UA_StatusCode (*processOPNHeader)(void *application, UA_SecureChannel *channel,
@@ -1878,6 +1905,11 @@ UA_StatusCode
 UA_MessageContext_encode(UA_MessageContext *mc, const void *content,
                          const UA_DataType *contentType);
 
+/* Copies already encoded content and sends out full chunks. Cleans up the
+ * context in case of errors like UA_MessageContext_encode. */
+UA_StatusCode
+UA_MessageContext_encodeBytes(UA_MessageContext *mc, const UA_ByteString *bytes);
+
 /* Sends a symmetric message already encoded in the context. The context is
  * cleaned up, also in case of errors. */
 UA_StatusCode
@@ -2371,10 +2403,35 @@ _UA_BEGIN_DECLS
  * notification was not added to the global queue */
 #define UA_SUBSCRIPTION_QUEUE_SENTINEL ((UA_Notification*)0x01)
 
+struct UA_NotificationPool;
+
+/* Storage for a fixed-size scalar value (up to the size of a Guid) */
+typedef struct {
+    UA_UInt64 data[2];
+} UA_NotificationInlineValue;
+
+/* A DataValue sample that was handed to several MonitoredItems, together with
+ * its binary encoding. The notifications created from the sample share it, so
+ * the value is copied and encoded once and the bytes are copied into every
+ * PublishResponse. Reference counted. Only used with the server lock held. */
+typedef struct UA_EncodedDataValue {
+    size_t refCount;
+    UA_DataValue value;
+    UA_ByteString encoding; /* Points behind the struct */
+} UA_EncodedDataValue;
+
+/* Returns NULL if the value cannot be encoded */
+UA_EncodedDataValue *
+UA_EncodedDataValue_new(const UA_DataValue *value);
+
+void
+UA_EncodedDataValue_release(UA_EncodedDataValue *ev);
+
 typedef struct UA_Notification {
     TAILQ_ENTRY(UA_Notification) localEntry;  /* Notification list for the MonitoredItem */
     TAILQ_ENTRY(UA_Notification) globalEntry; /* Notification list for the Subscription */
     UA_MonitoredItem *mon; /* Always set */
+    struct UA_NotificationPool *pool; /* NULL if allocated on the heap */
 
     /* The event field is used if mon->attributeId is the EventNotifier */
     union {
@@ -2384,14 +2441,46 @@ typedef struct UA_Notification {
 #endif
     } data;
 
+    /* Fixed-size scalar values are copied here instead of to the heap. The
+     * variant in data.dataChange then points here with
+     * UA_VARIANT_DATA_NODELETE. */
+    UA_NotificationInlineValue inlineValue;
+
+    /* Shared sample and encoding (can be NULL). Then data.dataChange.value is
+     * empty. The value is copied from the shared sample before it is
+     * changed. */
+    UA_EncodedDataValue *encoded;
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
     UA_Boolean isOverflowEvent; /* Counted manually */
     UA_EventFilterResult result;
 #endif
 } UA_Notification;
 
-/* Initializes and sets the sentinel pointers */
-UA_Notification * UA_Notification_new(void);
+/* Notifications are taken from slabs owned by the Subscription. Deleted
+ * notifications are put on a free list and reused. So the sampling does not
+ * allocate once the slabs cover the queue sizes of the MonitoredItems. */
+#define UA_NOTIFICATIONSLAB_SIZE 64
+
+typedef struct UA_NotificationSlab {
+    struct UA_NotificationSlab *next;
+    UA_Notification notifications[UA_NOTIFICATIONSLAB_SIZE];
+} UA_NotificationSlab;
+
+typedef struct UA_NotificationPool {
+    UA_NotificationSlab *slabs;
+    UA_Notification *freeList; /* Linked via the localEntry */
+    size_t used;
+} UA_NotificationPool;
+
+UA_NotificationPool * UA_NotificationPool_new(void);
+
+/* All notifications must have been returned to the pool */
+void UA_NotificationPool_delete(UA_NotificationPool *pool);
+
+/* Initializes and sets the sentinel pointers. Taken from the pool of the
+ * Subscription if it is set. */
+UA_Notification * UA_Notification_new(UA_Subscription *sub);
 
 /* Notifications are always added to the queue of the MonitoredItem. That queue
  * can overflow. If Notifications are reported, they are also added to the
@@ -2405,7 +2494,7 @@ UA_Notification * UA_Notification_new(void);
 void UA_Notification_enqueueAndTrigger(UA_Server *server,
                                        UA_Notification *n);
 
-/* Dequeue and delete the notification */
+/* Dequeue and delete the notification (or return it to its pool) */
 void UA_Notification_delete(UA_Notification *n);
 
 /* A NotificationMessage contains an array of notifications.
@@ -2435,9 +2524,23 @@ typedef enum {
     UA_MONITOREDITEMSAMPLINGTYPE_EVENT,  /* Attached to the node. Can be a "write
                                           * event" for DataChange MonitoredItems
                                           * with a zero sampling interval .*/
-    UA_MONITOREDITEMSAMPLINGTYPE_PUBLISH /* Attached to the subscription */
+    UA_MONITOREDITEMSAMPLINGTYPE_PUBLISH, /* Attached to the subscription */
+    UA_MONITOREDITEMSAMPLINGTYPE_SHARED  /* Attached to a shared cyclic sampler */
 } UA_MonitoredItemSamplingType;
 
+struct UA_MonitoredItemSampler;
+
+/* Compares two variants of the same type. Returns true if the values
+ * differ. */
+typedef UA_Boolean
+(*UA_MonitoredItemValueChanged)(const UA_Variant *v1, const UA_Variant *v2);
+
+/* Tests if two scalars of the same numerical type differ by more than the
+ * deadband */
+typedef UA_Boolean
+(*UA_MonitoredItemOutsideDeadband)(const void *data1, const void *data2,
+                                   const UA_Double deadband);
+
 struct UA_MonitoredItem {
     UA_TimerEntry delayedFreePointers;
     LIST_ENTRY(UA_MonitoredItem) listEntry; /* Linked list in the Subscription */
@@ -2467,6 +2570,9 @@ struct UA_MonitoredItem {
      * So we can convert from a percentage to an absolute deadband and keep
      * the hot code path simple.
      *
+     * The resulting absolute deadband is cached with the test for the value
+     * type (see below).
+     *
      * TODO: Store the percentage deadband to recompute when the UARange is
      * changed at runtime of the MonitoredItem */
     UA_MonitoringParameters parameters;
@@ -2478,9 +2584,26 @@ struct UA_MonitoredItem {
         UA_MonitoredItem *nodeListNext; /* Event-Based: Attached to Node */
         LIST_ENTRY(UA_MonitoredItem) samplingListEntry; /* Publish-interval: Linked in
                                                          * Subscription */
+        struct {
+            struct UA_MonitoredItemSampler *sampler;
+            LIST_ENTRY(UA_MonitoredItem) listEntry;
+        } shared; /* Shared cyclic sampling */
     } sampling;
     UA_DataValue lastValue;
 
+    /* Comparator for the type of the value read when the MonitoredItem was
+     * created. Used if both the sample and lastValue have that type. Otherwise
+     * (or if NULL) the generic UA_order is used. */
+    const UA_DataType *valueChangedType;
+    UA_MonitoredItemValueChanged valueChanged;
+
+    /* Absolute deadband of the DataChangeFilter (after the conversion of a
+     * percentage deadband) and the test for the valueChangedType. Resolved
+     * when the parameters are set. NULL if there is no deadband or the type
+     * is not numeric. */
+    UA_Double deadband;
+    UA_MonitoredItemOutsideDeadband outsideDeadband;
+
     /* Triggering Links */
     size_t triggeringLinksSize;
     UA_UInt32 *triggeringLinks;
@@ -2493,6 +2616,33 @@ struct UA_MonitoredItem {
                             * the queue size */
 };
 
+/* DataChange MonitoredItems on the value attribute with the same NodeId,
+ * IndexRange, DataEncoding, sampling interval and TimestampsToReturn share one
+ * cyclic callback (if enabled in the server config). The value is read once
+ * per interval with the admin session. The access checks of the Read service
+ * are then applied for the session of every attached MonitoredItem, which gets
+ * either the sample or the status of the denied read. The samplers are kept in
+ * a hash table in the server. */
+typedef struct UA_MonitoredItemSampler {
+    struct UA_MonitoredItemSampler *next; /* Next in the hash bucket */
+    UA_UInt32 hash;
+    UA_ReadValueId itemToMonitor;
+    UA_Double samplingInterval;
+    UA_TimestampsToReturn timestampsToReturn;
+    UA_UInt64 callbackId;
+    LIST_HEAD(, UA_MonitoredItem) monitoredItems;
+    size_t monitoredItemsSize;
+    UA_Boolean sampling; /* Handing out a sample. Not deleted when the last
+                          * MonitoredItem is removed in the meantime. */
+} UA_MonitoredItemSampler;
+
+/* Remove the callback and free the sampler (without MonitoredItems) */
+void
+UA_MonitoredItemSampler_delete(UA_Server *server, UA_MonitoredItemSampler *sampler);
+
+void
+UA_MonitoredItemSampler_sampleCallback(UA_Server *server, UA_MonitoredItemSampler *sampler);
+
 void UA_MonitoredItem_init(UA_MonitoredItem *mon);
 
 void
@@ -2521,9 +2671,14 @@ void
 UA_MonitoredItem_sampleCallback(UA_Server *server,
                                 UA_MonitoredItem *monitoredItem);
 
+/* If encoded is not NULL, the sample is shared with other MonitoredItems. The
+ * notification then uses the shared encoding in *encoded. The encoding is
+ * created for the first notification and has to be released by the caller
+ * after the sample was handed out. */
 UA_StatusCode
 sampleCallbackWithValue(UA_Server *server, UA_Subscription *sub,
-                        UA_MonitoredItem *mon, UA_DataValue *value);
+                        UA_MonitoredItem *mon, UA_DataValue *value,
+                        UA_EncodedDataValue **encoded);
 
 UA_StatusCode
 UA_MonitoredItem_removeLink(UA_Subscription *sub, UA_MonitoredItem *mon,
@@ -2537,7 +2692,16 @@ UA_StatusCode
 UA_MonitoredItem_createDataChangeNotification(UA_Server *server,
                                               UA_Subscription *sub,
                                               UA_MonitoredItem *mon,
-                                              const UA_DataValue *value);
+                                              const UA_DataValue *value,
+                                              UA_EncodedDataValue **encoded);
+
+/* Returns NULL if there is no specialized comparator for the type */
+UA_MonitoredItemValueChanged
+UA_MonitoredItem_resolveValueChanged(const UA_DataType *type);
+
+/* Cache the deadband from the current parameters */
+void
+UA_MonitoredItem_resolveDeadband(UA_MonitoredItem *mon);
 
 UA_StatusCode
 UA_Event_addEventToMonitoredItem(UA_Server *server, const UA_NodeId *event,
@@ -2605,8 +2769,12 @@ struct UA_Subscription {
     UA_UInt32 currentKeepAliveCount;
     UA_UInt32 currentLifetimeCount;
 
-    /* Publish Callback. Registered if id > 0. */
+    /* Publish Callback. Registered if id > 0. Or the Subscription is published
+     * with the other Subscriptions of a publish bucket. */
     UA_UInt64 publishCallbackId;
+    struct UA_PublishBucket *publishBucket;
+    LIST_ENTRY(UA_Subscription) publishBucketEntry;
+    UA_DateTime publishStart; /* Earlier passes of the bucket are skipped */
 
     /* MonitoredItems */
     UA_UInt32 lastMonitoredItemId; /* increase the identifiers */
@@ -2618,6 +2786,7 @@ struct UA_Subscription {
     LIST_HEAD(, UA_MonitoredItem) samplingMonitoredItems;
 
     /* Global list of notifications from the MonitoredItems */
+    UA_NotificationPool *notificationPool;
     TAILQ_HEAD(, UA_Notification) notificationQueue;
     UA_UInt32 notificationQueueSize; /* Total queue size */
     UA_UInt32 dataChangeNotifications;
@@ -2649,6 +2818,22 @@ struct UA_Subscription {
 #endif
 };
 
+/* Subscriptions with the same publishing interval whose cycles begin in the
+ * same phase slot share one repeated callback (if enabled in the server
+ * config). The slot width is the configured granularity, shortened so that a
+ * whole number of slots fits into the interval. The buckets are kept in a
+ * linked list in the server. */
+typedef struct UA_PublishBucket {
+    LIST_ENTRY(UA_PublishBucket) listEntry;
+    UA_DateTime interval; /* In 100ns ticks, as in the timer */
+    UA_DateTime phase;    /* Start of the slot within the interval */
+    UA_UInt64 callbackId;
+    LIST_HEAD(, UA_Subscription) subscriptions;
+    size_t subscriptionsSize;
+    UA_Boolean publishing; /* Not deleted when the last Subscription is
+                            * removed during a pass */
+} UA_PublishBucket;
+
 UA_Subscription * UA_Subscription_new(void);
 
 void
@@ -3800,11 +3985,72 @@ typedef enum {
     UA_DIAGNOSTICEVENT_PURGE
 } UA_DiagnosticEvent;
 
-typedef struct channel_entry {
+typedef struct channel_entry channel_entry;
+
+#ifdef UA_ARCHITECTURE_POSIX
+
+#include <pthread.h>
+
+/* A request for a read-only service that is executed and encoded by a service
+ * worker thread. The server thread sends the encoded response once all
+ * earlier requests of the SecureChannel have been answered. A serial job is a
+ * request of another service that arrived behind dispatched requests. The
+ * server thread processes it once it is first in the queue. Later jobs of the
+ * channel are not picked up by a worker before. */
+typedef enum {
+    UA_SERVICEJOB_QUEUED,
+    UA_SERVICEJOB_RUNNING,
+    UA_SERVICEJOB_DONE,
+    UA_SERVICEJOB_SERIAL
+} UA_ServiceJobState;
+
+typedef struct UA_ServiceJob {
+    TAILQ_ENTRY(UA_ServiceJob) pointers;
+    UA_ServiceJobState state;
+    UA_Session *session; /* NULL if the session was removed meanwhile */
+    void (*service)(UA_Server*, UA_Session*, const void*, void*); /* UA_Service */
+    const UA_DataType *requestType;
+    const UA_DataType *responseType;
+    UA_UInt32 requestId;
+    UA_UInt32 requestHandle;
+    UA_StatusCode serviceResult;
+    UA_ByteString encoded; /* Response type NodeId and the response. The
+                            * request message for a serial job. */
+    UA_Request request;
+} UA_ServiceJob;
+
+typedef struct {
+    /* Held shared by the workers while a service executes and exclusively by
+     * the server thread while it modifies the server state */
+    pthread_rwlock_t serviceLock;
+    UA_UInt32 lockDepth; /* Only accessed from the server thread */
+
+    pthread_mutex_t mutex;
+    pthread_cond_t workAvailable;
+    TAILQ_HEAD(, channel_entry) ready; /* Channels with a job to be picked up */
+    size_t workers;
+    size_t queued; /* Jobs waiting for a worker */
+    UA_Boolean stopping;
+    UA_Boolean responsesPending; /* Notified, not yet sent */
+    UA_ServiceWorkerStatistics stats;
+} UA_ServiceDispatcher;
+
+#endif
+
+struct channel_entry {
     UA_TimerEntry cleanupCallback;
     TAILQ_ENTRY(channel_entry) pointers;
+#ifdef UA_ARCHITECTURE_POSIX
+    /* Dispatched jobs in request order. At most one job of a channel runs at
+     * a time, so the per-session state needs no further locking. */
+    TAILQ_HEAD(UA_ServiceJobQueue, UA_ServiceJob) serviceJobs;
+    TAILQ_ENTRY(channel_entry) readyPointers;
+    UA_Boolean serviceScheduled; /* In the ready list or a job is running */
+    UA_Boolean serviceClosed;    /* Jobs are no longer scheduled */
+    UA_Boolean serviceSerial;    /* The server thread processes a serial job */
+#endif
     UA_SecureChannel channel;
-} channel_entry;
+};
 
 typedef struct session_list_entry {
     UA_TimerEntry cleanupCallback;
@@ -3872,6 +4118,17 @@ struct UA_Server {
     LIST_HEAD(, UA_MonitoredItem) localMonitoredItems;
     UA_UInt32 lastLocalMonitoredItemId;
 
+    /* Shared samplers. Hash table with chaining, the size is a power of two. */
+    UA_MonitoredItemSampler **samplers;
+    size_t samplersSize;
+    size_t samplersCount;
+
+    /* Coalesced publish callbacks. The connections that hold back their
+     * PublishResponses during a pass are collected in a reused array. */
+    LIST_HEAD(, UA_PublishBucket) publishBuckets;
+    UA_Connection **heldConnections;
+    size_t heldConnectionsSize;
+
 # ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
     LIST_HEAD(, UA_ConditionSource) conditionSources;
 # endif
@@ -3888,6 +4145,10 @@ struct UA_Server {
     UA_Lock serviceMutex;
 #endif
 
+#ifdef UA_ARCHITECTURE_POSIX
+    UA_ServiceDispatcher serviceDispatcher;
+#endif
+
     /* Statistics */
     UA_NetworkStatistics networkStatistics;
     UA_SecureChannelStatistics secureChannelStatistics;
@@ -3932,6 +4193,38 @@ void
 UA_Server_closeSecureChannel(UA_Server *server, UA_SecureChannel *channel,
                              UA_DiagnosticEvent event);
 
+/**************************/
+/* Service Worker Threads */
+/**************************/
+
+#ifdef UA_ARCHITECTURE_POSIX
+
+void UA_ServiceDispatcher_init(UA_ServiceDispatcher *d);
+void UA_ServiceDispatcher_clear(UA_ServiceDispatcher *d);
+
+/* Exclusive access of the server thread to the server state. Can be nested. */
+void UA_Server_lockServices(UA_Server *server);
+void UA_Server_unlockServices(UA_Server *server);
+
+/* Sends the responses that the workers have finished and processes the serial
+ * jobs behind them, in request order */
+void UA_Server_sendServiceResponses(UA_Server *server);
+
+/* Drops the jobs that are not running. A running job of a closed channel is
+ * dropped when the channel is freed (the server thread then holds the lock). */
+void UA_Server_cancelChannelServiceJobs(UA_Server *server, channel_entry *entry);
+void UA_Server_cancelSessionServiceJobs(UA_Server *server, UA_Session *session);
+
+#else
+
+#define UA_Server_lockServices(server)
+#define UA_Server_unlockServices(server)
+#define UA_Server_sendServiceResponses(server)
+#define UA_Server_cancelChannelServiceJobs(server, entry)
+#define UA_Server_cancelSessionServiceJobs(server, session)
+
+#endif
+
 /* Gets the a pointer to the context of a security policy supported by the
  * server matched by the security policy uri. */
 UA_SecurityPolicy *
@@ -5265,16 +5558,54 @@ UA_findDataType(const UA_NodeId *typeId) {
 /* Random Number Generator */
 /***************************/
 
-//TODO is this safe for multithreading?
-static pcg32_random_t UA_rng = PCG32_INITIALIZER;
+/* Service workers and reactor threads create sessions, SecureChannels and
+ * continuation points concurrently, also without UA_MULTITHREADING. So the
+ * state is kept per thread. Every seeding takes a new stream, so no two
+ * threads of a process generate the same sequence. A thread that was not
+ * seeded seeds itself from the last seed on first use. */
+#if defined(__GNUC__)
+# define UA_RNG_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+# define UA_RNG_THREAD_LOCAL __declspec(thread)
+#else
+# define UA_RNG_THREAD_LOCAL UA_THREAD_LOCAL
+#endif
+
+static UA_RNG_THREAD_LOCAL pcg32_random_t UA_rng = PCG32_INITIALIZER;
+static UA_RNG_THREAD_LOCAL UA_Boolean UA_rngSeeded;
+static u64 UA_rngSeed;
+static u64 UA_rngStreams;
+
+static void
+seedThread(u64 seed) {
+#if defined(__GNUC__)
+    u64 stream = __atomic_add_fetch(&UA_rngStreams, 1, __ATOMIC_RELAXED);
+#else
+    u64 stream = ++UA_rngStreams;
+#endif
+    pcg32_srandom_r(&UA_rng, seed ^ (u64)UA_DateTime_now(), stream);
+    UA_rngSeeded = true;
+}
 
 void
 UA_random_seed(u64 seed) {
-    pcg32_srandom_r(&UA_rng, seed, (u64)UA_DateTime_now());
+#if defined(__GNUC__)
+    __atomic_store_n(&UA_rngSeed, seed, __ATOMIC_RELAXED);
+#else
+    UA_rngSeed = seed;
+#endif
+    seedThread(seed);
 }
 
 u32
 UA_UInt32_random(void) {
+    if(UA_UNLIKELY(!UA_rngSeeded)) {
+#if defined(__GNUC__)
+        seedThread(__atomic_load_n(&UA_rngSeed, __ATOMIC_RELAXED));
+#else
+        seedThread(UA_rngSeed);
+#endif
+    }
     return (u32)pcg32_random_r(&UA_rng);
 }
 
@@ -5432,7 +5763,7 @@ UA_Guid_equal(const UA_Guid *g1, const UA_Guid *g2) {
 UA_Guid
 UA_Guid_random(void) {
     UA_Guid result;
-    result.data1 = (u32)pcg32_random_r(&UA_rng);
+    result.data1 = UA_UInt32_random(); /* Seeds the state of the thread */
     u32 r = (u32)pcg32_random_r(&UA_rng);
     result.data2 = (u16) r;
     result.data3 = (u16) (r >> 16);
@@ -19927,7 +20258,7 @@ void UA_SecureChannel_init(UA_SecureChannel *channel,
     memset(channel, 0, sizeof(UA_SecureChannel));
     channel->state = UA_SECURECHANNELSTATE_FRESH;
     SIMPLEQ_INIT(&channel->completeChunks);
-    SIMPLEQ_INIT(&channel->decryptedChunks);
+    SIMPLEQ_INIT(&channel->freeChunks);
     SLIST_INIT(&channel->sessions);
     channel->config = *config;
 }
@@ -19964,27 +20295,73 @@ UA_SecureChannel_setSecurityPolicy(UA_SecureChannel *channel,
     return UA_STATUSCODE_GOOD;
 }
 
+#define UA_SECURECHANNEL_MAXFREECHUNKS 16
+
+static UA_Chunk *
+UA_Chunk_new(UA_SecureChannel *channel) {
+    UA_Chunk *chunk = SIMPLEQ_FIRST(&channel->freeChunks);
+    if(!chunk)
+        return (UA_Chunk*)UA_malloc(sizeof(UA_Chunk));
+    SIMPLEQ_REMOVE_HEAD(&channel->freeChunks, pointers);
+    channel->freeChunksCount--;
+    return chunk;
+}
+
 static void
-UA_Chunk_delete(UA_Chunk *chunk) {
+UA_Chunk_delete(UA_SecureChannel *channel, UA_Chunk *chunk) {
     if(chunk->copied)
         UA_ByteString_clear(&chunk->bytes);
-    UA_free(chunk);
+    if(chunk->inRecvBuffer)
+        channel->recvChunks--;
+    /* The free list of a closed channel was already released. Chunks that
+     * were being processed when the channel closed are not recycled. */
+    if(channel->state == UA_SECURECHANNELSTATE_CLOSED ||
+       channel->freeChunksCount >= UA_SECURECHANNEL_MAXFREECHUNKS) {
+        UA_free(chunk);
+        return;
+    }
+    SIMPLEQ_INSERT_HEAD(&channel->freeChunks, chunk, pointers);
+    channel->freeChunksCount++;
 }
 
 static void
-deleteChunks(UA_ChunkQueue *queue) {
+deleteChunks(UA_SecureChannel *channel, UA_ChunkQueue *queue) {
     UA_Chunk *chunk;
     while((chunk = SIMPLEQ_FIRST(queue))) {
         SIMPLEQ_REMOVE_HEAD(queue, pointers);
-        UA_Chunk_delete(chunk);
+        UA_Chunk_delete(channel, chunk);
+    }
+}
+
+/* The block may still be in use by a chunk that is being processed. Free it
+ * once the outermost UA_SecureChannel_processBuffer returns. */
+static void
+releaseRecvBlock(UA_SecureChannel *channel, UA_RecvBlock *block) {
+    if(!block)
+        return;
+    if(channel->recvDepth == 0) {
+        UA_free(block);
+        return;
     }
+    block->next = channel->recvRetired;
+    channel->recvRetired = block;
 }
 
 void
 UA_SecureChannel_deleteBuffered(UA_SecureChannel *channel) {
-    deleteChunks(&channel->completeChunks);
-    deleteChunks(&channel->decryptedChunks);
-    UA_ByteString_clear(&channel->incompleteChunk);
+    deleteChunks(channel, &channel->completeChunks);
+    UA_Chunk *chunk;
+    while((chunk = SIMPLEQ_FIRST(&channel->freeChunks))) {
+        SIMPLEQ_REMOVE_HEAD(&channel->freeChunks, pointers);
+        UA_free(chunk);
+    }
+    channel->freeChunksCount = 0;
+    UA_ByteString_clear(&channel->decryptedMessage);
+    channel->decryptedMessageCapacity = 0;
+    releaseRecvBlock(channel, channel->recvBlock);
+    channel->recvBlock = NULL;
+    channel->recvParsed = 0;
+    channel->recvEnd = 0;
 }
 
 void
@@ -20315,6 +20692,31 @@ UA_MessageContext_encode(UA_MessageContext *mc, const void *content,
     return res;
 }
 
+UA_StatusCode
+UA_MessageContext_encodeBytes(UA_MessageContext *mc, const UA_ByteString *bytes) {
+    const UA_Byte *src = bytes->data;
+    size_t left = bytes->length;
+    while(left > 0) {
+        size_t space = (size_t)(mc->buf_end - mc->buf_pos);
+        if(space == 0) {
+            UA_StatusCode res =
+                sendSymmetricEncodingCallback(mc, &mc->buf_pos, &mc->buf_end);
+            if(res != UA_STATUSCODE_GOOD) {
+                if(mc->messageBuffer.length > 0)
+                    UA_MessageContext_abort(mc);
+                return res;
+            }
+            continue;
+        }
+        size_t n = (left < space) ? left : space;
+        memcpy(mc->buf_pos, src, n);
+        mc->buf_pos += n;
+        src += n;
+        left -= n;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_MessageContext_finish(UA_MessageContext *mc) {
     mc->final = true;
@@ -20510,63 +20912,65 @@ unpackPayloadMSG(UA_SecureChannel *channel, UA_Chunk *chunk) {
     return UA_STATUSCODE_GOOD;
 }
 
+/* Append the payload of a decrypted chunk to the message */
 static UA_StatusCode
-assembleProcessMessage(UA_SecureChannel *channel, void *application,
-                       UA_ProcessMessageCallback callback) {
-    UA_Chunk *chunk = SIMPLEQ_FIRST(&channel->decryptedChunks);
-    UA_assert(chunk != NULL);
+appendDecryptedChunk(UA_SecureChannel *channel, const UA_Chunk *chunk) {
+    /* Consistency check */
+    if(channel->decryptedChunksCount == 1) {
+        channel->decryptedRequestId = chunk->requestId;
+        channel->decryptedMessageType = chunk->messageType;
+    } else {
+        if(chunk->requestId != channel->decryptedRequestId)
+            return UA_STATUSCODE_BADINTERNALERROR;
+        if(chunk->messageType != channel->decryptedMessageType)
+            return UA_STATUSCODE_BADTCPMESSAGETYPEINVALID;
+    }
 
-    UA_StatusCode res = UA_STATUSCODE_GOOD;
-    if(chunk->chunkType == UA_CHUNKTYPE_FINAL) {
-        SIMPLEQ_REMOVE_HEAD(&channel->decryptedChunks, pointers);
-        UA_assert(chunk->chunkType == UA_CHUNKTYPE_FINAL);
+    /* Grow the message buffer geometrically */
+    UA_ByteString *msg = &channel->decryptedMessage;
+    if(msg->length + chunk->bytes.length > channel->decryptedMessageCapacity) {
+        size_t capacity = 2 * channel->decryptedMessageCapacity;
+        if(capacity < channel->config.recvBufferSize)
+            capacity = channel->config.recvBufferSize;
+        if(capacity < msg->length + chunk->bytes.length)
+            capacity = msg->length + chunk->bytes.length;
+        UA_Byte *data = (UA_Byte*)UA_realloc(msg->data, capacity);
+        UA_CHECK_MEM(data, return UA_STATUSCODE_BADOUTOFMEMORY);
+        msg->data = data;
+        channel->decryptedMessageCapacity = capacity;
+    }
+    memcpy(&msg->data[msg->length], chunk->bytes.data, chunk->bytes.length);
+    msg->length += chunk->bytes.length;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Process the message of a final chunk. A single chunk is processed in place.
+ * Otherwise the payload completes the assembled message. */
+static UA_StatusCode
+processFinalChunk(UA_SecureChannel *channel, void *application,
+                  UA_ProcessMessageCallback callback, UA_Chunk *chunk,
+                  UA_Boolean assembled) {
+    UA_StatusCode res;
+    if(!assembled) {
         res = callback(application, channel, chunk->messageType,
                        chunk->requestId, &chunk->bytes);
-        UA_Chunk_delete(chunk);
+        UA_Chunk_delete(channel, chunk);
         return res;
     }
 
-    UA_UInt32 requestId = chunk->requestId;
-    UA_MessageType messageType = chunk->messageType;
-    UA_ChunkType chunkType = chunk->chunkType;
-    UA_assert(chunkType == UA_CHUNKTYPE_INTERMEDIATE);
-
-    size_t messageSize = 0;
-    SIMPLEQ_FOREACH(chunk, &channel->decryptedChunks, pointers) {
-        /* Consistency check */
-        if(requestId != chunk->requestId)
-            return UA_STATUSCODE_BADINTERNALERROR;
-        if(chunkType != chunk->chunkType && chunk->chunkType != UA_CHUNKTYPE_FINAL)
-            return UA_STATUSCODE_BADTCPMESSAGETYPEINVALID;
-        if(chunk->messageType != messageType)
-            return UA_STATUSCODE_BADTCPMESSAGETYPEINVALID;
+    res = appendDecryptedChunk(channel, chunk);
+    UA_Chunk_delete(channel, chunk);
+    UA_CHECK_STATUS(res, return res);
 
-        /* Sum up the lengths */
-        messageSize += chunk->bytes.length;
-        if(chunk->chunkType == UA_CHUNKTYPE_FINAL)
-            break;
-    }
+    /* Detach the message. Processing can receive the next message for the
+     * channel. */
+    UA_ByteString payload = channel->decryptedMessage;
+    channel->decryptedMessage = UA_BYTESTRING_NULL;
+    channel->decryptedMessageCapacity = 0;
 
-    /* Allocate memory for the full message */
-    UA_ByteString payload;
-    res = UA_ByteString_allocBuffer(&payload, messageSize);
-    UA_CHECK_STATUS(res, return res);
-    
-    /* Assemble the full message */
-    size_t offset = 0;
-    while(true) {
-        chunk = SIMPLEQ_FIRST(&channel->decryptedChunks);
-        memcpy(&payload.data[offset], chunk->bytes.data, chunk->bytes.length);
-        offset += chunk->bytes.length;
-        SIMPLEQ_REMOVE_HEAD(&channel->decryptedChunks, pointers);
-        UA_ChunkType ct = chunk->chunkType;
-        UA_Chunk_delete(chunk);
-        if(ct == UA_CHUNKTYPE_FINAL)
-            break;
-    }
-    
     /* Process the assembled message */
-    res = callback(application, channel, messageType, requestId, &payload);
+    res = callback(application, channel, channel->decryptedMessageType,
+                   channel->decryptedRequestId, &payload);
     UA_ByteString_clear(&payload);
     return res;
 }
@@ -20575,7 +20979,7 @@ static UA_StatusCode
 persistCompleteChunks(UA_ChunkQueue *queue) {
     UA_Chunk *chunk;
     SIMPLEQ_FOREACH(chunk, queue, pointers) {
-        if(chunk->copied)
+        if(chunk->copied || chunk->inRecvBuffer)
             continue;
         UA_ByteString copy;
         UA_StatusCode res = UA_ByteString_copy(&chunk->bytes, &copy);
@@ -20586,21 +20990,97 @@ persistCompleteChunks(UA_ChunkQueue *queue) {
     return UA_STATUSCODE_GOOD;
 }
 
+/* Offset of the first byte in the receive buffer that is still needed. Chunks
+ * that are processed right now (not in a queue) are not considered. */
+static size_t
+recvBufferLiveStart(const UA_SecureChannel *channel) {
+    size_t start = channel->recvParsed;
+    if(channel->recvChunks == 0)
+        return start;
+    UA_Chunk *chunk;
+    SIMPLEQ_FOREACH(chunk, &channel->completeChunks, pointers) {
+        if(!chunk->inRecvBuffer)
+            continue;
+        size_t pos = (size_t)(chunk->bytes.data - channel->recvBlock->data);
+        if(pos < start)
+            start = pos;
+    }
+    return start;
+}
+
+/* Move the queued chunks along with the bytes of the receive buffer */
+static void
+rebaseRecvChunks(UA_SecureChannel *channel, const UA_Byte *oldData,
+                 UA_Byte *newData, size_t shift) {
+    UA_Chunk *chunk;
+    SIMPLEQ_FOREACH(chunk, &channel->completeChunks, pointers) {
+        if(chunk->inRecvBuffer)
+            chunk->bytes.data = newData + ((size_t)(chunk->bytes.data - oldData) - shift);
+    }
+}
+
+/* Append to the receive buffer. If the end of the buffer is reached, the bytes
+ * still needed are moved to the front. A larger block is allocated only if they
+ * do not fit. During processing the current block must not change, so the
+ * bytes are then copied into a new block. */
 static UA_StatusCode
-persistIncompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
-                       size_t offset) {
-    UA_assert(channel->incompleteChunk.length == 0);
-    UA_assert(offset < buffer->length);
-    size_t length = buffer->length - offset;
-    UA_StatusCode res = UA_ByteString_allocBuffer(&channel->incompleteChunk, length);
-    UA_CHECK_STATUS(res, return res);
-    memcpy(channel->incompleteChunk.data, &buffer->data[offset], length);
+appendRecvBuffer(UA_SecureChannel *channel, const UA_Byte *data, size_t length) {
+    UA_RecvBlock *block = channel->recvBlock;
+    if(!block || channel->recvEnd + length > block->size) {
+        size_t start = (block) ? recvBufferLiveStart(channel) : 0;
+        size_t live = channel->recvEnd - start;
+        if(block && channel->recvDepth == 0 && live + length <= block->size) {
+            memmove(block->data, &block->data[start], live);
+            rebaseRecvChunks(channel, block->data, block->data, start);
+        } else {
+            size_t size = channel->config.recvBufferSize;
+            if(block && size < 2 * block->size)
+                size = 2 * block->size;
+            if(size < live + length)
+                size = live + length;
+            UA_RecvBlock *newBlock = (UA_RecvBlock*)
+                UA_malloc(sizeof(UA_RecvBlock) + size);
+            UA_CHECK_MEM(newBlock, return UA_STATUSCODE_BADOUTOFMEMORY);
+            newBlock->next = NULL;
+            newBlock->size = size;
+            if(block) {
+                memcpy(newBlock->data, &block->data[start], live);
+                rebaseRecvChunks(channel, block->data, newBlock->data, start);
+                releaseRecvBlock(channel, block);
+            }
+            channel->recvBlock = newBlock;
+            block = newBlock;
+        }
+        channel->recvParsed -= start;
+        channel->recvEnd -= start;
+    }
+    memcpy(&block->data[channel->recvEnd], data, length);
+    channel->recvEnd += length;
     return UA_STATUSCODE_GOOD;
 }
 
-/* Processes chunks and puts them into the payloads queue. Once a final chunk is
- * put into the queue, the message is assembled and the callback is called. The
- * queue will be cleared for the next message. */
+/* After the outermost call of UA_SecureChannel_processBuffer. Free the replaced
+ * blocks. A drained buffer starts from the front again and is only kept if it
+ * does not exceed the negotiated receive buffer size. */
+static void
+trimRecvBuffer(UA_SecureChannel *channel) {
+    UA_RecvBlock *retired;
+    while((retired = channel->recvRetired)) {
+        channel->recvRetired = retired->next;
+        UA_free(retired);
+    }
+    if(channel->recvChunks > 0 || channel->recvParsed < channel->recvEnd)
+        return;
+    channel->recvParsed = 0;
+    channel->recvEnd = 0;
+    if(channel->recvBlock && channel->recvBlock->size > channel->config.recvBufferSize) {
+        UA_free(channel->recvBlock);
+        channel->recvBlock = NULL;
+    }
+}
+
+/* Processes chunks and appends intermediate chunks to the decrypted message.
+ * Once a final chunk arrives, the callback is called with the message. */
 static UA_StatusCode
 processChunks(UA_SecureChannel *channel, void *application,
               UA_ProcessMessageCallback callback) {
@@ -20630,13 +21110,10 @@ processChunks(UA_SecureChannel *channel, void *application,
         }
 
         if(res != UA_STATUSCODE_GOOD) {
-            UA_Chunk_delete(chunk);
+            UA_Chunk_delete(channel, chunk);
             return res;
         }
 
-        /* Add to the decrypted-chunk queue */
-        SIMPLEQ_INSERT_TAIL(&channel->decryptedChunks, chunk, pointers);
-
         /* Check the resource limits */
         channel->decryptedChunksCount++;
         channel->decryptedChunksLength += chunk->bytes.length;
@@ -20644,30 +21121,35 @@ processChunks(UA_SecureChannel *channel, void *application,
             channel->decryptedChunksCount > channel->config.localMaxChunkCount) ||
            (channel->config.localMaxMessageSize != 0 &&
             channel->decryptedChunksLength > channel->config.localMaxMessageSize)) {
+            UA_Chunk_delete(channel, chunk);
             return UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
         }
 
-        /* Waiting for additional chunks */
-        if(chunk->chunkType == UA_CHUNKTYPE_INTERMEDIATE)
+        /* Waiting for additional chunks. The chunk is released right away, so
+         * it does not have to be persisted. */
+        if(chunk->chunkType == UA_CHUNKTYPE_INTERMEDIATE) {
+            res = appendDecryptedChunk(channel, chunk);
+            UA_Chunk_delete(channel, chunk);
+            UA_CHECK_STATUS(res, return res);
             continue;
+        }
 
         /* Final chunk or abort. Reset the counters. */
+        UA_Boolean assembled = (channel->decryptedChunksCount > 1);
         channel->decryptedChunksCount = 0;
         channel->decryptedChunksLength = 0;
 
-        /* Abort the message, remove all decrypted chunks
+        /* Abort the message, remove the decrypted part
          * TODO: Log a warning with the error code */
         if(chunk->chunkType == UA_CHUNKTYPE_ABORT) {
-            while((chunk = SIMPLEQ_FIRST(&channel->decryptedChunks))) {
-                SIMPLEQ_REMOVE_HEAD(&channel->decryptedChunks, pointers);
-                UA_Chunk_delete(chunk);
-            }
+            channel->decryptedMessage.length = 0;
+            UA_Chunk_delete(channel, chunk);
             continue;
         }
 
-        /* The decrypted queue contains a full message. Process it. */
+        /* Process the full message */
         UA_assert(chunk->chunkType == UA_CHUNKTYPE_FINAL);
-        res = assembleProcessMessage(channel, application, callback);
+        res = processFinalChunk(channel, application, callback, chunk, assembled);
         UA_CHECK_STATUS(res, return res);
     }
 
@@ -20676,7 +21158,7 @@ processChunks(UA_SecureChannel *channel, void *application,
 
 static UA_StatusCode
 extractCompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
-                     size_t *offset, UA_Boolean *done) {
+                     size_t *offset, UA_Boolean *done, UA_Boolean inRecvBuffer) {
     /* At least 8 byte needed for the header. Wait for the next chunk. */
     size_t initial_offset = *offset;
     size_t remaining = buffer->length - initial_offset;
@@ -20733,7 +21215,7 @@ extractCompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
 
     /* Add the chunk; forward the offset */
     *offset += hdr.messageSize;
-    UA_Chunk *chunk = (UA_Chunk*)UA_malloc(sizeof(UA_Chunk));
+    UA_Chunk *chunk = UA_Chunk_new(channel);
     UA_CHECK_MEM(chunk, return UA_STATUSCODE_BADOUTOFMEMORY);
 
     chunk->bytes = chunkPayload;
@@ -20741,6 +21223,9 @@ extractCompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
     chunk->chunkType = chunkType;
     chunk->requestId = 0;
     chunk->copied = false;
+    chunk->inRecvBuffer = inRecvBuffer;
+    if(inRecvBuffer)
+        channel->recvChunks++;
 
     SIMPLEQ_INSERT_TAIL(&channel->completeChunks, chunk, pointers);
     return UA_STATUSCODE_GOOD;
@@ -20750,49 +21235,50 @@ UA_StatusCode
 UA_SecureChannel_processBuffer(UA_SecureChannel *channel, void *application,
                                UA_ProcessMessageCallback callback,
                                const UA_ByteString *buffer) {
-    /* Prepend the incomplete last chunk. This is usually done in the
-     * networklayer. But we test for a buffered incomplete chunk here again to
-     * work around "lazy" network layers. */
-    UA_ByteString appended = channel->incompleteChunk;
-    if(appended.length > 0) {
-        channel->incompleteChunk = UA_BYTESTRING_NULL;
-        UA_Byte *t = (UA_Byte*)UA_realloc(appended.data, appended.length + buffer->length);
-        UA_CHECK_MEM(t, UA_ByteString_clear(&appended);
-                     return UA_STATUSCODE_BADOUTOFMEMORY);
-        memcpy(&t[appended.length], buffer->data, buffer->length);
-        appended.data = t;
-        appended.length += buffer->length;
-        buffer = &appended;
-    }
-
-    /* Loop over the received chunks */
     size_t offset = 0;
     UA_Boolean done = false;
-    UA_StatusCode res;
-    while(!done) {
-        res = extractCompleteChunk(channel, buffer, &offset, &done);
-        UA_CHECK_STATUS(res, goto cleanup);
-    }
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(channel->recvParsed == channel->recvEnd) {
+        /* No incomplete chunk is buffered. Loop over the chunks in the network
+         * buffer directly. */
+        while(!done) {
+            res = extractCompleteChunk(channel, buffer, &offset, &done, false);
+            UA_CHECK_STATUS(res, goto cleanup);
+        }
 
-    /* Buffer half-received chunk. Before processing the messages so that
-     * processing is reentrant. */
-    if(offset < buffer->length) {
-        res = persistIncompleteChunk(channel, buffer, offset);
+        /* Buffer half-received chunk. Before processing the messages so that
+         * processing is reentrant. */
+        if(offset < buffer->length) {
+            res = appendRecvBuffer(channel, &buffer->data[offset],
+                                   buffer->length - offset);
+            UA_CHECK_STATUS(res, goto cleanup);
+        }
+    } else {
+        /* Append to the incomplete chunk and extract the chunks in place */
+        res = appendRecvBuffer(channel, buffer->data, buffer->length);
+        UA_CHECK_STATUS(res, goto cleanup);
+        UA_ByteString received = {channel->recvEnd, channel->recvBlock->data};
+        offset = channel->recvParsed;
+        while(!done && res == UA_STATUSCODE_GOOD)
+            res = extractCompleteChunk(channel, &received, &offset, &done, true);
+        channel->recvParsed = offset;
         UA_CHECK_STATUS(res, goto cleanup);
     }
 
     /* Process whatever we can. Chunks of completed and processed messages are
      * removed. */
+    channel->recvDepth++;
     res = processChunks(channel, application, callback);
+    channel->recvDepth--;
     UA_CHECK_STATUS(res, goto cleanup);
 
-    /* Persist full chunks that still point to the buffer. Can only return
-     * UA_STATUSCODE_BADOUTOFMEMORY as an error code. So merging res works. */
-    res |= persistCompleteChunks(&channel->completeChunks);
-    res |= persistCompleteChunks(&channel->decryptedChunks);
+    /* Persist full chunks that still point to the network buffer. This only
+     * happens if they were left by a nested call. */
+    res = persistCompleteChunks(&channel->completeChunks);
 
  cleanup:
-    UA_ByteString_clear(&appended);
+    if(channel->recvDepth == 0)
+        trimRecvBuffer(channel);
     return res;
 }
 
@@ -22073,6 +22559,17 @@ UA_NodeReferenceKind_switch(UA_NodeReferenceKind *rk) {
     return UA_STATUSCODE_GOOD;
 }
 
+/* Large reference kinds are stored as trees. The nodestores convert them when
+ * a node is stored, so that reading a node never modifies it. */
+static void
+switchLargeReferenceKinds(UA_NodeHead *head) {
+    for(size_t i = 0; i < head->referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &head->references[i];
+        if(rk->targetsSize > 16 && !rk->hasRefTree)
+            UA_NodeReferenceKind_switch(rk);
+    }
+}
+
 const UA_ReferenceTarget *
 UA_NodeReferenceKind_findTarget(const UA_NodeReferenceKind *rk,
                                 const UA_ExpandedNodeId *targetId) {
@@ -23009,6 +23506,10 @@ void UA_Server_delete(UA_Server *server) {
     }
     UA_assert(server->monitoredItemsSize == 0);
     UA_assert(server->subscriptionsSize == 0);
+    UA_assert(server->samplersCount == 0);
+    UA_free(server->samplers);
+    UA_assert(LIST_EMPTY(&server->publishBuckets));
+    UA_free(server->heldConnections);
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
     UA_ConditionList_delete(server);
@@ -23046,6 +23547,10 @@ void UA_Server_delete(UA_Server *server) {
     UA_LOCK_DESTROY(&server->serviceMutex);
 #endif
 
+#ifdef UA_ARCHITECTURE_POSIX
+    UA_ServiceDispatcher_clear(&server->serviceDispatcher);
+#endif
+
     /* Delete the server itself */
     UA_free(server);
 }
@@ -23077,6 +23582,9 @@ static UA_Server *
 UA_Server_init(UA_Server *server) {
 
     UA_StatusCode res = UA_STATUSCODE_GOOD;
+#ifdef UA_ARCHITECTURE_POSIX
+    UA_ServiceDispatcher_init(&server->serviceDispatcher);
+#endif
     UA_CHECK_FATAL(UA_Server_NodestoreIsConfigured(server), goto cleanup,
                     &server->config.logger, UA_LOGCATEGORY_SERVER,
                     "No Nodestore configured in the server"
@@ -23485,7 +23993,11 @@ serverExecuteRepeatedCallback(UA_Server *server, UA_ApplicationCallback cb,
     /* The following check cannot be used since another thread can take the
      * serviceMutex during a server_iterate_call. */
     //UA_LOCK_ASSERT(&server->serviceMutex, 0);
+    /* Only the callbacks exclude the service workers. Iterations without due
+     * callbacks do not wait for running services. */
+    UA_Server_lockServices(server);
     cb(callbackApplication, data);
+    UA_Server_unlockServices(server);
 }
 
 UA_UInt16
@@ -23511,6 +24023,9 @@ UA_Server_run_iterate(UA_Server *server, UA_Boolean waitInternal) {
         nl->listen(nl, server, timeout);
     }
 
+    /* Responses finished by the service workers */
+    UA_Server_sendServiceResponses(server);
+
 #if defined(UA_ENABLE_PUBSUB_MQTT)
     /* Listen on the pubsublayer, but only if the yield function is set */
     UA_PubSubConnection *connection;
@@ -26197,6 +26712,461 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
     return channelRes;
 }
 
+/**************************/
+/* Service Worker Threads */
+/**************************/
+
+#ifdef UA_ARCHITECTURE_POSIX
+
+#ifndef container_of
+#define container_of(ptr, type, member) \
+    (type *)((uintptr_t)ptr - offsetof(type,member))
+#endif
+
+void
+UA_ServiceDispatcher_init(UA_ServiceDispatcher *d) {
+    memset(d, 0, sizeof(UA_ServiceDispatcher));
+    /* Prefer the server thread, so that it is not starved by a continuous
+     * stream of dispatched requests */
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    pthread_rwlock_init(&d->serviceLock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    pthread_mutex_init(&d->mutex, NULL);
+    pthread_cond_init(&d->workAvailable, NULL);
+    TAILQ_INIT(&d->ready);
+}
+
+void
+UA_ServiceDispatcher_clear(UA_ServiceDispatcher *d) {
+    UA_assert(d->workers == 0);
+    pthread_cond_destroy(&d->workAvailable);
+    pthread_mutex_destroy(&d->mutex);
+    pthread_rwlock_destroy(&d->serviceLock);
+}
+
+void
+UA_Server_lockServices(UA_Server *server) {
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    if(d->lockDepth++ == 0)
+        pthread_rwlock_wrlock(&d->serviceLock);
+}
+
+void
+UA_Server_unlockServices(UA_Server *server) {
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    UA_assert(d->lockDepth > 0);
+    if(--d->lockDepth == 0)
+        pthread_rwlock_unlock(&d->serviceLock);
+}
+
+static UA_Boolean
+isWorkerService(const UA_DataType *requestType) {
+    return requestType == &UA_TYPES[UA_TYPES_READREQUEST] ||
+        requestType == &UA_TYPES[UA_TYPES_BROWSEREQUEST] ||
+        requestType == &UA_TYPES[UA_TYPES_BROWSENEXTREQUEST] ||
+        requestType == &UA_TYPES[UA_TYPES_TRANSLATEBROWSEPATHSTONODEIDSREQUEST] ||
+        requestType == &UA_TYPES[UA_TYPES_CALLREQUEST];
+}
+
+static UA_Boolean
+serviceWorkersRunning(UA_Server *server) {
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    pthread_mutex_lock(&d->mutex);
+    UA_Boolean running = (d->workers > 0 && !d->stopping);
+    pthread_mutex_unlock(&d->mutex);
+    return running;
+}
+
+static void
+deleteServiceJob(UA_ServiceJob *job) {
+    if(job->state == UA_SERVICEJOB_QUEUED)
+        UA_clear(&job->request, job->requestType);
+    UA_ByteString_clear(&job->encoded);
+    UA_free(job);
+}
+
+/* Jobs behind a serial job wait until the server thread has processed it */
+static UA_ServiceJob *
+firstQueuedJob(channel_entry *entry) {
+    UA_ServiceJob *job;
+    TAILQ_FOREACH(job, &entry->serviceJobs, pointers) {
+        if(job->state == UA_SERVICEJOB_QUEUED)
+            return job;
+        if(job->state == UA_SERVICEJOB_SERIAL)
+            return NULL;
+    }
+    return NULL;
+}
+
+/* Takes over the decoded request if a worker will execute it. Requests that
+ * are rejected (no valid session, ...) are answered by the server thread. */
+static UA_Boolean
+dispatchService(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
+                UA_Service service, const UA_Request *request,
+                const UA_DataType *requestType, const UA_DataType *responseType) {
+    if(server->config.securityPolicyNoneDiscoveryOnly &&
+       UA_String_equal(&channel->securityPolicy->policyUri, &securityPolicyNone))
+        return false;
+
+    UA_Session *session = NULL;
+    UA_SessionHeader *sh;
+    SLIST_FOREACH(sh, &channel->sessions, next) {
+        if(UA_NodeId_equal(&request->requestHeader.authenticationToken,
+                           &sh->authenticationToken)) {
+            session = (UA_Session*)sh;
+            break;
+        }
+    }
+    if(!session || !session->activated ||
+       session->validTill < UA_DateTime_nowMonotonic())
+        return false;
+
+    UA_ServiceJob *job = (UA_ServiceJob*)UA_malloc(sizeof(UA_ServiceJob));
+    if(!job)
+        return false;
+    job->state = UA_SERVICEJOB_QUEUED;
+    job->session = session;
+    job->service = service;
+    job->requestType = requestType;
+    job->responseType = responseType;
+    job->requestId = requestId;
+    job->requestHandle = request->requestHeader.requestHandle;
+    job->serviceResult = UA_STATUSCODE_GOOD;
+    job->encoded = UA_BYTESTRING_NULL;
+    memcpy(&job->request, request, requestType->memSize);
+
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    channel_entry *entry = container_of(channel, channel_entry, channel);
+    pthread_mutex_lock(&d->mutex);
+    if(d->workers == 0 || d->stopping) {
+        pthread_mutex_unlock(&d->mutex);
+        UA_free(job); /* The request remains with the caller */
+        return false;
+    }
+    TAILQ_INSERT_TAIL(&entry->serviceJobs, job, pointers);
+    if(!entry->serviceScheduled) {
+        entry->serviceScheduled = true;
+        TAILQ_INSERT_TAIL(&d->ready, entry, readyPointers);
+        pthread_cond_signal(&d->workAvailable);
+    }
+    d->stats.dispatched++;
+    if(++d->queued > d->stats.maxQueued)
+        d->stats.maxQueued = d->queued;
+    pthread_mutex_unlock(&d->mutex);
+
+    UA_Session_updateLifetime(session);
+    return true;
+}
+
+static UA_StatusCode
+encodeServiceResponse(UA_ServiceJob *job, const UA_Response *response) {
+    const UA_NodeId *typeId = &job->responseType->binaryEncodingId;
+    size_t length = UA_calcSizeBinary(typeId, &UA_TYPES[UA_TYPES_NODEID]) +
+        UA_calcSizeBinary(response, job->responseType);
+    UA_StatusCode res = UA_ByteString_allocBuffer(&job->encoded, length);
+    UA_CHECK_STATUS(res, return res);
+    UA_Byte *pos = job->encoded.data;
+    const UA_Byte *end = &job->encoded.data[length];
+    res = UA_encodeBinaryInternal(typeId, &UA_TYPES[UA_TYPES_NODEID],
+                                  &pos, &end, NULL, NULL);
+    if(res == UA_STATUSCODE_GOOD)
+        res = UA_encodeBinaryInternal(response, job->responseType,
+                                      &pos, &end, NULL, NULL);
+    if(res != UA_STATUSCODE_GOOD)
+        UA_ByteString_clear(&job->encoded);
+    return res;
+}
+
+/* Executed in a worker while it holds the service lock shared */
+static void
+runServiceJob(UA_Server *server, UA_ServiceJob *job) {
+    UA_Response response;
+    UA_init(&response, job->responseType);
+    response.responseHeader.requestHandle = job->requestHandle;
+    job->service(server, job->session, &job->request, &response);
+    job->serviceResult = response.responseHeader.serviceResult;
+    if(job->serviceResult == UA_STATUSCODE_GOOD) {
+        response.responseHeader.timestamp = UA_DateTime_now();
+        job->serviceResult = encodeServiceResponse(job, &response);
+    }
+    UA_clear(&response, job->responseType);
+    UA_clear(&job->request, job->requestType);
+}
+
+void
+UA_Server_runServiceWorker(UA_Server *server) {
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    pthread_mutex_lock(&d->mutex);
+    d->workers++;
+    while(true) {
+        while(!d->stopping && TAILQ_EMPTY(&d->ready))
+            pthread_cond_wait(&d->workAvailable, &d->mutex);
+        if(TAILQ_EMPTY(&d->ready))
+            break; /* Stopping and nothing left */
+
+        /* Take the service lock before the job. While the server thread holds
+         * the lock, all jobs are either queued or done. */
+        pthread_mutex_unlock(&d->mutex);
+        pthread_rwlock_rdlock(&d->serviceLock);
+        pthread_mutex_lock(&d->mutex);
+        channel_entry *entry = TAILQ_FIRST(&d->ready);
+        if(!entry) {
+            pthread_mutex_unlock(&d->mutex);
+            pthread_rwlock_unlock(&d->serviceLock);
+            pthread_mutex_lock(&d->mutex);
+            continue;
+        }
+        TAILQ_REMOVE(&d->ready, entry, readyPointers);
+        UA_ServiceJob *job = firstQueuedJob(entry);
+        if(!job) {
+            entry->serviceScheduled = false;
+            pthread_mutex_unlock(&d->mutex);
+            pthread_rwlock_unlock(&d->serviceLock);
+            pthread_mutex_lock(&d->mutex);
+            continue;
+        }
+        job->state = UA_SERVICEJOB_RUNNING;
+        d->queued--;
+        pthread_mutex_unlock(&d->mutex);
+
+        runServiceJob(server, job);
+
+        /* The channel cannot be freed before the service lock is released */
+        pthread_mutex_lock(&d->mutex);
+        job->state = UA_SERVICEJOB_DONE;
+        UA_ServiceJob *next = TAILQ_NEXT(job, pointers);
+        if(next && next->state == UA_SERVICEJOB_QUEUED && !entry->serviceClosed) {
+            TAILQ_INSERT_TAIL(&d->ready, entry, readyPointers);
+            pthread_cond_signal(&d->workAvailable);
+        } else {
+            entry->serviceScheduled = false;
+        }
+        UA_Boolean notify = !d->responsesPending;
+        d->responsesPending = true;
+        pthread_mutex_unlock(&d->mutex);
+        pthread_rwlock_unlock(&d->serviceLock);
+
+        if(notify && server->config.serviceWorkerNotify)
+            server->config.serviceWorkerNotify(server, server->config.serviceWorkerContext);
+        pthread_mutex_lock(&d->mutex);
+    }
+    d->workers--;
+    pthread_mutex_unlock(&d->mutex);
+}
+
+void
+UA_Server_stopServiceWorkers(UA_Server *server) {
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    pthread_mutex_lock(&d->mutex);
+    d->stopping = true;
+    pthread_cond_broadcast(&d->workAvailable);
+    pthread_mutex_unlock(&d->mutex);
+}
+
+void
+UA_Server_getServiceWorkerStatistics(UA_Server *server,
+                                     UA_ServiceWorkerStatistics *stats) {
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    pthread_mutex_lock(&d->mutex);
+    *stats = d->stats;
+    pthread_mutex_unlock(&d->mutex);
+}
+
+static UA_StatusCode
+sendServiceJobResponse(UA_SecureChannel *channel, UA_ServiceJob *job) {
+    if(job->serviceResult != UA_STATUSCODE_GOOD)
+        return sendServiceFault(channel, job->requestId, job->requestHandle,
+                                job->serviceResult);
+    UA_MessageContext mc;
+    UA_StatusCode res =
+        UA_MessageContext_begin(&mc, channel, job->requestId, UA_MESSAGETYPE_MSG);
+    UA_CHECK_STATUS(res, return res);
+    res = UA_MessageContext_encodeBytes(&mc, &job->encoded);
+    UA_CHECK_STATUS(res, return res);
+    return UA_MessageContext_finish(&mc);
+}
+
+static UA_StatusCode
+processSecureChannelMessage(void *application, UA_SecureChannel *channel,
+                            UA_MessageType messagetype, UA_UInt32 requestId,
+                            UA_ByteString *message);
+
+/* Processes the parked request like a message that has just arrived. An error
+ * closes the channel. */
+static void
+processSerialJob(UA_Server *server, channel_entry *entry, UA_ServiceJob *job) {
+    entry->serviceSerial = true;
+    processSecureChannelMessage(server, &entry->channel, UA_MESSAGETYPE_MSG,
+                                job->requestId, &job->encoded);
+    entry->serviceSerial = false;
+}
+
+/* Only the server thread adds and removes jobs. The workers change their
+ * state. */
+static void
+sendChannelServiceResponses(UA_Server *server, channel_entry *entry) {
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    while(!TAILQ_EMPTY(&entry->serviceJobs)) {
+        pthread_mutex_lock(&d->mutex);
+        UA_ServiceJob *job = TAILQ_FIRST(&entry->serviceJobs);
+        if(job->state != UA_SERVICEJOB_DONE && job->state != UA_SERVICEJOB_SERIAL) {
+            pthread_mutex_unlock(&d->mutex);
+            return;
+        }
+        TAILQ_REMOVE(&entry->serviceJobs, job, pointers);
+        pthread_mutex_unlock(&d->mutex);
+
+        if(job->state == UA_SERVICEJOB_SERIAL) {
+            processSerialJob(server, entry, job);
+            deleteServiceJob(job);
+            if(entry->channel.state != UA_SECURECHANNELSTATE_OPEN)
+                return;
+
+            /* Hand the jobs that waited behind the serial job to the workers.
+             * If the workers have returned meanwhile, the server thread
+             * executes them. */
+            pthread_mutex_lock(&d->mutex);
+            UA_ServiceJob *next = NULL;
+            if(!entry->serviceScheduled && !entry->serviceClosed)
+                next = firstQueuedJob(entry);
+            if(next && d->workers > 0) {
+                entry->serviceScheduled = true;
+                TAILQ_INSERT_TAIL(&d->ready, entry, readyPointers);
+                pthread_cond_signal(&d->workAvailable);
+                next = NULL;
+            } else if(next) {
+                next->state = UA_SERVICEJOB_RUNNING;
+                d->queued--;
+            }
+            pthread_mutex_unlock(&d->mutex);
+            if(next) {
+                UA_Server_lockServices(server);
+                runServiceJob(server, next);
+                UA_Server_unlockServices(server);
+                pthread_mutex_lock(&d->mutex);
+                next->state = UA_SERVICEJOB_DONE;
+                pthread_mutex_unlock(&d->mutex);
+            }
+            continue;
+        }
+
+        UA_StatusCode res = UA_STATUSCODE_GOOD;
+        if(job->session)
+            res = sendServiceJobResponse(&entry->channel, job);
+        deleteServiceJob(job);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_INFO_CHANNEL(&server->config.logger, &entry->channel,
+                                "Sending a response failed with error %s",
+                                UA_StatusCode_name(res));
+            UA_Server_closeSecureChannel(server, &entry->channel,
+                                         UA_DIAGNOSTICEVENT_ABORT);
+            return;
+        }
+    }
+}
+
+void
+UA_Server_sendServiceResponses(UA_Server *server) {
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    pthread_mutex_lock(&d->mutex);
+    UA_Boolean pending = d->responsesPending;
+    d->responsesPending = false;
+    pthread_mutex_unlock(&d->mutex);
+    if(!pending)
+        return;
+    channel_entry *entry, *tmp;
+    TAILQ_FOREACH_SAFE(entry, &server->channels, pointers, tmp)
+        sendChannelServiceResponses(server, entry);
+}
+
+/* Requests that are not dispatched are answered after the dispatched requests
+ * of the channel. If some of them are not answered yet, a copy of the message
+ * is parked behind them as a serial job. The server thread does not wait and
+ * continues with the other channels. */
+static UA_StatusCode
+parkSerialRequest(UA_Server *server, channel_entry *entry, UA_UInt32 requestId,
+                  const UA_ByteString *msg, UA_Boolean *parked) {
+    *parked = false;
+    if(entry->serviceSerial || TAILQ_EMPTY(&entry->serviceJobs))
+        return UA_STATUSCODE_GOOD;
+    sendChannelServiceResponses(server, entry);
+    if(TAILQ_EMPTY(&entry->serviceJobs) ||
+       entry->channel.state != UA_SECURECHANNELSTATE_OPEN)
+        return UA_STATUSCODE_GOOD;
+
+    UA_ServiceJob *job = (UA_ServiceJob*)UA_calloc(1, sizeof(UA_ServiceJob));
+    if(!job)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode res = UA_ByteString_copy(msg, &job->encoded);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_free(job);
+        return res;
+    }
+    job->state = UA_SERVICEJOB_SERIAL;
+    job->requestId = requestId;
+
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    pthread_mutex_lock(&d->mutex);
+    TAILQ_INSERT_TAIL(&entry->serviceJobs, job, pointers);
+    d->stats.parked++;
+    pthread_mutex_unlock(&d->mutex);
+    *parked = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_Server_cancelChannelServiceJobs(UA_Server *server, channel_entry *entry) {
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    pthread_mutex_lock(&d->mutex);
+    entry->serviceClosed = true;
+    UA_Boolean running = false;
+    UA_ServiceJob *job, *tmp;
+    TAILQ_FOREACH_SAFE(job, &entry->serviceJobs, pointers, tmp) {
+        if(job->state == UA_SERVICEJOB_RUNNING) {
+            running = true;
+            continue;
+        }
+        if(job->state == UA_SERVICEJOB_QUEUED)
+            d->queued--;
+        TAILQ_REMOVE(&entry->serviceJobs, job, pointers);
+        deleteServiceJob(job);
+    }
+    if(entry->serviceScheduled && !running) {
+        TAILQ_REMOVE(&d->ready, entry, readyPointers);
+        entry->serviceScheduled = false;
+    }
+    pthread_mutex_unlock(&d->mutex);
+}
+
+void
+UA_Server_cancelSessionServiceJobs(UA_Server *server, UA_Session *session) {
+    if(!session->header.channel)
+        return;
+    channel_entry *entry = container_of(session->header.channel, channel_entry, channel);
+    UA_ServiceDispatcher *d = &server->serviceDispatcher;
+    pthread_mutex_lock(&d->mutex);
+    UA_ServiceJob *job, *tmp;
+    TAILQ_FOREACH_SAFE(job, &entry->serviceJobs, pointers, tmp) {
+        if(job->session != session)
+            continue;
+        if(job->state == UA_SERVICEJOB_RUNNING) {
+            job->session = NULL; /* Drop the response */
+            continue;
+        }
+        if(job->state == UA_SERVICEJOB_QUEUED)
+            d->queued--;
+        TAILQ_REMOVE(&entry->serviceJobs, job, pointers);
+        deleteServiceJob(job);
+    }
+    pthread_mutex_unlock(&d->mutex);
+}
+
+#endif /* UA_ARCHITECTURE_POSIX */
+
 static UA_StatusCode
 processMSG(UA_Server *server, UA_SecureChannel *channel,
            UA_UInt32 requestId, const UA_ByteString *msg) {
@@ -26222,6 +27192,23 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
     size_t counterOffset = 0;
     getServicePointers(requestTypeId.identifier.numeric, &requestType,
                        &responseType, &service, &sessionRequired, &counterOffset);
+
+#ifdef UA_ARCHITECTURE_POSIX
+    /* Read-only services go to the service workers if they run. All other
+     * requests are answered after the dispatched requests of the channel.
+     * Publish responses are sent asynchronously anyway. A parked request is
+     * processed in the server thread when its turn has come. */
+    channel_entry *entry = container_of(channel, channel_entry, channel);
+    UA_Boolean dispatch = !entry->serviceSerial && isWorkerService(requestType) &&
+        serviceWorkersRunning(server);
+    UA_Boolean parked;
+    if(!dispatch && requestType != &UA_TYPES[UA_TYPES_PUBLISHREQUEST]) {
+        retval = parkSerialRequest(server, entry, requestId, msg, &parked);
+        if(retval != UA_STATUSCODE_GOOD || parked)
+            return retval;
+    }
+#endif
+
     if(!requestType) {
         if(requestTypeId.identifier.numeric ==
            UA_NS0ID_CREATESUBSCRIPTIONREQUEST_ENCODING_DEFAULTBINARY) {
@@ -26247,6 +27234,13 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
         UA_LOG_DEBUG_CHANNEL(&server->config.logger, channel,
                              "Could not decode the request with StatusCode %s",
                              UA_StatusCode_name(retval));
+#ifdef UA_ARCHITECTURE_POSIX
+        if(dispatch) {
+            UA_StatusCode res = parkSerialRequest(server, entry, requestId, msg, &parked);
+            if(res != UA_STATUSCODE_GOOD || parked)
+                return res;
+        }
+#endif
         return decodeHeaderSendServiceFault(channel, msg, requestPos,
                                             responseType, requestId, retval);
     }
@@ -26259,6 +27253,15 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
                                    "The server sends no timestamp in the request header. "
                                    "See the 'verifyRequestTimestamp' setting.");
             if(server->config.verifyRequestTimestamp <= UA_RULEHANDLING_ABORT) {
+#ifdef UA_ARCHITECTURE_POSIX
+                if(dispatch) {
+                    retval = parkSerialRequest(server, entry, requestId, msg, &parked);
+                    if(retval != UA_STATUSCODE_GOOD || parked) {
+                        UA_clear(&request, requestType);
+                        return retval;
+                    }
+                }
+#endif
                 retval = sendServiceFault(channel, requestId, requestHeader->requestHandle,
                                           UA_STATUSCODE_BADINVALIDTIMESTAMP);
                 UA_clear(&request, requestType);
@@ -26277,12 +27280,28 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
     }
 #endif
 
+#ifdef UA_ARCHITECTURE_POSIX
+    if(dispatch) {
+        /* The job has taken over the request */
+        if(dispatchService(server, channel, requestId, service, &request,
+                           requestType, responseType))
+            return UA_STATUSCODE_GOOD;
+        retval = parkSerialRequest(server, entry, requestId, msg, &parked);
+        if(retval != UA_STATUSCODE_GOOD || parked) {
+            UA_clear(&request, requestType);
+            return retval;
+        }
+    }
+#endif
+
     /* Prepare the respone and process the request */
     UA_Response response;
     UA_init(&response, responseType);
     response.responseHeader.requestHandle = requestHeader->requestHandle;
+    UA_Server_lockServices(server);
     retval = processMSGDecoded(server, channel, requestId, service, &request, requestType,
                                &response, responseType, sessionRequired, counterOffset);
+    UA_Server_unlockServices(server);
 
     /* Clean up */
     UA_clear(&request, requestType);
@@ -37964,6 +38983,9 @@ UA_Server_removeSession(UA_Server *server, session_list_entry *sentry,
 
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
+    /* Drop the dispatched requests of the session */
+    UA_Server_cancelSessionServiceJobs(server, session);
+
     /* Remove the Subscriptions */
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     UA_Subscription *sub, *tempsub;
@@ -39029,12 +40051,11 @@ readValueAttributeFromDataSource(UA_Server *server, UA_Session *session,
              &vn->head.nodeId, vn->head.context,
              sourceTimeStamp, rangeptr, &v2);
     UA_LOCK(&server->serviceMutex);
-    if(v2.hasValue && v2.value.storageType == UA_VARIANT_DATA_NODELETE) {
-        retval = UA_DataValue_copy(&v2, v);
-        UA_DataValue_clear(&v2);
-    } else {
-        *v = v2;
-    }
+    /* The value may point into memory of the data source via
+     * UA_VARIANT_DATA_NODELETE. This is the same contract as for ReadWithNode.
+     * Callers that keep the value beyond the current service call have to make
+     * a copy (see UA_Server_readWithSession). */
+    *v = v2;
     return retval;
 }
 
@@ -39474,6 +40495,22 @@ Service_Read(UA_Server *server, UA_Session *session,
                                            &UA_TYPES[UA_TYPES_DATAVALUE]);
 }
 
+/* Detach a read value from memory owned by a data source, so that it can
+ * outlive the node (e.g. as the last sample of a MonitoredItem) */
+static void
+detachDataValue(UA_DataValue *dv) {
+    if(!dv->hasValue || dv->value.storageType != UA_VARIANT_DATA_NODELETE)
+        return;
+    UA_Variant borrowed = dv->value;
+    UA_StatusCode res = UA_Variant_copy(&borrowed, &dv->value);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_Variant_init(&dv->value);
+        dv->hasValue = false;
+        dv->hasStatus = true;
+        dv->status = res;
+    }
+}
+
 UA_DataValue
 UA_Server_readWithSession(UA_Server *server, UA_Session *session,
                           const UA_ReadValueId *item,
@@ -39496,6 +40533,9 @@ UA_Server_readWithSession(UA_Server *server, UA_Session *session,
 
     /* Release the node and return */
     UA_NODESTORE_RELEASE(server, node);
+
+    /* The returned value can outlive the node */
+    detachDataValue(&dv);
     return dv;
 }
 
@@ -40363,8 +41403,10 @@ triggerImmediateDataChange(UA_Server *server, UA_Session *session,
         UA_DataValue_init(&value);
         ReadWithNode(node, server, session, mon->timestampsToReturn,
                      &mon->itemToMonitor, &value);
+        /* The sample becomes the last value of the MonitoredItem */
+        detachDataValue(&value);
         UA_Subscription *sub = mon->subscription;
-        UA_StatusCode res = sampleCallbackWithValue(server, sub, mon, &value);
+        UA_StatusCode res = sampleCallbackWithValue(server, sub, mon, &value, NULL);
         if(res != UA_STATUSCODE_GOOD) {
             UA_DataValue_clear(&value);
             UA_LOG_WARNING_SUBSCRIPTION(&server->config.logger, sub,
@@ -41756,11 +42798,22 @@ Service_ModifySubscription(UA_Server *server, UA_Session *session,
     sub->currentLifetimeCount = 0;
 
     /* Change the repeated callback to the new interval. This cannot fail as the
-     * CallbackId must exist. */
-    if(sub->publishCallbackId > 0 &&
-       sub->publishingInterval != oldPublishingInterval)
-        changeRepeatedCallbackInterval(server, sub->publishCallbackId,
-                                       sub->publishingInterval);
+     * CallbackId must exist. A Subscription in a publish bucket moves to the
+     * bucket of the new interval. It remains in the old bucket if that
+     * fails. */
+    if(sub->publishingInterval != oldPublishingInterval) {
+        if(sub->publishCallbackId > 0) {
+            changeRepeatedCallbackInterval(server, sub->publishCallbackId,
+                                           sub->publishingInterval);
+        } else if(sub->publishBucket) {
+            UA_StatusCode res = Subscription_registerPublishCallback(server, sub);
+            if(res != UA_STATUSCODE_GOOD)
+                UA_LOG_WARNING_SUBSCRIPTION(&server->config.logger, sub,
+                                            "Could not move to the publish bucket "
+                                            "of the new interval with error code %s",
+                                            UA_StatusCode_name(res));
+        }
+    }
 
     /* If the priority has changed, re-enter the subscription to the
      * priority-ordered queue in the session. */
@@ -42107,7 +43160,10 @@ Operation_TransferSubscription(UA_Server *server, UA_Session *session,
      * that all backpointers are set correctly. */
     memcpy(newSub, sub, sizeof(UA_Subscription));
 
-    /* Register cyclic publish callback */
+    /* Register cyclic publish callback. The registration of the original
+     * subscription is removed when it is deleted. */
+    newSub->publishCallbackId = 0;
+    newSub->publishBucket = NULL;
     result->statusCode = Subscription_registerPublishCallback(server, newSub);
     if(result->statusCode != UA_STATUSCODE_GOOD) {
         UA_Array_delete(result->availableSequenceNumbers,
@@ -42141,6 +43197,10 @@ Operation_TransferSubscription(UA_Server *server, UA_Session *session,
     sub->dataChangeNotifications = 0;
     sub->eventNotifications = 0;
 
+    /* The queued notifications were taken from the pool (copied over with the
+     * struct) */
+    sub->notificationPool = NULL;
+
     TAILQ_INIT(&newSub->retransmissionQueue);
     UA_NotificationMessageEntry *nme, *nme_tmp;
     TAILQ_FOREACH_SAFE(nme, &sub->retransmissionQueue, listEntry, nme_tmp) {
@@ -42191,7 +43251,7 @@ Operation_TransferSubscription(UA_Server *server, UA_Session *session,
 
             /* Create a notification with the last sampled value */
             UA_MonitoredItem_createDataChangeNotification(server, newSub, mon,
-                                                          &mon->lastValue);
+                                                          &mon->lastValue, NULL);
         }
     }
 
@@ -42696,6 +43756,8 @@ Operation_CreateMonitoredItem(UA_Server *server, UA_Session *session,
     UA_MonitoredItem_init(newMon);
     newMon->subscription = cmc->sub; /* Can be NULL for local MonitoredItems */
     newMon->timestampsToReturn = cmc->timestampsToReturn;
+    newMon->valueChangedType = valueType;
+    newMon->valueChanged = UA_MonitoredItem_resolveValueChanged(valueType);
     result->statusCode |= UA_ReadValueId_copy(&request->itemToMonitor,
                                               &newMon->itemToMonitor);
     result->statusCode |= UA_MonitoringParameters_copy(&request->requestedParameters,
@@ -42715,6 +43777,9 @@ Operation_CreateMonitoredItem(UA_Server *server, UA_Session *session,
         return;
     }
 
+    /* Cache the (converted) deadband */
+    UA_MonitoredItem_resolveDeadband(newMon);
+
     /* Initialize the value status so the first sample always passes the filter */
     newMon->lastValue.hasStatus = true;
     newMon->lastValue.status = ~(UA_StatusCode)0;
@@ -42846,6 +43911,7 @@ Operation_ModifyMonitoredItem(UA_Server *server, UA_Session *session, UA_Subscri
     /* Move over the new settings */
     UA_MonitoringParameters_clear(&mon->parameters);
     mon->parameters = params;
+    UA_MonitoredItem_resolveDeadband(mon);
 
     /* Re-register the callback if necessary */
     if(oldSamplingInterval != mon->parameters.samplingInterval) {
@@ -43042,7 +44108,9 @@ UA_Server_deleteMonitoredItem(UA_Server *server, UA_UInt32 monitoredItemId) {
 #endif
 
 static void
-removeSecureChannelCallback(void *_, channel_entry *entry) {
+removeSecureChannelCallback(UA_Server *server, channel_entry *entry) {
+    /* Timed callbacks hold the service lock. No worker uses the channel. */
+    UA_Server_cancelChannelServiceJobs(server, entry);
     UA_SecureChannel_close(&entry->channel);
 }
 
@@ -43056,6 +44124,11 @@ removeSecureChannel(UA_Server *server, channel_entry *entry,
         return;
     entry->channel.state = UA_SECURECHANNELSTATE_CLOSING;
 
+    /* Requests of the channel that have not been picked up by a worker are
+     * dropped. The workers read the list of channels for diagnostics. */
+    UA_Server_cancelChannelServiceJobs(server, entry);
+    UA_Server_lockServices(server);
+
     /* Detach from the connection and close the connection */
     if(entry->channel.connection) {
         if(entry->channel.connection->state != UA_CONNECTIONSTATE_CLOSED)
@@ -43093,11 +44166,12 @@ removeSecureChannel(UA_Server *server, channel_entry *entry,
     /* Add a delayed callback to remove the channel when the currently
      * scheduled jobs have completed */
     entry->cleanupCallback.callback = (UA_ApplicationCallback)removeSecureChannelCallback;
-    entry->cleanupCallback.application = NULL;
+    entry->cleanupCallback.application = server;
     entry->cleanupCallback.data = entry;
     entry->cleanupCallback.nextTime = UA_DateTime_nowMonotonic() + 1;
     entry->cleanupCallback.interval = 0; /* Remove the structure */
     UA_Timer_addTimerEntry(&server->timer, &entry->cleanupCallback, NULL);
+    UA_Server_unlockServices(server);
 }
 
 void
@@ -43199,8 +44273,16 @@ UA_Server_createSecureChannel(UA_Server *server, UA_Connection *connection) {
                           &server->config.networkLayers[0].localConnectionConfig);
     entry->channel.certificateVerification = &server->config.certificateVerification;
     entry->channel.processOPNHeader = UA_Server_configSecureChannel;
+#ifdef UA_ARCHITECTURE_POSIX
+    TAILQ_INIT(&entry->serviceJobs);
+    entry->serviceScheduled = false;
+    entry->serviceClosed = false;
+    entry->serviceSerial = false;
+#endif
 
+    UA_Server_lockServices(server);
     TAILQ_INSERT_TAIL(&server->channels, entry, pointers);
+    UA_Server_unlockServices(server);
     UA_Connection_attachSecureChannel(connection, &entry->channel);
     server->secureChannelStatistics.currentChannelCount++;
     server->secureChannelStatistics.cumulatedChannelCount++;
@@ -65026,6 +66108,12 @@ UA_Subscription_new(void) {
      * This can happen by a subscription without a monitored item (see CTT test scripts). */
     newSub->nextSequenceNumber = 1;
 
+    newSub->notificationPool = UA_NotificationPool_new();
+    if(!newSub->notificationPool) {
+        UA_free(newSub);
+        return NULL;
+    }
+
     TAILQ_INIT(&newSub->retransmissionQueue);
     TAILQ_INIT(&newSub->notificationQueue);
     return newSub;
@@ -65087,6 +66175,13 @@ UA_Subscription_delete(UA_Server *server, UA_Subscription *sub) {
     }
     UA_assert(sub->monitoredItemsSize == 0);
 
+    /* All notifications were released with the MonitoredItems. The pool was
+     * moved away if the Subscription was transferred. */
+    if(sub->notificationPool) {
+        UA_NotificationPool_delete(sub->notificationPool);
+        sub->notificationPool = NULL;
+    }
+
     /* Delete Retransmission Queue */
     UA_NotificationMessageEntry *nme, *nme_tmp;
     TAILQ_FOREACH_SAFE(nme, &sub->retransmissionQueue, listEntry, nme_tmp) {
@@ -65204,6 +66299,57 @@ UA_Subscription_removeRetransmissionMessage(UA_Subscription *sub, UA_UInt32 sequ
     return UA_STATUSCODE_GOOD;
 }
 
+/* Encode the DataChangeNotification with the shared encodings of the values
+ * that have one. The other values are encoded here. */
+static UA_StatusCode
+encodeDataChangeNotification(const UA_DataChangeNotification *dcn,
+                             UA_EncodedDataValue **encodedValues,
+                             UA_ByteString *body) {
+    /* Array lengths of the MonitoredItems and the DiagnosticInfos */
+    size_t size = 2 * sizeof(UA_Int32);
+    for(size_t i = 0; i < dcn->monitoredItemsSize; i++) {
+        size += sizeof(UA_UInt32); /* ClientHandle */
+        if(encodedValues[i])
+            size += encodedValues[i]->encoding.length;
+        else
+            size += UA_calcSizeBinary(&dcn->monitoredItems[i].value,
+                                      &UA_TYPES[UA_TYPES_DATAVALUE]);
+    }
+    UA_StatusCode res = UA_ByteString_allocBuffer(body, size);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    UA_Byte *pos = body->data;
+    const UA_Byte *end = &body->data[size];
+    UA_Int32 length = (UA_Int32)dcn->monitoredItemsSize;
+    res = UA_encodeBinaryInternal(&length, &UA_TYPES[UA_TYPES_INT32],
+                                  &pos, &end, NULL, NULL);
+    for(size_t i = 0; i < dcn->monitoredItemsSize && res == UA_STATUSCODE_GOOD; i++) {
+        const UA_MonitoredItemNotification *min = &dcn->monitoredItems[i];
+        res = UA_encodeBinaryInternal(&min->clientHandle, &UA_TYPES[UA_TYPES_UINT32],
+                                      &pos, &end, NULL, NULL);
+        if(res != UA_STATUSCODE_GOOD)
+            break;
+        if(encodedValues[i]) {
+            memcpy(pos, encodedValues[i]->encoding.data,
+                   encodedValues[i]->encoding.length);
+            pos += encodedValues[i]->encoding.length;
+        } else {
+            res = UA_encodeBinaryInternal(&min->value, &UA_TYPES[UA_TYPES_DATAVALUE],
+                                          &pos, &end, NULL, NULL);
+        }
+    }
+
+    /* No DiagnosticInfos */
+    length = -1;
+    if(res == UA_STATUSCODE_GOOD)
+        res = UA_encodeBinaryInternal(&length, &UA_TYPES[UA_TYPES_INT32],
+                                      &pos, &end, NULL, NULL);
+    if(res != UA_STATUSCODE_GOOD)
+        UA_ByteString_clear(body);
+    return res;
+}
+
 /* The output counters are only set when the preparation is successful */
 static UA_StatusCode
 prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
@@ -65227,6 +66373,9 @@ prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
     size_t notificationDataIdx = 0;
     size_t dcnPos = 0; /* How many DataChangeNotifications? */
     UA_DataChangeNotification *dcn = NULL;
+    UA_NotificationInlineValue *inlineValues = NULL;
+    UA_EncodedDataValue **encodedValues = NULL;
+    size_t sharedEncodings = 0;
     if(sub->dataChangeNotifications > 0) {
         dcn = UA_DataChangeNotification_new();
         if(!dcn) {
@@ -65238,13 +66387,19 @@ prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
         size_t dcnSize = sub->dataChangeNotifications;
         if(dcnSize > maxNotifications)
             dcnSize = maxNotifications;
+        /* Inline values of the notifications are moved behind the array. They
+         * are freed together with the array. The shared encodings follow. */
         dcn->monitoredItems = (UA_MonitoredItemNotification*)
-            UA_Array_new(dcnSize, &UA_TYPES[UA_TYPES_MONITOREDITEMNOTIFICATION]);
+            UA_calloc(dcnSize, sizeof(UA_MonitoredItemNotification) +
+                      sizeof(UA_NotificationInlineValue) +
+                      sizeof(UA_EncodedDataValue*));
         if(!dcn->monitoredItems) {
             UA_NotificationMessage_clear(message);
             return UA_STATUSCODE_BADOUTOFMEMORY;
         }
         dcn->monitoredItemsSize = dcnSize;
+        inlineValues = (UA_NotificationInlineValue*)&dcn->monitoredItems[dcnSize];
+        encodedValues = (UA_EncodedDataValue**)&inlineValues[dcnSize];
         notificationDataIdx++;
     }
 
@@ -65299,7 +66454,15 @@ prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
         default:
             UA_assert(dcn != NULL); /* Have at least one change notification */
             dcn->monitoredItems[dcnPos] = notification->data.dataChange;
+            if(notification->data.dataChange.value.value.data == &notification->inlineValue) {
+                inlineValues[dcnPos] = notification->inlineValue;
+                dcn->monitoredItems[dcnPos].value.value.data = &inlineValues[dcnPos];
+            }
             UA_DataValue_init(&notification->data.dataChange.value);
+            encodedValues[dcnPos] = notification->encoded;
+            notification->encoded = NULL;
+            if(encodedValues[dcnPos])
+                sharedEncodings++;
             dcnPos++;
             break;
         }
@@ -65328,6 +66491,36 @@ prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
         }
     }
 
+    /* Send the DataChangeNotification as an encoded body that contains the
+     * shared encodings. Fall back to copies of the shared samples if that
+     * fails. */
+    if(sharedEncodings > 0) {
+        UA_ByteString body;
+        UA_StatusCode res = encodeDataChangeNotification(dcn, encodedValues, &body);
+        UA_StatusCode copyRes = UA_STATUSCODE_GOOD;
+        for(size_t i = 0; i < dcnPos; i++) {
+            if(!encodedValues[i])
+                continue;
+            if(res != UA_STATUSCODE_GOOD && copyRes == UA_STATUSCODE_GOOD)
+                copyRes = UA_DataValue_copy(&encodedValues[i]->value,
+                                            &dcn->monitoredItems[i].value);
+            UA_EncodedDataValue_release(encodedValues[i]);
+        }
+        /* Don't send empty DataValues for the samples that could not be copied */
+        if(copyRes != UA_STATUSCODE_GOOD) {
+            UA_NotificationMessage_clear(message);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        if(res == UA_STATUSCODE_GOOD) {
+            UA_ExtensionObject *eo = &message->notificationData[0];
+            UA_ExtensionObject_clear(eo);
+            eo->encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
+            eo->content.encoded.typeId =
+                UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION].binaryEncodingId;
+            eo->content.encoded.body = body;
+        }
+    }
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
     if(enl) {
         enl->eventsSize = enlPos;
@@ -65679,6 +66872,126 @@ UA_Session_reachedPublishReqLimit(UA_Server *server, UA_Session *session) {
     return true;
 }
 
+static void
+removePublishBucket(UA_Server *server, UA_PublishBucket *bucket) {
+    UA_assert(bucket->subscriptionsSize == 0);
+    removeCallback(server, bucket->callbackId);
+    LIST_REMOVE(bucket, listEntry);
+    UA_free(bucket);
+}
+
+/* Hold back the PublishResponses to the connection of the Subscription until
+ * the end of the pass. Returns the number of held connections. */
+static size_t
+holdPublishConnection(UA_Server *server, UA_Subscription *sub, size_t held) {
+    if(!sub->session || !sub->session->header.channel)
+        return held;
+    UA_Connection *connection = sub->session->header.channel->connection;
+    if(!connection || !connection->flush || connection->holdSend)
+        return held;
+    if(held == server->heldConnectionsSize) {
+        size_t size = held ? held * 2 : 16;
+        UA_Connection **connections = (UA_Connection**)
+            UA_realloc(server->heldConnections, size * sizeof(UA_Connection*));
+        if(!connections)
+            return held; /* Sent right away */
+        server->heldConnections = connections;
+        server->heldConnectionsSize = size;
+    }
+    connection->holdSend = true;
+    server->heldConnections[held] = connection;
+    return held + 1;
+}
+
+static void
+publishBucketCallback(UA_Server *server, UA_PublishBucket *bucket) {
+    UA_LOCK(&server->serviceMutex);
+
+    /* Publish all Subscriptions of the bucket in one pass. Subscriptions that
+     * joined less than half an interval ago wait for the next pass. A
+     * Subscription can be deleted when it is published. */
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    size_t held = 0;
+    bucket->publishing = true;
+    UA_Subscription *sub, *sub_tmp;
+    LIST_FOREACH_SAFE(sub, &bucket->subscriptions, publishBucketEntry, sub_tmp) {
+        if(sub->publishStart > now)
+            continue;
+        held = holdPublishConnection(server, sub, held);
+        UA_Subscription_sampleAndPublish(server, sub);
+    }
+    bucket->publishing = false;
+
+    /* Send the PublishResponses of each connection together */
+    for(size_t i = 0; i < held; i++) {
+        UA_Connection *connection = server->heldConnections[i];
+        connection->holdSend = false;
+        connection->flush(connection);
+    }
+
+    if(bucket->subscriptionsSize == 0)
+        removePublishBucket(server, bucket);
+
+    UA_UNLOCK(&server->serviceMutex);
+}
+
+/* Attach the Subscription to the bucket of its interval and the phase slot
+ * nearest to its own cycle. So every publish deviates by at most half a slot
+ * from the cycle of a Subscription with its own callback. A Subscription that
+ * is already in a bucket of another interval moves over. */
+static UA_StatusCode
+addToPublishBucket(UA_Server *server, UA_Subscription *sub) {
+    UA_DateTime interval = (UA_DateTime)(sub->publishingInterval * UA_DATETIME_MSEC);
+    if(interval <= 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_PublishBucket *old = sub->publishBucket;
+    if(old && old->interval == interval)
+        return UA_STATUSCODE_GOOD;
+
+    UA_DateTime granularity = (UA_DateTime)
+        (server->config.publishingGranularity * UA_DATETIME_MSEC);
+    UA_DateTime slots = (granularity > 0) ? interval / granularity : 1;
+    if(slots < 1)
+        slots = 1;
+    UA_DateTime width = interval / slots;
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    UA_DateTime phase = (((now % interval) + width / 2) / width) % slots * width;
+
+    UA_PublishBucket *bucket;
+    LIST_FOREACH(bucket, &server->publishBuckets, listEntry) {
+        if(bucket->interval == interval && bucket->phase == phase)
+            break;
+    }
+
+    if(!bucket) {
+        bucket = (UA_PublishBucket*)UA_calloc(1, sizeof(UA_PublishBucket));
+        if(!bucket)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        bucket->interval = interval;
+        bucket->phase = phase;
+        /* Keep the passes on the grid of the slot after a cycle miss */
+        UA_StatusCode res =
+            UA_Timer_addRepeatedCallback(&server->timer,
+                                         (UA_ApplicationCallback)publishBucketCallback,
+                                         server, bucket, sub->publishingInterval,
+                                         &phase, UA_TIMER_HANDLE_CYCLEMISS_WITH_BASETIME,
+                                         &bucket->callbackId);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_free(bucket);
+            return res;
+        }
+        LIST_INSERT_HEAD(&server->publishBuckets, bucket, listEntry);
+    }
+
+    if(old)
+        Subscription_unregisterPublishCallback(server, sub);
+    LIST_INSERT_HEAD(&bucket->subscriptions, sub, publishBucketEntry);
+    bucket->subscriptionsSize++;
+    sub->publishBucket = bucket;
+    sub->publishStart = now + interval / 2;
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 Subscription_registerPublishCallback(UA_Server *server, UA_Subscription *sub) {
     UA_LOG_DEBUG_SUBSCRIPTION(&server->config.logger, sub,
@@ -65688,6 +67001,9 @@ Subscription_registerPublishCallback(UA_Server *server, UA_Subscription *sub) {
     if(sub->publishCallbackId > 0)
         return UA_STATUSCODE_GOOD;
 
+    if(sub->publishBucket || server->config.publishingGranularity > 0.0)
+        return addToPublishBucket(server, sub);
+
     UA_StatusCode retval =
         addRepeatedCallback(server, (UA_ServerCallback)publishCallback,
                             sub, sub->publishingInterval, &sub->publishCallbackId);
@@ -65703,6 +67019,17 @@ Subscription_unregisterPublishCallback(UA_Server *server, UA_Subscription *sub)
     UA_LOG_DEBUG_SUBSCRIPTION(&server->config.logger, sub,
                               "Unregister subscription publishing callback");
 
+    /* A bucket that is in the middle of a pass is removed once it is done */
+    UA_PublishBucket *bucket = sub->publishBucket;
+    if(bucket) {
+        LIST_REMOVE(sub, publishBucketEntry);
+        sub->publishBucket = NULL;
+        bucket->subscriptionsSize--;
+        if(bucket->subscriptionsSize == 0 && !bucket->publishing)
+            removePublishBucket(server, bucket);
+        return;
+    }
+
     if(sub->publishCallbackId == 0)
         return;
 
@@ -65765,7 +67092,7 @@ createEventOverflowNotification(UA_Server *server, UA_Subscription *sub,
      * NodeId of the OverflowEventType. */
 
     /* Allocate the notification */
-    UA_Notification *overflowNotification = UA_Notification_new();
+    UA_Notification *overflowNotification = UA_Notification_new(sub);
     if(!overflowNotification)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
@@ -65775,7 +67102,7 @@ createEventOverflowNotification(UA_Server *server, UA_Subscription *sub,
     overflowNotification->data.event.clientHandle = mon->parameters.clientHandle;
     overflowNotification->data.event.eventFields = UA_Variant_new();
     if(!overflowNotification->data.event.eventFields) {
-        UA_free(overflowNotification);
+        UA_Notification_delete(overflowNotification);
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
     overflowNotification->data.event.eventFieldsSize = 1;
@@ -65840,9 +67167,12 @@ createEventOverflowNotification(UA_Server *server, UA_Subscription *sub,
 
 #endif
 
+static UA_StatusCode
+copyNotificationValue(UA_Notification *n, const UA_DataValue *value);
+
 /* Set the InfoBits that a datachange notification was removed */
 static void
-setOverflowInfoBits(UA_MonitoredItem *mon) {
+setOverflowInfoBits(UA_Server *server, UA_Subscription *sub, UA_MonitoredItem *mon) {
     /* Only for queues with more than one element */
     if(mon->parameters.queueSize == 1)
         return;
@@ -65855,6 +67185,20 @@ setOverflowInfoBits(UA_MonitoredItem *mon) {
     }
     UA_assert(indicator); /* must exist */
 
+    /* Take an own copy of a shared sample */
+    if(indicator->encoded) {
+        if(copyNotificationValue(indicator, &indicator->encoded->value) !=
+           UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING_SUBSCRIPTION(&server->config.logger, sub,
+                                        "MonitoredItem %" PRIi32 " | Could not copy "
+                                        "the shared sample. The overflow bit is "
+                                        "not set.", mon->monitoredItemId);
+            return;
+        }
+        UA_EncodedDataValue_release(indicator->encoded);
+        indicator->encoded = NULL;
+    }
+
     indicator->data.dataChange.value.hasStatus = true;
     indicator->data.dataChange.value.status |=
         (UA_STATUSCODE_INFOTYPE_DATAVALUE | UA_STATUSCODE_INFOBITS_OVERFLOW);
@@ -65881,14 +67225,97 @@ UA_MonitoredItem_removeOverflowInfoBits(UA_MonitoredItem *mon) {
         (UA_STATUSCODE_INFOTYPE_DATAVALUE | UA_STATUSCODE_INFOBITS_OVERFLOW);
 }
 
+UA_EncodedDataValue *
+UA_EncodedDataValue_new(const UA_DataValue *value) {
+    size_t size = UA_calcSizeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    if(size == 0)
+        return NULL;
+    UA_EncodedDataValue *ev = (UA_EncodedDataValue*)
+        UA_malloc(sizeof(UA_EncodedDataValue) + size);
+    if(!ev)
+        return NULL;
+    ev->refCount = 1;
+    ev->encoding.length = size;
+    ev->encoding.data = (UA_Byte*)&ev[1];
+    UA_Byte *pos = ev->encoding.data;
+    const UA_Byte *end = &ev->encoding.data[size];
+    UA_StatusCode res = UA_encodeBinaryInternal(value, &UA_TYPES[UA_TYPES_DATAVALUE],
+                                                &pos, &end, NULL, NULL);
+    if(res == UA_STATUSCODE_GOOD)
+        res = UA_DataValue_copy(value, &ev->value);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_free(ev);
+        return NULL;
+    }
+    return ev;
+}
+
+void
+UA_EncodedDataValue_release(UA_EncodedDataValue *ev) {
+    UA_assert(ev->refCount > 0);
+    if(--ev->refCount > 0)
+        return;
+    UA_DataValue_clear(&ev->value);
+    UA_free(ev);
+}
+
+UA_NotificationPool *
+UA_NotificationPool_new(void) {
+    return (UA_NotificationPool*)UA_calloc(1, sizeof(UA_NotificationPool));
+}
+
+void
+UA_NotificationPool_delete(UA_NotificationPool *pool) {
+    UA_assert(pool->used == 0);
+    UA_NotificationSlab *slab = pool->slabs;
+    while(slab) {
+        UA_NotificationSlab *next = slab->next;
+        UA_free(slab);
+        slab = next;
+    }
+    UA_free(pool);
+}
+
+/* Add a slab to the free list if it is empty */
+static UA_StatusCode
+UA_NotificationPool_reserve(UA_NotificationPool *pool) {
+    if(pool->freeList)
+        return UA_STATUSCODE_GOOD;
+    UA_NotificationSlab *slab = (UA_NotificationSlab*)
+        UA_malloc(sizeof(UA_NotificationSlab));
+    if(!slab)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    for(size_t i = UA_NOTIFICATIONSLAB_SIZE; i > 0; i--) {
+        UA_Notification *n = &slab->notifications[i - 1];
+        TAILQ_NEXT(n, localEntry) = pool->freeList;
+        pool->freeList = n;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_Notification *
-UA_Notification_new(void) {
-    UA_Notification *n = (UA_Notification*)UA_calloc(1, sizeof(UA_Notification));
-    if(n) {
-        /* Set the sentinel for a notification that is not enqueued */
-        TAILQ_NEXT(n, globalEntry) = UA_SUBSCRIPTION_QUEUE_SENTINEL;
-        TAILQ_NEXT(n, localEntry) = UA_SUBSCRIPTION_QUEUE_SENTINEL;
+UA_Notification_new(UA_Subscription *sub) {
+    UA_NotificationPool *pool = (sub) ? sub->notificationPool : NULL;
+    UA_Notification *n = NULL;
+    if(pool) {
+        if(UA_NotificationPool_reserve(pool) != UA_STATUSCODE_GOOD)
+            return NULL;
+        n = pool->freeList;
+        pool->freeList = TAILQ_NEXT(n, localEntry);
+        pool->used++;
+        memset(n, 0, sizeof(UA_Notification));
+        n->pool = pool;
+    } else {
+        n = (UA_Notification*)UA_calloc(1, sizeof(UA_Notification));
+        if(!n)
+            return NULL;
     }
+
+    /* Set the sentinel for a notification that is not enqueued */
+    TAILQ_NEXT(n, globalEntry) = UA_SUBSCRIPTION_QUEUE_SENTINEL;
+    TAILQ_NEXT(n, localEntry) = UA_SUBSCRIPTION_QUEUE_SENTINEL;
     return n;
 }
 
@@ -65911,10 +67338,22 @@ UA_Notification_delete(UA_Notification *n) {
 #endif
         default:
             UA_MonitoredItemNotification_clear(&n->data.dataChange);
+            if(n->encoded)
+                UA_EncodedDataValue_release(n->encoded);
             break;
         }
     }
-    UA_free(n);
+
+    /* Return to the pool */
+    UA_NotificationPool *pool = n->pool;
+    if(!pool) {
+        UA_free(n);
+        return;
+    }
+    UA_assert(pool->used > 0);
+    TAILQ_NEXT(n, localEntry) = pool->freeList;
+    pool->freeList = n;
+    pool->used--;
 }
 
 /* Add to the MonitoredItem queue, update all counters and then handle overflow */
@@ -66408,8 +67847,133 @@ UA_MonitoredItem_ensureQueueSpace(UA_Server *server, UA_MonitoredItem *mon) {
             createEventOverflowNotification(server, sub, mon);
         else
 #endif
-            setOverflowInfoBits(mon);
+            setOverflowInfoBits(server, sub, mon);
+    }
+}
+
+/* The application pushes changes of the node value. See
+ * UA_ServerConfig::monitoredItemPushSampling. */
+static UA_Boolean
+isPushSampled(UA_Server *server, UA_MonitoredItem *mon) {
+    if(!server->config.monitoredItemPushSampling ||
+       mon->itemToMonitor.attributeId != UA_ATTRIBUTEID_VALUE)
+        return false;
+    void *nodeContext = NULL;
+    getNodeContext(server, mon->itemToMonitor.nodeId, &nodeContext);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_Boolean pushed =
+        server->config.monitoredItemPushSampling(server, &mon->itemToMonitor.nodeId,
+                                                 nodeContext);
+    UA_LOCK(&server->serviceMutex);
+    return pushed;
+}
+
+static UA_UInt32
+samplerHash(const UA_MonitoredItem *mon) {
+    UA_UInt32 h = UA_NodeId_hash(&mon->itemToMonitor.nodeId);
+    h = UA_ByteString_hash(h, mon->itemToMonitor.indexRange.data,
+                           mon->itemToMonitor.indexRange.length);
+    h = UA_ByteString_hash(h, (const UA_Byte*)&mon->parameters.samplingInterval,
+                           sizeof(UA_Double));
+    return UA_ByteString_hash(h, (const UA_Byte*)&mon->timestampsToReturn,
+                              sizeof(UA_TimestampsToReturn));
+}
+
+static UA_Boolean
+samplerMatches(const UA_MonitoredItemSampler *sampler, UA_UInt32 hash,
+               const UA_MonitoredItem *mon) {
+    return sampler->hash == hash &&
+        sampler->samplingInterval == mon->parameters.samplingInterval &&
+        sampler->timestampsToReturn == mon->timestampsToReturn &&
+        UA_NodeId_equal(&sampler->itemToMonitor.nodeId, &mon->itemToMonitor.nodeId) &&
+        UA_String_equal(&sampler->itemToMonitor.indexRange,
+                        &mon->itemToMonitor.indexRange) &&
+        UA_QualifiedName_equal(&sampler->itemToMonitor.dataEncoding,
+                               &mon->itemToMonitor.dataEncoding);
+}
+
+/* Double the number of buckets when there are as many samplers as buckets */
+static UA_StatusCode
+growSamplers(UA_Server *server) {
+    if(server->samplersCount < server->samplersSize)
+        return UA_STATUSCODE_GOOD;
+    size_t size = server->samplersSize ? server->samplersSize * 2 : 64;
+    UA_MonitoredItemSampler **buckets = (UA_MonitoredItemSampler**)
+        UA_calloc(size, sizeof(UA_MonitoredItemSampler*));
+    if(!buckets)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < server->samplersSize; i++) {
+        UA_MonitoredItemSampler *sampler = server->samplers[i], *next;
+        for(; sampler; sampler = next) {
+            next = sampler->next;
+            size_t b = sampler->hash & (size - 1);
+            sampler->next = buckets[b];
+            buckets[b] = sampler;
+        }
+    }
+    UA_free(server->samplers);
+    server->samplers = buckets;
+    server->samplersSize = size;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Attach the MonitoredItem to the sampler of identical MonitoredItems. Create
+ * the sampler and its repeated callback if there is none yet. */
+static UA_StatusCode
+addSharedSampling(UA_Server *server, UA_MonitoredItem *mon) {
+    UA_UInt32 hash = samplerHash(mon);
+    UA_MonitoredItemSampler *sampler = NULL;
+    if(server->samplersSize > 0) {
+        sampler = server->samplers[hash & (server->samplersSize - 1)];
+        while(sampler && !samplerMatches(sampler, hash, mon))
+            sampler = sampler->next;
+    }
+
+    if(!sampler) {
+        UA_StatusCode res = growSamplers(server);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        sampler = (UA_MonitoredItemSampler*)UA_calloc(1, sizeof(UA_MonitoredItemSampler));
+        if(!sampler)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        sampler->hash = hash;
+        sampler->samplingInterval = mon->parameters.samplingInterval;
+        sampler->timestampsToReturn = mon->timestampsToReturn;
+        res = UA_ReadValueId_copy(&mon->itemToMonitor, &sampler->itemToMonitor);
+        if(res == UA_STATUSCODE_GOOD)
+            res = addRepeatedCallback(server,
+                                      (UA_ServerCallback)UA_MonitoredItemSampler_sampleCallback,
+                                      sampler, sampler->samplingInterval,
+                                      &sampler->callbackId);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_ReadValueId_clear(&sampler->itemToMonitor);
+            UA_free(sampler);
+            return res;
+        }
+        size_t b = hash & (server->samplersSize - 1);
+        sampler->next = server->samplers[b];
+        server->samplers[b] = sampler;
+        server->samplersCount++;
     }
+
+    LIST_INSERT_HEAD(&sampler->monitoredItems, mon, sampling.shared.listEntry);
+    sampler->monitoredItemsSize++;
+    mon->sampling.shared.sampler = sampler;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_MonitoredItemSampler_delete(UA_Server *server, UA_MonitoredItemSampler *sampler) {
+    UA_assert(sampler->monitoredItemsSize == 0);
+    removeCallback(server, sampler->callbackId);
+    UA_MonitoredItemSampler **prev =
+        &server->samplers[sampler->hash & (server->samplersSize - 1)];
+    while(*prev != sampler)
+        prev = &(*prev)->next;
+    *prev = sampler->next;
+    server->samplersCount--;
+    UA_ReadValueId_clear(&sampler->itemToMonitor);
+    UA_free(sampler);
 }
 
 UA_StatusCode
@@ -66423,7 +67987,7 @@ UA_MonitoredItem_registerSampling(UA_Server *server, UA_MonitoredItem *mon) {
     UA_StatusCode res = UA_STATUSCODE_GOOD;
     UA_Subscription *sub = mon->subscription;
     if(mon->itemToMonitor.attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER ||
-       mon->parameters.samplingInterval == 0.0) {
+       mon->parameters.samplingInterval == 0.0 || isPushSampled(server, mon)) {
         /* Add to the linked list in the node */
         UA_Session *session = &server->adminSession;
         if(sub)
@@ -66439,6 +68003,13 @@ UA_MonitoredItem_registerSampling(UA_Server *server, UA_MonitoredItem *mon) {
             return UA_STATUSCODE_BADINTERNALERROR; /* Not possible for local MonitoredItems */
         LIST_INSERT_HEAD(&sub->samplingMonitoredItems, mon, sampling.samplingListEntry);
         mon->samplingType = UA_MONITOREDITEMSAMPLINGTYPE_PUBLISH;
+    } else if(server->config.shareMonitoredItemSampling &&
+              mon->itemToMonitor.attributeId == UA_ATTRIBUTEID_VALUE) {
+        /* Attach to the cyclic sampler of identical MonitoredItems. Other
+         * attributes can depend on the locale of the session. */
+        res = addSharedSampling(server, mon);
+        if(res == UA_STATUSCODE_GOOD)
+            mon->samplingType = UA_MONITOREDITEMSAMPLINGTYPE_SHARED;
     } else {
         /* DataChange MonitoredItems with a positive sampling interval have a
          * repeated callback. Other MonitoredItems are attached to the Node in a
@@ -66480,6 +68051,17 @@ UA_MonitoredItem_unregisterSampling(UA_Server *server, UA_MonitoredItem *mon) {
         LIST_REMOVE(mon, sampling.samplingListEntry);
         break;
 
+    case UA_MONITOREDITEMSAMPLINGTYPE_SHARED: {
+        /* Attached to a shared sampler. A sampler that is currently handing
+         * out a sample is removed once it is done. */
+        UA_MonitoredItemSampler *sampler = mon->sampling.shared.sampler;
+        LIST_REMOVE(mon, sampling.shared.listEntry);
+        sampler->monitoredItemsSize--;
+        if(sampler->monitoredItemsSize == 0 && !sampler->sampling)
+            UA_MonitoredItemSampler_delete(server, sampler);
+        break;
+    }
+
     case UA_MONITOREDITEMSAMPLINGTYPE_NONE:
     default:
         /* Sampling is not registered */
@@ -66571,48 +68153,55 @@ UA_MonitoredItem_addLink(UA_Subscription *sub, UA_MonitoredItem *mon, UA_UInt32
 #ifdef UA_ENABLE_SUBSCRIPTIONS /* conditional compilation */
 
 /* Detect value changes outside the deadband */
-#define UA_DETECT_DEADBAND(TYPE) do {                           \
-    TYPE v1 = *(const TYPE*)data1;                              \
-    TYPE v2 = *(const TYPE*)data2;                              \
-    TYPE diff = (v1 > v2) ? (TYPE)(v1 - v2) : (TYPE)(v2 - v1);  \
-    return ((UA_Double)diff > deadband);                        \
-} while(false);
-
-static UA_Boolean
-detectScalarDeadBand(const void *data1, const void *data2,
-                     const UA_DataType *type, const UA_Double deadband) {
-    if(type->typeKind == UA_DATATYPEKIND_SBYTE) {
-        UA_DETECT_DEADBAND(UA_SByte);
-    } else if(type->typeKind == UA_DATATYPEKIND_BYTE) {
-        UA_DETECT_DEADBAND(UA_Byte);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT16) {
-        UA_DETECT_DEADBAND(UA_Int16);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT16) {
-        UA_DETECT_DEADBAND(UA_UInt16);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT32) {
-        UA_DETECT_DEADBAND(UA_Int32);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT32) {
-        UA_DETECT_DEADBAND(UA_UInt32);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT64) {
-        UA_DETECT_DEADBAND(UA_Int64);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT64) {
-        UA_DETECT_DEADBAND(UA_UInt64);
-    } else if(type->typeKind == UA_DATATYPEKIND_FLOAT) {
-        UA_DETECT_DEADBAND(UA_Float);
-    } else if(type->typeKind == UA_DATATYPEKIND_DOUBLE) {
-        UA_DETECT_DEADBAND(UA_Double);
-    } else {
-        return false; /* Not a known numerical type */
+#define UA_DETECT_DEADBAND(NAME, TYPE)                              \
+    static UA_Boolean                                               \
+    NAME(const void *data1, const void *data2,                      \
+         const UA_Double deadband) {                                \
+        TYPE v1 = *(const TYPE*)data1;                              \
+        TYPE v2 = *(const TYPE*)data2;                              \
+        TYPE diff = (v1 > v2) ? (TYPE)(v1 - v2) : (TYPE)(v2 - v1);  \
+        return ((UA_Double)diff > deadband);                        \
+    }
+
+UA_DETECT_DEADBAND(outsideDeadbandSByte, UA_SByte)
+UA_DETECT_DEADBAND(outsideDeadbandByte, UA_Byte)
+UA_DETECT_DEADBAND(outsideDeadbandInt16, UA_Int16)
+UA_DETECT_DEADBAND(outsideDeadbandUInt16, UA_UInt16)
+UA_DETECT_DEADBAND(outsideDeadbandInt32, UA_Int32)
+UA_DETECT_DEADBAND(outsideDeadbandUInt32, UA_UInt32)
+UA_DETECT_DEADBAND(outsideDeadbandInt64, UA_Int64)
+UA_DETECT_DEADBAND(outsideDeadbandUInt64, UA_UInt64)
+UA_DETECT_DEADBAND(outsideDeadbandFloat, UA_Float)
+UA_DETECT_DEADBAND(outsideDeadbandDouble, UA_Double)
+
+/* Returns NULL if the type is not a known numerical type */
+static UA_MonitoredItemOutsideDeadband
+resolveOutsideDeadband(const UA_DataType *type) {
+    switch(type->typeKind) {
+    case UA_DATATYPEKIND_SBYTE: return outsideDeadbandSByte;
+    case UA_DATATYPEKIND_BYTE: return outsideDeadbandByte;
+    case UA_DATATYPEKIND_INT16: return outsideDeadbandInt16;
+    case UA_DATATYPEKIND_UINT16: return outsideDeadbandUInt16;
+    case UA_DATATYPEKIND_INT32: return outsideDeadbandInt32;
+    case UA_DATATYPEKIND_UINT32: return outsideDeadbandUInt32;
+    case UA_DATATYPEKIND_INT64: return outsideDeadbandInt64;
+    case UA_DATATYPEKIND_UINT64: return outsideDeadbandUInt64;
+    case UA_DATATYPEKIND_FLOAT: return outsideDeadbandFloat;
+    case UA_DATATYPEKIND_DOUBLE: return outsideDeadbandDouble;
+    default: return NULL;
     }
 }
 
 static UA_Boolean
 detectVariantDeadband(const UA_Variant *value, const UA_Variant *oldValue,
+                      UA_MonitoredItemOutsideDeadband outsideDeadband,
                       const UA_Double deadbandValue) {
     if(value->arrayLength != oldValue->arrayLength)
         return true;
     if(value->type != oldValue->type)
         return true;
+    if(!outsideDeadband)
+        return false;
     size_t length = 1;
     if(!UA_Variant_isScalar(value))
         length = value->arrayLength;
@@ -66620,8 +68209,7 @@ detectVariantDeadband(const UA_Variant *value, const UA_Variant *oldValue,
     uintptr_t oldData = (uintptr_t)oldValue->data;
     UA_UInt32 memSize = value->type->memSize;
     for(size_t i = 0; i < length; ++i) {
-        if(detectScalarDeadBand((const void*)data, (const void*)oldData,
-                                value->type, deadbandValue))
+        if(outsideDeadband((const void*)data, (const void*)oldData, deadbandValue))
             return true;
         data += memSize;
         oldData += memSize;
@@ -66629,6 +68217,129 @@ detectVariantDeadband(const UA_Variant *value, const UA_Variant *oldValue,
     return false;
 }
 
+void
+UA_MonitoredItem_resolveDeadband(UA_MonitoredItem *mon) {
+    mon->deadband = 0.0;
+    mon->outsideDeadband = NULL;
+    const UA_ExtensionObject *filter = &mon->parameters.filter;
+    if(filter->content.decoded.type != &UA_TYPES[UA_TYPES_DATACHANGEFILTER] ||
+       !mon->valueChangedType || !UA_DataType_isNumeric(mon->valueChangedType))
+        return;
+    const UA_DataChangeFilter *dcf = (const UA_DataChangeFilter*)
+        filter->content.decoded.data;
+    if(dcf->deadbandType != UA_DEADBANDTYPE_ABSOLUTE ||
+       dcf->trigger == UA_DATACHANGETRIGGER_STATUS)
+        return;
+    mon->deadband = dcf->deadbandValue;
+    mon->outsideDeadband = resolveOutsideDeadband(mon->valueChangedType);
+}
+
+/* Comparators for the value of a MonitoredItem. They are resolved once for
+ * the type of the value when the MonitoredItem is created. Both variants have
+ * that type. Anything beyond scalars and plain arrays uses UA_order. */
+
+static UA_Boolean
+valueChangedGeneric(const UA_Variant *v1, const UA_Variant *v2) {
+    return (UA_order(v1, v2, &UA_TYPES[UA_TYPES_VARIANT]) != UA_ORDER_EQ);
+}
+
+/* Scalars or arrays without ArrayDimensions */
+static UA_Boolean
+isPlainVariant(const UA_Variant *v) {
+    return (v->arrayDimensionsSize == 0 && v->data > UA_EMPTY_ARRAY_SENTINEL);
+}
+
+/* Types without padding are equal if their memory is equal. Floating point
+ * types are excluded (NaN and signed zero). */
+static UA_Boolean
+valueChangedMemory(const UA_Variant *v1, const UA_Variant *v2) {
+    if(!isPlainVariant(v1) || !isPlainVariant(v2) ||
+       v1->arrayLength != v2->arrayLength)
+        return valueChangedGeneric(v1, v2);
+    size_t length = (v1->arrayLength > 0) ? v1->arrayLength : 1;
+    return (memcmp(v1->data, v2->data, length * v1->type->memSize) != 0);
+}
+
+#define UA_VALUECHANGED_BITS(NAME, TYPE)                                \
+    static UA_Boolean                                                   \
+    NAME(const UA_Variant *v1, const UA_Variant *v2) {                  \
+        if(!UA_Variant_isScalar(v1) || !UA_Variant_isScalar(v2) ||      \
+           v1->arrayDimensionsSize > 0 || v2->arrayDimensionsSize > 0)  \
+            return valueChangedMemory(v1, v2);                          \
+        return (*(const TYPE*)v1->data != *(const TYPE*)v2->data);      \
+    }
+
+UA_VALUECHANGED_BITS(valueChanged8, UA_Byte)
+UA_VALUECHANGED_BITS(valueChanged16, UA_UInt16)
+UA_VALUECHANGED_BITS(valueChanged32, UA_UInt32)
+UA_VALUECHANGED_BITS(valueChanged64, UA_UInt64)
+
+/* Same as UA_order: NaN equals NaN, -0.0 equals 0.0 */
+#define UA_VALUECHANGED_FLOAT(NAME, TYPE)                               \
+    static UA_Boolean                                                   \
+    NAME(const UA_Variant *v1, const UA_Variant *v2) {                  \
+        if(!UA_Variant_isScalar(v1) || !UA_Variant_isScalar(v2) ||      \
+           v1->arrayDimensionsSize > 0 || v2->arrayDimensionsSize > 0)  \
+            return valueChangedGeneric(v1, v2);                         \
+        TYPE f1 = *(const TYPE*)v1->data;                               \
+        TYPE f2 = *(const TYPE*)v2->data;                               \
+        return (f1 != f2 && (f1 == f1 || f2 == f2));                    \
+    }
+
+UA_VALUECHANGED_FLOAT(valueChangedFloat, UA_Float)
+UA_VALUECHANGED_FLOAT(valueChangedDouble, UA_Double)
+
+static UA_Boolean
+valueChangedString(const UA_Variant *v1, const UA_Variant *v2) {
+    if(!UA_Variant_isScalar(v1) || !UA_Variant_isScalar(v2) ||
+       v1->arrayDimensionsSize > 0 || v2->arrayDimensionsSize > 0)
+        return valueChangedGeneric(v1, v2);
+    const UA_String *s1 = (const UA_String*)v1->data;
+    const UA_String *s2 = (const UA_String*)v2->data;
+    if(s1->length != s2->length)
+        return true;
+    /* The null string differs from the empty string */
+    if(s1->length == 0)
+        return ((s1->data == NULL) != (s2->data == NULL));
+    return (memcmp(s1->data, s2->data, s1->length) != 0);
+}
+
+UA_MonitoredItemValueChanged
+UA_MonitoredItem_resolveValueChanged(const UA_DataType *type) {
+    if(!type)
+        return NULL;
+    switch(type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN:
+    case UA_DATATYPEKIND_SBYTE:
+    case UA_DATATYPEKIND_BYTE:
+        return valueChanged8;
+    case UA_DATATYPEKIND_INT16:
+    case UA_DATATYPEKIND_UINT16:
+        return valueChanged16;
+    case UA_DATATYPEKIND_INT32:
+    case UA_DATATYPEKIND_UINT32:
+    case UA_DATATYPEKIND_STATUSCODE:
+    case UA_DATATYPEKIND_ENUM:
+        return valueChanged32;
+    case UA_DATATYPEKIND_INT64:
+    case UA_DATATYPEKIND_UINT64:
+    case UA_DATATYPEKIND_DATETIME:
+        return valueChanged64;
+    case UA_DATATYPEKIND_FLOAT:
+        return valueChangedFloat;
+    case UA_DATATYPEKIND_DOUBLE:
+        return valueChangedDouble;
+    case UA_DATATYPEKIND_STRING:
+    case UA_DATATYPEKIND_BYTESTRING:
+    case UA_DATATYPEKIND_XMLELEMENT:
+        return valueChangedString;
+    default:
+        if(type->pointerFree && type->overlayable)
+            return valueChangedMemory; /* e.g. Guid */
+        return NULL;
+    }
+}
+
 static UA_Boolean
 detectValueChange(UA_Server *server, UA_MonitoredItem *mon,
                   const UA_DataValue *value) {
@@ -66658,10 +68369,16 @@ detectValueChange(UA_Server *server, UA_MonitoredItem *mon,
     UA_assert(trigger == UA_DATACHANGETRIGGER_STATUSVALUE ||
               trigger == UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP);
 
-    /* Test absolute deadband */
+    /* Test absolute deadband. Percentage deadbands were converted when the
+     * filter was set. Use the cached test if the sample has the resolved
+     * type. */
+    if(mon->outsideDeadband && value->value.type == mon->valueChangedType)
+        return detectVariantDeadband(&value->value, &mon->lastValue.value,
+                                     mon->outsideDeadband, mon->deadband);
     if(dcf && dcf->deadbandType == UA_DEADBANDTYPE_ABSOLUTE &&
        value->value.type != NULL && UA_DataType_isNumeric(value->value.type))
         return detectVariantDeadband(&value->value, &mon->lastValue.value,
+                                     resolveOutsideDeadband(value->value.type),
                                      dcf->deadbandValue);
 
     /* Compare the source timestamp if the trigger requires that */
@@ -66676,26 +68393,60 @@ detectValueChange(UA_Server *server, UA_MonitoredItem *mon,
     /* Has the value changed? */
     if(value->hasValue != mon->lastValue.hasValue)
         return true;
-    return (UA_order(&value->value, &mon->lastValue.value,
-                     &UA_TYPES[UA_TYPES_VARIANT]) != UA_ORDER_EQ);
+    if(mon->valueChanged && value->value.type == mon->valueChangedType &&
+       mon->lastValue.value.type == mon->valueChangedType)
+        return mon->valueChanged(&value->value, &mon->lastValue.value);
+    return valueChangedGeneric(&value->value, &mon->lastValue.value);
+}
+
+/* Fixed-size scalars are stored inline in the notification. Everything else is
+ * copied to the heap. */
+static UA_StatusCode
+copyNotificationValue(UA_Notification *n, const UA_DataValue *value) {
+    const UA_Variant *v = &value->value;
+    if(!value->hasValue || !UA_Variant_isScalar(v) || v->arrayDimensionsSize > 0 ||
+       !v->type->pointerFree || v->type->memSize > sizeof(UA_NotificationInlineValue))
+        return UA_DataValue_copy(value, &n->data.dataChange.value);
+
+    UA_DataValue *dst = &n->data.dataChange.value;
+    *dst = *value;
+    memcpy(&n->inlineValue, v->data, v->type->memSize);
+    dst->value.data = &n->inlineValue;
+    dst->value.storageType = UA_VARIANT_DATA_NODELETE;
+    return UA_STATUSCODE_GOOD;
 }
 
 UA_StatusCode
 UA_MonitoredItem_createDataChangeNotification(UA_Server *server, UA_Subscription *sub,
                                               UA_MonitoredItem *mon,
-                                              const UA_DataValue *value) {
+                                              const UA_DataValue *value,
+                                              UA_EncodedDataValue **encoded) {
     /* Allocate a new notification */
-    UA_Notification *newNotification = UA_Notification_new();
+    UA_Notification *newNotification = UA_Notification_new(sub);
     if(!newNotification)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     /* Prepare the notification */
     newNotification->mon = mon;
     newNotification->data.dataChange.clientHandle = mon->parameters.clientHandle;
-    UA_StatusCode retval = UA_DataValue_copy(value, &newNotification->data.dataChange.value);
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_free(newNotification);
-        return retval;
+
+    /* Share the sample and its encoding with the notifications of the other
+     * MonitoredItems. Otherwise copy the value and encode it with the
+     * PublishResponse. */
+    if(encoded && server->config.shareNotificationEncoding) {
+        if(!*encoded)
+            *encoded = UA_EncodedDataValue_new(value);
+        if(*encoded) {
+            (*encoded)->refCount++;
+            newNotification->encoded = *encoded;
+        }
+    }
+    if(!newNotification->encoded) {
+        UA_StatusCode retval = copyNotificationValue(newNotification, value);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_Notification_delete(newNotification);
+            return retval;
+        }
     }
 
     /* Enqueue the notification */
@@ -66704,27 +68455,18 @@ UA_MonitoredItem_createDataChangeNotification(UA_Server *server, UA_Subscription
     return UA_STATUSCODE_GOOD;
 }
 
-/* Moves the value to the MonitoredItem if successful */
-UA_StatusCode
-sampleCallbackWithValue(UA_Server *server, UA_Subscription *sub,
-                        UA_MonitoredItem *mon, UA_DataValue *value) {
-    UA_assert(mon->itemToMonitor.attributeId != UA_ATTRIBUTEID_EVENTNOTIFIER);
-
-    /* Has the value changed (with the filters applied)? */
-    UA_Boolean changed = detectValueChange(server, mon, value);
-    if(!changed) {
-        UA_LOG_DEBUG_SUBSCRIPTION(&server->config.logger, sub,
-                                  "MonitoredItem %" PRIi32 " | "
-                                  "The value has not changed", mon->monitoredItemId);
-        UA_DataValue_clear(value);
-        return UA_STATUSCODE_GOOD;
-    }
-
+/* Moves the changed value (see detectValueChange) to the MonitoredItem if
+ * successful */
+static UA_StatusCode
+sampleCallbackWithChangedValue(UA_Server *server, UA_Subscription *sub,
+                               UA_MonitoredItem *mon, UA_DataValue *value,
+                               UA_EncodedDataValue **encoded) {
     /* The MonitoredItem is attached to a subscription (not server-local).
      * Prepare a notification and enqueue it. */
     if(sub) {
         UA_StatusCode retval =
-            UA_MonitoredItem_createDataChangeNotification(server, sub, mon, value);
+            UA_MonitoredItem_createDataChangeNotification(server, sub, mon,
+                                                          value, encoded);
         if(retval != UA_STATUSCODE_GOOD)
             return retval;
     }
@@ -66753,6 +68495,26 @@ sampleCallbackWithValue(UA_Server *server, UA_Subscription *sub,
     return UA_STATUSCODE_GOOD;
 }
 
+/* Moves the value to the MonitoredItem if successful */
+UA_StatusCode
+sampleCallbackWithValue(UA_Server *server, UA_Subscription *sub,
+                        UA_MonitoredItem *mon, UA_DataValue *value,
+                        UA_EncodedDataValue **encoded) {
+    UA_assert(mon->itemToMonitor.attributeId != UA_ATTRIBUTEID_EVENTNOTIFIER);
+
+    /* Has the value changed (with the filters applied)? */
+    UA_Boolean changed = detectValueChange(server, mon, value);
+    if(!changed) {
+        UA_LOG_DEBUG_SUBSCRIPTION(&server->config.logger, sub,
+                                  "MonitoredItem %" PRIi32 " | "
+                                  "The value has not changed", mon->monitoredItemId);
+        UA_DataValue_clear(value);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    return sampleCallbackWithChangedValue(server, sub, mon, value, encoded);
+}
+
 void
 UA_MonitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem) {
     UA_LOCK(&server->serviceMutex);
@@ -66781,7 +68543,7 @@ monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem)
                                                    monitoredItem->timestampsToReturn);
 
     /* Operate on the sample. The sample is consumed when the status is good. */
-    UA_StatusCode res = sampleCallbackWithValue(server, sub, monitoredItem, &value);
+    UA_StatusCode res = sampleCallbackWithValue(server, sub, monitoredItem, &value, NULL);
     if(res != UA_STATUSCODE_GOOD) {
         UA_DataValue_clear(&value);
         UA_LOG_WARNING_SUBSCRIPTION(&server->config.logger, sub,
@@ -66792,6 +68554,174 @@ monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem)
     }
 }
 
+/* The Read service checks the AccessLevel of the variable and the
+ * UserAccessLevel of the session before it reads the value. The shared sample
+ * is read with the admin session, which skips both. */
+static UA_StatusCode
+sampleAccess(UA_Server *server, const UA_Node *node, UA_Session *session) {
+    if(!node || node->head.nodeClass != UA_NODECLASS_VARIABLE ||
+       session == &server->adminSession)
+        return UA_STATUSCODE_GOOD;
+    if(!(node->variableNode.accessLevel & UA_ACCESSLEVELMASK_READ))
+        return UA_STATUSCODE_BADNOTREADABLE;
+    if(!(getUserAccessLevel(server, session, &node->variableNode) & UA_ACCESSLEVELMASK_READ))
+        return UA_STATUSCODE_BADUSERACCESSDENIED;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_MonitoredItemSampler_sampleCallback(UA_Server *server, UA_MonitoredItemSampler *sampler) {
+    UA_LOCK(&server->serviceMutex);
+
+    /* One read for all attached MonitoredItems */
+    UA_DataValue value = UA_Server_readWithSession(server, &server->adminSession,
+                                                   &sampler->itemToMonitor,
+                                                   sampler->timestampsToReturn);
+    const UA_Node *node = UA_NODESTORE_GET(server, &sampler->itemToMonitor.nodeId);
+
+    /* MonitoredItems whose session may not read the value get the status of
+     * the denied read instead, like an unshared sample */
+    UA_DataValue denied;
+    UA_DataValue_init(&denied);
+    denied.hasStatus = true;
+    UA_Session *checkedSession = NULL;
+    UA_StatusCode checkedAccess = UA_STATUSCODE_GOOD;
+    UA_Boolean checked = false;
+
+    /* Only the MonitoredItems that see a change get their own copy. The local
+     * callback of a MonitoredItem may delete it. The notifications share one
+     * encoding of the sample if there is more than one MonitoredItem. */
+    UA_EncodedDataValue *encoded = NULL;
+    UA_EncodedDataValue **sharedEncoding =
+        (sampler->monitoredItemsSize > 1) ? &encoded : NULL;
+    sampler->sampling = true;
+    UA_MonitoredItem *mon, *mon_tmp;
+    LIST_FOREACH_SAFE(mon, &sampler->monitoredItems, sampling.shared.listEntry, mon_tmp) {
+        /* Consecutive MonitoredItems of the same session are checked once */
+        UA_Session *session = mon->subscription ?
+            mon->subscription->session : &server->adminSession;
+        if(!checked || session != checkedSession) {
+            checkedAccess = sampleAccess(server, node, session);
+            checkedSession = session;
+            checked = true;
+        }
+        UA_DataValue *sampled = &value;
+        UA_EncodedDataValue **sampledEncoding = sharedEncoding;
+        if(checkedAccess != UA_STATUSCODE_GOOD) {
+            denied.status = checkedAccess;
+            sampled = &denied;
+            sampledEncoding = NULL;
+        }
+
+        if(!detectValueChange(server, mon, sampled))
+            continue;
+        UA_DataValue sample;
+        UA_StatusCode res = UA_DataValue_copy(sampled, &sample);
+        if(res == UA_STATUSCODE_GOOD) {
+            res = sampleCallbackWithChangedValue(server, mon->subscription, mon,
+                                                 &sample, sampledEncoding);
+            if(res != UA_STATUSCODE_GOOD)
+                UA_DataValue_clear(&sample);
+        }
+        if(res != UA_STATUSCODE_GOOD)
+            UA_LOG_WARNING_SUBSCRIPTION(&server->config.logger, mon->subscription,
+                                        "MonitoredItem %" PRIi32 " | "
+                                        "Sampling returned the statuscode %s",
+                                        mon->monitoredItemId, UA_StatusCode_name(res));
+    }
+    sampler->sampling = false;
+    if(node)
+        UA_NODESTORE_RELEASE(server, node);
+    UA_DataValue_clear(&value);
+    if(encoded)
+        UA_EncodedDataValue_release(encoded);
+
+    if(sampler->monitoredItemsSize == 0)
+        UA_MonitoredItemSampler_delete(server, sampler);
+
+    UA_UNLOCK(&server->serviceMutex);
+}
+
+UA_StatusCode
+UA_Server_notifyDataChange(UA_Server *server, const UA_NodeId *nodeId,
+                           const UA_DataValue *value) {
+    UA_LOCK(&server->serviceMutex);
+    const UA_Node *node = UA_NODESTORE_GET(server, nodeId);
+    if(!node) {
+        UA_UNLOCK(&server->serviceMutex);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+
+    /* The MonitoredItems with the same TimestampsToReturn get identical
+     * samples. Their notifications share one encoding if there are several
+     * MonitoredItems. */
+    UA_DateTime now = UA_DateTime_now();
+    UA_EncodedDataValue *encoded[UA_TIMESTAMPSTORETURN_NEITHER + 1];
+    memset(encoded, 0, sizeof(encoded));
+    UA_MonitoredItem *mon = node->head.monitoredItems;
+    UA_Boolean share = (mon && mon->sampling.nodeListNext);
+
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_MonitoredItem *next;
+    for(; mon != NULL; mon = next) {
+        /* The local callback of a MonitoredItem may delete it */
+        next = mon->sampling.nodeListNext;
+        if(mon->itemToMonitor.attributeId != UA_ATTRIBUTEID_VALUE)
+            continue;
+
+        if(mon->itemToMonitor.indexRange.length > 0) {
+            monitoredItem_sampleCallback(server, mon);
+            continue;
+        }
+
+        UA_DataValue sample;
+        retval = UA_DataValue_copy(value, &sample);
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+
+        /* Same timestamp handling as in ReadWithNode */
+        UA_TimestampsToReturn ttr = mon->timestampsToReturn;
+        if(ttr == UA_TIMESTAMPSTORETURN_SERVER || ttr == UA_TIMESTAMPSTORETURN_BOTH) {
+            if(!sample.hasServerTimestamp) {
+                sample.serverTimestamp = now;
+                sample.hasServerTimestamp = true;
+            }
+        } else {
+            sample.hasServerTimestamp = false;
+        }
+        if(ttr == UA_TIMESTAMPSTORETURN_SERVER || ttr == UA_TIMESTAMPSTORETURN_NEITHER) {
+            sample.hasSourceTimestamp = false;
+            sample.hasSourcePicoseconds = false;
+        } else if(!sample.hasSourceTimestamp) {
+            sample.sourceTimestamp = now;
+            sample.hasSourceTimestamp = true;
+        }
+
+        UA_Subscription *sub = mon->subscription;
+        UA_EncodedDataValue **sharedEncoding =
+            (share && ttr <= UA_TIMESTAMPSTORETURN_NEITHER) ? &encoded[ttr] : NULL;
+        UA_StatusCode res = sampleCallbackWithValue(server, sub, mon, &sample,
+                                                    sharedEncoding);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_DataValue_clear(&sample);
+            UA_LOG_WARNING_SUBSCRIPTION(&server->config.logger, sub,
+                                        "MonitoredItem %" PRIi32 " | "
+                                        "Sampling returned the statuscode %s",
+                                        mon->monitoredItemId,
+                                        UA_StatusCode_name(res));
+        }
+    }
+
+    for(size_t i = 0; i <= UA_TIMESTAMPSTORETURN_NEITHER; i++) {
+        if(encoded[i])
+            UA_EncodedDataValue_release(encoded[i]);
+    }
+
+    UA_NODESTORE_RELEASE(server, node);
+    UA_UNLOCK(&server->serviceMutex);
+    return retval;
+}
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS */
 
 /**** amalgamated original file "/src/server/ua_subscription_events.c" ****/
@@ -66975,10 +68905,6 @@ eventSetStandardFields(UA_Server *server, const UA_NodeId *event,
 UA_StatusCode
 UA_Event_addEventToMonitoredItem(UA_Server *server, const UA_NodeId *event,
                                  UA_MonitoredItem *mon) {
-    UA_Notification *notification = UA_Notification_new();
-    if(!notification)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-
     if(mon->parameters.filter.content.decoded.type != &UA_TYPES[UA_TYPES_EVENTFILTER])
         return UA_STATUSCODE_BADFILTERNOTALLOWED;
     UA_EventFilter *eventFilter = (UA_EventFilter*)
@@ -66989,6 +68915,10 @@ UA_Event_addEventToMonitoredItem(UA_Server *server, const UA_NodeId *event,
     UA_Subscription *sub = mon->subscription;
     UA_assert(sub);
 
+    UA_Notification *notification = UA_Notification_new(sub);
+    if(!notification)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
     UA_Session *session = sub->session;
     UA_StatusCode retval = filterEvent(server, session, event,
                                        eventFilter, &notification->data.event,
@@ -78257,16 +80187,8 @@ static void
 cleanupEntry(NodeEntry *entry) {
     if(entry->refCount > 0)
         return;
-    if(entry->deleted) {
+    if(entry->deleted)
         deleteEntry(entry);
-        return;
-    }
-    UA_NodeHead *head = (UA_NodeHead*)&entry->nodeId;
-    for(size_t i = 0; i < head->referencesSize; i++) {
-        UA_NodeReferenceKind *rk = &head->references[i];
-        if(rk->targetsSize > 16 && !rk->hasRefTree)
-            UA_NodeReferenceKind_switch(rk);
-    }
 }
 
 /***********************/
@@ -78297,7 +80219,8 @@ zipNsGetNode(void *nsCtx, const UA_NodeId *nodeId) {
     NodeEntry *entry = ZIP_FIND(NodeTree, &ns->root, &dummy);
     if(!entry)
         return NULL;
-    ++entry->refCount;
+    /* Service workers get nodes concurrently */
+    __atomic_add_fetch(&entry->refCount, 1, __ATOMIC_RELAXED);
     return (const UA_Node*)&entry->nodeId;
 }
 
@@ -78307,8 +80230,8 @@ zipNsReleaseNode(void *nsCtx, const UA_Node *node) {
         return;
     NodeEntry *entry = container_of(node, NodeEntry, nodeId);
     UA_assert(entry->refCount > 0);
-    --entry->refCount;
-    cleanupEntry(entry);
+    if(__atomic_sub_fetch(&entry->refCount, 1, __ATOMIC_ACQ_REL) == 0)
+        cleanupEntry(entry);
 }
 
 static UA_StatusCode
@@ -78404,6 +80327,7 @@ zipNsInsertNode(void *nsCtx, UA_Node *node, UA_NodeId *addedNodeId) {
     }
 
     /* Insert the node */
+    switchLargeReferenceKinds(&node->head);
     entry->nodeIdHash = dummy.nodeIdHash;
     ZIP_INSERT(NodeTree, &ns->root, entry, UA_UInt32_random());
     return UA_STATUSCODE_GOOD;
@@ -78430,6 +80354,7 @@ zipNsReplaceNode(void *nsCtx, UA_Node *node) {
 
     /* Replace */
     ZipContext *ns = (ZipContext*)nsCtx;
+    switchLargeReferenceKinds(&node->head);
     ZIP_REMOVE(NodeTree, &ns->root, oldEntry);
     entry->nodeIdHash = oldEntry->nodeIdHash;
     ZIP_INSERT(NodeTree, &ns->root, entry, ZIP_RANK(entry, zipfields));
@@ -78731,15 +80656,8 @@ static void
 cleanupNodeMapEntry(UA_NodeMapEntry *entry) {
     if(entry->refCount > 0)
         return;
-    if(entry->deleted) {
+    if(entry->deleted)
         deleteNodeMapEntry(entry);
-        return;
-    }
-    for(size_t i = 0; i < entry->node.head.referencesSize; i++) {
-        UA_NodeReferenceKind *rk = &entry->node.head.references[i];
-        if(rk->targetsSize > 16 && !rk->hasRefTree)
-            UA_NodeReferenceKind_switch(rk);
-    }
 }
 
 static UA_NodeMapSlot *
@@ -78794,7 +80712,8 @@ UA_NodeMap_getNode(void *context, const UA_NodeId *nodeid) {
     UA_NodeMapSlot *slot = findOccupiedSlot(ns, nodeid);
     if(!slot)
         return NULL;
-    ++slot->entry->refCount;
+    /* Service workers get nodes concurrently */
+    __atomic_add_fetch(&slot->entry->refCount, 1, __ATOMIC_RELAXED);
     return &slot->entry->node;
 }
 
@@ -78805,8 +80724,8 @@ UA_NodeMap_releaseNode(void *context, const UA_Node *node) {
     UA_NodeMapEntry *entry = container_of(node, UA_NodeMapEntry, node);
     UA_assert(&entry->node == node);
     UA_assert(entry->refCount > 0);
-    --entry->refCount;
-    cleanupNodeMapEntry(entry);
+    if(__atomic_sub_fetch(&entry->refCount, 1, __ATOMIC_ACQ_REL) == 0)
+        cleanupNodeMapEntry(entry);
 }
 
 static UA_StatusCode
@@ -78939,6 +80858,7 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
     }
 
     /* Insert the node */
+    switchLargeReferenceKinds(&node->head);
     UA_NodeMapEntry *newEntry = container_of(node, UA_NodeMapEntry, node);
     slot->nodeIdHash = UA_NodeId_hash(&node->head.nodeId);
     UA_atomic_sync(); /* Set the hash first */
@@ -78967,6 +80887,7 @@ UA_NodeMap_replaceNode(void *context, UA_Node *node) {
     }
 
     /* Replace the entry */
+    switchLargeReferenceKinds(&node->head);
     slot->entry = newEntry;
     UA_atomic_sync();
     oldEntry->deleted = true;
@@ -81202,11 +83123,9 @@ connection_releaserecvbuffer(UA_Connection *connection,
 }
 
 static UA_StatusCode
-connection_write(UA_Connection *connection, UA_ByteString *buf) {
-    if(connection->state == UA_CONNECTIONSTATE_CLOSED) {
-        UA_ByteString_clear(buf);
+connection_writeAll(UA_Connection *connection, const UA_ByteString *buf) {
+    if(connection->state == UA_CONNECTIONSTATE_CLOSED)
         return UA_STATUSCODE_BADCONNECTIONCLOSED;
-    }
 
     /* Prevent OS signals when sending to a closed socket */
     int flags = 0;
@@ -81228,7 +83147,6 @@ connection_write(UA_Connection *connection, UA_ByteString *buf) {
             if(n<0) {
                 if(UA_ERRNO != UA_INTERRUPTED && UA_ERRNO != UA_AGAIN) {
                     connection->close(connection);
-                    UA_ByteString_clear(buf);
                     return UA_STATUSCODE_BADCONNECTIONCLOSED;
                 }
                 int poll_ret;
@@ -81240,10 +83158,15 @@ connection_write(UA_Connection *connection, UA_ByteString *buf) {
 
         nWritten += (size_t)n;
     } while(nWritten < buf->length);
+    return UA_STATUSCODE_GOOD;
+}
 
+static UA_StatusCode
+connection_write(UA_Connection *connection, UA_ByteString *buf) {
+    UA_StatusCode res = connection_writeAll(connection, buf);
     /* Free the buffer */
     UA_ByteString_clear(buf);
-    return UA_STATUSCODE_GOOD;
+    return res;
 }
 
 static UA_StatusCode
@@ -81324,11 +83247,197 @@ connection_recv(UA_Connection *connection, UA_ByteString *response,
 #define NOHELLOTIMEOUT 120000 /* timeout in ms before close the connection
                                * if server does not receive Hello Message */
 
+#define SENDBATCH_MAXCHUNKS 32
+
 typedef struct ConnectionEntry {
     UA_Connection connection;
     LIST_ENTRY(ConnectionEntry) pointers;
+    /* Chunks waiting to be sent together */
+    UA_ByteString pending[SENDBATCH_MAXCHUNKS];
+    size_t pendingCount;
 } ConnectionEntry;
 
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+/* Buffer pool of a server network layer. The send and receive buffers of all
+ * connections have the same size and are recycled instead of allocated per
+ * message. The layer is only used from the server thread, so the pool needs
+ * no locking. Every buffer is preceded by a cache line with its header. */
+
+#define BUFFERPOOL_HEADERSIZE 64
+#define BUFFERPOOL_SLABSIZE (2u * 1024u * 1024u) /* One huge page */
+#define BUFFERPOOL_DEFAULT_MAXRETAINED (4u * 1024u * 1024u)
+
+typedef struct PooledBuffer {
+    struct PooledBuffer *next; /* Free list */
+    void *allocation;          /* NULL if carved from a slab */
+    size_t capacity;
+} PooledBuffer;
+
+typedef struct BufferSlab {
+    struct BufferSlab *next;
+    void *memory;
+} BufferSlab;
+
+typedef struct {
+    size_t bufferSize;
+    size_t maxRetained;
+    UA_Boolean hugePages;
+    PooledBuffer *free;
+    size_t idleHeapBytes; /* Heap buffers in the free list */
+    BufferSlab *slabs;
+    size_t slabBytes;
+    UA_Byte *slabPos;     /* Unused rest of the newest slab */
+    UA_Byte *slabEnd;
+    UA_UInt64 hits;
+    UA_UInt64 misses;
+    UA_UInt64 drops;
+} BufferPool;
+
+static PooledBuffer *
+bufferPool_header(UA_Byte *data) {
+    return (PooledBuffer*)(uintptr_t)(data - BUFFERPOOL_HEADERSIZE);
+}
+
+#ifdef __linux__
+/* Huge page backed slab. Uses reserved huge pages if available and otherwise
+ * asks for transparent huge pages on an aligned mapping. */
+static void *
+bufferPool_mapSlab(void) {
+    void *mem = mmap(NULL, BUFFERPOOL_SLABSIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if(mem != MAP_FAILED)
+        return mem;
+    mem = mmap(NULL, 2 * BUFFERPOOL_SLABSIZE, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(mem == MAP_FAILED)
+        return NULL;
+    uintptr_t start = (uintptr_t)mem;
+    uintptr_t aligned = (start + BUFFERPOOL_SLABSIZE - 1) & ~(uintptr_t)(BUFFERPOOL_SLABSIZE - 1);
+    if(aligned > start)
+        munmap(mem, aligned - start);
+    if(aligned + BUFFERPOOL_SLABSIZE < start + 2 * BUFFERPOOL_SLABSIZE)
+        munmap((void*)(aligned + BUFFERPOOL_SLABSIZE),
+               start + 2 * BUFFERPOOL_SLABSIZE - aligned - BUFFERPOOL_SLABSIZE);
+    madvise((void*)aligned, BUFFERPOOL_SLABSIZE, MADV_HUGEPAGE);
+    return (void*)aligned;
+}
+#endif
+
+static UA_Byte *
+bufferPool_carve(BufferPool *pool) {
+#ifdef __linux__
+    size_t stride = BUFFERPOOL_HEADERSIZE + pool->bufferSize;
+    if(pool->slabPos + stride > pool->slabEnd) {
+        if(pool->slabBytes + BUFFERPOOL_SLABSIZE > pool->maxRetained ||
+           stride > BUFFERPOOL_SLABSIZE)
+            return NULL;
+        BufferSlab *slab = (BufferSlab*)UA_malloc(sizeof(BufferSlab));
+        if(!slab)
+            return NULL;
+        slab->memory = bufferPool_mapSlab();
+        if(!slab->memory) {
+            UA_free(slab);
+            return NULL;
+        }
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+        pool->slabBytes += BUFFERPOOL_SLABSIZE;
+        pool->slabPos = (UA_Byte*)slab->memory;
+        pool->slabEnd = pool->slabPos + BUFFERPOOL_SLABSIZE;
+    }
+    PooledBuffer *b = (PooledBuffer*)pool->slabPos;
+    pool->slabPos += stride;
+    b->allocation = NULL;
+    b->capacity = pool->bufferSize;
+    return (UA_Byte*)b + BUFFERPOOL_HEADERSIZE;
+#else
+    return NULL;
+#endif
+}
+
+static UA_StatusCode
+bufferPool_get(BufferPool *pool, size_t length, UA_ByteString *buf) {
+    if(pool->free && length <= pool->bufferSize) {
+        PooledBuffer *b = pool->free;
+        pool->free = b->next;
+        if(b->allocation)
+            pool->idleHeapBytes -= b->capacity;
+        pool->hits++;
+        buf->data = (UA_Byte*)b + BUFFERPOOL_HEADERSIZE;
+        buf->length = length;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    pool->misses++;
+    UA_Byte *data = NULL;
+    if(pool->hugePages && length <= pool->bufferSize)
+        data = bufferPool_carve(pool);
+    if(!data) {
+        /* Over-allocate to align the buffer to the cache line */
+        size_t capacity = length > pool->bufferSize ? length : pool->bufferSize;
+        void *allocation = UA_malloc(capacity + 2 * BUFFERPOOL_HEADERSIZE);
+        if(!allocation)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        uintptr_t aligned = ((uintptr_t)allocation + BUFFERPOOL_HEADERSIZE - 1) &
+            ~(uintptr_t)(BUFFERPOOL_HEADERSIZE - 1);
+        PooledBuffer *b = (PooledBuffer*)aligned;
+        b->allocation = allocation;
+        b->capacity = capacity;
+        data = (UA_Byte*)b + BUFFERPOOL_HEADERSIZE;
+    }
+    buf->data = data;
+    buf->length = length;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+bufferPool_release(BufferPool *pool, UA_ByteString *buf) {
+    if(!buf->data)
+        return;
+    PooledBuffer *b = bufferPool_header(buf->data);
+    buf->data = NULL;
+    buf->length = 0;
+
+    /* Slab buffers always go back. Heap buffers only if they have the pool
+     * size and the retained memory stays below the cap. */
+    if(b->allocation) {
+        if(b->capacity != pool->bufferSize ||
+           pool->slabBytes + pool->idleHeapBytes + b->capacity > pool->maxRetained) {
+            pool->drops++;
+            UA_free(b->allocation);
+            return;
+        }
+        pool->idleHeapBytes += b->capacity;
+    }
+    b->next = pool->free;
+    pool->free = b;
+}
+
+static void
+bufferPool_clear(BufferPool *pool) {
+    while(pool->free) {
+        PooledBuffer *b = pool->free;
+        pool->free = b->next;
+        if(b->allocation)
+            UA_free(b->allocation);
+    }
+    pool->idleHeapBytes = 0;
+#ifdef __linux__
+    while(pool->slabs) {
+        BufferSlab *slab = pool->slabs;
+        pool->slabs = slab->next;
+        munmap(slab->memory, BUFFERPOOL_SLABSIZE);
+        UA_free(slab);
+    }
+#endif
+    pool->slabBytes = 0;
+    pool->slabPos = NULL;
+    pool->slabEnd = NULL;
+}
+
 typedef struct {
     const UA_Logger *logger;
     UA_UInt16 port;
@@ -81337,10 +83446,181 @@ typedef struct {
     UA_UInt16 serverSocketsSize;
     LIST_HEAD(, ConnectionEntry) connections;
     UA_UInt16 connectionsSize;
+    BufferPool pool;
+    UA_Boolean batchSend;
+    UA_Boolean reusePort;
+    UA_UInt16 addressShards; /* Select the listening socket by client address */
+    UA_Connection *processing; /* Receiving connection, answers are collected */
 } ServerNetworkLayerTCP;
 
+static UA_StatusCode
+ServerNetworkLayerTCP_getSendBuffer(UA_Connection *connection,
+                                    size_t length, UA_ByteString *buf) {
+    UA_SecureChannel *channel = connection->channel;
+    if(channel && channel->config.sendBufferSize < length)
+        return UA_STATUSCODE_BADCOMMUNICATIONERROR;
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)connection->handle;
+    return bufferPool_get(&layer->pool, length, buf);
+}
+
+static void
+ServerNetworkLayerTCP_releaseBuffer(UA_Connection *connection,
+                                    UA_ByteString *buf) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)connection->handle;
+    bufferPool_release(&layer->pool, buf);
+}
+
+static void
+ServerNetworkLayerTCP_dropPending(ServerNetworkLayerTCP *layer, ConnectionEntry *e) {
+    for(size_t i = 0; i < e->pendingCount; i++)
+        bufferPool_release(&layer->pool, &e->pending[i]);
+    e->pendingCount = 0;
+}
+
+/* Send the pending chunks of a connection with a single sendmsg (repeated only
+ * for partial writes) and return the buffers to the pool */
+static UA_StatusCode
+ServerNetworkLayerTCP_flush(ServerNetworkLayerTCP *layer, ConnectionEntry *e) {
+    if(e->pendingCount == 0)
+        return UA_STATUSCODE_GOOD;
+    UA_Connection *connection = &e->connection;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(connection->state == UA_CONNECTIONSTATE_CLOSED) {
+        res = UA_STATUSCODE_BADCONNECTIONCLOSED;
+    } else {
+#ifdef UA_ARCHITECTURE_POSIX
+        struct iovec iov[SENDBATCH_MAXCHUNKS];
+        for(size_t i = 0; i < e->pendingCount; i++) {
+            iov[i].iov_base = e->pending[i].data;
+            iov[i].iov_len = e->pending[i].length;
+        }
+        size_t first = 0;
+        while(first < e->pendingCount) {
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(struct msghdr));
+            msg.msg_iov = &iov[first];
+            msg.msg_iovlen = e->pendingCount - first;
+            ssize_t n = sendmsg(connection->sockfd, &msg, MSG_NOSIGNAL);
+            if(n < 0) {
+                if(UA_ERRNO == UA_INTERRUPTED)
+                    continue;
+                if(UA_ERRNO != UA_AGAIN && UA_ERRNO != UA_WOULDBLOCK) {
+                    res = UA_STATUSCODE_BADCONNECTIONCLOSED;
+                    break;
+                }
+                /* Wait until the socket can take more */
+                struct pollfd poll_fd[1];
+                poll_fd[0].fd = connection->sockfd;
+                poll_fd[0].events = UA_POLLOUT;
+                int poll_ret;
+                do {
+                    poll_ret = UA_poll(poll_fd, 1, 1000);
+                } while(poll_ret == 0 || (poll_ret < 0 && UA_ERRNO == UA_INTERRUPTED));
+                continue;
+            }
+
+            /* Skip what was written */
+            size_t written = (size_t)n;
+            while(first < e->pendingCount && written >= iov[first].iov_len) {
+                written -= iov[first].iov_len;
+                first++;
+            }
+            if(written > 0) {
+                iov[first].iov_base = (UA_Byte*)iov[first].iov_base + written;
+                iov[first].iov_len -= written;
+            }
+        }
+#else
+        for(size_t i = 0; i < e->pendingCount && res == UA_STATUSCODE_GOOD; i++)
+            res = connection_writeAll(connection, &e->pending[i]);
+#endif
+    }
+
+    ServerNetworkLayerTCP_dropPending(layer, e);
+    if(res != UA_STATUSCODE_GOOD)
+        connection->close(connection);
+    return res;
+}
+
+/* The chunks of a message are sent together after the final chunk. The
+ * answers to a received buffer are collected until it is processed, and the
+ * messages to a held connection until it is flushed. */
+static UA_StatusCode
+ServerNetworkLayerTCP_send(UA_Connection *connection, UA_ByteString *buf) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)connection->handle;
+    if(!layer->batchSend) {
+        UA_StatusCode res = connection_writeAll(connection, buf);
+        ServerNetworkLayerTCP_releaseBuffer(connection, buf);
+        return res;
+    }
+
+    if(connection->state == UA_CONNECTIONSTATE_CLOSED) {
+        ServerNetworkLayerTCP_releaseBuffer(connection, buf);
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    }
+
+    ConnectionEntry *e = (ConnectionEntry*)connection;
+    UA_Boolean finalChunk = (buf->length < 4 || buf->data[3] != 'C');
+    e->pending[e->pendingCount++] = *buf;
+    buf->data = NULL;
+    buf->length = 0;
+    if(e->pendingCount < SENDBATCH_MAXCHUNKS &&
+       (!finalChunk || connection == layer->processing || connection->holdSend))
+        return UA_STATUSCODE_GOOD;
+    return ServerNetworkLayerTCP_flush(layer, e);
+}
+
+static UA_StatusCode
+ServerNetworkLayerTCP_flushConnection(UA_Connection *connection) {
+    return ServerNetworkLayerTCP_flush((ServerNetworkLayerTCP*)connection->handle,
+                                       (ConnectionEntry*)connection);
+}
+
+static size_t
+connection_recvBufferSize(const UA_Connection *connection) {
+    size_t bufferSize = 16384; /* Use as default for a new SecureChannel */
+    UA_SecureChannel *channel = connection->channel;
+    if(channel && channel->config.recvBufferSize > 0)
+        bufferSize = channel->config.recvBufferSize;
+    return bufferSize;
+}
+
+/* Receive into a buffer of the pool. The socket was reported readable, so no
+ * additional select is needed. Returns an empty buffer if there was no data
+ * after all. The buffer is returned with bufferPool_release. */
+static UA_StatusCode
+ServerNetworkLayerTCP_recv(ServerNetworkLayerTCP *layer, UA_Connection *connection,
+                           size_t bufferSize, UA_ByteString *buf) {
+    if(connection->state == UA_CONNECTIONSTATE_CLOSED)
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    UA_StatusCode res = bufferPool_get(&layer->pool, bufferSize, buf);
+    if(res != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOOD; /* Retried with the next activity */
+
+    ssize_t ret;
+    do {
+        ret = UA_recv(connection->sockfd, (char*)buf->data, bufferSize, 0);
+    } while(ret < 0 && UA_ERRNO == UA_INTERRUPTED);
+
+    if(ret > 0) {
+        buf->length = (size_t)ret;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    int err = UA_ERRNO; /* Releasing may overwrite errno */
+    bufferPool_release(&layer->pool, buf);
+    if(ret < 0 && (err == UA_AGAIN || err == UA_WOULDBLOCK))
+        return UA_STATUSCODE_GOOD; /* statuscode_good but no data -> retry */
+
+    /* Closed by the remote side or an unrecoverable error */
+    connection->close(connection);
+    return UA_STATUSCODE_BADCONNECTIONCLOSED;
+}
+
 static void
 ServerNetworkLayerTCP_freeConnection(UA_Connection *connection) {
+    ServerNetworkLayerTCP_dropPending((ServerNetworkLayerTCP*)connection->handle,
+                                      (ConnectionEntry*)connection);
     UA_free(connection);
 }
 
@@ -81354,6 +83634,16 @@ ServerNetworkLayerTCP_close(UA_Connection *connection) {
     connection->state = UA_CONNECTIONSTATE_CLOSED;
 }
 
+/* Send pending chunks (e.g. an error message) before the shutdown */
+static void
+ServerNetworkLayerTCP_flushClose(UA_Connection *connection) {
+    if(connection->state == UA_CONNECTIONSTATE_CLOSED)
+        return;
+    ServerNetworkLayerTCP_flush((ServerNetworkLayerTCP*)connection->handle,
+                                (ConnectionEntry*)connection);
+    ServerNetworkLayerTCP_close(connection);
+}
+
 static UA_Boolean
 purgeFirstConnectionWithoutChannel(ServerNetworkLayerTCP *layer) {
     ConnectionEntry *e;
@@ -81421,14 +83711,16 @@ ServerNetworkLayerTCP_add(UA_ServerNetworkLayer *nl, ServerNetworkLayerTCP *laye
 
     UA_Connection *c = &e->connection;
     memset(c, 0, sizeof(UA_Connection));
+    e->pendingCount = 0;
     c->sockfd = newsockfd;
     c->handle = layer;
-    c->send = connection_write;
-    c->close = ServerNetworkLayerTCP_close;
+    c->send = ServerNetworkLayerTCP_send;
+    c->close = ServerNetworkLayerTCP_flushClose;
     c->free = ServerNetworkLayerTCP_freeConnection;
-    c->getSendBuffer = connection_getsendbuffer;
-    c->releaseSendBuffer = connection_releasesendbuffer;
-    c->releaseRecvBuffer = connection_releaserecvbuffer;
+    c->flush = ServerNetworkLayerTCP_flushConnection;
+    c->getSendBuffer = ServerNetworkLayerTCP_getSendBuffer;
+    c->releaseSendBuffer = ServerNetworkLayerTCP_releaseBuffer;
+    c->releaseRecvBuffer = ServerNetworkLayerTCP_releaseBuffer;
     c->state = UA_CONNECTIONSTATE_OPENING;
     c->openingDate = UA_DateTime_nowMonotonic();
 
@@ -81443,6 +83735,34 @@ ServerNetworkLayerTCP_add(UA_ServerNetworkLayer *nl, ServerNetworkLayerTCP *laye
     return UA_STATUSCODE_GOOD;
 }
 
+#if defined(__linux__) && defined(SO_REUSEPORT)
+
+#include <linux/filter.h>
+
+/* The kernel runs the program on the SYN of a new connection and uses the
+ * result as the index of the listening socket in the SO_REUSEPORT group. The
+ * network header is addressed relative to SKF_NET_OFF. For IPv6 only the last
+ * four bytes of the source address are used. */
+static void
+attachAddressShardFilter(ServerNetworkLayerTCP *layer, UA_SOCKET sock, int family) {
+    UA_UInt32 srcOffset = (family == AF_INET) ? 12 : 20;
+    struct sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, (UA_UInt32)SKF_NET_OFF + srcOffset),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, layer->addressShards),
+        BPF_STMT(BPF_RET | BPF_A, 0)
+    };
+    struct sock_fprog program = {(unsigned short)(sizeof(code) / sizeof(code[0])), code};
+    if(UA_setsockopt(sock, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+                     (const char*)&program, sizeof(program)) == -1) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_WARNING(layer->logger, UA_LOGCATEGORY_NETWORK,
+                           "Could not select the listening socket by the "
+                           "client address: %s", errno_str));
+    }
+}
+
+#endif
+
 static UA_StatusCode
 addServerSocket(ServerNetworkLayerTCP *layer, struct addrinfo *ai) {
     /* Create the server socket */
@@ -81479,6 +83799,18 @@ addServerSocket(ServerNetworkLayerTCP *layer, struct addrinfo *ai) {
         return UA_STATUSCODE_BADCOMMUNICATIONERROR;
     }
 
+#if defined(__linux__) && defined(SO_REUSEPORT)
+    /* Other network layers may listen on the same port */
+    if(layer->reusePort) {
+        if(UA_setsockopt(newsock, SOL_SOCKET, SO_REUSEPORT,
+                         (const char *)&optval, sizeof(optval)) == -1) {
+            UA_LOG_WARNING(layer->logger, UA_LOGCATEGORY_NETWORK,
+                           "Could not share the port of the socket");
+            UA_close(newsock);
+            return UA_STATUSCODE_BADCOMMUNICATIONERROR;
+        }
+    }
+#endif
 
     if(UA_socket_set_nonblocking(newsock) != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING(layer->logger, UA_LOGCATEGORY_NETWORK,
@@ -81534,6 +83866,13 @@ addServerSocket(ServerNetworkLayerTCP *layer, struct addrinfo *ai) {
         return UA_STATUSCODE_BADCOMMUNICATIONERROR;
     }
 
+#if defined(__linux__) && defined(SO_REUSEPORT)
+    /* Attached once the socket has joined the SO_REUSEPORT group. An unbound
+     * socket would get a group of its own. */
+    if(layer->reusePort && layer->addressShards > 1)
+        attachAddressShardFilter(layer, newsock, ai->ai_family);
+#endif
+
     if(layer->port == 0) {
         /* Port was automatically chosen. Read it from the OS */
         struct sockaddr_in returned_addr;
@@ -81556,6 +83895,16 @@ ServerNetworkLayerTCP_start(UA_ServerNetworkLayer *nl, const UA_Logger *logger,
     ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
     layer->logger = logger;
 
+    /* All pooled buffers have the size of the largest message chunk */
+    size_t bufferSize = 16384;
+    if(nl->localConnectionConfig.sendBufferSize > bufferSize)
+        bufferSize = nl->localConnectionConfig.sendBufferSize;
+    if(nl->localConnectionConfig.recvBufferSize > bufferSize)
+        bufferSize = nl->localConnectionConfig.recvBufferSize;
+    bufferPool_clear(&layer->pool);
+    layer->pool.bufferSize = (bufferSize + BUFFERPOOL_HEADERSIZE - 1) &
+        ~(size_t)(BUFFERPOOL_HEADERSIZE - 1);
+
     /* Get addrinfo of the server and create server sockets */
     char hostname[512];
     if(customHostname->length) {
@@ -81662,6 +84011,11 @@ ServerNetworkLayerTCP_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
     fd_set fdset, errset;
     UA_Int32 highestfd = setFDSet(layer, &fdset);
     setFDSet(layer, &errset);
+    if(nl->onWakeup) {
+        UA_fd_set(nl->wakeupFd, &fdset);
+        if((UA_Int32)nl->wakeupFd > highestfd)
+            highestfd = (UA_Int32)nl->wakeupFd;
+    }
     struct timeval tmptv = {0, timeout * 1000};
     if(UA_select(highestfd+1, &fdset, NULL, &errset, &tmptv) < 0) {
         UA_LOG_SOCKET_ERRNO_WRAP(
@@ -81671,6 +84025,16 @@ ServerNetworkLayerTCP_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
         return UA_STATUSCODE_GOOD;
     }
 
+    /* Wake-up from another thread */
+    if(nl->onWakeup && UA_fd_isset(nl->wakeupFd, &fdset)) {
+        uint64_t counter;
+        if(read(nl->wakeupFd, &counter, sizeof(counter)) < 0) {
+            UA_LOG_DEBUG(layer->logger, UA_LOGCATEGORY_NETWORK,
+                         "Reading the wake-up descriptor failed");
+        }
+        nl->onWakeup(server, nl->wakeupContext);
+    }
+
     /* Accept new connections via the server sockets */
     for(UA_UInt16 i = 0; i < layer->serverSocketsSize; i++) {
         if(!UA_fd_isset(layer->serverSockets[i], &fdset))
@@ -81721,12 +84085,19 @@ ServerNetworkLayerTCP_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
                     (int)(e->connection.sockfd));
 
         UA_ByteString buf = UA_BYTESTRING_NULL;
-        UA_StatusCode retval = connection_recv(&e->connection, &buf, 0);
+        UA_StatusCode retval =
+            ServerNetworkLayerTCP_recv(layer, &e->connection,
+                                       connection_recvBufferSize(&e->connection), &buf);
 
         if(retval == UA_STATUSCODE_GOOD) {
-            /* Process packets */
-            UA_Server_processBinaryMessage(server, &e->connection, &buf);
-            connection_releaserecvbuffer(&e->connection, &buf);
+            /* Process packets. Send the answers together. */
+            if(buf.length > 0) {
+                layer->processing = &e->connection;
+                UA_Server_processBinaryMessage(server, &e->connection, &buf);
+                layer->processing = NULL;
+                ServerNetworkLayerTCP_flush(layer, e);
+            }
+            bufferPool_release(&layer->pool, &buf);
         } else if(retval == UA_STATUSCODE_BADCONNECTIONCLOSED) {
             /* The socket is shutdown but not closed */
             UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
@@ -81782,6 +84153,7 @@ ServerNetworkLayerTCP_clear(UA_ServerNetworkLayer *nl) {
         LIST_REMOVE(e, pointers);
         layer->connectionsSize--;
         UA_close(e->connection.sockfd);
+        ServerNetworkLayerTCP_dropPending(layer, e);
         UA_free(e);
         if(nl->statistics) {
             nl->statistics->currentConnectionCount--;
@@ -81789,6 +84161,7 @@ ServerNetworkLayerTCP_clear(UA_ServerNetworkLayer *nl) {
     }
 
     /* Free the layer */
+    bufferPool_clear(&layer->pool);
     UA_free(layer);
 }
 
@@ -81812,10 +84185,1435 @@ UA_ServerNetworkLayerTCP(UA_ConnectionConfig config, UA_UInt16 port,
 
     layer->port = port;
     layer->maxConnections = maxConnections;
+    layer->pool.maxRetained = BUFFERPOOL_DEFAULT_MAXRETAINED;
+    layer->batchSend = true;
+
+    return nl;
+}
+
+void
+UA_ServerNetworkLayerTCP_setSendBatching(UA_ServerNetworkLayer *nl,
+                                         UA_Boolean enabled) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)nl->handle;
+    if(layer)
+        layer->batchSend = enabled;
+}
+
+void
+UA_ServerNetworkLayerTCP_setReusePort(UA_ServerNetworkLayer *nl,
+                                      UA_Boolean enabled,
+                                      UA_UInt16 addressShards) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)nl->handle;
+    if(!layer)
+        return;
+    layer->reusePort = enabled;
+    layer->addressShards = enabled ? addressShards : 0;
+}
+
+void
+UA_ServerNetworkLayerTCP_setBufferPool(UA_ServerNetworkLayer *nl,
+                                       size_t maxRetainedBytes,
+                                       UA_Boolean hugePages) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)nl->handle;
+    if(!layer)
+        return;
+    layer->pool.maxRetained = maxRetainedBytes;
+    layer->pool.hugePages = hugePages;
+}
+
+void
+UA_ServerNetworkLayerTCP_getBufferPoolStatistics(const UA_ServerNetworkLayer *nl,
+                                                 UA_BufferPoolStatistics *stats) {
+    memset(stats, 0, sizeof(UA_BufferPoolStatistics));
+    const ServerNetworkLayerTCP *layer = (const ServerNetworkLayerTCP*)nl->handle;
+    if(!layer)
+        return;
+    stats->hits = layer->pool.hits;
+    stats->misses = layer->pool.misses;
+    stats->drops = layer->pool.drops;
+    stats->retainedBytes = layer->pool.slabBytes + layer->pool.idleHeapBytes;
+    stats->maxRetainedBytes = layer->pool.maxRetained;
+    stats->hugePages = (layer->pool.slabBytes > 0);
+}
+
+#ifdef __linux__
+
+/*****************************/
+/* Server NetworkLayer epoll */
+/*****************************/
+
+/* Alternative to the select-based layer for many concurrent connections. The
+ * sockets are registered edge-triggered with an epoll instance, so that a
+ * wake-up only visits the sockets with activity. Connections are found by
+ * their file descriptor. New connections are accepted with accept4 until the
+ * backlog is empty. */
+
+#include <sys/epoll.h>
+
+/* Only declared with _GNU_SOURCE, which the POSIX feature flags do not set */
+extern int accept4(int sockfd, struct sockaddr *addr, socklen_t *addrlen, int flags);
+
+#define EPOLL_MAXEVENTS 256
+#define EPOLL_HELLOCHECK_INTERVAL UA_DATETIME_SEC
+
+typedef struct {
+    ServerNetworkLayerTCP tcp; /* Must be the first member. The TCP layer
+                                * functions for starting and for the server
+                                * sockets are reused. */
+    int epollfd;
+    ConnectionEntry **connectionsByFd;
+    size_t connectionsByFdSize;
+    UA_DateTime nextHelloCheck;
+    struct epoll_event events[EPOLL_MAXEVENTS];
+} ServerNetworkLayerEpoll;
+
+static void
+ServerNetworkLayerEpoll_remove(UA_ServerNetworkLayer *nl, ServerNetworkLayerEpoll *layer,
+                               UA_Server *server, ConnectionEntry *e) {
+    LIST_REMOVE(e, pointers);
+    layer->tcp.connectionsSize--;
+    layer->connectionsByFd[e->connection.sockfd] = NULL;
+    /* Closing the socket removes it from the epoll set */
+    UA_close(e->connection.sockfd);
+    UA_Server_removeConnection(server, &e->connection);
+    if(nl->statistics)
+        nl->statistics->currentConnectionCount--;
+}
+
+static UA_Boolean
+ServerNetworkLayerEpoll_purge(ServerNetworkLayerEpoll *layer) {
+    ConnectionEntry *e;
+    LIST_FOREACH(e, &layer->tcp.connections, pointers) {
+        if(e->connection.channel == NULL) {
+            LIST_REMOVE(e, pointers);
+            layer->tcp.connectionsSize--;
+            layer->connectionsByFd[e->connection.sockfd] = NULL;
+            UA_close(e->connection.sockfd);
+            e->connection.free(&e->connection);
+            return true;
+        }
+    }
+    return false;
+}
+
+static UA_StatusCode
+ServerNetworkLayerEpoll_add(UA_ServerNetworkLayer *nl, ServerNetworkLayerEpoll *layer,
+                            int newsockfd) {
+    if(layer->tcp.maxConnections &&
+       layer->tcp.connectionsSize >= layer->tcp.maxConnections &&
+       !ServerNetworkLayerEpoll_purge(layer))
+        return UA_STATUSCODE_BADTCPNOTENOUGHRESOURCES;
+
+    /* The socket is already nonblocking (accept4). Disable Nagle's algorithm. */
+    int dummy = 1;
+    if(UA_setsockopt(newsockfd, IPPROTO_TCP, TCP_NODELAY,
+                     (const char *)&dummy, sizeof(dummy)) < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_ERROR(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                         "Cannot set socket option TCP_NODELAY. Error: %s",
+                         errno_str));
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+
+    /* Grow the lookup table */
+    if((size_t)newsockfd >= layer->connectionsByFdSize) {
+        size_t size = layer->connectionsByFdSize ? layer->connectionsByFdSize : 1024;
+        while(size <= (size_t)newsockfd)
+            size *= 2;
+        ConnectionEntry **table = (ConnectionEntry**)
+            UA_realloc(layer->connectionsByFd, size * sizeof(ConnectionEntry*));
+        if(!table)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        memset(&table[layer->connectionsByFdSize], 0,
+               (size - layer->connectionsByFdSize) * sizeof(ConnectionEntry*));
+        layer->connectionsByFd = table;
+        layer->connectionsByFdSize = size;
+    }
+
+    ConnectionEntry *e = (ConnectionEntry*)UA_malloc(sizeof(ConnectionEntry));
+    if(!e)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_Connection *c = &e->connection;
+    memset(c, 0, sizeof(UA_Connection));
+    e->pendingCount = 0;
+    c->sockfd = newsockfd;
+    c->handle = layer;
+    c->send = ServerNetworkLayerTCP_send;
+    c->close = ServerNetworkLayerTCP_flushClose;
+    c->free = ServerNetworkLayerTCP_freeConnection;
+    c->flush = ServerNetworkLayerTCP_flushConnection;
+    c->getSendBuffer = ServerNetworkLayerTCP_getSendBuffer;
+    c->releaseSendBuffer = ServerNetworkLayerTCP_releaseBuffer;
+    c->releaseRecvBuffer = ServerNetworkLayerTCP_releaseBuffer;
+    c->state = UA_CONNECTIONSTATE_OPENING;
+    c->openingDate = UA_DateTime_nowMonotonic();
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    event.data.fd = newsockfd;
+    if(epoll_ctl(layer->epollfd, EPOLL_CTL_ADD, newsockfd, &event) != 0) {
+        UA_free(e);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_LOG_DEBUG(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                 "Connection %i | New connection over TCP (epoll)", newsockfd);
+
+    layer->connectionsByFd[newsockfd] = e;
+    layer->tcp.connectionsSize++;
+    LIST_INSERT_HEAD(&layer->tcp.connections, e, pointers);
+    if(nl->statistics) {
+        nl->statistics->currentConnectionCount++;
+        nl->statistics->cumulatedConnectionCount++;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Edge-triggered: Accept until the backlog is empty */
+static void
+ServerNetworkLayerEpoll_accept(UA_ServerNetworkLayer *nl, ServerNetworkLayerEpoll *layer,
+                               UA_SOCKET serverSocket) {
+    for(;;) {
+        struct sockaddr_storage remote;
+        socklen_t remote_size = sizeof(remote);
+        int newsockfd = accept4((int)serverSocket, (struct sockaddr*)&remote,
+                                &remote_size, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(newsockfd < 0) {
+            if(UA_ERRNO == UA_INTERRUPTED)
+                continue;
+            if(UA_ERRNO != UA_AGAIN && UA_ERRNO != UA_WOULDBLOCK) {
+                UA_LOG_SOCKET_ERRNO_WRAP(
+                    UA_LOG_WARNING(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                                   "Accepting a connection failed with %s", errno_str));
+            }
+            return;
+        }
+        if(ServerNetworkLayerEpoll_add(nl, layer, newsockfd) != UA_STATUSCODE_GOOD)
+            UA_close(newsockfd);
+    }
+}
+
+/* Edge-triggered: Receive until the socket has no more data. A short read
+ * means the socket was drained (new data raises a new edge). */
+static void
+ServerNetworkLayerEpoll_read(UA_ServerNetworkLayer *nl, ServerNetworkLayerEpoll *layer,
+                             UA_Server *server, ConnectionEntry *e) {
+    UA_Connection *c = &e->connection;
+    for(;;) {
+        size_t bufferSize = connection_recvBufferSize(c);
+        UA_ByteString buf = UA_BYTESTRING_NULL;
+        UA_StatusCode res = ServerNetworkLayerTCP_recv(&layer->tcp, c, bufferSize, &buf);
+        if(res == UA_STATUSCODE_GOOD) {
+            if(buf.length == 0)
+                return; /* Drained (or out of memory, retried with the next edge) */
+            size_t received = buf.length;
+            layer->tcp.processing = c;
+            UA_Server_processBinaryMessage(server, c, &buf);
+            layer->tcp.processing = NULL;
+            ServerNetworkLayerTCP_flush(&layer->tcp, e);
+            bufferPool_release(&layer->tcp.pool, &buf);
+            /* Pick up a shutdown by the server right away */
+            if(received < bufferSize && c->state != UA_CONNECTIONSTATE_CLOSED)
+                return;
+            continue;
+        }
+
+        /* Closed by the remote side or shut down by the server */
+        UA_LOG_INFO(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                    "Connection %i | Closed", (int)c->sockfd);
+        ServerNetworkLayerEpoll_remove(nl, layer, server, e);
+        return;
+    }
+}
+
+static UA_StatusCode
+ServerNetworkLayerEpoll_start(UA_ServerNetworkLayer *nl, const UA_Logger *logger,
+                              const UA_String *customHostname) {
+    ServerNetworkLayerEpoll *layer = (ServerNetworkLayerEpoll *)nl->handle;
+    layer->epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if(layer->epollfd < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_WARNING(logger, UA_LOGCATEGORY_NETWORK,
+                           "Creating the epoll instance failed with %s", errno_str));
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_StatusCode retval = ServerNetworkLayerTCP_start(nl, logger, customHostname);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_close(layer->epollfd);
+        layer->epollfd = -1;
+        return retval;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    for(UA_UInt16 i = 0; i < layer->tcp.serverSocketsSize; i++) {
+        event.events = EPOLLIN | EPOLLET;
+        event.data.fd = (int)layer->tcp.serverSockets[i];
+        epoll_ctl(layer->epollfd, EPOLL_CTL_ADD, (int)layer->tcp.serverSockets[i], &event);
+    }
+    if(nl->onWakeup) {
+        event.events = EPOLLIN;
+        event.data.fd = nl->wakeupFd;
+        epoll_ctl(layer->epollfd, EPOLL_CTL_ADD, nl->wakeupFd, &event);
+    }
+    layer->nextHelloCheck = UA_DateTime_nowMonotonic() + EPOLL_HELLOCHECK_INTERVAL;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Close connections that did not send a Hello in time. This visits all
+ * connections and is therefore only done once per second. */
+static void
+ServerNetworkLayerEpoll_checkHello(UA_ServerNetworkLayer *nl, ServerNetworkLayerEpoll *layer,
+                                   UA_Server *server, UA_DateTime now) {
+    ConnectionEntry *e, *e_tmp;
+    LIST_FOREACH_SAFE(e, &layer->tcp.connections, pointers, e_tmp) {
+        if(e->connection.state != UA_CONNECTIONSTATE_OPENING ||
+           now <= e->connection.openingDate + (NOHELLOTIMEOUT * UA_DATETIME_MSEC))
+            continue;
+        UA_LOG_INFO(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                    "Connection %i | Closed by the server (no Hello Message)",
+                    (int)(e->connection.sockfd));
+        if(nl->statistics)
+            nl->statistics->connectionTimeoutCount++;
+        ServerNetworkLayerEpoll_remove(nl, layer, server, e);
+    }
+}
+
+static UA_StatusCode
+ServerNetworkLayerEpoll_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
+                               UA_UInt16 timeout) {
+    ServerNetworkLayerEpoll *layer = (ServerNetworkLayerEpoll *)nl->handle;
+    if(layer->epollfd < 0)
+        return UA_STATUSCODE_GOOD;
+
+    int n = epoll_wait(layer->epollfd, layer->events, EPOLL_MAXEVENTS, timeout);
+    if(n < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_DEBUG(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                         "epoll_wait failed with %s", errno_str));
+        // we will retry, so do not return bad
+        return UA_STATUSCODE_GOOD;
+    }
+
+    for(int i = 0; i < n; i++) {
+        int fd = layer->events[i].data.fd;
+
+        /* Wake-up from another thread */
+        if(nl->onWakeup && fd == nl->wakeupFd) {
+            uint64_t counter;
+            if(read(fd, &counter, sizeof(counter)) < 0) {
+                UA_LOG_DEBUG(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                             "Reading the wake-up descriptor failed");
+            }
+            nl->onWakeup(server, nl->wakeupContext);
+            continue;
+        }
 
+        /* New connections */
+        UA_Boolean isServerSocket = false;
+        for(UA_UInt16 j = 0; j < layer->tcp.serverSocketsSize; j++) {
+            if(fd == (int)layer->tcp.serverSockets[j]) {
+                ServerNetworkLayerEpoll_accept(nl, layer, layer->tcp.serverSockets[j]);
+                isServerSocket = true;
+                break;
+            }
+        }
+        if(isServerSocket)
+            continue;
+
+        /* The connection may have been removed by an earlier event of this
+         * round. The fd is then not in the table (or already reused by a new
+         * connection that simply has no data yet). */
+        if((size_t)fd >= layer->connectionsByFdSize || !layer->connectionsByFd[fd])
+            continue;
+        ServerNetworkLayerEpoll_read(nl, layer, server, layer->connectionsByFd[fd]);
+    }
+
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    if(now >= layer->nextHelloCheck) {
+        ServerNetworkLayerEpoll_checkHello(nl, layer, server, now);
+        layer->nextHelloCheck = now + EPOLL_HELLOCHECK_INTERVAL;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+ServerNetworkLayerEpoll_stop(UA_ServerNetworkLayer *nl, UA_Server *server) {
+    ServerNetworkLayerEpoll *layer = (ServerNetworkLayerEpoll *)nl->handle;
+    UA_LOG_INFO(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                "Shutting down the TCP network layer (epoll)");
+
+    /* Close the server sockets */
+    for(UA_UInt16 i = 0; i < layer->tcp.serverSocketsSize; i++) {
+        UA_shutdown(layer->tcp.serverSockets[i], 2);
+        UA_close(layer->tcp.serverSockets[i]);
+    }
+    layer->tcp.serverSocketsSize = 0;
+
+    /* Close and remove open connections */
+    ConnectionEntry *e, *e_tmp;
+    LIST_FOREACH_SAFE(e, &layer->tcp.connections, pointers, e_tmp) {
+        ServerNetworkLayerTCP_close(&e->connection);
+        ServerNetworkLayerEpoll_remove(nl, layer, server, e);
+    }
+
+    if(layer->epollfd >= 0)
+        UA_close(layer->epollfd);
+    layer->epollfd = -1;
+    UA_deinitialize_architecture_network();
+}
+
+static void
+ServerNetworkLayerEpoll_clear(UA_ServerNetworkLayer *nl) {
+    ServerNetworkLayerEpoll *layer = (ServerNetworkLayerEpoll *)nl->handle;
+    UA_free(layer->connectionsByFd);
+    layer->connectionsByFd = NULL;
+    layer->connectionsByFdSize = 0;
+    /* Frees remaining connections and the layer */
+    ServerNetworkLayerTCP_clear(nl);
+}
+
+UA_ServerNetworkLayer
+UA_ServerNetworkLayerTCPEpoll(UA_ConnectionConfig config, UA_UInt16 port,
+                              UA_UInt16 maxConnections) {
+    UA_ServerNetworkLayer nl;
+    memset(&nl, 0, sizeof(UA_ServerNetworkLayer));
+    nl.clear = ServerNetworkLayerEpoll_clear;
+    nl.localConnectionConfig = config;
+    nl.start = ServerNetworkLayerEpoll_start;
+    nl.listen = ServerNetworkLayerEpoll_listen;
+    nl.stop = ServerNetworkLayerEpoll_stop;
+    nl.handle = NULL;
+
+    ServerNetworkLayerEpoll *layer = (ServerNetworkLayerEpoll*)
+        UA_calloc(1, sizeof(ServerNetworkLayerEpoll));
+    if(!layer)
+        return nl;
+    nl.handle = layer;
+
+    layer->tcp.port = port;
+    layer->tcp.maxConnections = maxConnections;
+    layer->tcp.pool.maxRetained = BUFFERPOOL_DEFAULT_MAXRETAINED;
+    layer->tcp.batchSend = true;
+    layer->epollfd = -1;
     return nl;
 }
 
+
+/********************************/
+/* Server NetworkLayer io_uring */
+/********************************/
+
+/* Network layer for the highest connection and request rates. All socket
+ * operations are submitted to an io_uring and a single io_uring_enter per
+ * iteration submits the pending operations and collects the completions:
+ *
+ * - One multishot accept per server socket produces all new connections.
+ * - One multishot recv per connection receives into a ring of provided
+ *   buffers. The buffers are handed to the server without copying and
+ *   returned to the ring right after processing.
+ * - Send buffers come from a pool that is registered with the kernel. The
+ *   messages of an iteration are submitted together. Consecutive messages on
+ *   a connection are linked so that they keep their order. Large messages are
+ *   sent zero-copy from the registered buffer if the kernel supports it.
+ *
+ * Requires multishot recv and provided buffer rings (Linux 6.0). Use
+ * UA_ServerNetworkLayerTCPUring_supported to test the running kernel. */
+
+#if defined(__has_include)
+# if __has_include(<linux/io_uring.h>)
+#  include <linux/io_uring.h>
+# endif
+#endif
+
+#ifdef IORING_RECV_MULTISHOT
+
+#include <sys/syscall.h>
+
+#define URING_ENTRIES 1024
+#define URING_RECV_BUFFERS 256 /* Power of two */
+#define URING_RECV_BUFFERSIZE 16384
+#define URING_SEND_BUFFERS 64
+#define URING_SEND_BUFFERSIZE 65536
+#define URING_ZEROCOPY_MINSIZE 16384 /* Smaller messages are cheaper to copy */
+#define URING_MAX_LINKED_SENDS 32
+#define URING_BUFFER_GROUP 0
+
+/* Kind of operation in the lower bits of the user_data. The upper bits point
+ * to the connection or send buffer (or index the server socket). */
+#define URING_OP_ACCEPT 1
+#define URING_OP_RECV 2
+#define URING_OP_SEND 3
+#define URING_OP_WAKEUP 4
+#define URING_OP_MASK 7
+
+typedef struct {
+    int fd;
+    UA_UInt32 features;
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned sqMask;
+    unsigned sqEntries;
+    unsigned sqLocalTail;   /* Prepared up to here */
+    unsigned sqSubmitted;   /* Submitted up to here */
+    struct io_uring_sqe *sqes;
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned cqMask;
+    struct io_uring_cqe *cqes;
+    void *sqRing;
+    void *cqRing;
+    size_t sqRingSize;
+    size_t cqRingSize;
+    size_t sqesSize;
+} UringRing;
+
+static void
+uringRing_clear(UringRing *ring) {
+    if(ring->sqes)
+        munmap(ring->sqes, ring->sqesSize);
+    if(ring->cqRing && ring->cqRing != ring->sqRing)
+        munmap(ring->cqRing, ring->cqRingSize);
+    if(ring->sqRing)
+        munmap(ring->sqRing, ring->sqRingSize);
+    if(ring->fd >= 0)
+        UA_close(ring->fd);
+    memset(ring, 0, sizeof(UringRing));
+    ring->fd = -1;
+}
+
+static UA_StatusCode
+uringRing_init(UringRing *ring, unsigned entries) {
+    memset(ring, 0, sizeof(UringRing));
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = entries * 4;
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if(ring->fd < 0 && errno == EINVAL) {
+        /* Kernels before 5.19 do not know all flags */
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = entries * 4;
+        ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    }
+    if(ring->fd < 0)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    ring->features = params.features;
+    if(!(params.features & IORING_FEAT_NODROP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+        uringRing_clear(ring);
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    }
+
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if(params.features & IORING_FEAT_SINGLE_MMAP) {
+        if(ring->cqRingSize > ring->sqRingSize)
+            ring->sqRingSize = ring->cqRingSize;
+        ring->cqRingSize = ring->sqRingSize;
+    }
+    ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if(ring->sqRing == MAP_FAILED) {
+        ring->sqRing = NULL;
+        uringRing_clear(ring);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    ring->cqRing = ring->sqRing;
+    if(!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        ring->cqRing = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if(ring->cqRing == MAP_FAILED) {
+            ring->cqRing = NULL;
+            uringRing_clear(ring);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+    }
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe*)
+        mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if(ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        uringRing_clear(ring);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    UA_Byte *sq = (UA_Byte*)ring->sqRing;
+    ring->sqHead = (unsigned*)(sq + params.sq_off.head);
+    ring->sqTail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sqEntries = *(unsigned*)(sq + params.sq_off.ring_entries);
+    ring->sqLocalTail = *ring->sqTail;
+    ring->sqSubmitted = ring->sqLocalTail;
+    /* The submission queue entries are used in order */
+    unsigned *array = (unsigned*)(sq + params.sq_off.array);
+    for(unsigned i = 0; i < ring->sqEntries; i++)
+        array[i] = i;
+
+    UA_Byte *cq = (UA_Byte*)ring->cqRing;
+    ring->cqHead = (unsigned*)(cq + params.cq_off.head);
+    ring->cqTail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Submit the prepared entries. Waits up to timeout milliseconds until
+ * minComplete completions are available. Always reaps completions that are
+ * pending in the kernel. */
+static int
+uringRing_enter(UringRing *ring, unsigned minComplete, UA_UInt32 timeout) {
+    __atomic_store_n(ring->sqTail, ring->sqLocalTail, __ATOMIC_RELEASE);
+    unsigned toSubmit = ring->sqLocalTail - ring->sqSubmitted;
+    struct __kernel_timespec ts;
+    ts.tv_sec = timeout / 1000;
+    ts.tv_nsec = (long long)(timeout % 1000) * 1000000;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = (UA_UInt64)(uintptr_t)&ts;
+    int ret = (int)syscall(__NR_io_uring_enter, ring->fd, toSubmit, minComplete,
+                           IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                           &arg, sizeof(arg));
+    if(ret > 0)
+        ring->sqSubmitted += (unsigned)ret;
+    return ret < 0 ? -errno : ret;
+}
+
+/* Returns NULL if the submission queue is full and cannot be submitted */
+static struct io_uring_sqe *
+uringRing_getSqe(UringRing *ring) {
+    unsigned head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+    if(ring->sqLocalTail - head >= ring->sqEntries) {
+        uringRing_enter(ring, 0, 0);
+        head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+        if(ring->sqLocalTail - head >= ring->sqEntries)
+            return NULL;
+    }
+    struct io_uring_sqe *sqe = &ring->sqes[ring->sqLocalTail & ring->sqMask];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    ring->sqLocalTail++;
+    return sqe;
+}
+
+static unsigned
+uringRing_sqSpace(UringRing *ring) {
+    unsigned head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+    return ring->sqEntries - (ring->sqLocalTail - head);
+}
+
+static UA_Boolean
+uringRing_cqReady(UringRing *ring) {
+    return *ring->cqHead != __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+}
+
+static int
+uringRing_register(UringRing *ring, unsigned opcode, void *arg, unsigned count) {
+    return (int)syscall(__NR_io_uring_register, ring->fd, opcode, arg, count);
+}
+
+/* Ring of provided receive buffers */
+typedef struct {
+    struct io_uring_buf_ring *ring;
+    size_t ringSize;
+    UA_Byte *buffers;
+    UA_UInt16 tail;
+    UA_UInt16 mask;
+    UA_Boolean registered;
+} UringBufferRing;
+
+static void
+uringBufferRing_recycle(UringBufferRing *br, UA_UInt16 bid) {
+    struct io_uring_buf *buf = &br->ring->bufs[br->tail & br->mask];
+    buf->addr = (UA_UInt64)(uintptr_t)&br->buffers[(size_t)bid * URING_RECV_BUFFERSIZE];
+    buf->len = URING_RECV_BUFFERSIZE;
+    buf->bid = bid;
+    br->tail++;
+    __atomic_store_n(&br->ring->tail, br->tail, __ATOMIC_RELEASE);
+}
+
+static void
+uringBufferRing_clear(UringRing *ring, UringBufferRing *br) {
+    if(br->registered) {
+        struct io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.bgid = URING_BUFFER_GROUP;
+        uringRing_register(ring, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+    }
+    if(br->ring)
+        munmap(br->ring, br->ringSize);
+    UA_free(br->buffers);
+    memset(br, 0, sizeof(UringBufferRing));
+}
+
+static UA_StatusCode
+uringBufferRing_init(UringRing *ring, UringBufferRing *br, UA_UInt16 count) {
+    memset(br, 0, sizeof(UringBufferRing));
+    br->ringSize = count * sizeof(struct io_uring_buf);
+    void *mem = mmap(NULL, br->ringSize, PROT_READ | PROT_WRITE,
+                     MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if(mem == MAP_FAILED)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    br->ring = (struct io_uring_buf_ring*)mem;
+    br->buffers = (UA_Byte*)UA_malloc((size_t)count * URING_RECV_BUFFERSIZE);
+    if(!br->buffers) {
+        uringBufferRing_clear(ring, br);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (UA_UInt64)(uintptr_t)br->ring;
+    reg.ring_entries = count;
+    reg.bgid = URING_BUFFER_GROUP;
+    if(uringRing_register(ring, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        uringBufferRing_clear(ring, br);
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    }
+    br->registered = true;
+    br->mask = (UA_UInt16)(count - 1);
+    for(UA_UInt16 i = 0; i < count; i++)
+        uringBufferRing_recycle(br, i);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+uringPrepRecv(struct io_uring_sqe *sqe, int fd, UA_UInt64 userData) {
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->user_data = userData;
+}
+
+UA_Boolean
+UA_ServerNetworkLayerTCPUring_supported(void) {
+    /* Probe the kernel with a multishot recv over a socket pair. This covers
+     * the provided buffer ring and the extended io_uring_enter arguments. */
+    UringRing ring;
+    if(uringRing_init(&ring, 8) != UA_STATUSCODE_GOOD)
+        return false;
+    UringBufferRing br;
+    if(uringBufferRing_init(&ring, &br, 2) != UA_STATUSCODE_GOOD) {
+        uringRing_clear(&ring);
+        return false;
+    }
+
+    UA_Boolean supported = false;
+    int pair[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) == 0) {
+        struct io_uring_sqe *sqe = uringRing_getSqe(&ring);
+        uringPrepRecv(sqe, pair[0], URING_OP_RECV);
+        if(uringRing_enter(&ring, 0, 0) == 1 && write(pair[1], "x", 1) == 1) {
+            uringRing_enter(&ring, 1, 1000);
+            if(uringRing_cqReady(&ring)) {
+                struct io_uring_cqe *cqe = &ring.cqes[*ring.cqHead & ring.cqMask];
+                supported = (cqe->res == 1 && (cqe->flags & IORING_CQE_F_MORE) &&
+                             (cqe->flags & IORING_CQE_F_BUFFER));
+            }
+        }
+        UA_close(pair[0]);
+        UA_close(pair[1]);
+    }
+
+    /* Closing the ring cancels the pending recv */
+    UA_close(ring.fd);
+    ring.fd = -1;
+    uringBufferRing_clear(&ring, &br);
+    uringRing_clear(&ring);
+    return supported;
+}
+
+typedef struct UringConnection UringConnection;
+
+typedef struct UringSend {
+    struct UringSend *next; /* Queue of the connection or free list */
+    UringConnection *conn;
+    UA_Byte *data;
+    size_t length;
+    size_t offset;          /* Already sent */
+    int bufIndex;           /* Registered buffer or -1 for a heap buffer */
+    UA_UInt32 notifications; /* Pending zero-copy notifications */
+    UA_Boolean done;
+} UringSend;
+
+struct UringConnection {
+    UA_Connection connection;
+    LIST_ENTRY(UringConnection) pointers;
+    UringSend *sendFirst;
+    UringSend *sendLast;
+    UringConnection *nextDirty;
+    size_t sendsInFlight;
+    UA_Boolean dirty;     /* In the list of connections with new messages */
+    UA_Boolean receiving; /* Multishot recv armed */
+    UA_Boolean removed;
+    UA_Boolean freed;
+};
+
+typedef struct {
+    ServerNetworkLayerTCP tcp; /* Must be the first member. Reused for the
+                                * server sockets. */
+    UringRing ring;
+    UringBufferRing recvBuffers;
+    UA_Byte *sendBuffers;
+    UringSend sends[URING_SEND_BUFFERS];
+    UringSend *freeSends;
+    UA_Boolean fixedBuffers; /* Send buffers registered with the kernel */
+    UA_Boolean zeroCopy;
+    LIST_HEAD(, UringConnection) connections;
+    UringConnection *dirty;
+    size_t activeAccepts;
+    UA_Boolean stopping;
+    UA_DateTime nextHelloCheck;
+} ServerNetworkLayerUring;
+
+static UringSend *
+uringSendOf(ServerNetworkLayerUring *layer, const UA_Byte *data) {
+    if(layer->sendBuffers && data >= layer->sendBuffers &&
+       data < layer->sendBuffers + (size_t)URING_SEND_BUFFERS * URING_SEND_BUFFERSIZE)
+        return &layer->sends[(size_t)(data - layer->sendBuffers) / URING_SEND_BUFFERSIZE];
+    return ((UringSend*)(uintptr_t)data) - 1;
+}
+
+static void
+uringSend_release(ServerNetworkLayerUring *layer, UringSend *s) {
+    if(s->bufIndex < 0) {
+        UA_free(s);
+        return;
+    }
+    s->conn = NULL;
+    s->next = layer->freeSends;
+    layer->freeSends = s;
+}
+
+static UA_StatusCode
+ServerNetworkLayerUring_getSendBuffer(UA_Connection *connection, size_t length,
+                                      UA_ByteString *buf) {
+    UA_SecureChannel *channel = connection->channel;
+    if(channel && channel->config.sendBufferSize < length)
+        return UA_STATUSCODE_BADCOMMUNICATIONERROR;
+    ServerNetworkLayerUring *layer = (ServerNetworkLayerUring*)connection->handle;
+    UringSend *s = layer->freeSends;
+    if(s && length <= URING_SEND_BUFFERSIZE) {
+        layer->freeSends = s->next;
+    } else {
+        /* Pool exhausted or message too large */
+        s = (UringSend*)UA_malloc(sizeof(UringSend) + length);
+        if(!s)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        s->data = (UA_Byte*)(s + 1);
+        s->bufIndex = -1;
+    }
+    s->next = NULL;
+    s->conn = NULL;
+    s->offset = 0;
+    s->notifications = 0;
+    s->done = false;
+    buf->data = s->data;
+    buf->length = length;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+ServerNetworkLayerUring_releaseSendBuffer(UA_Connection *connection, UA_ByteString *buf) {
+    if(!buf->data)
+        return;
+    ServerNetworkLayerUring *layer = (ServerNetworkLayerUring*)connection->handle;
+    uringSend_release(layer, uringSendOf(layer, buf->data));
+    buf->data = NULL;
+    buf->length = 0;
+}
+
+/* Nothing to do, the receive buffers are recycled by the layer */
+static void
+ServerNetworkLayerUring_releaseRecvBuffer(UA_Connection *connection, UA_ByteString *buf) {
+}
+
+static void
+uringMarkDirty(ServerNetworkLayerUring *layer, UringConnection *conn) {
+    if(conn->dirty)
+        return;
+    conn->dirty = true;
+    conn->nextDirty = layer->dirty;
+    layer->dirty = conn;
+}
+
+/* Queue the message. It is submitted with the next io_uring_enter. */
+static UA_StatusCode
+ServerNetworkLayerUring_send(UA_Connection *connection, UA_ByteString *buf) {
+    ServerNetworkLayerUring *layer = (ServerNetworkLayerUring*)connection->handle;
+    UringConnection *conn = (UringConnection*)connection;
+    if(connection->state == UA_CONNECTIONSTATE_CLOSED || conn->removed) {
+        ServerNetworkLayerUring_releaseSendBuffer(connection, buf);
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    }
+    UringSend *s = uringSendOf(layer, buf->data);
+    s->conn = conn;
+    s->length = buf->length;
+    s->next = NULL;
+    if(conn->sendLast)
+        conn->sendLast->next = s;
+    else
+        conn->sendFirst = s;
+    conn->sendLast = s;
+    uringMarkDirty(layer, conn);
+    buf->data = NULL;
+    buf->length = 0;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Drop the queued messages of a closed connection */
+static void
+uringDropSends(ServerNetworkLayerUring *layer, UringConnection *conn) {
+    UringSend *s = conn->sendFirst;
+    while(s) {
+        UringSend *next = s->next;
+        s->done = true;
+        s->conn = NULL;
+        if(s->notifications == 0)
+            uringSend_release(layer, s);
+        s = next;
+    }
+    conn->sendFirst = NULL;
+    conn->sendLast = NULL;
+}
+
+/* The connection memory is kept until no operation refers to it */
+static void
+uringMaybeFree(ServerNetworkLayerUring *layer, UringConnection *conn) {
+    if(!conn->freed || conn->receiving || conn->sendsInFlight > 0 || conn->dirty)
+        return;
+    uringDropSends(layer, conn);
+    UA_free(conn);
+}
+
+static void
+ServerNetworkLayerUring_freeConnection(UA_Connection *connection) {
+    UringConnection *conn = (UringConnection*)connection;
+    conn->freed = true;
+    uringMaybeFree((ServerNetworkLayerUring*)connection->handle, conn);
+}
+
+static void
+uringArmRecv(ServerNetworkLayerUring *layer, UringConnection *conn) {
+    struct io_uring_sqe *sqe = uringRing_getSqe(&layer->ring);
+    if(!sqe) {
+        /* Cannot receive. Close the connection. */
+        ServerNetworkLayerTCP_close(&conn->connection);
+        return;
+    }
+    uringPrepRecv(sqe, (int)conn->connection.sockfd,
+                  (UA_UInt64)(uintptr_t)conn | URING_OP_RECV);
+    conn->receiving = true;
+}
+
+static void
+uringArmAccept(ServerNetworkLayerUring *layer, UA_UInt16 index) {
+    struct io_uring_sqe *sqe = uringRing_getSqe(&layer->ring);
+    if(!sqe)
+        return;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = (int)layer->tcp.serverSockets[index];
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = ((UA_UInt64)index << 3) | URING_OP_ACCEPT;
+    layer->activeAccepts++;
+}
+
+static void
+uringArmWakeup(UA_ServerNetworkLayer *nl, ServerNetworkLayerUring *layer) {
+    struct io_uring_sqe *sqe = uringRing_getSqe(&layer->ring);
+    if(!sqe)
+        return;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = nl->wakeupFd;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = URING_OP_WAKEUP;
+}
+
+/* Submit the queued messages of the connections as linked chains. A new
+ * chain starts only after the previous one has completed. Returns the number
+ * of prepared sends, or zero if messages are left over for the next chain. */
+static unsigned
+uringFlushSends(ServerNetworkLayerUring *layer) {
+    unsigned sends = 0;
+    UA_Boolean leftover = false;
+    UringConnection *conn = layer->dirty;
+    layer->dirty = NULL;
+    while(conn) {
+        UringConnection *next = conn->nextDirty;
+        conn->dirty = false;
+        conn->nextDirty = NULL;
+        if(conn->removed) {
+            uringMaybeFree(layer, conn);
+            conn = next;
+            continue;
+        }
+        if(conn->sendsInFlight > 0 || !conn->sendFirst) {
+            leftover |= (conn->sendFirst != NULL);
+            conn = next;
+            continue;
+        }
+
+        /* A chain must not be split over two submissions */
+        size_t chain = 0;
+        for(UringSend *s = conn->sendFirst; s && chain < URING_MAX_LINKED_SENDS; s = s->next)
+            chain++;
+        if(uringRing_sqSpace(&layer->ring) < chain)
+            uringRing_enter(&layer->ring, 0, 0);
+        if(uringRing_sqSpace(&layer->ring) < chain) {
+            uringMarkDirty(layer, conn);
+            leftover = true;
+            conn = next;
+            continue;
+        }
+
+        UringSend *s = conn->sendFirst;
+        for(size_t i = 0; i < chain; i++, s = s->next) {
+            struct io_uring_sqe *sqe = uringRing_getSqe(&layer->ring);
+            size_t remaining = s->length - s->offset;
+            sqe->opcode = IORING_OP_SEND;
+            sqe->fd = (int)conn->connection.sockfd;
+            sqe->addr = (UA_UInt64)(uintptr_t)(s->data + s->offset);
+            sqe->len = (UA_UInt32)remaining;
+            sqe->msg_flags = MSG_NOSIGNAL;
+            if(layer->zeroCopy && s->bufIndex >= 0 && remaining >= URING_ZEROCOPY_MINSIZE) {
+                sqe->opcode = IORING_OP_SEND_ZC;
+                sqe->ioprio = IORING_RECVSEND_FIXED_BUF;
+                sqe->buf_index = (UA_UInt16)s->bufIndex;
+            }
+            if(i + 1 < chain)
+                sqe->flags = IOSQE_IO_LINK;
+            sqe->user_data = (UA_UInt64)(uintptr_t)s | URING_OP_SEND;
+            conn->sendsInFlight++;
+            sends++;
+        }
+        leftover |= (s != NULL);
+        conn = next;
+    }
+    return leftover ? 0 : sends;
+}
+
+static void
+uringHandleSend(ServerNetworkLayerUring *layer, UringSend *s, struct io_uring_cqe *cqe) {
+    /* Zero-copy: the buffer can be reused */
+    if(cqe->flags & IORING_CQE_F_NOTIF) {
+        s->notifications--;
+        if(s->done && s->notifications == 0)
+            uringSend_release(layer, s);
+        return;
+    }
+    if(cqe->flags & IORING_CQE_F_MORE)
+        s->notifications++;
+
+    UringConnection *conn = s->conn;
+    conn->sendsInFlight--;
+    if(cqe->res >= 0 && (size_t)cqe->res == s->length - s->offset) {
+        /* Linked sends complete in order */
+        conn->sendFirst = s->next;
+        if(!conn->sendFirst)
+            conn->sendLast = NULL;
+        s->done = true;
+        if(s->notifications == 0)
+            uringSend_release(layer, s);
+    } else if(cqe->res >= 0) {
+        /* Short send. The rest of the chain is canceled and resubmitted. */
+        s->offset += (size_t)cqe->res;
+    } else if(cqe->res != -ECANCELED) {
+        UA_LOG_DEBUG(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                     "Connection %i | Send failed with error %i",
+                     (int)conn->connection.sockfd, -cqe->res);
+        ServerNetworkLayerTCP_close(&conn->connection);
+    }
+
+    if(conn->sendsInFlight > 0)
+        return;
+    if(conn->removed || conn->connection.state == UA_CONNECTIONSTATE_CLOSED) {
+        uringDropSends(layer, conn);
+        uringMaybeFree(layer, conn);
+    } else if(conn->sendFirst) {
+        uringMarkDirty(layer, conn);
+    }
+}
+
+static void
+uringRemoveConnection(UA_ServerNetworkLayer *nl, ServerNetworkLayerUring *layer,
+                      UA_Server *server, UringConnection *conn) {
+    UA_LOG_INFO(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                "Connection %i | Closed", (int)conn->connection.sockfd);
+    conn->removed = true;
+    conn->connection.state = UA_CONNECTIONSTATE_CLOSED;
+    LIST_REMOVE(conn, pointers);
+    layer->tcp.connectionsSize--;
+    if(nl->statistics)
+        nl->statistics->currentConnectionCount--;
+    /* Pending sends keep a reference to the socket in the kernel */
+    UA_close(conn->connection.sockfd);
+    if(conn->sendsInFlight == 0)
+        uringDropSends(layer, conn);
+    UA_Server_removeConnection(server, &conn->connection);
+}
+
+static void
+uringHandleRecv(UA_ServerNetworkLayer *nl, ServerNetworkLayerUring *layer,
+                UA_Server *server, UringConnection *conn, struct io_uring_cqe *cqe) {
+    if(cqe->flags & IORING_CQE_F_BUFFER) {
+        UA_UInt16 bid = (UA_UInt16)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        if(cqe->res > 0 && !conn->removed) {
+            UA_ByteString buf;
+            buf.data = &layer->recvBuffers.buffers[(size_t)bid * URING_RECV_BUFFERSIZE];
+            buf.length = (size_t)cqe->res;
+            UA_Server_processBinaryMessage(server, &conn->connection, &buf);
+        }
+        uringBufferRing_recycle(&layer->recvBuffers, bid);
+    }
+    if(cqe->flags & IORING_CQE_F_MORE)
+        return;
+
+    /* The multishot recv has ended. Rearm if it ran out of buffers or if the
+     * kernel stopped it for another reason. Otherwise the connection was
+     * closed by the remote side or shut down by the server. */
+    conn->receiving = false;
+    if(conn->removed) {
+        uringMaybeFree(layer, conn);
+        return;
+    }
+    if(cqe->res > 0 || cqe->res == -ENOBUFS) {
+        uringArmRecv(layer, conn);
+        if(conn->receiving)
+            return;
+    }
+    /* Frees the connection once no send refers to it */
+    uringRemoveConnection(nl, layer, server, conn);
+}
+
+static UA_Boolean
+uringPurgeConnection(ServerNetworkLayerUring *layer) {
+    UringConnection *conn;
+    LIST_FOREACH(conn, &layer->connections, pointers) {
+        if(!conn->connection.channel &&
+           conn->connection.state != UA_CONNECTIONSTATE_CLOSED) {
+            ServerNetworkLayerTCP_close(&conn->connection);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void
+uringHandleAccept(UA_ServerNetworkLayer *nl, ServerNetworkLayerUring *layer,
+                  struct io_uring_cqe *cqe) {
+    UA_UInt16 index = (UA_UInt16)(cqe->user_data >> 3);
+    if(!(cqe->flags & IORING_CQE_F_MORE)) {
+        layer->activeAccepts--;
+        if(!layer->stopping)
+            uringArmAccept(layer, index);
+    }
+    if(cqe->res < 0) {
+        if(!layer->stopping)
+            UA_LOG_WARNING(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                           "Accepting a connection failed with error %i", -cqe->res);
+        return;
+    }
+
+    int newsockfd = cqe->res;
+    if(layer->stopping ||
+       (layer->tcp.maxConnections &&
+        layer->tcp.connectionsSize >= layer->tcp.maxConnections &&
+        !uringPurgeConnection(layer))) {
+        UA_close(newsockfd);
+        return;
+    }
+
+    int dummy = 1;
+    UA_setsockopt(newsockfd, IPPROTO_TCP, TCP_NODELAY,
+                  (const char *)&dummy, sizeof(dummy));
+
+    UringConnection *conn = (UringConnection*)UA_calloc(1, sizeof(UringConnection));
+    if(!conn) {
+        UA_close(newsockfd);
+        return;
+    }
+    UA_Connection *c = &conn->connection;
+    c->sockfd = newsockfd;
+    c->handle = layer;
+    c->send = ServerNetworkLayerUring_send;
+    c->close = ServerNetworkLayerTCP_close;
+    c->free = ServerNetworkLayerUring_freeConnection;
+    c->getSendBuffer = ServerNetworkLayerUring_getSendBuffer;
+    c->releaseSendBuffer = ServerNetworkLayerUring_releaseSendBuffer;
+    c->releaseRecvBuffer = ServerNetworkLayerUring_releaseRecvBuffer;
+    c->state = UA_CONNECTIONSTATE_OPENING;
+    c->openingDate = UA_DateTime_nowMonotonic();
+
+    uringArmRecv(layer, conn);
+    if(!conn->receiving) {
+        UA_close(newsockfd);
+        UA_free(conn);
+        return;
+    }
+
+    UA_LOG_DEBUG(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                 "Connection %i | New connection over TCP (io_uring)", newsockfd);
+    LIST_INSERT_HEAD(&layer->connections, conn, pointers);
+    layer->tcp.connectionsSize++;
+    if(nl->statistics) {
+        nl->statistics->currentConnectionCount++;
+        nl->statistics->cumulatedConnectionCount++;
+    }
+}
+
+static void
+uringProcessCompletions(UA_ServerNetworkLayer *nl, ServerNetworkLayerUring *layer,
+                        UA_Server *server) {
+    UringRing *ring = &layer->ring;
+    unsigned head = *ring->cqHead;
+    while(head != __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe cqe = ring->cqes[head & ring->cqMask];
+        head++;
+        /* Free the entry before processing. Processing can submit. */
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+
+        void *ptr = (void*)(uintptr_t)(cqe.user_data & ~(UA_UInt64)URING_OP_MASK);
+        switch(cqe.user_data & URING_OP_MASK) {
+        case URING_OP_ACCEPT:
+            uringHandleAccept(nl, layer, &cqe);
+            break;
+        case URING_OP_RECV:
+            uringHandleRecv(nl, layer, server, (UringConnection*)ptr, &cqe);
+            break;
+        case URING_OP_SEND:
+            uringHandleSend(layer, (UringSend*)ptr, &cqe);
+            break;
+        case URING_OP_WAKEUP: {
+            uint64_t counter;
+            if(read(nl->wakeupFd, &counter, sizeof(counter)) < 0) {
+                UA_LOG_DEBUG(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                             "Reading the wake-up descriptor failed");
+            }
+            if(!(cqe.flags & IORING_CQE_F_MORE) && !layer->stopping)
+                uringArmWakeup(nl, layer);
+            nl->onWakeup(server, nl->wakeupContext);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+static void
+uringClearResources(ServerNetworkLayerUring *layer) {
+    uringBufferRing_clear(&layer->ring, &layer->recvBuffers);
+    uringRing_clear(&layer->ring); /* Closing the ring cancels what is left */
+    UA_free(layer->sendBuffers);
+    layer->sendBuffers = NULL;
+    layer->freeSends = NULL;
+}
+
+static UA_StatusCode
+ServerNetworkLayerUring_start(UA_ServerNetworkLayer *nl, const UA_Logger *logger,
+                              const UA_String *customHostname) {
+    ServerNetworkLayerUring *layer = (ServerNetworkLayerUring *)nl->handle;
+    layer->tcp.logger = logger;
+    UA_StatusCode retval = uringRing_init(&layer->ring, URING_ENTRIES);
+    if(retval == UA_STATUSCODE_GOOD)
+        retval = uringBufferRing_init(&layer->ring, &layer->recvBuffers, URING_RECV_BUFFERS);
+    if(retval == UA_STATUSCODE_GOOD) {
+        layer->sendBuffers = (UA_Byte*)UA_malloc((size_t)URING_SEND_BUFFERS * URING_SEND_BUFFERSIZE);
+        if(!layer->sendBuffers)
+            retval = UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(logger, UA_LOGCATEGORY_NETWORK,
+                       "Setting up io_uring failed with %s", UA_StatusCode_name(retval));
+        uringClearResources(layer);
+        return retval;
+    }
+
+    /* Register the send buffers for zero-copy sends. Optional, registered
+     * memory counts against RLIMIT_MEMLOCK. */
+    struct iovec iov[URING_SEND_BUFFERS];
+    layer->freeSends = NULL;
+    for(int i = URING_SEND_BUFFERS - 1; i >= 0; i--) {
+        UringSend *s = &layer->sends[i];
+        memset(s, 0, sizeof(UringSend));
+        s->data = layer->sendBuffers + (size_t)i * URING_SEND_BUFFERSIZE;
+        s->bufIndex = i;
+        s->next = layer->freeSends;
+        layer->freeSends = s;
+        iov[i].iov_base = s->data;
+        iov[i].iov_len = URING_SEND_BUFFERSIZE;
+    }
+    layer->fixedBuffers =
+        (uringRing_register(&layer->ring, IORING_REGISTER_BUFFERS, iov, URING_SEND_BUFFERS) == 0);
+    layer->zeroCopy = false;
+    if(layer->fixedBuffers) {
+        size_t probeSize = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+        struct io_uring_probe *probe = (struct io_uring_probe*)UA_calloc(1, probeSize);
+        if(probe && uringRing_register(&layer->ring, IORING_REGISTER_PROBE, probe, 256) == 0 &&
+           probe->ops_len > IORING_OP_SEND_ZC)
+            layer->zeroCopy = (probe->ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED) != 0;
+        UA_free(probe);
+    }
+
+    retval = ServerNetworkLayerTCP_start(nl, logger, customHostname);
+    if(retval != UA_STATUSCODE_GOOD) {
+        uringClearResources(layer);
+        return retval;
+    }
+
+    layer->stopping = false;
+    layer->activeAccepts = 0;
+    for(UA_UInt16 i = 0; i < layer->tcp.serverSocketsSize; i++)
+        uringArmAccept(layer, i);
+    if(nl->onWakeup)
+        uringArmWakeup(nl, layer);
+    uringRing_enter(&layer->ring, 0, 0);
+    layer->nextHelloCheck = UA_DateTime_nowMonotonic() + EPOLL_HELLOCHECK_INTERVAL;
+    UA_LOG_INFO(logger, UA_LOGCATEGORY_NETWORK,
+                "io_uring network layer with %s send buffers%s",
+                layer->fixedBuffers ? "registered" : "pooled",
+                layer->zeroCopy ? " and zero-copy sends" : "");
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+ServerNetworkLayerUring_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
+                               UA_UInt16 timeout) {
+    ServerNetworkLayerUring *layer = (ServerNetworkLayerUring *)nl->handle;
+    if(layer->ring.fd < 0)
+        return UA_STATUSCODE_GOOD;
+
+    /* Submit the messages and rearmed operations of the last iteration and
+     * wait for new events with the same system call. The sends usually
+     * complete right away. Wait for one completion more than that so that a
+     * request-response round trip costs a single system call. */
+    unsigned sends = uringFlushSends(layer);
+    unsigned minComplete = 0;
+    if(timeout > 0 && !uringRing_cqReady(&layer->ring))
+        minComplete = sends + 1;
+    int ret = uringRing_enter(&layer->ring, minComplete, timeout);
+    if(ret < 0 && ret != -ETIME && ret != -EINTR && ret != -EBUSY) {
+        UA_LOG_DEBUG(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                     "io_uring_enter failed with error %i", -ret);
+    }
+    uringProcessCompletions(nl, layer, server);
+
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    if(now >= layer->nextHelloCheck) {
+        UringConnection *conn;
+        LIST_FOREACH(conn, &layer->connections, pointers) {
+            if(conn->connection.state != UA_CONNECTIONSTATE_OPENING ||
+               now <= conn->connection.openingDate + (NOHELLOTIMEOUT * UA_DATETIME_MSEC))
+                continue;
+            UA_LOG_INFO(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                        "Connection %i | Closed by the server (no Hello Message)",
+                        (int)conn->connection.sockfd);
+            if(nl->statistics)
+                nl->statistics->connectionTimeoutCount++;
+            ServerNetworkLayerTCP_close(&conn->connection);
+        }
+        layer->nextHelloCheck = now + EPOLL_HELLOCHECK_INTERVAL;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+ServerNetworkLayerUring_stop(UA_ServerNetworkLayer *nl, UA_Server *server) {
+    ServerNetworkLayerUring *layer = (ServerNetworkLayerUring *)nl->handle;
+    UA_LOG_INFO(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                "Shutting down the TCP network layer (io_uring)");
+    if(layer->ring.fd < 0)
+        return;
+    layer->stopping = true;
+
+    /* Shutting down the sockets ends the multishot operations */
+    for(UA_UInt16 i = 0; i < layer->tcp.serverSocketsSize; i++)
+        UA_shutdown(layer->tcp.serverSockets[i], 2);
+    UringConnection *conn;
+    LIST_FOREACH(conn, &layer->connections, pointers)
+        ServerNetworkLayerTCP_close(&conn->connection);
+
+    /* Wait until the kernel no longer uses the buffers */
+    for(size_t i = 0; i < 100; i++) {
+        if(LIST_EMPTY(&layer->connections) && layer->activeAccepts == 0)
+            break;
+        uringFlushSends(layer);
+        uringRing_enter(&layer->ring, uringRing_cqReady(&layer->ring) ? 0 : 1, 10);
+        uringProcessCompletions(nl, layer, server);
+    }
+
+    for(UA_UInt16 i = 0; i < layer->tcp.serverSocketsSize; i++)
+        UA_close(layer->tcp.serverSockets[i]);
+    layer->tcp.serverSocketsSize = 0;
+
+    if(!LIST_EMPTY(&layer->connections)) {
+        /* Keep the buffers. They may still be in use. */
+        UA_LOG_WARNING(layer->tcp.logger, UA_LOGCATEGORY_NETWORK,
+                       "io_uring operations did not finish on shutdown");
+        UA_close(layer->ring.fd);
+        layer->ring.fd = -1;
+        return;
+    }
+    uringClearResources(layer);
+    UA_deinitialize_architecture_network();
+}
+
+static void
+ServerNetworkLayerUring_clear(UA_ServerNetworkLayer *nl) {
+    /* Only the layer itself is left after stop */
+    ServerNetworkLayerTCP_clear(nl);
+}
+
+UA_ServerNetworkLayer
+UA_ServerNetworkLayerTCPUring(UA_ConnectionConfig config, UA_UInt16 port,
+                              UA_UInt16 maxConnections) {
+    UA_ServerNetworkLayer nl;
+    memset(&nl, 0, sizeof(UA_ServerNetworkLayer));
+    nl.clear = ServerNetworkLayerUring_clear;
+    nl.localConnectionConfig = config;
+    nl.start = ServerNetworkLayerUring_start;
+    nl.listen = ServerNetworkLayerUring_listen;
+    nl.stop = ServerNetworkLayerUring_stop;
+    nl.handle = NULL;
+
+    ServerNetworkLayerUring *layer = (ServerNetworkLayerUring*)
+        UA_calloc(1, sizeof(ServerNetworkLayerUring));
+    if(!layer)
+        return nl;
+    nl.handle = layer;
+
+    layer->tcp.port = port;
+    layer->tcp.maxConnections = maxConnections;
+    layer->ring.fd = -1;
+    LIST_INIT(&layer->connections);
+    return nl;
+}
+
+#else /* IORING_RECV_MULTISHOT */
+
+UA_Boolean
+UA_ServerNetworkLayerTCPUring_supported(void) {
+    return false;
+}
+
+UA_ServerNetworkLayer
+UA_ServerNetworkLayerTCPUring(UA_ConnectionConfig config, UA_UInt16 port,
+                              UA_UInt16 maxConnections) {
+    UA_ServerNetworkLayer nl;
+    memset(&nl, 0, sizeof(UA_ServerNetworkLayer));
+    return nl;
+}
+
+#endif /* IORING_RECV_MULTISHOT */
+
+#endif /* __linux__ */
+
 typedef struct TCPClientConnection {
     struct addrinfo hints, *server;
     UA_DateTime connStart;
@@ -26008,6 +26008,12 @@ struct UA_Connection {
     /* To be called only from within the server (and not the network layer).
      * Frees up the connection's memory. */
     void (*free)(UA_Connection *connection);
+
+    /* Send the messages that were held back (optional). While holdSend is set,
+     * a network layer with a flush method collects the sent messages, so that
+     * the server can answer several requests with one write. */
+    UA_StatusCode (*flush)(UA_Connection *connection);
+    UA_Boolean holdSend;
 };
 
 /**
@@ -26083,6 +26089,14 @@ struct UA_ServerNetworkLayer {
 
     /* Deletes the network layer context. Call only after stopping. */
     void (*clear)(UA_ServerNetworkLayer *nl);
+
+    /* Optional wake-up of the server loop from other threads. If onWakeup is
+     * set, wakeupFd (e.g. an eventfd) is waited on together with the sockets
+     * in listen. When it becomes readable, the pending counter is consumed and
+     * onWakeup is called from the server thread. */
+    int wakeupFd;
+    void (*onWakeup)(UA_Server *server, void *context);
+    void *wakeupContext;
 };
 
 /**
@@ -27522,7 +27536,9 @@ typedef struct {
      *        apply
      * @param value The (non-null) DataValue that is returned to the client. The
      *        data source sets the read data, the result status and optionally a
-     *        sourcetimestamp.
+     *        sourcetimestamp. The data may point into memory of the data source
+     *        with UA_VARIANT_DATA_NODELETE. It then has to remain valid until
+     *        the current service call has completed.
      * @return Returns a status code for logging. Error codes intended for the
      *         original caller are set in the value. If an error is returned,
      *         then no releasing of the value is done
@@ -28987,6 +29003,14 @@ struct UA_ServerConfig {
     UA_ServerNetworkLayer *networkLayers;
     UA_String customHostname;
 
+    /* While threads run UA_Server_runServiceWorker, the read-only services
+     * (Read, Browse, BrowseNext, TranslateBrowsePathsToNodeIds and Call) are
+     * executed and encoded in these threads. serviceWorkerNotify is then
+     * called from a worker when responses are ready to be sent. It shall wake
+     * up the server loop, e.g. via the wakeupFd of the network layer. */
+    void (*serviceWorkerNotify)(UA_Server *server, void *context);
+    void *serviceWorkerContext;
+
     /**
      * Security and Encryption
      * ^^^^^^^^^^^^^^^^^^^^^^^ */
@@ -29133,6 +29157,56 @@ struct UA_ServerConfig {
                                           void *nodeContext,
                                           UA_UInt32 attibuteId,
                                           UA_Boolean removed);
+
+    /* Push-based sampling of node values
+     *
+     * Optional. Return true if the application reports every change of the
+     * value attribute of the node with UA_Server_notifyDataChange. DataChange
+     * MonitoredItems on such nodes are then not sampled cyclically. They are
+     * attached to the node like MonitoredItems with a sampling interval of
+     * zero and only sampled when a change is pushed (or the value is written).
+     *
+     * @param server Allows the access to the server object
+     * @param nodeId Id of the monitored node
+     * @param nodeContext An optional pointer to user-defined data, associated
+     *        with the node in the nodestore */
+    UA_Boolean (*monitoredItemPushSampling)(UA_Server *server,
+                                            const UA_NodeId *nodeId,
+                                            void *nodeContext);
+
+    /* Shared sampling of identical MonitoredItems
+     *
+     * Cyclic DataChange MonitoredItems on the value attribute with the same
+     * NodeId, IndexRange, DataEncoding, sampling interval and
+     * TimestampsToReturn share one sampling callback. The value is read once
+     * per interval and handed to all of them, so the sampling cost grows with
+     * the number of distinct items and not with the number of subscriptions
+     * monitoring them. The shared sample is read with the admin session. The
+     * AccessLevel and the UserAccessLevel (AccessControl plugin) are checked
+     * for the session of every MonitoredItem, which gets the status of the
+     * denied read instead of the sample. Value callbacks and DataSources are
+     * called with the admin session, so they must not return different values
+     * for different sessions. */
+    UA_Boolean shareMonitoredItemSampling;
+
+    /* Shared encoding of notifications
+     *
+     * A sample that is handed to several MonitoredItems (by shared sampling
+     * or UA_Server_notifyDataChange) is binary-encoded once. The notifications
+     * of all subscriptions share the encoding and the bytes are copied into
+     * the PublishResponses. So the encoding cost grows with the number of
+     * changes and not with the number of subscriptions monitoring them. */
+    UA_Boolean shareNotificationEncoding;
+
+    /* Coalesced publish callbacks
+     *
+     * If positive, Subscriptions with the same publishing interval share one
+     * repeated publish callback per phase slot of this width (in ms). The
+     * cycle of a new Subscription is aligned to the nearest slot, so its
+     * publish times deviate by at most half a slot from its own cycle. The
+     * PublishResponses of one pass to the same connection are sent together.
+     * Zero registers a callback for every Subscription. */
+    UA_Double publishingGranularity;
 #endif
 
     /**
@@ -29227,6 +29301,42 @@ UA_Server_run_iterate(UA_Server *server, UA_Boolean waitInternal);
 UA_StatusCode UA_EXPORT
 UA_Server_run_shutdown(UA_Server *server);
 
+/**
+ * Service Workers
+ * ---------------
+ * Read-only service requests can be executed by application threads running
+ * UA_Server_runServiceWorker. The requests of one SecureChannel are executed
+ * one after the other and answered in the order of arrival, so that a slow
+ * request only delays its own client. Requests of other services that arrive
+ * behind them are queued and executed by the server thread once the earlier
+ * requests are answered. The server thread serves the other clients meanwhile.
+ * All other services, the subscriptions and the timed callbacks run in the
+ * server thread while no worker executes a service. Method callbacks (Call is
+ * dispatched) execute concurrently with other dispatched services and must not
+ * modify the information model. The worker threads have to be stopped and
+ * joined before the server is deleted. */
+
+/* Executes dispatched services until UA_Server_stopServiceWorkers is called
+ * and no dispatched request is left. */
+void UA_EXPORT
+UA_Server_runServiceWorker(UA_Server *server);
+
+/* Lets the service workers return. Afterwards all requests are executed in
+ * the server thread. */
+void UA_EXPORT
+UA_Server_stopServiceWorkers(UA_Server *server);
+
+typedef struct {
+    UA_UInt64 dispatched; /* Requests executed by a worker */
+    UA_UInt64 parked;     /* Requests of other services that were queued
+                           * behind the dispatched requests of their channel */
+    UA_UInt64 maxQueued;  /* Most requests waiting for a worker at once */
+} UA_ServiceWorkerStatistics;
+
+void UA_EXPORT
+UA_Server_getServiceWorkerStatistics(UA_Server *server,
+                                     UA_ServiceWorkerStatistics *stats);
+
 /**
  * Timed Callbacks
  * ---------------
@@ -29935,6 +30045,20 @@ UA_Server_createDataChangeMonitoredItem(UA_Server *server,
 UA_StatusCode UA_EXPORT UA_THREADSAFE
 UA_Server_deleteMonitoredItem(UA_Server *server, UA_UInt32 monitoredItemId);
 
+/* Report a new value of the value attribute of a node. All DataChange
+ * MonitoredItems attached to the node (see monitoredItemPushSampling in the
+ * server configuration) are sampled with a copy of the value. The server
+ * timestamp and the source timestamp are set according to the
+ * TimestampsToReturn of each MonitoredItem. MonitoredItems with an index
+ * range are sampled by reading the node instead.
+ *
+ * @param server The server executing the MonitoredItems
+ * @param nodeId Id of the changed node
+ * @param value The new value. It is not modified or taken over. */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_notifyDataChange(UA_Server *server, const UA_NodeId *nodeId,
+                           const UA_DataValue *value);
+
 #endif
 
 /**
@@ -33588,6 +33712,72 @@ UA_ServerNetworkLayer UA_EXPORT
 UA_ServerNetworkLayerTCP(UA_ConnectionConfig config, UA_UInt16 port,
                          UA_UInt16 maxConnections);
 
+typedef struct {
+    UA_UInt64 hits;            /* Buffers taken from the pool */
+    UA_UInt64 misses;          /* Buffers newly allocated */
+    UA_UInt64 drops;           /* Returned buffers freed because of the cap */
+    size_t retainedBytes;      /* Memory currently held by the pool */
+    size_t maxRetainedBytes;
+    UA_Boolean hugePages;      /* Buffers are carved from huge page slabs */
+} UA_BufferPoolStatistics;
+
+/* The send and receive buffers of the TCP and epoll network layers are
+ * recycled in a pool instead of being allocated per message. The pool retains
+ * at most maxRetainedBytes (4 MiB by default, 0 disables the pool). With
+ * hugePages the buffers are carved from 2 MiB slabs backed by huge pages.
+ * Must be set before the network layer is started. */
+void UA_EXPORT
+UA_ServerNetworkLayerTCP_setBufferPool(UA_ServerNetworkLayer *nl,
+                                       size_t maxRetainedBytes,
+                                       UA_Boolean hugePages);
+
+void UA_EXPORT
+UA_ServerNetworkLayerTCP_getBufferPoolStatistics(const UA_ServerNetworkLayer *nl,
+                                                 UA_BufferPoolStatistics *stats);
+
+/* The chunks of a message, and all answers to a received buffer, are sent
+ * with a single sendmsg call instead of one send per chunk. Enabled by
+ * default for the TCP and epoll network layers. */
+void UA_EXPORT
+UA_ServerNetworkLayerTCP_setSendBatching(UA_ServerNetworkLayer *nl,
+                                         UA_Boolean enabled);
+
+/* The listening sockets are bound with SO_REUSEPORT (Linux only), so that the
+ * network layers of several servers can listen on the same port. The kernel
+ * distributes new connections among them by a hash of the connection. With
+ * addressShards > 1, the listening socket is instead selected by the client
+ * address modulo addressShards. A client that reconnects then arrives at the
+ * same server, where its session lives. addressShards shall be the number of
+ * network layers on the port. Applies to the TCP, epoll and io_uring network
+ * layers and must be set before the network layer is started. */
+void UA_EXPORT
+UA_ServerNetworkLayerTCP_setReusePort(UA_ServerNetworkLayer *nl,
+                                      UA_Boolean enabled,
+                                      UA_UInt16 addressShards);
+
+#ifdef __linux__
+/* Initializes a TCP network layer that waits with edge-triggered epoll instead
+ * of select. The cost of a wake-up depends only on the sockets with activity
+ * and the number of connections is not limited by FD_SETSIZE. Same parameters
+ * as UA_ServerNetworkLayerTCP. */
+UA_ServerNetworkLayer UA_EXPORT
+UA_ServerNetworkLayerTCPEpoll(UA_ConnectionConfig config, UA_UInt16 port,
+                              UA_UInt16 maxConnections);
+
+/* Initializes a TCP network layer on io_uring. Multishot accept and recv into
+ * provided buffers, sends from a registered buffer pool submitted in batches.
+ * Only one system call per server iteration. The handle is NULL if io_uring
+ * was not available at build time. */
+UA_ServerNetworkLayer UA_EXPORT
+UA_ServerNetworkLayerTCPUring(UA_ConnectionConfig config, UA_UInt16 port,
+                              UA_UInt16 maxConnections);
+
+/* Whether the running kernel supports the io_uring network layer (Linux 6.0
+ * or later, io_uring not disabled). Use the epoll or select layer otherwise. */
+UA_Boolean UA_EXPORT
+UA_ServerNetworkLayerTCPUring_supported(void);
+#endif
+
 /* Open a non-blocking client TCP socket. The connection might not be fully
  * opened yet. Drop into the _poll function withe a timeout to complete the
  * connection. */
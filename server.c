@@ -3,11 +3,23 @@
 #include <stdio.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <malloc.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
 #include <unistd.h>
 #include <stdarg.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/ioctl.h>
+#include <sys/prctl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
+#include <poll.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
 
 // 包含配置文件（如果存在）
 #ifdef HAVE_CONFIG_H
@@ -15,11 +27,28 @@
 #endif
 
 // ==================== 常量定义 ====================
-#define MAX_VARIABLES 100
-#define MAX_OBJECTS 50
-#define MAX_METHODS 20
 #define MAX_EVENTS 10
+#define CACHE_LINE_SIZE 64
+#define TAG_CHUNK_SHIFT 12
+#define TAG_CHUNK_SIZE (1 << TAG_CHUNK_SHIFT) // 每个内存块容纳的变量记录数
+#define SIMULATION_BLOCK_SIZE 1024            // 批量模拟每次处理的变量数
+#define SIMULATION_TICK_MS 10                 // 时间轮的最小调度粒度
+#define TIMING_WHEEL_BITS 6
+#define TIMING_WHEEL_SLOTS (1 << TIMING_WHEEL_BITS)
+#define TIMING_WHEEL_LEVELS 4 // 64^4个周期，约46小时
+#define CHANGE_RING_BITS 16 // 变化推送环形队列容量 2^16 条记录
+#define CHANGE_PUSH_BATCH 64 // 生产者每次预留的最大记录数
+
+// 批量模拟内核：x86-64上同时生成AVX2版本并在运行时选择，其他平台为普通循环
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SIMD_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define SIMD_KERNEL
+#endif
 #define SERVER_PORT 4840
+#define NETWORK_MAX_CONNECTIONS 4096 // epoll/io_uring网络层的最大连接数，同时作为安全通道和会话上限
+#define BUFFER_POOL_DEFAULT_KIB 4096 // 网络层收发缓冲区池最多保留的内存
+#define PUBLISH_GRANULARITY_DEFAULT_MS 5.0 // 发布间隔相同的订阅按此宽度的相位槽共用发布回调
 #define SIMULATION_INTERVAL_MS 1000
 #define LOG_BUFFER_SIZE 1024
 
@@ -30,9 +59,45 @@ typedef enum
     SIMULATION_SINE_WAVE,
     SIMULATION_RANDOM,
     SIMULATION_COUNTER,
-    SIMULATION_SQUARE_WAVE
+    SIMULATION_SQUARE_WAVE,
+    SIMULATION_GAUSSIAN_NOISE // 高斯噪声：参数2为均值，参数3为标准差
 } SimulationType;
 
+typedef enum
+{
+    SIMULATION_ENGINE_SCALAR, // 逐个变量调用 updateSimulatedValue
+    SIMULATION_ENGINE_BATCH,  // 按(模拟类型, 数据类型)分组的SoA批量内核
+    SIMULATION_ENGINE_LAZY    // 不做周期计算，读取或采样时按当前时间求值
+} SimulationEngineMode;
+
+// 批量模拟分组，对应 updateSimulatedValue 支持的组合
+typedef enum
+{
+    SIMULATION_GROUP_SINE_FLOAT,
+    SIMULATION_GROUP_SINE_DOUBLE,
+    SIMULATION_GROUP_RANDOM_INT32,
+    SIMULATION_GROUP_RANDOM_FLOAT,
+    SIMULATION_GROUP_COUNTER_INT32,
+    SIMULATION_GROUP_COUNTER_UINT32,
+    SIMULATION_GROUP_SQUARE_BOOLEAN,
+    SIMULATION_GROUP_GAUSSIAN_FLOAT,
+    SIMULATION_GROUP_GAUSSIAN_DOUBLE,
+    SIMULATION_GROUP_COUNT
+} SimulationGroupKind;
+
+typedef enum
+{
+    READ_MODE_COPY,     // 每次读取堆分配一份值的副本
+    READ_MODE_ZERO_COPY // 定长标量直接引用变量自有存储，不做堆分配
+} ReadMode;
+
+typedef enum
+{
+    NETWORK_MODE_SELECT, // open62541自带的select网络层，连接数受FD_SETSIZE限制
+    NETWORK_MODE_EPOLL,  // 边沿触发epoll，只处理有事件的套接字
+    NETWORK_MODE_URING   // io_uring，每次服务器循环只有一次系统调用
+} NetworkMode;
+
 typedef enum
 {
     LOG_LEVEL_DEBUG,
@@ -42,21 +107,268 @@ typedef enum
 } LogLevel;
 
 // ==================== 结构体定义 ====================
+// 定长标量值的存储单元（不超过64位，可整体原子读写）
+typedef union
+{
+    UA_UInt64 bits;
+    UA_Boolean boolean;
+    UA_Int32 int32;
+    UA_UInt32 uint32;
+    UA_Float floatValue;
+    UA_Double doubleValue;
+    UA_DateTime dateTime;
+} ScalarValue;
+
+// 无锁值单元：定长标量保存在原子64位槽中，字符串通过指针交换更新(RCU)
+// 模拟周期内写入时保留周期开始前的值，周期全部完成前读取方读到的仍是上一个完整周期的值
 typedef struct
 {
-    void *value;
-    const UA_DataType *type;
-    pthread_mutex_t mutex;
+    ScalarValue scalar;
+    ScalarValue previous; // tick 尚未完成时读取方使用的值
+    UA_UInt64 tick;       // 最近一次模拟写入所在的周期序号，0 表示不属于任何周期
+    UA_String *string;
+    UA_UInt32 stringReaders[2]; // 按读取开始时的代号分别计数正在复制字符串的读者
+    UA_UInt32 stringEpoch;      // 当前读者计入的代号，写者替换字符串后翻转
+    UA_Boolean stringWriting;   // 写者互斥，同一时刻只有一个宽限期
+} ValueCell;
+
+struct VariableContext;
+struct SimulationGroup;
+
+// 时间轮中的周期定时器，嵌入在变量记录（逐个计算）或模拟分组（批量计算）中
+typedef struct SimulationTimer
+{
+    struct SimulationTimer *next;
+    struct SimulationTimer **pprev; // 指向前一个节点的next，未调度时为NULL
+    UA_UInt64 expires;              // 到期的时间轮周期
+    UA_UInt32 periodTicks;
+    struct VariableContext *tag;
+    struct SimulationGroup *group;
+} SimulationTimer;
+
+// 变量记录按缓存行对齐，连续存放在注册表的内存块中
+typedef struct __attribute__((aligned(CACHE_LINE_SIZE))) VariableContext
+{
+    // 模拟写回时访问的字段放在第一个缓存行
+    ValueCell cell;
+    time_t lastUpdate;
+    UA_Boolean hasAlarm;
+    UA_Boolean alarmState;
     SimulationType simulation;
+    const UA_DataType *type;
+    ScalarValue readSnapshot; // 零拷贝读取的快照，仅由主服务器线程读写
     double simulationParam1; // 频率或范围
     double simulationParam2; // 振幅或最小值
     double simulationParam3; // 偏移或最大值
-    time_t lastUpdate;
-    UA_Boolean hasAlarm;
+    UA_UInt32 updatePeriodMs; // 模拟更新周期
+    UA_UInt64 lazyStep;       // 惰性模式下最近一次求值所在的更新周期序号
+    UA_UInt64 rngCounter;     // 下一次随机抽样的序号（在批量分组中时以分组数组为准）
+    UA_UInt32 monitorCount;   // 监视Value属性的监视项数量
+    UA_UInt64 lastReadMs;     // 最近一次读取或采样的时间（毫秒）
+    UA_Boolean observed;      // 是否在观察集合中（由模拟线程按周期更新）
+    UA_Boolean activationPending; // 已提交加入观察集合的请求
+    int simulationGroup;      // 批量模拟分组序号，-1 表示未加入
+    size_t simulationSlot;    // 在分组结构数组中的位置
+    SimulationTimer timer;    // 逐个计算模式下的定时器
     double alarmThreshold;
-    UA_Boolean alarmState;
+    UA_NodeId nodeId;
+    size_t index; // 在注册表中的位置
 } VariableContext;
 
+// 变量注册表：分块的连续记录 + NodeId开放寻址哈希索引
+// 记录地址在注册表生命周期内保持不变，可直接作为节点上下文
+typedef struct
+{
+    VariableContext **chunks;
+    size_t chunkCount;
+    size_t chunkCapacity;
+    size_t count;
+    UA_UInt32 *hashSlots; // 存放 index + 1，0 表示空槽
+    size_t hashCapacity;  // 2的幂
+    UA_Boolean shared;    // 内存块映射为进程间共享内存（多进程模式）
+} TagRegistry;
+
+// 同一分组的模拟参数以结构数组(SoA)形式连续存放，只分配该分组内核用到的数组
+// 分组按(模拟类型, 数据类型, 更新周期)划分，整组共用一个定时器
+typedef struct SimulationGroup
+{
+    SimulationGroupKind kind;
+    UA_UInt32 periodMs;
+    SimulationTimer timer;
+    size_t count;
+    size_t capacity;
+    VariableContext **tags;
+    double *phase;       // 正弦
+    double *frequency;   // 正弦
+    double *amplitude;   // 正弦
+    double *offset;      // 正弦
+    double *minimum;     // 随机
+    double *maximum;     // 随机
+    double *mean;        // 高斯噪声
+    double *stddev;      // 高斯噪声
+    UA_UInt32 *rngStream;  // 随机、高斯噪声：变量序号
+    UA_UInt64 *rngCounter; // 随机、高斯噪声：抽样序号
+    UA_UInt32 *increment; // 计数器
+    double *period;      // 方波
+} SimulationGroup;
+
+typedef struct
+{
+    SimulationGroup **groups; // 分组地址保持不变，定时器可直接挂入时间轮
+    size_t groupCount;
+    size_t groupCapacity;
+} SimulationEngine;
+
+// 并行模拟任务：批量分组中的一个数据块，或本周期到期变量中的一段
+typedef struct
+{
+    SimulationGroup *group; // 为NULL时处理 dueTags[begin, begin + count)
+    size_t begin;
+    size_t count;
+} SimulationTask;
+
+// 每个线程的任务队列：本线程和窃取者都从head原子取任务
+typedef struct __attribute__((aligned(CACHE_LINE_SIZE)))
+{
+    size_t head;
+    size_t end;
+} SimulationQueue;
+
+struct SimulationPool;
+
+typedef struct
+{
+    struct SimulationPool *pool;
+    int index;
+    pthread_t thread;
+} SimulationWorker;
+
+// 模拟线程池：模拟线程作为0号线程参与计算，每个周期递增generation唤醒工作线程，
+// 并等待所有线程完成后才返回。之后模拟线程发布周期序号，读取方在此之前只看到上一个完整周期的值
+typedef struct SimulationPool
+{
+    int threadCount; // 包括模拟线程本身
+    SimulationWorker *workers;
+    SimulationQueue *queues;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    UA_UInt64 generation;
+    int busy; // 本周期尚未完成的工作线程数
+    UA_Boolean stopping;
+    double time;
+    UA_UInt64 tick; // 正在计算的周期序号
+    SimulationTask *tasks;
+    size_t taskCount;
+    size_t taskCapacity;
+    VariableContext **dueTags;
+    size_t dueCount;
+    size_t dueCapacity;
+    UA_UInt64 steals; // 从其他线程队列窃取的任务数
+} SimulationPool;
+
+// 分层时间轮：第L层每个槽跨越 64^L 个周期，到期前逐层下移
+typedef struct
+{
+    SimulationTimer *slots[TIMING_WHEEL_LEVELS][TIMING_WHEEL_SLOTS];
+    UA_UInt64 currentTick;
+    SimulationPool *pool;     // 为NULL时在模拟线程内直接计算
+    SimulationTimer **fired;  // 当前周期到期的定时器
+    size_t firedCapacity;
+    // 统计信息（模拟线程写入，诊断线程读取）
+    UA_UInt64 ticks;
+    UA_UInt64 overruns;     // 唤醒迟到超过一个周期的次数
+    UA_UInt64 missedTicks;  // 因迟到而合并处理的周期数
+    UA_UInt64 firedTimers;
+    UA_UInt64 totalJitterNs;
+    UA_UInt64 maxJitterNs;
+} TimingWheel;
+
+// 观察集合：只有被监视或最近被读取的变量由模拟线程周期计算，其余在读取时补算
+// 服务器线程提交加入请求，模拟线程在每个周期开始时处理，并在定时器触发时移出不再观察的变量
+typedef struct
+{
+    UA_Boolean enabled;
+    UA_UInt32 windowMs; // 读取后保持在观察集合中的时长
+    pthread_mutex_t lock;
+    VariableContext **pending;
+    size_t pendingCount;
+    size_t pendingCapacity;
+    size_t activeCount; // 仅由模拟线程修改
+} ObservedSet;
+
+// 变化推送：模拟线程把被监视变量的新值写入有界无锁多生产者单消费者环形队列，
+// 服务器线程整批取出后通知监视项，这些变量的监视项不再按采样间隔读取
+typedef struct
+{
+    UA_UInt64 sequence; // 等于位置时可写入，等于位置+1时可读取
+    UA_UInt32 tag;      // 变量在注册表中的位置
+    ScalarValue value;
+    double time; // 模拟时间，作为源时间戳
+} ChangeRecord;
+
+typedef struct
+{
+    UA_Boolean enabled;
+    int wakeupFd; // eventfd，唤醒服务器主循环，-1 表示未使用
+    ChangeRecord *ring;
+    UA_UInt64 mask;
+    UA_UInt32 monitoredTags; // 被监视的模拟变量数，为0时不收集
+    // 生产者与消费者各自修改的位置放在不同缓存行
+    __attribute__((aligned(CACHE_LINE_SIZE))) UA_UInt64 enqueuePos;
+    UA_Boolean wakeupPending;  // 已通知、服务器线程尚未处理
+    UA_UInt64 dropped;         // 队列满而丢弃的变化
+    __attribute__((aligned(CACHE_LINE_SIZE))) UA_UInt64 dequeuePos;
+    // 统计信息（服务器线程写入）
+    UA_UInt64 batches;
+    UA_UInt64 notifications;
+    UA_UInt64 wakeups;
+    UA_UInt64 maxDepth;
+    UA_UInt64 totalLatencyUs; // 从模拟计算到通知的延迟
+    UA_UInt64 maxLatencyUs;
+} ChangePush;
+
+// 服务工作线程：Read、Browse、BrowseNext、TranslateBrowsePaths和Call在这些线程中执行并编码，
+// 同一安全通道的请求依次执行、按到达顺序应答，应答就绪后经eventfd唤醒服务器主循环发送
+typedef struct
+{
+    int count; // 运行中的工作线程数
+    pthread_t *threads;
+    int wakeupFd;            // 与变化推送共用网络层的eventfd时不由这里关闭
+    UA_Boolean ownsWakeupFd;
+} ServiceWorkers;
+
+// 多反应器：每个反应器是一个独立的UA_Server及其事件循环线程，监听套接字以SO_REUSEPORT绑定同一端口。
+// 连接、安全通道、会话和订阅只属于接受连接的反应器，请求路径上没有锁；变量记录由所有反应器共享
+typedef struct
+{
+    UA_Server *server;
+    pthread_t thread;
+    UA_Boolean threadStarted;
+    ScalarValue *readSnapshots; // 零拷贝读取的快照，按变量在注册表中的位置索引（主服务器用变量记录中的快照）
+    size_t readSnapshotCount;
+} Reactor;
+
+typedef struct
+{
+    int count;                  // 反应器数，1表示只有主服务器
+    UA_Boolean addressAffinity; // 按客户端地址而不是连接分配反应器，重连的客户端回到持有其会话的反应器
+    Reactor *list;              // list[0]为主服务器，在主线程中运行
+    const volatile UA_Boolean *running;
+} Reactors;
+
+// 预派生进程池：主进程构建地址空间后派生一个模拟进程和N个工作进程。
+// 变量记录在共享内存中，由模拟进程写入；其余地址空间（节点存储等）在派生后写时复制共享
+typedef struct
+{
+    int count;           // 工作进程数，0表示单进程运行
+    UA_Server *server;   // 各工作进程运行的服务器（派生前构建，尚未启动）
+    pid_t supervisor;
+    pid_t simulation;    // 模拟进程，惰性模式下为0
+    pid_t *workers;
+    UA_UInt64 restarts;  // 因信号终止而重新派生的次数
+} ProcessPool;
+
 typedef struct
 {
     UA_NodeId nodeId;
@@ -98,131 +410,1990 @@ typedef struct
 
     // 配置
     LogLevel logLevel;
+    ReadMode readMode;
+    NetworkMode networkMode;
+    size_t bufferPoolBytes; // 收发缓冲区池上限，0表示每条消息单独分配
+    UA_Boolean hugePages;   // 缓冲区池使用大页
+    UA_Boolean noSendBatching; // 每个应答块单独发送，不合并为一次sendmsg
+    UA_Boolean noSharedSampling; // 每个监视项各自采样，不与相同的监视项共享
+    UA_Boolean noSharedEncoding; // 每个订阅的通知各自编码，不共用同一采样值的编码
+    double publishGranularityMs; // 发布调度的相位槽宽度，0表示每个订阅各自注册发布回调
+    SimulationEngineMode simulationEngineMode;
+    UA_UInt64 runSeed; // 模拟随机数种子
+    int simulationThreads; // 参与模拟计算的线程数
+    int serviceWorkerCount; // 只读服务工作线程数，0表示所有服务在服务器线程中执行
     UA_Boolean enableSecurity;
     UA_Boolean enableDiagnostics;
 
     // 存储上下文
-    VariableContext *variables[MAX_VARIABLES];
-    ObjectContext *objects[MAX_OBJECTS];
-    MethodContext *methods[MAX_METHODS];
+    TagRegistry tags;
+    UA_UInt64 *simulationEpoch; // 最近一个全部计算完成的模拟周期序号（多进程模式下在共享内存中）
+    SimulationEngine simulationEngine;
+    TimingWheel scheduler;
+    SimulationPool simulationPool;
+    ObservedSet observedSet;
+    ServiceWorkers serviceWorkers;
+    Reactors reactors;
+    ProcessPool processes;
+    ChangePush changePush;
+    ObjectContext **objects;
+    MethodContext **methods;
     EventContext *events[MAX_EVENTS];
-    int variableCount;
     int objectCount;
+    int objectCapacity;
     int methodCount;
+    int methodCapacity;
     int eventCount;
 } ServerContext;
 
-// ==================== 全局变量 ====================
-ServerContext g_serverContext = {0};
+// ==================== 全局变量 ====================
+ServerContext g_serverContext = {0};
+static UA_UInt64 g_simulationEpoch; // 单进程时 simulationEpoch 指向这里
+
+// ==================== 日志系统 ====================
+void logMessage(LogLevel level, const char *format, ...)
+{
+    if (level < g_serverContext.logLevel)
+        return;
+
+    time_t now = time(NULL);
+    char timeStr[64];
+    strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", localtime(&now));
+
+    const char *levelStr[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+
+    va_list args;
+    va_start(args, format);
+
+    printf("[%s] [%s] ", timeStr, levelStr[level]);
+    vprintf(format, args);
+    printf("\n");
+
+    va_end(args);
+}
+
+// ==================== 信号处理 ====================
+static void stopHandler(int sig)
+{
+    logMessage(LOG_LEVEL_INFO, "收到停止信号，正在关闭服务器...");
+    g_serverContext.running = false;
+}
+
+// ==================== 无锁值单元 ====================
+static inline ScalarValue valueCellLoad(const ValueCell *cell)
+{
+    ScalarValue value;
+    value.bits = __atomic_load_n(&cell->scalar.bits, __ATOMIC_ACQUIRE);
+    return value;
+}
+
+// 周期外的写入（客户端写入、惰性求值）立即可见：两个槽都写入新值
+static inline void valueCellStore(ValueCell *cell, ScalarValue value)
+{
+    __atomic_store_n(&cell->previous.bits, value.bits, __ATOMIC_RELEASE);
+    __atomic_store_n(&cell->scalar.bits, value.bits, __ATOMIC_RELEASE);
+}
+
+// 读-改-写操作使用CAS，失败时expected被更新为当前值
+static inline UA_Boolean valueCellCompareExchange(ValueCell *cell, ScalarValue *expected,
+                                                  ScalarValue desired)
+{
+    if (!__atomic_compare_exchange_n(&cell->scalar.bits, &expected->bits, desired.bits,
+                                     false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        return false;
+    __atomic_store_n(&cell->previous.bits, desired.bits, __ATOMIC_RELEASE);
+    return true;
+}
+
+// 模拟周期tick内的写入：先保存当前值并标记周期，再写入新值；tick为0时等同于立即写入
+static inline void valueCellPublish(ValueCell *cell, ScalarValue value, UA_UInt64 tick)
+{
+    if (tick == 0)
+    {
+        valueCellStore(cell, value);
+        return;
+    }
+    ScalarValue current = valueCellLoad(cell);
+    __atomic_store_n(&cell->previous.bits, current.bits, __ATOMIC_RELEASE);
+    __atomic_store_n(&cell->tick, tick, __ATOMIC_RELEASE);
+    __atomic_store_n(&cell->scalar.bits, value.bits, __ATOMIC_RELEASE);
+}
+
+static inline UA_Boolean valueCellPublishExchange(ValueCell *cell, ScalarValue *expected,
+                                                  ScalarValue desired, UA_UInt64 tick)
+{
+    if (tick == 0)
+        return valueCellCompareExchange(cell, expected, desired);
+    __atomic_store_n(&cell->previous.bits, expected->bits, __ATOMIC_RELEASE);
+    __atomic_store_n(&cell->tick, tick, __ATOMIC_RELEASE);
+    return __atomic_compare_exchange_n(&cell->scalar.bits, &expected->bits, desired.bits,
+                                       false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+// 读取 completed 周期结束时的值：单元的周期标记在读取前后不变时两个槽的值才是一致的。
+// 只有读取后 epoch 仍等于 completed 结果才有效，读取多个单元时可据此得到同一周期的快照
+static inline ScalarValue valueCellReadAt(const ValueCell *cell, UA_UInt64 completed)
+{
+    for (;;)
+    {
+        UA_UInt64 tick = __atomic_load_n(&cell->tick, __ATOMIC_ACQUIRE);
+        ScalarValue value = valueCellLoad(cell);
+        ScalarValue previous;
+        previous.bits = __atomic_load_n(&cell->previous.bits, __ATOMIC_ACQUIRE);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&cell->tick, __ATOMIC_RELAXED) == tick)
+            return tick > completed ? previous : value;
+    }
+}
+
+// 读取方：只返回 epoch（最近一个全部计算完成的周期）及之前写入的值
+static inline ScalarValue valueCellRead(const ValueCell *cell, const UA_UInt64 *epoch)
+{
+    for (;;)
+    {
+        UA_UInt64 completed = __atomic_load_n(epoch, __ATOMIC_ACQUIRE);
+        ScalarValue value = valueCellReadAt(cell, completed);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(epoch, __ATOMIC_RELAXED) == completed)
+            return value;
+    }
+}
+
+static UA_StatusCode valueCellReadString(ValueCell *cell, UA_String *out)
+{
+    // 计入当前代号的读者；计数期间代号被翻转时改计入新代号，保证写者等待的代号包含所有持有旧值的读者
+    UA_UInt32 epoch;
+    for (;;)
+    {
+        epoch = __atomic_load_n(&cell->stringEpoch, __ATOMIC_SEQ_CST) & 1;
+        __atomic_add_fetch(&cell->stringReaders[epoch], 1, __ATOMIC_SEQ_CST);
+        if ((__atomic_load_n(&cell->stringEpoch, __ATOMIC_SEQ_CST) & 1) == epoch)
+            break;
+        __atomic_sub_fetch(&cell->stringReaders[epoch], 1, __ATOMIC_RELEASE);
+    }
+
+    const UA_String *current = __atomic_load_n(&cell->string, __ATOMIC_SEQ_CST);
+    UA_StatusCode status = UA_String_copy(current, out);
+    __atomic_sub_fetch(&cell->stringReaders[epoch], 1, __ATOMIC_RELEASE);
+    return status;
+}
+
+static UA_StatusCode valueCellWriteString(ValueCell *cell, const UA_String *value)
+{
+    UA_String *next = UA_String_new();
+    if (!next)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_StatusCode status = UA_String_copy(value, next);
+    if (status != UA_STATUSCODE_GOOD)
+    {
+        UA_String_delete(next);
+        return status;
+    }
+
+    while (__atomic_test_and_set(&cell->stringWriting, __ATOMIC_ACQUIRE))
+        sched_yield();
+
+    UA_String *previous = __atomic_exchange_n(&cell->string, next, __ATOMIC_SEQ_CST);
+
+    // 宽限期：翻转代号后只等待旧代号的读者，交换后开始的读者计入新代号，持续的读取不会让写者一直等待
+    UA_UInt32 epoch = __atomic_fetch_add(&cell->stringEpoch, 1, __ATOMIC_SEQ_CST) & 1;
+    while (__atomic_load_n(&cell->stringReaders[epoch], __ATOMIC_SEQ_CST) != 0)
+        sched_yield();
+
+    __atomic_clear(&cell->stringWriting, __ATOMIC_RELEASE);
+    UA_String_delete(previous);
+    return UA_STATUSCODE_GOOD;
+}
+
+// ==================== 变量注册表 ====================
+static inline VariableContext *tagRegistryAt(const TagRegistry *registry, size_t index)
+{
+    return &registry->chunks[index >> TAG_CHUNK_SHIFT][index & (TAG_CHUNK_SIZE - 1)];
+}
+
+static VariableContext *tagRegistryFind(const TagRegistry *registry, const UA_NodeId *nodeId)
+{
+    if (registry->hashCapacity == 0)
+        return NULL;
+
+    size_t mask = registry->hashCapacity - 1;
+    for (size_t slot = UA_NodeId_hash(nodeId) & mask;; slot = (slot + 1) & mask)
+    {
+        UA_UInt32 entry = registry->hashSlots[slot];
+        if (entry == 0)
+            return NULL;
+        VariableContext *context = tagRegistryAt(registry, entry - 1);
+        if (UA_NodeId_equal(&context->nodeId, nodeId))
+            return context;
+    }
+}
+
+static void tagRegistryInsertHash(TagRegistry *registry, const VariableContext *context)
+{
+    size_t mask = registry->hashCapacity - 1;
+    size_t slot = UA_NodeId_hash(&context->nodeId) & mask;
+    while (registry->hashSlots[slot] != 0)
+        slot = (slot + 1) & mask;
+    registry->hashSlots[slot] = (UA_UInt32)(context->index + 1);
+}
+
+// 负载因子超过0.7时扩容并重建哈希索引
+static UA_StatusCode tagRegistryGrowHash(TagRegistry *registry)
+{
+    if ((registry->count + 1) * 10 < registry->hashCapacity * 7)
+        return UA_STATUSCODE_GOOD;
+
+    size_t capacity = registry->hashCapacity ? registry->hashCapacity * 2 : 1024;
+    UA_UInt32 *slots = (UA_UInt32 *)UA_calloc(capacity, sizeof(UA_UInt32));
+    if (!slots)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_free(registry->hashSlots);
+    registry->hashSlots = slots;
+    registry->hashCapacity = capacity;
+    for (size_t i = 0; i < registry->count; i++)
+    {
+        VariableContext *context = tagRegistryAt(registry, i);
+        if (!UA_NodeId_isNull(&context->nodeId))
+            tagRegistryInsertHash(registry, context);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+// 分配一条新记录（已清零）。记录在 tagRegistryCommit 之后才能按NodeId查找
+static VariableContext *tagRegistryAllocate(TagRegistry *registry)
+{
+    if (registry->count >= UA_UINT32_MAX - 1 || tagRegistryGrowHash(registry) != UA_STATUSCODE_GOOD)
+        return NULL;
+
+    size_t chunkIndex = registry->count >> TAG_CHUNK_SHIFT;
+    if (chunkIndex == registry->chunkCount)
+    {
+        if (registry->chunkCount == registry->chunkCapacity)
+        {
+            size_t capacity = registry->chunkCapacity ? registry->chunkCapacity * 2 : 16;
+            VariableContext **chunks = (VariableContext **)
+                UA_realloc(registry->chunks, capacity * sizeof(VariableContext *));
+            if (!chunks)
+                return NULL;
+            registry->chunks = chunks;
+            registry->chunkCapacity = capacity;
+        }
+
+        void *chunk = NULL;
+        if (registry->shared)
+        {
+            // 匿名共享映射在派生后仍指向同一物理页，映射按页对齐
+            chunk = mmap(NULL, TAG_CHUNK_SIZE * sizeof(VariableContext), PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            if (chunk == MAP_FAILED)
+                return NULL;
+        }
+        else if (posix_memalign(&chunk, CACHE_LINE_SIZE, TAG_CHUNK_SIZE * sizeof(VariableContext)) != 0)
+            return NULL;
+        registry->chunks[registry->chunkCount++] = (VariableContext *)chunk;
+    }
+
+    VariableContext *context = tagRegistryAt(registry, registry->count);
+    memset(context, 0, sizeof(VariableContext));
+    context->simulationGroup = -1;
+    context->index = registry->count++;
+    return context;
+}
+
+static UA_StatusCode tagRegistryCommit(TagRegistry *registry, VariableContext *context,
+                                       const UA_NodeId *nodeId)
+{
+    UA_StatusCode status = UA_NodeId_copy(nodeId, &context->nodeId);
+    if (status == UA_STATUSCODE_GOOD)
+        tagRegistryInsertHash(registry, context);
+    return status;
+}
+
+// 撤销最近一次分配（节点创建失败时使用）
+static void tagRegistryDiscardLast(TagRegistry *registry)
+{
+    if (registry->count > 0)
+        registry->count--;
+}
+
+// ==================== 向量化数学函数 ====================
+// 加上再减去 1.5*2^52 可将 |x| < 2^51 的值舍入到最近整数，且能被向量化
+#define ROUND_MAGIC 6755399441055744.0
+#define PI_HI 3.14159265358979311600
+#define PI_LO 1.22464679914735317723e-16
+#define SQRT_HALF_BITS 0x3FE6A09E667F3BCDULL
+#define EXPONENT_MAGIC_BITS 0x4330000000000000ULL // 2^52
+
+static inline double roundNearest(double x)
+{
+    return (x + ROUND_MAGIC) - ROUND_MAGIC;
+}
+
+// 可向量化的正弦：x = kπ + r，r在[-π/2, π/2]内用奇次多项式求值（误差小于1e-11），
+// k为奇数时翻转符号位。全程无分支；大参数的归约误差约为 |x|·2^-53，与模拟用途相比可以忽略
+static inline double vectorSin(double x)
+{
+    union
+    {
+        UA_UInt64 bits;
+        double value;
+    } q, result;
+    q.value = x * M_1_PI + ROUND_MAGIC; // 尾数低位即为k
+    double k = q.value - ROUND_MAGIC;
+    double r = (x - k * PI_HI) - k * PI_LO;
+    double r2 = r * r;
+    double p = 1.0 / 1307674368000.0;
+    p = p * r2 - 1.0 / 6227020800.0;
+    p = p * r2 + 1.0 / 39916800.0;
+    p = p * r2 - 1.0 / 362880.0;
+    p = p * r2 + 1.0 / 5040.0;
+    p = p * r2 - 1.0 / 120.0;
+    p = p * r2 + 1.0 / 6.0;
+    result.value = r - r * r2 * p;
+    result.bits ^= q.bits << 63;
+    return result.value;
+}
+
+// 对数：拆出指数后把尾数归约到[√½, √2)，用atanh级数求值
+static inline double vectorLog(double x)
+{
+    union
+    {
+        UA_UInt64 bits;
+        double value;
+    } u, e;
+    u.value = x;
+    // 以√½为界拆分指数，使尾数落在[√½, √2)；指数经2^52偏移直接转为浮点数
+    UA_UInt64 biased = (u.bits - SQRT_HALF_BITS + 0x3FF0000000000000ULL) >> 52;
+    u.bits -= (biased - 1023) << 52;
+    e.bits = biased | EXPONENT_MAGIC_BITS;
+    double exponent = e.value - (4503599627370496.0 + 1023.0);
+    double m = u.value;
+
+    double z = (m - 1.0) / (m + 1.0);
+    double z2 = z * z;
+    double p = 1.0 / 15.0;
+    p = p * z2 + 1.0 / 13.0;
+    p = p * z2 + 1.0 / 11.0;
+    p = p * z2 + 1.0 / 9.0;
+    p = p * z2 + 1.0 / 7.0;
+    p = p * z2 + 1.0 / 5.0;
+    p = p * z2 + 1.0 / 3.0;
+    return exponent * M_LN2 + 2.0 * z * (1.0 + z2 * p);
+}
+
+// ==================== 计数器随机数 ====================
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+
+// Philox4x32-10：以运行种子为密钥加密计数器(抽样序号, 变量序号)得到128位随机数。
+// 结果只取决于(种子, 变量, 序号)，与计算顺序、分块和线程数无关
+static inline void philox4x32(UA_UInt64 seed, UA_UInt32 stream, UA_UInt64 counter,
+                              UA_UInt64 *out0, UA_UInt64 *out1)
+{
+    UA_UInt32 c0 = (UA_UInt32)counter;
+    UA_UInt32 c1 = (UA_UInt32)(counter >> 32);
+    UA_UInt32 c2 = stream;
+    UA_UInt32 c3 = 0;
+    UA_UInt32 k0 = (UA_UInt32)seed;
+    UA_UInt32 k1 = (UA_UInt32)(seed >> 32);
+    for (int round = 0; round < 10; round++)
+    {
+        UA_UInt64 p0 = (UA_UInt64)PHILOX_M0 * c0;
+        UA_UInt64 p1 = (UA_UInt64)PHILOX_M1 * c2;
+        UA_UInt32 n0 = (UA_UInt32)(p1 >> 32) ^ c1 ^ k0;
+        UA_UInt32 n2 = (UA_UInt32)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (UA_UInt32)p1;
+        c3 = (UA_UInt32)p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    *out0 = c0 | ((UA_UInt64)c1 << 32);
+    *out1 = c2 | ((UA_UInt64)c3 << 32);
+}
+
+// 取高52位构造[1, 2)的浮点数再减1，得到[0, 1)均匀分布
+static inline double unitDouble(UA_UInt64 bits)
+{
+    union
+    {
+        UA_UInt64 bits;
+        double value;
+    } u;
+    u.bits = (bits >> 12) | 0x3FF0000000000000ULL;
+    return u.value - 1.0;
+}
+
+static inline double philoxUniform(UA_UInt64 seed, UA_UInt32 stream, UA_UInt64 counter)
+{
+    UA_UInt64 r0, r1;
+    philox4x32(seed, stream, counter, &r0, &r1);
+    return unitDouble(r0);
+}
+
+// Box-Muller，一次抽样只取一个正态变量，保证抽样之间互不依赖
+static inline double philoxGaussian(UA_UInt64 seed, UA_UInt32 stream, UA_UInt64 counter)
+{
+    UA_UInt64 r0, r1;
+    philox4x32(seed, stream, counter, &r0, &r1);
+    double u1 = 1.0 - unitDouble(r0); // (0, 1]
+    double u2 = unitDouble(r1);
+    return sqrt(-2.0 * vectorLog(u1)) * vectorSin(2 * M_PI * u2 + M_PI_2);
+}
+
+// 为整个分组批量生成均匀分布/正态分布变量，并推进各自的抽样序号
+SIMD_KERNEL static void uniformKernel(size_t n, UA_UInt64 seed, const UA_UInt32 *restrict stream,
+                                      UA_UInt64 *restrict counter, double *restrict out)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = philoxUniform(seed, stream[i], counter[i]++);
+}
+
+SIMD_KERNEL static void gaussianKernel(size_t n, UA_UInt64 seed, const UA_UInt32 *restrict stream,
+                                       UA_UInt64 *restrict counter, double *restrict out)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = philoxGaussian(seed, stream[i], counter[i]++);
+}
+
+static double tagUniform(VariableContext *context)
+{
+    return philoxUniform(g_serverContext.runSeed, (UA_UInt32)context->index, context->rngCounter++);
+}
+
+static double tagGaussian(VariableContext *context)
+{
+    return philoxGaussian(g_serverContext.runSeed, (UA_UInt32)context->index, context->rngCounter++);
+}
+
+// ==================== 数据模拟函数 ====================
+static void checkAlarm(VariableContext *context)
+{
+    // 检查报警条件
+    if (context->hasAlarm && context->type == &UA_TYPES[UA_TYPES_FLOAT])
+    {
+        UA_Boolean newAlarmState = (valueCellLoad(&context->cell).floatValue > context->alarmThreshold);
+        if (newAlarmState != context->alarmState)
+        {
+            context->alarmState = newAlarmState;
+            logMessage(LOG_LEVEL_WARNING, "报警状态变更: %s", newAlarmState ? "激活" : "解除");
+        }
+    }
+}
+
+// 模拟使用的高精度时间（秒）
+static double simulationTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// tick 为本次写入所在的模拟周期序号，0 表示在周期之外求值（立即可见）
+void updateSimulatedValue(VariableContext *context, double now, UA_UInt64 tick)
+{
+    if (context->simulation == SIMULATION_NONE)
+        return;
+
+    double timeDiff = now - context->lastUpdate;
+    ScalarValue next = {0};
+
+    switch (context->simulation)
+    {
+    case SIMULATION_SINE_WAVE:
+    {
+        if (context->type == &UA_TYPES[UA_TYPES_FLOAT])
+        {
+            double frequency = context->simulationParam1;
+            double amplitude = context->simulationParam2;
+            double offset = context->simulationParam3;
+            next.floatValue = (UA_Float)(amplitude * sin(2 * M_PI * frequency * now / 60.0) + offset);
+            valueCellPublish(&context->cell, next, tick);
+        }
+        else if (context->type == &UA_TYPES[UA_TYPES_DOUBLE])
+        {
+            double frequency = context->simulationParam1;
+            double amplitude = context->simulationParam2;
+            double offset = context->simulationParam3;
+            next.doubleValue = amplitude * sin(2 * M_PI * frequency * now / 60.0) + offset;
+            valueCellPublish(&context->cell, next, tick);
+        }
+        break;
+    }
+    case SIMULATION_RANDOM:
+    {
+        if (context->type == &UA_TYPES[UA_TYPES_INT32])
+        {
+            int min = (int)context->simulationParam2;
+            int max = (int)context->simulationParam3;
+            next.int32 = min + (int)(tagUniform(context) * (max - min + 1.0));
+            valueCellPublish(&context->cell, next, tick);
+        }
+        else if (context->type == &UA_TYPES[UA_TYPES_FLOAT])
+        {
+            float min = (float)context->simulationParam2;
+            float max = (float)context->simulationParam3;
+            next.floatValue = (float)(min + tagUniform(context) * (max - min));
+            valueCellPublish(&context->cell, next, tick);
+        }
+        break;
+    }
+    case SIMULATION_COUNTER:
+    {
+        // 使用CAS累加，不会覆盖客户端并发写入的值
+        ScalarValue current = valueCellLoad(&context->cell);
+        if (context->type == &UA_TYPES[UA_TYPES_INT32])
+        {
+            do
+            {
+                next = current;
+                next.int32 += (UA_Int32)context->simulationParam1;
+            } while (!valueCellPublishExchange(&context->cell, &current, next, tick));
+        }
+        else if (context->type == &UA_TYPES[UA_TYPES_UINT32])
+        {
+            do
+            {
+                next = current;
+                next.uint32 += (UA_UInt32)context->simulationParam1;
+            } while (!valueCellPublishExchange(&context->cell, &current, next, tick));
+        }
+        break;
+    }
+    case SIMULATION_SQUARE_WAVE:
+    {
+        if (context->type == &UA_TYPES[UA_TYPES_BOOLEAN])
+        {
+            double period = context->simulationParam1;
+            next.boolean = (UA_Boolean)(fmod(now, period) < (period / 2));
+            valueCellPublish(&context->cell, next, tick);
+        }
+        break;
+    }
+    case SIMULATION_GAUSSIAN_NOISE:
+    {
+        double mean = context->simulationParam2;
+        double stddev = context->simulationParam3;
+        if (context->type == &UA_TYPES[UA_TYPES_FLOAT])
+        {
+            next.floatValue = (UA_Float)(mean + stddev * tagGaussian(context));
+            valueCellPublish(&context->cell, next, tick);
+        }
+        else if (context->type == &UA_TYPES[UA_TYPES_DOUBLE])
+        {
+            next.doubleValue = mean + stddev * tagGaussian(context);
+            valueCellPublish(&context->cell, next, tick);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    context->lastUpdate = (time_t)now;
+    checkAlarm(context);
+}
+
+// 按更新周期划分的绝对序号，惰性求值据此计算经过的周期数
+static UA_UInt64 simulationStepAt(const VariableContext *context, double now)
+{
+    return (UA_UInt64)(now * 1000.0) / context->updatePeriodMs;
+}
+
+// 模拟周期的起始时间：同一周期内的读取按相同时间求值，各变量的值属于同一个周期
+static double simulationTickTime(double now)
+{
+    return floor(now * 1000.0 / SIMULATION_TICK_MS) * SIMULATION_TICK_MS / 1000.0;
+}
+
+// 惰性模式：正弦和方波是时间的纯函数，按当前模拟周期的起始时间求值；
+// 计数器和随机数只在经过至少一个更新周期后变化，计数器一次累加所有经过的周期，
+// 随机数以周期序号作为抽样序号，同一周期内读到的值相同
+static void evaluateSimulatedValue(VariableContext *context, double now)
+{
+    now = simulationTickTime(now);
+    if (context->simulation == SIMULATION_SINE_WAVE || context->simulation == SIMULATION_SQUARE_WAVE)
+    {
+        updateSimulatedValue(context, now, 0);
+        return;
+    }
+    UA_Boolean random = context->simulation == SIMULATION_RANDOM ||
+                        context->simulation == SIMULATION_GAUSSIAN_NOISE;
+    if (context->simulation != SIMULATION_COUNTER && !random)
+        return;
+
+    // 服务工作线程可能同时读取同一变量，只有推进了周期序号的线程求值
+    UA_UInt64 step = simulationStepAt(context, now);
+    UA_UInt64 previous = __atomic_load_n(&context->lazyStep, __ATOMIC_RELAXED);
+    do
+    {
+        if (step <= previous)
+            return;
+    } while (!__atomic_compare_exchange_n(&context->lazyStep, &previous, step, true, __ATOMIC_RELAXED,
+                                          __ATOMIC_RELAXED));
+    UA_UInt64 elapsed = step - previous;
+
+    if (random)
+    {
+        context->rngCounter = step;
+        updateSimulatedValue(context, now, 0);
+        return;
+    }
+
+    if (context->type != &UA_TYPES[UA_TYPES_INT32] && context->type != &UA_TYPES[UA_TYPES_UINT32])
+        return;
+
+    // 按2^32取模累加，Int32与UInt32的回绕行为一致
+    UA_UInt32 increment = (UA_UInt32)((UA_UInt64)(UA_Int64)context->simulationParam1 * elapsed);
+    ScalarValue current = valueCellLoad(&context->cell);
+    ScalarValue next;
+    do
+    {
+        next = current;
+        next.uint32 += increment;
+    } while (!valueCellCompareExchange(&context->cell, &current, next));
+    context->lastUpdate = (time_t)now;
+}
+
+// ==================== 批量模拟引擎 ====================
+SIMD_KERNEL static void sineKernel(size_t n, double t,
+                                   const double *restrict phase, const double *restrict frequency,
+                                   const double *restrict amplitude, const double *restrict offset,
+                                   double *restrict out)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = amplitude[i] * vectorSin(2 * M_PI * frequency[i] * t / 60.0 + phase[i]) + offset[i];
+}
+
+SIMD_KERNEL static void counterKernel(size_t n, const UA_UInt32 *restrict current,
+                                      const UA_UInt32 *restrict increment, UA_UInt32 *restrict out)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = current[i] + increment[i];
+}
+
+SIMD_KERNEL static void squareKernel(size_t n, double t, const double *restrict period,
+                                     UA_Byte *restrict out)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        // 与最近整数的差在[0, 0.5)内即处于周期前半段
+        double cycles = t / period[i];
+        double fraction = cycles - roundNearest(cycles);
+        out[i] = (UA_Byte)((fraction >= 0.0) & (fraction < 0.5));
+    }
+}
+
+static int simulationGroupKind(SimulationType simulation, const UA_DataType *type)
+{
+    switch (simulation)
+    {
+    case SIMULATION_SINE_WAVE:
+        if (type == &UA_TYPES[UA_TYPES_FLOAT])
+            return SIMULATION_GROUP_SINE_FLOAT;
+        if (type == &UA_TYPES[UA_TYPES_DOUBLE])
+            return SIMULATION_GROUP_SINE_DOUBLE;
+        break;
+    case SIMULATION_RANDOM:
+        if (type == &UA_TYPES[UA_TYPES_INT32])
+            return SIMULATION_GROUP_RANDOM_INT32;
+        if (type == &UA_TYPES[UA_TYPES_FLOAT])
+            return SIMULATION_GROUP_RANDOM_FLOAT;
+        break;
+    case SIMULATION_COUNTER:
+        if (type == &UA_TYPES[UA_TYPES_INT32])
+            return SIMULATION_GROUP_COUNTER_INT32;
+        if (type == &UA_TYPES[UA_TYPES_UINT32])
+            return SIMULATION_GROUP_COUNTER_UINT32;
+        break;
+    case SIMULATION_SQUARE_WAVE:
+        if (type == &UA_TYPES[UA_TYPES_BOOLEAN])
+            return SIMULATION_GROUP_SQUARE_BOOLEAN;
+        break;
+    case SIMULATION_GAUSSIAN_NOISE:
+        if (type == &UA_TYPES[UA_TYPES_FLOAT])
+            return SIMULATION_GROUP_GAUSSIAN_FLOAT;
+        if (type == &UA_TYPES[UA_TYPES_DOUBLE])
+            return SIMULATION_GROUP_GAUSSIAN_DOUBLE;
+        break;
+    default:
+        break;
+    }
+    return -1;
+}
+
+static UA_Boolean growSimulationArray(void **array, size_t capacity, size_t elementSize)
+{
+    if (!*array)
+        return true;
+    void *grown = UA_realloc(*array, capacity * elementSize);
+    if (!grown)
+        return false;
+    *array = grown;
+    return true;
+}
+
+static UA_StatusCode simulationGroupReserve(SimulationGroup *group)
+{
+    SimulationGroupKind kind = group->kind;
+    if (group->count < group->capacity)
+        return UA_STATUSCODE_GOOD;
+
+    size_t capacity = group->capacity ? group->capacity * 2 : 64;
+    if (group->capacity == 0)
+    {
+        // 首次分配时按分组类型决定需要哪些数组（非NULL的数组随后一起扩容）
+        group->tags = (VariableContext **)UA_malloc(sizeof(VariableContext *));
+        if (kind == SIMULATION_GROUP_SINE_FLOAT || kind == SIMULATION_GROUP_SINE_DOUBLE)
+        {
+            group->phase = (double *)UA_malloc(sizeof(double));
+            group->frequency = (double *)UA_malloc(sizeof(double));
+            group->amplitude = (double *)UA_malloc(sizeof(double));
+            group->offset = (double *)UA_malloc(sizeof(double));
+        }
+        else if (kind == SIMULATION_GROUP_RANDOM_INT32 || kind == SIMULATION_GROUP_RANDOM_FLOAT)
+        {
+            group->minimum = (double *)UA_malloc(sizeof(double));
+            group->maximum = (double *)UA_malloc(sizeof(double));
+            group->rngStream = (UA_UInt32 *)UA_malloc(sizeof(UA_UInt32));
+            group->rngCounter = (UA_UInt64 *)UA_malloc(sizeof(UA_UInt64));
+        }
+        else if (kind == SIMULATION_GROUP_GAUSSIAN_FLOAT || kind == SIMULATION_GROUP_GAUSSIAN_DOUBLE)
+        {
+            group->mean = (double *)UA_malloc(sizeof(double));
+            group->stddev = (double *)UA_malloc(sizeof(double));
+            group->rngStream = (UA_UInt32 *)UA_malloc(sizeof(UA_UInt32));
+            group->rngCounter = (UA_UInt64 *)UA_malloc(sizeof(UA_UInt64));
+        }
+        else if (kind == SIMULATION_GROUP_COUNTER_INT32 || kind == SIMULATION_GROUP_COUNTER_UINT32)
+        {
+            group->increment = (UA_UInt32 *)UA_malloc(sizeof(UA_UInt32));
+        }
+        else
+        {
+            group->period = (double *)UA_malloc(sizeof(double));
+        }
+    }
+
+    if (!growSimulationArray((void **)&group->tags, capacity, sizeof(VariableContext *)) ||
+        !growSimulationArray((void **)&group->phase, capacity, sizeof(double)) ||
+        !growSimulationArray((void **)&group->frequency, capacity, sizeof(double)) ||
+        !growSimulationArray((void **)&group->amplitude, capacity, sizeof(double)) ||
+        !growSimulationArray((void **)&group->offset, capacity, sizeof(double)) ||
+        !growSimulationArray((void **)&group->minimum, capacity, sizeof(double)) ||
+        !growSimulationArray((void **)&group->maximum, capacity, sizeof(double)) ||
+        !growSimulationArray((void **)&group->mean, capacity, sizeof(double)) ||
+        !growSimulationArray((void **)&group->stddev, capacity, sizeof(double)) ||
+        !growSimulationArray((void **)&group->rngStream, capacity, sizeof(UA_UInt32)) ||
+        !growSimulationArray((void **)&group->rngCounter, capacity, sizeof(UA_UInt64)) ||
+        !growSimulationArray((void **)&group->increment, capacity, sizeof(UA_UInt32)) ||
+        !growSimulationArray((void **)&group->period, capacity, sizeof(double)))
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    group->capacity = capacity;
+    return UA_STATUSCODE_GOOD;
+}
+
+// 查找(类型, 周期)对应的分组，不存在时创建
+static int simulationEngineFindGroup(SimulationEngine *engine, SimulationGroupKind kind, UA_UInt32 periodMs)
+{
+    for (size_t g = 0; g < engine->groupCount; g++)
+    {
+        if (engine->groups[g]->kind == kind && engine->groups[g]->periodMs == periodMs)
+            return (int)g;
+    }
+
+    if (engine->groupCount == engine->groupCapacity)
+    {
+        size_t capacity = engine->groupCapacity ? engine->groupCapacity * 2 : SIMULATION_GROUP_COUNT;
+        SimulationGroup **groups = (SimulationGroup **)UA_realloc(engine->groups, capacity * sizeof(SimulationGroup *));
+        if (!groups)
+            return -1;
+        engine->groups = groups;
+        engine->groupCapacity = capacity;
+    }
+
+    SimulationGroup *group = (SimulationGroup *)UA_calloc(1, sizeof(SimulationGroup));
+    if (!group)
+        return -1;
+    group->kind = kind;
+    group->periodMs = periodMs;
+    group->timer.group = group;
+    engine->groups[engine->groupCount] = group;
+    return (int)engine->groupCount++;
+}
+
+// 将变量加入对应分组；不支持批量计算的组合返回 BADNOTSUPPORTED
+static UA_StatusCode simulationEngineAdd(SimulationEngine *engine, VariableContext *context)
+{
+    int kind = simulationGroupKind(context->simulation, context->type);
+    if (kind < 0)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    int g = simulationEngineFindGroup(engine, (SimulationGroupKind)kind, context->updatePeriodMs);
+    if (g < 0)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    SimulationGroup *group = engine->groups[g];
+    UA_StatusCode status = simulationGroupReserve(group);
+    if (status != UA_STATUSCODE_GOOD)
+        return status;
+
+    size_t i = group->count++;
+    group->tags[i] = context;
+    context->simulationGroup = g;
+    context->simulationSlot = i;
+    if (group->frequency)
+    {
+        group->phase[i] = 0.0;
+        group->frequency[i] = context->simulationParam1;
+        group->amplitude[i] = context->simulationParam2;
+        group->offset[i] = context->simulationParam3;
+    }
+    if (group->minimum)
+    {
+        group->minimum[i] = context->simulationParam2;
+        group->maximum[i] = context->simulationParam3;
+    }
+    if (group->mean)
+    {
+        group->mean[i] = context->simulationParam2;
+        group->stddev[i] = context->simulationParam3;
+    }
+    if (group->rngCounter)
+    {
+        group->rngStream[i] = (UA_UInt32)context->index;
+        group->rngCounter[i] = context->rngCounter;
+    }
+    if (group->increment)
+        group->increment[i] = (UA_UInt32)(UA_Int32)context->simulationParam1;
+    if (group->period)
+        group->period[i] = context->simulationParam1;
+    return UA_STATUSCODE_GOOD;
+}
+
+// 从分组中移除变量：用最后一个变量填补空位
+static void simulationEngineRemove(SimulationEngine *engine, VariableContext *context)
+{
+    if (context->simulationGroup < 0)
+        return;
+
+    SimulationGroup *group = engine->groups[context->simulationGroup];
+    size_t i = context->simulationSlot;
+    size_t last = --group->count;
+    if (group->rngCounter)
+        context->rngCounter = group->rngCounter[i];
+    if (i != last)
+    {
+        group->tags[i] = group->tags[last];
+        group->tags[i]->simulationSlot = i;
+        if (group->frequency)
+        {
+            group->phase[i] = group->phase[last];
+            group->frequency[i] = group->frequency[last];
+            group->amplitude[i] = group->amplitude[last];
+            group->offset[i] = group->offset[last];
+        }
+        if (group->minimum)
+        {
+            group->minimum[i] = group->minimum[last];
+            group->maximum[i] = group->maximum[last];
+        }
+        if (group->mean)
+        {
+            group->mean[i] = group->mean[last];
+            group->stddev[i] = group->stddev[last];
+        }
+        if (group->rngCounter)
+        {
+            group->rngStream[i] = group->rngStream[last];
+            group->rngCounter[i] = group->rngCounter[last];
+        }
+        if (group->increment)
+            group->increment[i] = group->increment[last];
+        if (group->period)
+            group->period[i] = group->period[last];
+    }
+    context->simulationGroup = -1;
+}
+
+static void cleanupSimulationEngine(SimulationEngine *engine)
+{
+    for (size_t g = 0; g < engine->groupCount; g++)
+    {
+        SimulationGroup *group = engine->groups[g];
+        UA_free(group->tags);
+        UA_free(group->phase);
+        UA_free(group->frequency);
+        UA_free(group->amplitude);
+        UA_free(group->offset);
+        UA_free(group->minimum);
+        UA_free(group->maximum);
+        UA_free(group->mean);
+        UA_free(group->stddev);
+        UA_free(group->rngStream);
+        UA_free(group->rngCounter);
+        UA_free(group->increment);
+        UA_free(group->period);
+        UA_free(group);
+    }
+    UA_free(engine->groups);
+    memset(engine, 0, sizeof(SimulationEngine));
+}
+
+// 计算分组中[begin, begin + n)的变量，作为周期tick的值写回值单元
+static void simulationGroupStepBlock(SimulationGroup *group, size_t begin, size_t n, double t, UA_UInt64 tick)
+{
+    SimulationGroupKind kind = group->kind;
+    time_t now = (time_t)t;
+    double out[SIMULATION_BLOCK_SIZE];
+    UA_UInt32 current[SIMULATION_BLOCK_SIZE];
+    UA_UInt32 counters[SIMULATION_BLOCK_SIZE];
+    UA_Byte flags[SIMULATION_BLOCK_SIZE];
+    VariableContext **tags = group->tags + begin;
+
+    switch (kind)
+    {
+    case SIMULATION_GROUP_SINE_FLOAT:
+    case SIMULATION_GROUP_SINE_DOUBLE:
+        sineKernel(n, t, group->phase + begin, group->frequency + begin,
+                   group->amplitude + begin, group->offset + begin, out);
+        break;
+    case SIMULATION_GROUP_RANDOM_INT32:
+    case SIMULATION_GROUP_RANDOM_FLOAT:
+        uniformKernel(n, g_serverContext.runSeed, group->rngStream + begin, group->rngCounter + begin, out);
+        break;
+    case SIMULATION_GROUP_GAUSSIAN_FLOAT:
+    case SIMULATION_GROUP_GAUSSIAN_DOUBLE:
+        gaussianKernel(n, g_serverContext.runSeed, group->rngStream + begin, group->rngCounter + begin, out);
+        break;
+    case SIMULATION_GROUP_COUNTER_INT32:
+    case SIMULATION_GROUP_COUNTER_UINT32:
+        for (size_t i = 0; i < n; i++)
+            current[i] = valueCellLoad(&tags[i]->cell).uint32;
+        counterKernel(n, current, group->increment + begin, counters);
+        break;
+    case SIMULATION_GROUP_SQUARE_BOOLEAN:
+        squareKernel(n, t, group->period + begin, flags);
+        break;
+    default:
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        VariableContext *context = tags[i];
+        ScalarValue next = {0};
+        switch (kind)
+        {
+        case SIMULATION_GROUP_SINE_FLOAT:
+            next.floatValue = (UA_Float)out[i];
+            break;
+        case SIMULATION_GROUP_SINE_DOUBLE:
+            next.doubleValue = out[i];
+            break;
+        case SIMULATION_GROUP_RANDOM_INT32:
+        {
+            int min = (int)group->minimum[begin + i];
+            int max = (int)group->maximum[begin + i];
+            next.int32 = min + (int)(out[i] * (max - min + 1.0));
+            break;
+        }
+        case SIMULATION_GROUP_RANDOM_FLOAT:
+        {
+            float min = (float)group->minimum[begin + i];
+            float max = (float)group->maximum[begin + i];
+            next.floatValue = (float)(min + out[i] * (max - min));
+            break;
+        }
+        case SIMULATION_GROUP_COUNTER_INT32:
+        case SIMULATION_GROUP_COUNTER_UINT32:
+        {
+            // CAS失败说明客户端刚写入了新值，在新值基础上累加
+            ScalarValue expected = {0};
+            expected.uint32 = current[i];
+            next.uint32 = counters[i];
+            while (!valueCellPublishExchange(&context->cell, &expected, next, tick))
+                next.uint32 = expected.uint32 + group->increment[begin + i];
+            context->lastUpdate = now;
+            continue;
+        }
+        case SIMULATION_GROUP_SQUARE_BOOLEAN:
+            next.boolean = flags[i];
+            break;
+        case SIMULATION_GROUP_GAUSSIAN_FLOAT:
+            next.floatValue = (UA_Float)(group->mean[begin + i] + group->stddev[begin + i] * out[i]);
+            break;
+        case SIMULATION_GROUP_GAUSSIAN_DOUBLE:
+            next.doubleValue = group->mean[begin + i] + group->stddev[begin + i] * out[i];
+            break;
+        default:
+            break;
+        }
+        valueCellPublish(&context->cell, next, tick);
+        context->lastUpdate = now;
+        if (context->hasAlarm)
+            checkAlarm(context);
+    }
+}
+
+static void simulationGroupStep(SimulationGroup *group, double t, UA_UInt64 tick)
+{
+    for (size_t begin = 0; begin < group->count; begin += SIMULATION_BLOCK_SIZE)
+    {
+        size_t n = group->count - begin;
+        if (n > SIMULATION_BLOCK_SIZE)
+            n = SIMULATION_BLOCK_SIZE;
+        simulationGroupStepBlock(group, begin, n, t, tick);
+    }
+}
+
+// ==================== 变化推送 ====================
+static UA_StatusCode changePushInit(ChangePush *push, UA_Boolean useWakeup)
+{
+    size_t capacity = (size_t)1 << CHANGE_RING_BITS;
+    void *ring = NULL;
+    if (posix_memalign(&ring, CACHE_LINE_SIZE, capacity * sizeof(ChangeRecord)) != 0)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    push->ring = (ChangeRecord *)ring;
+    push->mask = capacity - 1;
+    for (size_t i = 0; i < capacity; i++)
+        push->ring[i].sequence = i;
+    push->enqueuePos = 0;
+    push->dequeuePos = 0;
+    push->wakeupFd = useWakeup ? eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) : -1;
+    if (useWakeup && push->wakeupFd < 0)
+        logMessage(LOG_LEVEL_WARNING, "创建eventfd失败，变化推送按周期处理");
+    return UA_STATUSCODE_GOOD;
+}
+
+static void cleanupChangePush(ChangePush *push)
+{
+    if (push->wakeupFd >= 0)
+        close(push->wakeupFd);
+    push->wakeupFd = -1;
+    free(push->ring);
+    push->ring = NULL;
+}
+
+// 生产者：一次CAS预留连续的count个位置。消费者按顺序释放位置，
+// 因此最后一个位置可写时前面的位置也都可写
+static UA_Boolean changePushEnqueue(ChangePush *push, const ChangeRecord *records, size_t count)
+{
+    UA_UInt64 pos = __atomic_load_n(&push->enqueuePos, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        ChangeRecord *last = &push->ring[(pos + count - 1) & push->mask];
+        UA_Int64 diff = (UA_Int64)(__atomic_load_n(&last->sequence, __ATOMIC_ACQUIRE) - (pos + count - 1));
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&push->enqueuePos, &pos, pos + count, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+        {
+            return false; // 队列已满
+        }
+        else
+        {
+            pos = __atomic_load_n(&push->enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        ChangeRecord *slot = &push->ring[(pos + i) & push->mask];
+        slot->tag = records[i].tag;
+        slot->value = records[i].value;
+        slot->time = records[i].time;
+        __atomic_store_n(&slot->sequence, pos + i + 1, __ATOMIC_RELEASE);
+    }
+    return true;
+}
+
+// 消费者（仅服务器线程）
+static UA_Boolean changePushDequeue(ChangePush *push, ChangeRecord *out)
+{
+    ChangeRecord *slot = &push->ring[push->dequeuePos & push->mask];
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != push->dequeuePos + 1)
+        return false;
+    out->tag = slot->tag;
+    out->value = slot->value;
+    out->time = slot->time;
+    __atomic_store_n(&slot->sequence, push->dequeuePos + push->mask + 1, __ATOMIC_RELEASE);
+    push->dequeuePos++;
+    return true;
+}
+
+static void changePushFlush(ChangePush *push, const ChangeRecord *records, size_t count)
+{
+    if (count == 0)
+        return;
+    if (!changePushEnqueue(push, records, count))
+    {
+        __atomic_fetch_add(&push->dropped, count, __ATOMIC_RELAXED);
+        return;
+    }
+    // 每次服务器线程处理后只写一次eventfd
+    if (push->wakeupFd >= 0 && !__atomic_exchange_n(&push->wakeupPending, true, __ATOMIC_ACQ_REL))
+    {
+        UA_UInt64 one = 1;
+        if (write(push->wakeupFd, &one, sizeof(one)) < 0)
+            __atomic_store_n(&push->wakeupPending, false, __ATOMIC_RELEASE);
+    }
+}
+
+// 模拟线程：周期全部计算完成并发布后提交其中被监视的变量，推送的总是完整周期的值
+static void changePushTags(VariableContext *const *tags, size_t count, double t)
+{
+    ChangePush *push = &g_serverContext.changePush;
+    if (!push->enabled || __atomic_load_n(&push->monitoredTags, __ATOMIC_RELAXED) == 0)
+        return;
+
+    ChangeRecord batch[CHANGE_PUSH_BATCH];
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        VariableContext *context = tags[i];
+        if (__atomic_load_n(&context->monitorCount, __ATOMIC_RELAXED) == 0)
+            continue;
+        batch[n].tag = (UA_UInt32)context->index;
+        batch[n].value = valueCellRead(&context->cell, g_serverContext.simulationEpoch);
+        batch[n].time = t;
+        if (++n == CHANGE_PUSH_BATCH)
+        {
+            changePushFlush(push, batch, n);
+            n = 0;
+        }
+    }
+    changePushFlush(push, batch, n);
+}
+
+// 服务器线程：eventfd唤醒时以及每个时间轮周期（兜底）取出队列中的全部记录
+static void changePushDrain(UA_Server *server, void *data)
+{
+    ChangePush *push = &g_serverContext.changePush;
+    // 先清除标志再取队列，之后提交的记录会再次唤醒
+    __atomic_store_n(&push->wakeupPending, false, __ATOMIC_SEQ_CST);
+
+    UA_UInt64 depth = __atomic_load_n(&push->enqueuePos, __ATOMIC_RELAXED) - push->dequeuePos;
+    if (depth == 0)
+        return;
+    if (depth > push->maxDepth)
+        push->maxDepth = depth;
+
+    double now = simulationTime();
+    UA_UInt64 applied = 0;
+    ChangeRecord record;
+    // 最多处理一圈，避免生产者持续写入时阻塞服务器线程
+    while (applied <= push->mask && changePushDequeue(push, &record))
+    {
+        VariableContext *context = tagRegistryAt(&g_serverContext.tags, record.tag);
+        UA_DataValue value;
+        UA_DataValue_init(&value);
+        // 通知时按监视项复制，这里直接引用记录中的值
+        UA_Variant_setScalar(&value.value, &record.value, context->type);
+        value.value.storageType = UA_VARIANT_DATA_NODELETE;
+        value.hasValue = true;
+        value.hasSourceTimestamp = true;
+        value.sourceTimestamp = UA_DATETIME_UNIX_EPOCH + (UA_DateTime)(record.time * UA_DATETIME_SEC);
+        UA_Server_notifyDataChange(server, &context->nodeId, &value);
+
+        UA_UInt64 latencyUs = now > record.time ? (UA_UInt64)((now - record.time) * 1e6) : 0;
+        push->totalLatencyUs += latencyUs;
+        if (latencyUs > push->maxLatencyUs)
+            push->maxLatencyUs = latencyUs;
+        applied++;
+    }
+    push->batches++;
+    push->notifications += applied;
+}
+
+static void changePushWakeup(UA_Server *server, void *context)
+{
+    ChangePush *push = (ChangePush *)context;
+    push->wakeups++;
+    changePushDrain(server, NULL);
+}
+
+// 模拟变量的监视项由变化推送驱动，不再周期采样
+static UA_Boolean isPushSampledTag(UA_Server *server, const UA_NodeId *nodeId, void *nodeContext)
+{
+    VariableContext *context = tagRegistryFind(&g_serverContext.tags, nodeId);
+    return context && context->simulation != SIMULATION_NONE;
+}
+
+// 在服务器配置中启用变化推送：监视项改为推送采样，网络层等待eventfd，
+// 另有一个时间轮周期的重复回调保证eventfd不可用时也能处理
+static void changePushAttach(UA_Server *server, UA_ServerConfig *config)
+{
+    ChangePush *push = &g_serverContext.changePush;
+    config->monitoredItemPushSampling = isPushSampledTag;
+    if (push->wakeupFd >= 0)
+    {
+        for (size_t i = 0; i < config->networkLayersSize; i++)
+        {
+            config->networkLayers[i].wakeupFd = push->wakeupFd;
+            config->networkLayers[i].onWakeup = changePushWakeup;
+            config->networkLayers[i].wakeupContext = push;
+        }
+    }
+    UA_Server_addRepeatedCallback(server, changePushDrain, NULL, SIMULATION_TICK_MS, NULL);
+}
+
+// ==================== 服务工作线程 ====================
+static __thread UA_Boolean t_serviceWorkerThread; // 当前线程是服务工作线程
+
+static void *serviceWorkerThread(void *arg)
+{
+    t_serviceWorkerThread = true;
+    UA_Server_runServiceWorker((UA_Server *)arg);
+    return NULL;
+}
+
+// 工作线程：应答就绪后唤醒服务器主循环（服务器线程发送前只通知一次）
+static void serviceWorkersNotify(UA_Server *server, void *context)
+{
+    ServiceWorkers *workers = (ServiceWorkers *)context;
+    UA_UInt64 one = 1;
+    if (write(workers->wakeupFd, &one, sizeof(one)) < 0)
+        logMessage(LOG_LEVEL_DEBUG, "唤醒服务器主循环失败");
+}
+
+// 应答在每次主循环迭代的网络处理之后发送，唤醒本身无需处理
+static void serviceWorkersWakeup(UA_Server *server, void *context)
+{
+}
+
+// 在服务器配置中挂接工作线程的唤醒，变化推送已占用网络层的eventfd时共用
+static UA_StatusCode serviceWorkersAttach(ServiceWorkers *workers, UA_ServerConfig *config)
+{
+    if (config->networkLayersSize > 0 && config->networkLayers[0].onWakeup)
+    {
+        workers->wakeupFd = config->networkLayers[0].wakeupFd;
+        workers->ownsWakeupFd = false;
+    }
+    else
+    {
+        workers->wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (workers->wakeupFd < 0)
+            return UA_STATUSCODE_BADINTERNALERROR;
+        workers->ownsWakeupFd = true;
+        for (size_t i = 0; i < config->networkLayersSize; i++)
+        {
+            config->networkLayers[i].wakeupFd = workers->wakeupFd;
+            config->networkLayers[i].onWakeup = serviceWorkersWakeup;
+            config->networkLayers[i].wakeupContext = workers;
+        }
+    }
+    config->serviceWorkerNotify = serviceWorkersNotify;
+    config->serviceWorkerContext = workers;
+    return UA_STATUSCODE_GOOD;
+}
+
+// 返回成功创建的线程数
+static int serviceWorkersStart(ServiceWorkers *workers, UA_Server *server, int count)
+{
+    workers->count = 0;
+    workers->threads = (pthread_t *)calloc((size_t)count, sizeof(pthread_t));
+    if (!workers->threads)
+        return 0;
+    while (workers->count < count &&
+           pthread_create(&workers->threads[workers->count], NULL, serviceWorkerThread, server) == 0)
+        workers->count++;
+    return workers->count;
+}
+
+// 需在删除服务器之前调用，剩余的请求由工作线程执行完毕后退出
+static void serviceWorkersStop(ServiceWorkers *workers, UA_Server *server)
+{
+    if (workers->count > 0)
+    {
+        UA_Server_stopServiceWorkers(server);
+        for (int i = 0; i < workers->count; i++)
+            pthread_join(workers->threads[i], NULL);
+    }
+    workers->count = 0;
+    free(workers->threads);
+    workers->threads = NULL;
+    if (workers->ownsWakeupFd && workers->wakeupFd >= 0)
+        close(workers->wakeupFd);
+    workers->wakeupFd = -1;
+    workers->ownsWakeupFd = false;
+}
+
+// ==================== 多反应器 ====================
+static __thread ScalarValue *t_readSnapshots; // 附加反应器线程的零拷贝读取快照
+static __thread size_t t_readSnapshotCount;
+
+static void *reactorThread(void *arg)
+{
+    Reactor *reactor = (Reactor *)arg;
+    t_readSnapshots = reactor->readSnapshots;
+    t_readSnapshotCount = reactor->readSnapshotCount;
+    // 随机数状态按线程保存，每个反应器的会话和安全通道令牌使用自己的种子
+    UA_random_seed((UA_UInt64)UA_DateTime_now() ^ (UA_UInt64)(uintptr_t)reactor);
+    UA_StatusCode retval = UA_Server_run(reactor->server, g_serverContext.reactors.running);
+    if (retval != UA_STATUSCODE_GOOD)
+        logMessage(LOG_LEVEL_ERROR, "反应器运行失败: %s", UA_StatusCode_name(retval));
+    return NULL;
+}
+
+// 启动附加反应器的事件循环线程（主服务器由调用者运行），需在所有变量添加之后调用。
+// 返回成功启动的附加反应器数
+static int reactorsStart(Reactors *reactors, const volatile UA_Boolean *running)
+{
+    int started = 0;
+    reactors->running = running;
+    for (int i = 1; i < reactors->count; i++)
+    {
+        Reactor *reactor = &reactors->list[i];
+        if (g_serverContext.readMode == READ_MODE_ZERO_COPY)
+        {
+            reactor->readSnapshotCount = g_serverContext.tags.count;
+            reactor->readSnapshots = (ScalarValue *)calloc(reactor->readSnapshotCount, sizeof(ScalarValue));
+            if (!reactor->readSnapshots)
+                reactor->readSnapshotCount = 0; // 退回复制
+        }
+        reactor->threadStarted = pthread_create(&reactor->thread, NULL, reactorThread, reactor) == 0;
+        if (reactor->threadStarted)
+            started++;
+    }
+    return started;
+}
+
+// 等待附加反应器的事件循环结束（running已置为false），然后删除其服务器
+static void reactorsStop(Reactors *reactors)
+{
+    for (int i = 1; i < reactors->count; i++)
+    {
+        Reactor *reactor = &reactors->list[i];
+        if (reactor->threadStarted)
+            pthread_join(reactor->thread, NULL);
+        reactor->threadStarted = false;
+        if (!reactor->server)
+            continue;
+        UA_ServerStatistics stats = UA_Server_getStatistics(reactor->server);
+        logMessage(LOG_LEVEL_INFO, "反应器 %d: 累计连接 %zu", i, stats.ns.cumulatedConnectionCount);
+        UA_Server_delete(reactor->server);
+        reactor->server = NULL;
+        free(reactor->readSnapshots);
+        reactor->readSnapshots = NULL;
+        reactor->readSnapshotCount = 0;
+    }
+    free(reactors->list);
+    reactors->list = NULL;
+}
+
+// ==================== 并行模拟 ====================
+#define SIMULATION_TAG_TASK_SIZE 256 // 逐变量模拟时每个任务处理的变量数
+
+static void simulationFireTimer(SimulationTimer *timer, double t, UA_UInt64 tick)
+{
+    if (timer->tag)
+        updateSimulatedValue(timer->tag, t, tick);
+    else
+        simulationGroupStep(timer->group, t, tick);
+}
+
+// 周期发布后提交定时器对应变量中被监视的变量
+static void simulationPushTimer(SimulationTimer *timer, double t)
+{
+    if (timer->tag)
+        changePushTags(&timer->tag, 1, t);
+    else
+        changePushTags(timer->group->tags, timer->group->count, t);
+}
+
+static void simulationRunTask(SimulationPool *pool, const SimulationTask *task)
+{
+    if (task->group)
+    {
+        simulationGroupStepBlock(task->group, task->begin, task->count, pool->time, pool->tick);
+        return;
+    }
+    for (size_t i = 0; i < task->count; i++)
+        updateSimulatedValue(pool->dueTags[task->begin + i], pool->time, pool->tick);
+}
+
+// 先取完自己的队列，再依次从其他线程的队列窃取，直到所有任务被领取
+static void simulationPoolWork(SimulationPool *pool, int self)
+{
+    for (int k = 0; k < pool->threadCount; k++)
+    {
+        SimulationQueue *queue = &pool->queues[(self + k) % pool->threadCount];
+        for (;;)
+        {
+            size_t i = __atomic_fetch_add(&queue->head, 1, __ATOMIC_RELAXED);
+            if (i >= queue->end)
+                break;
+            if (k > 0)
+                __atomic_fetch_add(&pool->steals, 1, __ATOMIC_RELAXED);
+            simulationRunTask(pool, &pool->tasks[i]);
+        }
+    }
+}
+
+// 工作线程等待新的周期编号，完成后递减busy，最后一个完成的线程通知模拟线程
+static void *simulationWorkerThread(void *arg)
+{
+    SimulationWorker *worker = (SimulationWorker *)arg;
+    SimulationPool *pool = worker->pool;
+    UA_UInt64 seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;)
+    {
+        while (pool->generation == seen && !pool->stopping)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        if (pool->stopping)
+            break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        simulationPoolWork(pool, worker->index);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0)
+            pthread_cond_signal(&pool->idle);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static int defaultSimulationThreads(void)
+{
+    // 留出一个核心给服务器网络线程
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 2 ? (int)(cores - 1) : 1;
+}
+
+static void simulationPoolStart(SimulationPool *pool, int threadCount)
+{
+    memset(pool, 0, sizeof(*pool));
+    pool->threadCount = 1;
+    if (threadCount <= 1)
+        return;
+
+    void *queues = NULL;
+    if (posix_memalign(&queues, CACHE_LINE_SIZE, threadCount * sizeof(SimulationQueue)) != 0)
+    {
+        logMessage(LOG_LEVEL_WARNING, "模拟线程池内存分配失败，使用单线程模拟");
+        return;
+    }
+    pool->queues = (SimulationQueue *)queues;
+    memset(pool->queues, 0, threadCount * sizeof(SimulationQueue));
+    pool->workers = (SimulationWorker *)UA_calloc(threadCount, sizeof(SimulationWorker));
+    if (!pool->workers)
+    {
+        logMessage(LOG_LEVEL_WARNING, "模拟线程池内存分配失败，使用单线程模拟");
+        free(pool->queues);
+        pool->queues = NULL;
+        return;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    for (int i = 1; i < threadCount; i++)
+    {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        if (pthread_create(&pool->workers[i].thread, NULL, simulationWorkerThread,
+                           &pool->workers[i]) != 0)
+        {
+            logMessage(LOG_LEVEL_WARNING, "模拟工作线程创建失败，使用 %d 个线程", i);
+            break;
+        }
+        pool->threadCount = i + 1;
+    }
+}
+
+static void simulationPoolStop(SimulationPool *pool)
+{
+    if (pool->workers)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pool->stopping = true;
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+        for (int i = 1; i < pool->threadCount; i++)
+            pthread_join(pool->workers[i].thread, NULL);
+        pthread_mutex_destroy(&pool->lock);
+        pthread_cond_destroy(&pool->wake);
+        pthread_cond_destroy(&pool->idle);
+    }
+    UA_free(pool->workers);
+    free(pool->queues);
+    UA_free(pool->tasks);
+    UA_free(pool->dueTags);
+    memset(pool, 0, sizeof(*pool));
+    pool->threadCount = 1;
+}
+
+static UA_Boolean simulationPoolAddTask(SimulationPool *pool, SimulationGroup *group,
+                                        size_t begin, size_t count)
+{
+    if (pool->taskCount == pool->taskCapacity)
+    {
+        size_t capacity = pool->taskCapacity ? pool->taskCapacity * 2 : 64;
+        SimulationTask *tasks =
+            (SimulationTask *)UA_realloc(pool->tasks, capacity * sizeof(SimulationTask));
+        if (!tasks)
+            return false;
+        pool->tasks = tasks;
+        pool->taskCapacity = capacity;
+    }
+    SimulationTask *task = &pool->tasks[pool->taskCount++];
+    task->group = group;
+    task->begin = begin;
+    task->count = count;
+    return true;
+}
+
+static UA_Boolean simulationPoolAddTag(SimulationPool *pool, VariableContext *context)
+{
+    if (pool->dueCount == pool->dueCapacity)
+    {
+        size_t capacity = pool->dueCapacity ? pool->dueCapacity * 2 : 256;
+        VariableContext **tags =
+            (VariableContext **)UA_realloc(pool->dueTags, capacity * sizeof(VariableContext *));
+        if (!tags)
+            return false;
+        pool->dueTags = tags;
+        pool->dueCapacity = capacity;
+    }
+    pool->dueTags[pool->dueCount++] = context;
+    return true;
+}
+
+// 计算周期tick内到期的全部定时器，返回时所有线程的写入均已完成
+static void simulationPoolRun(SimulationPool *pool, SimulationTimer **fired, size_t count,
+                              double t, UA_UInt64 tick)
+{
+    // 分组按数据块拆分，逐变量定时器按段合并，使各任务的计算量相近
+    UA_Boolean ok = pool->threadCount > 1;
+    pool->taskCount = 0;
+    pool->dueCount = 0;
+    for (size_t i = 0; ok && i < count; i++)
+    {
+        SimulationTimer *timer = fired[i];
+        if (timer->tag)
+        {
+            ok = simulationPoolAddTag(pool, timer->tag);
+            continue;
+        }
+        for (size_t begin = 0; ok && begin < timer->group->count; begin += SIMULATION_BLOCK_SIZE)
+        {
+            size_t n = timer->group->count - begin;
+            ok = simulationPoolAddTask(pool, timer->group, begin,
+                                       n < SIMULATION_BLOCK_SIZE ? n : SIMULATION_BLOCK_SIZE);
+        }
+    }
+    for (size_t begin = 0; ok && begin < pool->dueCount; begin += SIMULATION_TAG_TASK_SIZE)
+    {
+        size_t n = pool->dueCount - begin;
+        ok = simulationPoolAddTask(pool, NULL, begin,
+                                   n < SIMULATION_TAG_TASK_SIZE ? n : SIMULATION_TAG_TASK_SIZE);
+    }
+
+    // 任务太少时唤醒线程的开销大于计算本身
+    if (!ok || pool->taskCount < 2)
+    {
+        for (size_t i = 0; i < count; i++)
+            simulationFireTimer(fired[i], t, tick);
+        return;
+    }
+
+    int threads = pool->threadCount;
+    if ((size_t)threads > pool->taskCount)
+        threads = (int)pool->taskCount;
+    for (int w = 0; w < pool->threadCount; w++)
+    {
+        pool->queues[w].head = w < threads ? pool->taskCount * w / threads : 0;
+        pool->queues[w].end = w < threads ? pool->taskCount * (w + 1) / threads : 0;
+    }
+    pool->time = t;
+    pool->tick = tick;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->busy = pool->threadCount - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    simulationPoolWork(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0)
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// ==================== 观察集合 ====================
+static void timingWheelStart(TimingWheel *wheel, SimulationTimer *timer, UA_UInt32 periodMs);
+
+// 服务器线程或服务工作线程：未在观察集合中的变量先按当前时间补算，再提交加入请求
+static void observedSetRequest(VariableContext *context, double now)
+{
+    if (__atomic_load_n(&context->observed, __ATOMIC_ACQUIRE))
+        return;
+    evaluateSimulatedValue(context, now);
+    if (__atomic_exchange_n(&context->activationPending, true, __ATOMIC_ACQ_REL))
+        return;
+
+    ObservedSet *set = &g_serverContext.observedSet;
+    pthread_mutex_lock(&set->lock);
+    if (set->pendingCount == set->pendingCapacity)
+    {
+        size_t capacity = set->pendingCapacity ? set->pendingCapacity * 2 : 64;
+        VariableContext **pending = (VariableContext **)
+            UA_realloc(set->pending, capacity * sizeof(VariableContext *));
+        if (!pending)
+        {
+            // 下次读取时重试
+            __atomic_store_n(&context->activationPending, false, __ATOMIC_RELEASE);
+            pthread_mutex_unlock(&set->lock);
+            return;
+        }
+        set->pending = pending;
+        set->pendingCapacity = capacity;
+    }
+    set->pending[set->pendingCount++] = context;
+    pthread_mutex_unlock(&set->lock);
+}
+
+static void observedSetOnRead(VariableContext *context, double now)
+{
+    __atomic_store_n(&context->lastReadMs, (UA_UInt64)(now * 1000.0), __ATOMIC_RELAXED);
+    observedSetRequest(context, now);
+}
+
+static UA_Boolean observedSetIsWatched(const VariableContext *context, double now)
+{
+    if (__atomic_load_n(&context->monitorCount, __ATOMIC_RELAXED) > 0)
+        return true;
+    UA_UInt64 lastReadMs = __atomic_load_n(&context->lastReadMs, __ATOMIC_RELAXED);
+    return (UA_UInt64)(now * 1000.0) < lastReadMs + g_serverContext.observedSet.windowMs;
+}
+
+// 模拟线程：开始周期计算。批量模式下不支持的组合保持待处理状态，继续在读取时补算
+static void observedSetActivate(TimingWheel *wheel, VariableContext *context)
+{
+    if (g_serverContext.simulationEngineMode == SIMULATION_ENGINE_BATCH)
+    {
+        SimulationEngine *engine = &g_serverContext.simulationEngine;
+        if (simulationEngineAdd(engine, context) != UA_STATUSCODE_GOOD)
+            return;
+        SimulationGroup *group = engine->groups[context->simulationGroup];
+        if (!group->timer.pprev)
+            timingWheelStart(wheel, &group->timer, group->periodMs);
+    }
+    else
+    {
+        context->timer.tag = context;
+        timingWheelStart(wheel, &context->timer, context->updatePeriodMs);
+    }
+
+    __atomic_store_n(&context->observed, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&context->activationPending, false, __ATOMIC_RELEASE);
+    g_serverContext.observedSet.activeCount++;
+}
+
+// 模拟线程：停止周期计算，之后的读取从当前周期开始补算
+static void observedSetDeactivate(VariableContext *context, double now)
+{
+    context->lazyStep = simulationStepAt(context, now);
+    __atomic_store_n(&context->observed, false, __ATOMIC_RELEASE);
+    g_serverContext.observedSet.activeCount--;
+}
+
+static void observedSetDrain(TimingWheel *wheel)
+{
+    ObservedSet *set = &g_serverContext.observedSet;
+    pthread_mutex_lock(&set->lock);
+    for (size_t i = 0; i < set->pendingCount; i++)
+        observedSetActivate(wheel, set->pending[i]);
+    set->pendingCount = 0;
+    pthread_mutex_unlock(&set->lock);
+}
+
+// 批量分组触发后移出不再观察的变量（倒序遍历，移除时用末尾元素填补）
+static void observedSetPruneGroup(SimulationGroup *group, double now)
+{
+    for (size_t i = group->count; i-- > 0;)
+    {
+        VariableContext *context = group->tags[i];
+        if (observedSetIsWatched(context, now))
+            continue;
+        simulationEngineRemove(&g_serverContext.simulationEngine, context);
+        observedSetDeactivate(context, now);
+    }
+}
 
-// ==================== 日志系统 ====================
-void logMessage(LogLevel level, const char *format, ...)
+// ==================== 时间轮调度器 ====================
+static UA_UInt32 simulationPeriodTicks(UA_UInt32 periodMs)
 {
-    if (level < g_serverContext.logLevel)
-        return;
+    UA_UInt32 ticks = (periodMs + SIMULATION_TICK_MS / 2) / SIMULATION_TICK_MS;
+    return ticks ? ticks : 1;
+}
 
-    time_t now = time(NULL);
-    char timeStr[64];
-    strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", localtime(&now));
+static void timingWheelSchedule(TimingWheel *wheel, SimulationTimer *timer)
+{
+    UA_UInt64 delta = timer->expires - wheel->currentTick;
+    int level = 0;
+    while (level < TIMING_WHEEL_LEVELS - 1 && delta >= (1ULL << (TIMING_WHEEL_BITS * (level + 1))))
+        level++;
+    // 超出最高层范围的定时器每圈重新下移一次，直到进入范围
+    size_t slot = (timer->expires >> (TIMING_WHEEL_BITS * level)) & (TIMING_WHEEL_SLOTS - 1);
+
+    SimulationTimer **head = &wheel->slots[level][slot];
+    timer->next = *head;
+    if (timer->next)
+        timer->next->pprev = &timer->next;
+    timer->pprev = head;
+    *head = timer;
+}
 
-    const char *levelStr[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+static void timingWheelCancel(SimulationTimer *timer)
+{
+    if (!timer->pprev)
+        return;
+    *timer->pprev = timer->next;
+    if (timer->next)
+        timer->next->pprev = timer->pprev;
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
 
-    va_list args;
-    va_start(args, format);
+// 从下一个周期开始按固定周期触发
+static void timingWheelStart(TimingWheel *wheel, SimulationTimer *timer, UA_UInt32 periodMs)
+{
+    timingWheelCancel(timer);
+    timer->periodTicks = simulationPeriodTicks(periodMs);
+    timer->expires = wheel->currentTick + 1;
+    timingWheelSchedule(wheel, timer);
+}
 
-    printf("[%s] [%s] ", timeStr, levelStr[level]);
-    vprintf(format, args);
-    printf("\n");
+// 取下整个槽位的链表
+static SimulationTimer *timingWheelTakeSlot(TimingWheel *wheel, int level, size_t slot)
+{
+    SimulationTimer *list = wheel->slots[level][slot];
+    wheel->slots[level][slot] = NULL;
+    return list;
+}
 
-    va_end(args);
+static void timingWheelCascade(TimingWheel *wheel, int level)
+{
+    size_t slot = (wheel->currentTick >> (TIMING_WHEEL_BITS * level)) & (TIMING_WHEEL_SLOTS - 1);
+    SimulationTimer *timer = timingWheelTakeSlot(wheel, level, slot);
+    while (timer)
+    {
+        SimulationTimer *next = timer->next;
+        timingWheelSchedule(wheel, timer);
+        timer = next;
+    }
 }
 
-// ==================== 信号处理 ====================
-static void stopHandler(int sig)
+// 逐个周期推进到 targetTick，只处理到期的定时器
+// 迟到时合并处理：同一定时器在一次推进中最多触发一次
+static UA_Boolean timingWheelReserveFired(TimingWheel *wheel, size_t count)
 {
-    logMessage(LOG_LEVEL_INFO, "收到停止信号，正在关闭服务器...");
-    g_serverContext.running = false;
+    if (count < wheel->firedCapacity)
+        return true;
+    size_t capacity = wheel->firedCapacity ? wheel->firedCapacity * 2 : 256;
+    SimulationTimer **fired =
+        (SimulationTimer **)UA_realloc(wheel->fired, capacity * sizeof(SimulationTimer *));
+    if (!fired)
+        return false;
+    wheel->fired = fired;
+    wheel->firedCapacity = capacity;
+    return true;
 }
 
-// ==================== 数据模拟函数 ====================
-void updateSimulatedValue(VariableContext *context)
+// 模拟周期序号独立于时间轮的周期计数，在进程内单调递增：周期内的写入以下一个序号标记，
+// 全部完成后发布该序号，读取方据此只返回完整周期的值
+static UA_UInt64 simulationNextEpoch(void)
 {
-    if (context->simulation == SIMULATION_NONE)
-        return;
+    return __atomic_load_n(g_serverContext.simulationEpoch, __ATOMIC_RELAXED) + 1;
+}
 
-    time_t now = time(NULL);
-    double timeDiff = difftime(now, context->lastUpdate);
+static void simulationPublishEpoch(UA_UInt64 epoch)
+{
+    __atomic_store_n(g_serverContext.simulationEpoch, epoch, __ATOMIC_RELEASE);
+}
 
-    switch (context->simulation)
-    {
-    case SIMULATION_SINE_WAVE:
+static void timingWheelRescheduleFired(TimingWheel *wheel, SimulationTimer *timer, UA_UInt64 targetTick)
+{
+    timer->expires += timer->periodTicks;
+    while (timer->expires <= targetTick)
+        timer->expires += timer->periodTicks;
+    timingWheelSchedule(wheel, timer);
+}
+
+static void timingWheelAdvance(TimingWheel *wheel, UA_UInt64 targetTick, double t)
+{
+    while (wheel->currentTick < targetTick)
     {
-        if (context->type == &UA_TYPES[UA_TYPES_FLOAT])
+        UA_UInt64 tick = ++wheel->currentTick;
+        UA_UInt64 epoch = simulationNextEpoch();
+        for (int level = 1; level < TIMING_WHEEL_LEVELS; level++)
         {
-            double frequency = context->simulationParam1;
-            double amplitude = context->simulationParam2;
-            double offset = context->simulationParam3;
-            *(UA_Float *)context->value = (UA_Float)(amplitude * sin(2 * M_PI * frequency * now / 60.0) + offset);
+            if (tick & ((1ULL << (TIMING_WHEEL_BITS * level)) - 1))
+                break;
+            timingWheelCascade(wheel, level);
         }
-        else if (context->type == &UA_TYPES[UA_TYPES_DOUBLE])
+
+        // 先收集本周期到期的定时器，统一计算后再重新调度
+        size_t firedCount = 0;
+        SimulationTimer *inPlace = NULL;
+        SimulationTimer *timer = timingWheelTakeSlot(wheel, 0, tick & (TIMING_WHEEL_SLOTS - 1));
+        while (timer)
         {
-            double frequency = context->simulationParam1;
-            double amplitude = context->simulationParam2;
-            double offset = context->simulationParam3;
-            *(UA_Double *)context->value = amplitude * sin(2 * M_PI * frequency * now / 60.0) + offset;
+            SimulationTimer *next = timer->next;
+            timer->pprev = NULL;
+            if (timer->expires != tick)
+            {
+                // 超出最高层范围的定时器尚未到期
+                timingWheelSchedule(wheel, timer);
+            }
+            else if (timingWheelReserveFired(wheel, firedCount))
+            {
+                wheel->fired[firedCount++] = timer;
+            }
+            else
+            {
+                // 内存不足时就地计算，周期发布后单独重新调度
+                simulationFireTimer(timer, t, epoch);
+                wheel->firedTimers++;
+                timer->next = inPlace;
+                inPlace = timer;
+            }
+            timer = next;
         }
-        break;
-    }
-    case SIMULATION_RANDOM:
-    {
-        if (context->type == &UA_TYPES[UA_TYPES_INT32])
+
+        if (wheel->pool)
+            simulationPoolRun(wheel->pool, wheel->fired, firedCount, t, epoch);
+        else
+            for (size_t i = 0; i < firedCount; i++)
+                simulationFireTimer(wheel->fired[i], t, epoch);
+        wheel->firedTimers += firedCount;
+
+        // 本周期的写入全部完成，读取方从此看到新的值
+        simulationPublishEpoch(epoch);
+
+        while (inPlace)
         {
-            int min = (int)context->simulationParam2;
-            int max = (int)context->simulationParam3;
-            *(UA_Int32 *)context->value = min + rand() % (max - min + 1);
+            timer = inPlace;
+            inPlace = timer->next;
+            simulationPushTimer(timer, t);
+            timingWheelRescheduleFired(wheel, timer, targetTick);
         }
-        else if (context->type == &UA_TYPES[UA_TYPES_FLOAT])
+
+        for (size_t i = 0; i < firedCount; i++)
         {
-            float min = (float)context->simulationParam2;
-            float max = (float)context->simulationParam3;
-            *(UA_Float *)context->value = min + (float)rand() / RAND_MAX * (max - min);
+            timer = wheel->fired[i];
+            simulationPushTimer(timer, t);
+            if (g_serverContext.observedSet.enabled)
+            {
+                if (!timer->tag)
+                {
+                    observedSetPruneGroup(timer->group, t);
+                }
+                else if (!observedSetIsWatched(timer->tag, t))
+                {
+                    // 不再观察：不再调度该定时器
+                    observedSetDeactivate(timer->tag, t);
+                    continue;
+                }
+            }
+            timingWheelRescheduleFired(wheel, timer, targetTick);
         }
-        break;
     }
-    case SIMULATION_COUNTER:
+}
+
+// 为所有模拟变量（逐个计算）或模拟分组（批量计算）启动定时器
+static void timingWheelScheduleAll(TimingWheel *wheel, TagRegistry *registry,
+                                   SimulationEngine *engine, SimulationEngineMode mode)
+{
+    if (mode == SIMULATION_ENGINE_LAZY)
+        return;
+    if (mode == SIMULATION_ENGINE_BATCH)
     {
-        if (context->type == &UA_TYPES[UA_TYPES_INT32])
-        {
-            *(UA_Int32 *)context->value += (UA_Int32)context->simulationParam1;
-        }
-        else if (context->type == &UA_TYPES[UA_TYPES_UINT32])
-        {
-            *(UA_UInt32 *)context->value += (UA_UInt32)context->simulationParam1;
-        }
-        break;
+        for (size_t g = 0; g < engine->groupCount; g++)
+            timingWheelStart(wheel, &engine->groups[g]->timer, engine->groups[g]->periodMs);
+        return;
     }
-    case SIMULATION_SQUARE_WAVE:
+
+    for (size_t i = 0; i < registry->count; i++)
     {
-        if (context->type == &UA_TYPES[UA_TYPES_BOOLEAN])
-        {
-            double period = context->simulationParam1;
-            *(UA_Boolean *)context->value = (UA_Boolean)((now % (int)period) < (period / 2));
-        }
-        break;
+        VariableContext *context = tagRegistryAt(registry, i);
+        if (context->simulation == SIMULATION_NONE)
+            continue;
+        context->timer.tag = context;
+        timingWheelStart(wheel, &context->timer, context->updatePeriodMs);
     }
+}
+
+static void timespecAddNs(struct timespec *ts, UA_UInt64 ns)
+{
+    ts->tv_sec += ns / 1000000000ULL;
+    ts->tv_nsec += ns % 1000000000ULL;
+    if (ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
     }
+}
 
-    context->lastUpdate = now;
+// 以绝对时间睡眠驱动时间轮，误差不会累积；durationSeconds 为0时运行到服务器停止
+static void runSimulationScheduler(TimingWheel *wheel, double durationSeconds)
+{
+    const UA_UInt64 tickNs = SIMULATION_TICK_MS * 1000000ULL;
+    struct timespec start, deadline;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    deadline = start;
 
-    // 检查报警条件
-    if (context->hasAlarm && context->type == &UA_TYPES[UA_TYPES_FLOAT])
+    while (g_serverContext.running)
     {
-        UA_Boolean newAlarmState = (*(UA_Float *)context->value > context->alarmThreshold);
-        if (newAlarmState != context->alarmState)
+        timespecAddNs(&deadline, tickNs);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR &&
+               g_serverContext.running)
+            ;
+
+        struct timespec woke;
+        clock_gettime(CLOCK_MONOTONIC, &woke);
+        UA_Int64 lateNs = (UA_Int64)(woke.tv_sec - deadline.tv_sec) * 1000000000LL +
+                          (woke.tv_nsec - deadline.tv_nsec);
+        if (lateNs < 0)
+            lateNs = 0;
+
+        // 迟到超过一个周期时跳过错过的唤醒，到期的定时器在本次合并处理
+        UA_UInt64 missed = (UA_UInt64)lateNs / tickNs;
+        if (missed > 0)
         {
-            context->alarmState = newAlarmState;
-            logMessage(LOG_LEVEL_WARNING, "报警状态变更: %s", newAlarmState ? "激活" : "解除");
+            wheel->overruns++;
+            wheel->missedTicks += missed;
+            timespecAddNs(&deadline, missed * tickNs);
         }
+        wheel->ticks++;
+        wheel->totalJitterNs += (UA_UInt64)lateNs;
+        if ((UA_UInt64)lateNs > wheel->maxJitterNs)
+            wheel->maxJitterNs = (UA_UInt64)lateNs;
+
+        if (g_serverContext.observedSet.enabled)
+            observedSetDrain(wheel);
+        timingWheelAdvance(wheel, wheel->currentTick + 1 + missed, simulationTime());
+
+        if (durationSeconds > 0 &&
+            (woke.tv_sec - start.tv_sec) + (woke.tv_nsec - start.tv_nsec) / 1e9 >= durationSeconds)
+            break;
     }
 }
 
@@ -231,20 +2402,30 @@ void *simulationThread(void *arg)
 {
     logMessage(LOG_LEVEL_INFO, "数据模拟线程已启动");
 
-    while (g_serverContext.running)
+    if (g_serverContext.simulationEngineMode == SIMULATION_ENGINE_LAZY)
     {
-        for (int i = 0; i < g_serverContext.variableCount; i++)
-        {
-            if (g_serverContext.variables[i])
-            {
-                pthread_mutex_lock(&g_serverContext.variables[i]->mutex);
-                updateSimulatedValue(g_serverContext.variables[i]);
-                pthread_mutex_unlock(&g_serverContext.variables[i]->mutex);
-            }
-        }
+        logMessage(LOG_LEVEL_INFO, "惰性模拟模式：模拟值在读取或采样时计算，数据模拟线程退出");
+        return NULL;
+    }
 
-        usleep(SIMULATION_INTERVAL_MS * 1000);
+    // 每个变量（或批量分组）按各自周期挂入时间轮，每个周期只处理到期的部分
+    // 观察集合模式下变量在被监视或读取后才加入
+    TimingWheel *wheel = &g_serverContext.scheduler;
+    if (!g_serverContext.observedSet.enabled)
+        timingWheelScheduleAll(wheel, &g_serverContext.tags, &g_serverContext.simulationEngine,
+                               g_serverContext.simulationEngineMode);
+
+    // 到期的分组数据块和变量分摊到线程池，每个周期全部完成后才推进
+    SimulationPool *pool = &g_serverContext.simulationPool;
+    simulationPoolStart(pool, g_serverContext.simulationThreads);
+    if (pool->threadCount > 1)
+    {
+        logMessage(LOG_LEVEL_INFO, "并行模拟：%d 个线程", pool->threadCount);
+        wheel->pool = pool;
     }
+    runSimulationScheduler(wheel, 0);
+    wheel->pool = NULL;
+    simulationPoolStop(pool);
 
     logMessage(LOG_LEVEL_INFO, "数据模拟线程已结束");
     return NULL;
@@ -261,11 +2442,62 @@ void *diagnosticsThread(void *arg)
 
         if (g_serverContext.enableDiagnostics)
         {
-            logMessage(LOG_LEVEL_INFO, "服务器运行时间: %ld秒, 总请求数: %llu, 错误数: %llu, 连接客户端: %u",
-                       uptime,
-                       (unsigned long long)g_serverContext.totalRequests,
-                       (unsigned long long)g_serverContext.totalErrors,
-                       g_serverContext.connectedClients);
+            // 多进程模式下诊断线程在模拟进程中运行，请求统计在各工作进程退出时输出
+            if (g_serverContext.processes.count > 0)
+                logMessage(LOG_LEVEL_INFO, "服务器运行时间: %ld秒, 工作进程: %d", uptime,
+                           g_serverContext.processes.count);
+            else
+                logMessage(LOG_LEVEL_INFO, "服务器运行时间: %ld秒, 总请求数: %llu, 错误数: %llu, 连接客户端: %u",
+                           uptime,
+                           (unsigned long long)g_serverContext.totalRequests,
+                           (unsigned long long)g_serverContext.totalErrors,
+                           g_serverContext.connectedClients);
+
+            TimingWheel *wheel = &g_serverContext.scheduler;
+            UA_UInt64 ticks = wheel->ticks;
+            logMessage(LOG_LEVEL_INFO, "模拟调度: 周期数 %llu, 平均抖动 %.1fus, 最大抖动 %.1fus, 超时 %llu次 (合并周期 %llu)",
+                       (unsigned long long)ticks,
+                       ticks ? wheel->totalJitterNs / 1e3 / ticks : 0.0,
+                       wheel->maxJitterNs / 1e3,
+                       (unsigned long long)wheel->overruns,
+                       (unsigned long long)wheel->missedTicks);
+            SimulationPool *pool = &g_serverContext.simulationPool;
+            if (pool->threadCount > 1)
+            {
+                logMessage(LOG_LEVEL_INFO, "并行模拟: %d 个线程, 窃取任务 %llu",
+                           pool->threadCount,
+                           (unsigned long long)__atomic_load_n(&pool->steals, __ATOMIC_RELAXED));
+            }
+            if (g_serverContext.changePush.enabled)
+            {
+                ChangePush *push = &g_serverContext.changePush;
+                UA_UInt64 notifications = push->notifications;
+                logMessage(LOG_LEVEL_INFO, "变化推送: %u 个被监视变量, 批次 %llu, 通知 %llu, 唤醒 %llu, 丢弃 %llu",
+                           __atomic_load_n(&push->monitoredTags, __ATOMIC_RELAXED),
+                           (unsigned long long)push->batches,
+                           (unsigned long long)notifications,
+                           (unsigned long long)push->wakeups,
+                           (unsigned long long)__atomic_load_n(&push->dropped, __ATOMIC_RELAXED));
+                logMessage(LOG_LEVEL_INFO, "变化推送队列: 最大深度 %llu, 平均延迟 %.1fus, 最大延迟 %lluus",
+                           (unsigned long long)push->maxDepth,
+                           notifications ? (double)push->totalLatencyUs / notifications : 0.0,
+                           (unsigned long long)push->maxLatencyUs);
+            }
+            Reactors *reactors = &g_serverContext.reactors;
+            if (reactors->count > 1)
+            {
+                char counts[256];
+                size_t length = 0;
+                for (int i = 0; i < reactors->count && length < sizeof(counts); i++)
+                    length += (size_t)snprintf(counts + length, sizeof(counts) - length, " %zu",
+                                               UA_Server_getStatistics(reactors->list[i].server).ns.currentConnectionCount);
+                logMessage(LOG_LEVEL_INFO, "反应器连接数:%s", counts);
+            }
+            if (g_serverContext.observedSet.enabled)
+            {
+                logMessage(LOG_LEVEL_INFO, "观察集合: %zu/%zu 个变量",
+                           g_serverContext.observedSet.activeCount, g_serverContext.tags.count);
+            }
         }
 
         sleep(30); // 每30秒输出一次诊断信息
@@ -275,136 +2507,340 @@ void *diagnosticsThread(void *arg)
     return NULL;
 }
 
+// ==================== 多进程 ====================
+// 模拟进程：运行模拟调度和诊断，写入共享内存中的变量记录
+static int processSimulationRun(void)
+{
+    if (g_serverContext.enableDiagnostics &&
+        pthread_create(&g_serverContext.diagnosticsThread, NULL, diagnosticsThread, NULL) != 0)
+        logMessage(LOG_LEVEL_WARNING, "创建诊断线程失败");
+    simulationThread(NULL);
+    // 诊断线程每30秒才检查一次停止标志，随进程退出即可
+    return EXIT_SUCCESS;
+}
+
+// 工作进程：运行派生前构建的服务器，与其他工作进程以SO_REUSEPORT监听同一端口
+static int processWorkerRun(ProcessPool *pool, int index)
+{
+    // 变量记录中的零拷贝快照被所有进程共享，每个工作进程改用私有的快照数组
+    if (g_serverContext.readMode == READ_MODE_ZERO_COPY)
+    {
+        t_readSnapshots = (ScalarValue *)calloc(g_serverContext.tags.count, sizeof(ScalarValue));
+        t_readSnapshotCount = t_readSnapshots ? g_serverContext.tags.count : 0;
+    }
+    UA_StatusCode retval = UA_Server_run(pool->server, &g_serverContext.running);
+    if (retval != UA_STATUSCODE_GOOD)
+        logMessage(LOG_LEVEL_ERROR, "工作进程 %d 运行失败: %s", index, UA_StatusCode_name(retval));
+    UA_ServerStatistics stats = UA_Server_getStatistics(pool->server);
+    logMessage(LOG_LEVEL_INFO, "工作进程 %d: 累计连接 %zu, 请求 %llu", index, stats.ns.cumulatedConnectionCount,
+               (unsigned long long)g_serverContext.totalRequests);
+    return retval == UA_STATUSCODE_GOOD ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// 派生模拟进程（index为-1）或第index个工作进程，返回子进程号，失败返回-1。
+// 派生时主进程中不能有其他线程
+static pid_t processPoolFork(ProcessPool *pool, int index)
+{
+    fflush(stdout); // 避免子进程重复输出缓冲区中的日志
+    pid_t pid = fork();
+    if (pid != 0)
+        return pid;
+
+    // 主进程退出时子进程随之停止
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    if (getppid() != pool->supervisor)
+        exit(EXIT_FAILURE);
+    // 子进程继承派生前的随机数状态，重新播种，避免各工作进程生成相同的会话和安全通道令牌
+    UA_random_seed((UA_UInt64)UA_DateTime_now() ^ (UA_UInt64)getpid());
+    exit(index < 0 ? processSimulationRun() : processWorkerRun(pool, index));
+}
+
+// 派生所有工作进程（simulation为true时先派生模拟进程），返回成功派生的工作进程数
+static int processPoolStart(ProcessPool *pool, UA_Server *server, UA_Boolean simulation)
+{
+    pool->server = server;
+    pool->supervisor = getpid();
+    pool->workers = (pid_t *)calloc((size_t)pool->count, sizeof(pid_t));
+    if (!pool->workers)
+        return 0;
+
+    if (simulation)
+    {
+        // 工作进程按模拟进程发布的周期序号读取变量记录，序号与变量记录一样放在共享内存中
+        void *epoch = mmap(NULL, sizeof(UA_UInt64), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (epoch == MAP_FAILED)
+        {
+            logMessage(LOG_LEVEL_ERROR, "映射模拟周期序号失败，不派生模拟进程");
+        }
+        else
+        {
+            *(UA_UInt64 *)epoch = *g_serverContext.simulationEpoch;
+            g_serverContext.simulationEpoch = (UA_UInt64 *)epoch;
+            pool->simulation = processPoolFork(pool, -1);
+        }
+        if (pool->simulation < 0)
+        {
+            logMessage(LOG_LEVEL_ERROR, "派生模拟进程失败");
+            pool->simulation = 0;
+        }
+    }
+
+    int started = 0;
+    for (int i = 0; i < pool->count; i++)
+    {
+        pool->workers[i] = processPoolFork(pool, i);
+        if (pool->workers[i] > 0)
+            started++;
+        else
+            pool->workers[i] = 0;
+    }
+    return started;
+}
+
+// 主进程等待子进程退出：被信号终止（崩溃或被杀死）的进程从主进程的地址空间重新派生，
+// 正常或因错误退出的不再派生。收到停止信号或所有工作进程都已退出时返回
+static void processPoolSupervise(ProcessPool *pool, const volatile UA_Boolean *running)
+{
+    int alive = 0;
+    for (int i = 0; i < pool->count; i++)
+        alive += pool->workers[i] > 0;
+
+    while (*running && alive > 0)
+    {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        int index = pid == pool->simulation ? -1 : -2;
+        for (int i = 0; i < pool->count && index == -2; i++)
+        {
+            if (pool->workers[i] == pid)
+                index = i;
+        }
+        if (index == -2 || !*running)
+            continue;
+
+        pid_t next = 0;
+        if (WIFSIGNALED(status))
+        {
+            next = processPoolFork(pool, index);
+            if (next > 0)
+                pool->restarts++;
+            else
+                next = 0;
+            if (index < 0)
+                logMessage(LOG_LEVEL_WARNING, "模拟进程 (pid %d) 被信号 %d 终止%s", (int)pid, WTERMSIG(status),
+                           next ? "，已重新派生" : "，重新派生失败");
+            else
+                logMessage(LOG_LEVEL_WARNING, "工作进程 %d (pid %d) 被信号 %d 终止%s", index, (int)pid,
+                           WTERMSIG(status), next ? "，已重新派生" : "，重新派生失败");
+        }
+        else if (index < 0)
+        {
+            logMessage(LOG_LEVEL_WARNING, "模拟进程 (pid %d) 已退出，状态 %d", (int)pid, WEXITSTATUS(status));
+        }
+        else
+        {
+            logMessage(LOG_LEVEL_WARNING, "工作进程 %d (pid %d) 已退出，状态 %d", index, (int)pid,
+                       WEXITSTATUS(status));
+        }
+
+        if (index < 0)
+        {
+            pool->simulation = next;
+        }
+        else
+        {
+            pool->workers[index] = next;
+            alive -= next == 0;
+        }
+    }
+}
+
+// 通知所有子进程停止并等待退出
+static void processPoolStop(ProcessPool *pool)
+{
+    if (!pool->workers)
+        return;
+    if (pool->simulation > 0)
+        kill(pool->simulation, SIGTERM);
+    for (int i = 0; i < pool->count; i++)
+    {
+        if (pool->workers[i] > 0)
+            kill(pool->workers[i], SIGTERM);
+    }
+    if (pool->simulation > 0)
+        waitpid(pool->simulation, NULL, 0);
+    for (int i = 0; i < pool->count; i++)
+    {
+        if (pool->workers[i] > 0)
+            waitpid(pool->workers[i], NULL, 0);
+    }
+    pool->simulation = 0;
+    free(pool->workers);
+    pool->workers = NULL;
+    if (g_serverContext.simulationEpoch != &g_simulationEpoch)
+    {
+        g_simulationEpoch = *g_serverContext.simulationEpoch;
+        munmap(g_serverContext.simulationEpoch, sizeof(UA_UInt64));
+        g_serverContext.simulationEpoch = &g_simulationEpoch;
+    }
+}
+
 // ==================== 回调函数 ====================
-static void onReadCallBack(UA_Server *server,
-                           const UA_NodeId *sessionId,
-                           void *sessionContext,
-                           const UA_NodeId *nodeId,
-                           void *nodeContext,
-                           const UA_NumericRange *range,
-                           UA_DataValue *value)
+static UA_StatusCode onReadCallBack(UA_Server *server,
+                                    const UA_NodeId *sessionId,
+                                    void *sessionContext,
+                                    const UA_NodeId *nodeId,
+                                    void *nodeContext,
+                                    UA_Boolean includeSourceTimeStamp,
+                                    const UA_NumericRange *range,
+                                    UA_DataValue *value)
 {
     VariableContext *context = (VariableContext *)nodeContext;
     if (!context)
-        return;
-
-    g_serverContext.totalRequests++;
+        return UA_STATUSCODE_BADINTERNALERROR;
 
-    pthread_mutex_lock(&context->mutex);
+    __atomic_fetch_add(&g_serverContext.totalRequests, 1, __ATOMIC_RELAXED);
 
-    // 为不同类型进行深拷贝以确保线程安全
-    if (context->type == &UA_TYPES[UA_TYPES_INT32])
+    // 标量变量不支持索引范围
+    if (range)
     {
-        UA_Int32 *copyValue = UA_malloc(sizeof(UA_Int32));
-        *copyValue = *(UA_Int32 *)context->value;
-        UA_Variant_setScalar(&value->value, copyValue, &UA_TYPES[UA_TYPES_INT32]);
+        value->hasStatus = true;
+        value->status = UA_STATUSCODE_BADINDEXRANGEINVALID;
+        return UA_STATUSCODE_GOOD;
     }
-    else if (context->type == &UA_TYPES[UA_TYPES_UINT32])
+
+    // 惰性模式下在读取（含监视项采样）时按当前模拟周期求值，源时间戳即周期的起始时间
+    if (g_serverContext.simulationEngineMode == SIMULATION_ENGINE_LAZY &&
+        context->simulation != SIMULATION_NONE)
     {
-        UA_UInt32 *copyValue = UA_malloc(sizeof(UA_UInt32));
-        *copyValue = *(UA_UInt32 *)context->value;
-        UA_Variant_setScalar(&value->value, copyValue, &UA_TYPES[UA_TYPES_UINT32]);
+        double now = simulationTickTime(simulationTime());
+        evaluateSimulatedValue(context, now);
+        if (includeSourceTimeStamp)
+        {
+            value->hasSourceTimestamp = true;
+            value->sourceTimestamp = UA_DATETIME_UNIX_EPOCH + (UA_DateTime)(now * UA_DATETIME_SEC);
+        }
     }
-    else if (context->type == &UA_TYPES[UA_TYPES_FLOAT])
+    else if (g_serverContext.observedSet.enabled && context->simulation != SIMULATION_NONE)
     {
-        UA_Float *copyValue = UA_malloc(sizeof(UA_Float));
-        *copyValue = *(UA_Float *)context->value;
-        UA_Variant_setScalar(&value->value, copyValue, &UA_TYPES[UA_TYPES_FLOAT]);
+        observedSetOnRead(context, simulationTime());
     }
-    else if (context->type == &UA_TYPES[UA_TYPES_DOUBLE])
+
+    UA_StatusCode status = UA_STATUSCODE_GOOD;
+
+    if (context->type == &UA_TYPES[UA_TYPES_STRING])
     {
-        UA_Double *copyValue = UA_malloc(sizeof(UA_Double));
-        *copyValue = *(UA_Double *)context->value;
-        UA_Variant_setScalar(&value->value, copyValue, &UA_TYPES[UA_TYPES_DOUBLE]);
+        UA_String *copyValue = UA_String_new();
+        status = copyValue ? valueCellReadString(&context->cell, copyValue) : UA_STATUSCODE_BADOUTOFMEMORY;
+        if (status == UA_STATUSCODE_GOOD)
+            UA_Variant_setScalar(&value->value, copyValue, context->type);
+        else
+            UA_String_delete(copyValue);
     }
-    else if (context->type == &UA_TYPES[UA_TYPES_BOOLEAN])
+    else if (g_serverContext.readMode == READ_MODE_ZERO_COPY && !t_serviceWorkerThread &&
+             (!t_readSnapshots || context->index < t_readSnapshotCount))
     {
-        UA_Boolean *copyValue = UA_malloc(sizeof(UA_Boolean));
-        *copyValue = *(UA_Boolean *)context->value;
-        UA_Variant_setScalar(&value->value, copyValue, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        // 服务器线程中的读取在同一次服务调用内编码完毕，因此可以直接引用快照而无需堆分配；
+        // 附加反应器各自使用自己的快照数组；工作线程可能同时读取同一变量，仍然复制
+        ScalarValue *snapshot = t_readSnapshots ? &t_readSnapshots[context->index] : &context->readSnapshot;
+        *snapshot = valueCellRead(&context->cell, g_serverContext.simulationEpoch);
+        UA_Variant_setScalar(&value->value, snapshot, context->type);
+        value->value.storageType = UA_VARIANT_DATA_NODELETE;
     }
-    else if (context->type == &UA_TYPES[UA_TYPES_STRING])
+    else
     {
-        UA_String *copyValue = UA_malloc(sizeof(UA_String));
-        UA_String_copy((UA_String *)context->value, copyValue);
-        UA_Variant_setScalar(&value->value, copyValue, &UA_TYPES[UA_TYPES_STRING]);
+        ScalarValue current = valueCellRead(&context->cell, g_serverContext.simulationEpoch);
+        status = UA_Variant_setScalarCopy(&value->value, &current, context->type);
     }
-    else if (context->type == &UA_TYPES[UA_TYPES_DATETIME])
+
+    if (status != UA_STATUSCODE_GOOD)
     {
-        UA_DateTime *copyValue = UA_malloc(sizeof(UA_DateTime));
-        *copyValue = *(UA_DateTime *)context->value;
-        UA_Variant_setScalar(&value->value, copyValue, &UA_TYPES[UA_TYPES_DATETIME]);
+        __atomic_fetch_add(&g_serverContext.totalErrors, 1, __ATOMIC_RELAXED);
+        return status;
     }
 
     value->hasValue = true;
-    pthread_mutex_unlock(&context->mutex);
+    return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode writeVariableValue(const UA_Variant *value,
-                                        void *targetValue,
+                                        ValueCell *cell,
                                         const UA_DataType *expectedType)
 {
     if (value->type != expectedType)
     {
-        g_serverContext.totalErrors++;
+        __atomic_fetch_add(&g_serverContext.totalErrors, 1, __ATOMIC_RELAXED);
         return UA_STATUSCODE_BADTYPEMISMATCH;
     }
 
     logMessage(LOG_LEVEL_DEBUG, "触发值写入操作2: %s", value->data);
+    ScalarValue next = {0};
     if (expectedType == &UA_TYPES[UA_TYPES_INT32])
     {
-        *(UA_Int32 *)targetValue = *(UA_Int32 *)value->data;
+        next.int32 = *(UA_Int32 *)value->data;
         logMessage(LOG_LEVEL_DEBUG, "写入Int32值: %d", *(UA_Int32 *)value->data);
     }
     else if (expectedType == &UA_TYPES[UA_TYPES_UINT32])
     {
-        *(UA_UInt32 *)targetValue = *(UA_UInt32 *)value->data;
+        next.uint32 = *(UA_UInt32 *)value->data;
         logMessage(LOG_LEVEL_DEBUG, "写入UInt32值: %u", *(UA_UInt32 *)value->data);
     }
     else if (expectedType == &UA_TYPES[UA_TYPES_FLOAT])
     {
-        *(UA_Float *)targetValue = *(UA_Float *)value->data;
+        next.floatValue = *(UA_Float *)value->data;
         logMessage(LOG_LEVEL_DEBUG, "写入Float值: %f", *(UA_Float *)value->data);
     }
     else if (expectedType == &UA_TYPES[UA_TYPES_DOUBLE])
     {
-        *(UA_Double *)targetValue = *(UA_Double *)value->data;
+        next.doubleValue = *(UA_Double *)value->data;
         logMessage(LOG_LEVEL_DEBUG, "写入Double值: %f", *(UA_Double *)value->data);
     }
     else if (expectedType == &UA_TYPES[UA_TYPES_BOOLEAN])
     {
-        *(UA_Boolean *)targetValue = *(UA_Boolean *)value->data;
+        next.boolean = *(UA_Boolean *)value->data;
         logMessage(LOG_LEVEL_DEBUG, "写入Boolean值: %s", *(UA_Boolean *)value->data ? "true" : "false");
     }
     else if (expectedType == &UA_TYPES[UA_TYPES_STRING])
     {
+        // 字符串在写入进程的私有堆中分配，其他工作进程无法访问，多进程模式下只读
+        if (g_serverContext.tags.shared)
+        {
+            __atomic_fetch_add(&g_serverContext.totalErrors, 1, __ATOMIC_RELAXED);
+            return UA_STATUSCODE_BADNOTWRITABLE;
+        }
         UA_String *src = (UA_String *)value->data;
-        UA_String *dst = (UA_String *)targetValue;
-        UA_String_clear(dst);
-        UA_StatusCode status = UA_String_copy(src, dst);
+        UA_StatusCode status = valueCellWriteString(cell, src);
         if (status == UA_STATUSCODE_GOOD)
         {
-            logMessage(LOG_LEVEL_DEBUG, "写入String值: %.*s", (int)dst->length, dst->data);
+            logMessage(LOG_LEVEL_DEBUG, "写入String值: %.*s", (int)src->length, src->data);
         }
         else
         {
             logMessage(LOG_LEVEL_ERROR, "复制String值失败");
-            g_serverContext.totalErrors++;
-            return status;
+            __atomic_fetch_add(&g_serverContext.totalErrors, 1, __ATOMIC_RELAXED);
         }
+        return status;
     }
     else if (expectedType == &UA_TYPES[UA_TYPES_DATETIME])
     {
-        *(UA_DateTime *)targetValue = *(UA_DateTime *)value->data;
+        next.dateTime = *(UA_DateTime *)value->data;
         logMessage(LOG_LEVEL_DEBUG, "写入DateTime值");
     }
     else
     {
         logMessage(LOG_LEVEL_ERROR, "不支持的类型: %s", value->type->typeName);
-        g_serverContext.totalErrors++;
+        __atomic_fetch_add(&g_serverContext.totalErrors, 1, __ATOMIC_RELAXED);
         return UA_STATUSCODE_BADTYPEMISMATCH;
     }
 
+    valueCellStore(cell, next);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -413,25 +2849,27 @@ static UA_StatusCode onWriteCallback(UA_Server *server,
                                      void *sessionContext,
                                      const UA_NodeId *nodeId,
                                      void *nodeContext,
-                                     const UA_Variant *value,
-                                     const UA_DataSource *dataSource)
+                                     const UA_NumericRange *range,
+                                     const UA_DataValue *value)
 {
 
-    logMessage(LOG_LEVEL_DEBUG, "触发值写入操作1: %s", value->data);
+    logMessage(LOG_LEVEL_DEBUG, "触发值写入操作1: %s", value->value.data);
     VariableContext *context = (VariableContext *)nodeContext;
     if (!context)
     {
-        g_serverContext.totalErrors++;
+        __atomic_fetch_add(&g_serverContext.totalErrors, 1, __ATOMIC_RELAXED);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    g_serverContext.totalRequests++;
+    if (range)
+    {
+        __atomic_fetch_add(&g_serverContext.totalErrors, 1, __ATOMIC_RELAXED);
+        return UA_STATUSCODE_BADINDEXRANGEINVALID;
+    }
 
-    pthread_mutex_lock(&context->mutex);
-    UA_StatusCode status = writeVariableValue(value, context->value, context->type);
-    pthread_mutex_unlock(&context->mutex);
+    __atomic_fetch_add(&g_serverContext.totalRequests, 1, __ATOMIC_RELAXED);
 
-    return status;
+    return writeVariableValue(&value->value, &context->cell, context->type);
 }
 
 // ==================== 方法回调函数 ====================
@@ -547,85 +2985,235 @@ static void triggerCustomEvent(UA_Server *server, UA_NodeId eventTypeId, const c
     UA_String_clear(&messageValue);
 }
 
+// 监视项创建或删除时更新变量的监视计数（open62541在注册/注销采样前后调用）
+static void onMonitoredItemRegister(UA_Server *server,
+                                    const UA_NodeId *sessionId,
+                                    void *sessionContext,
+                                    const UA_NodeId *nodeId,
+                                    void *nodeContext,
+                                    UA_UInt32 attributeId,
+                                    UA_Boolean removed)
+{
+    if ((!g_serverContext.observedSet.enabled && !g_serverContext.changePush.enabled) ||
+        attributeId != UA_ATTRIBUTEID_VALUE)
+        return;
+
+    VariableContext *context = tagRegistryFind(&g_serverContext.tags, nodeId);
+    if (!context || context->simulation == SIMULATION_NONE)
+        return;
+
+    if (removed)
+    {
+        if (__atomic_sub_fetch(&context->monitorCount, 1, __ATOMIC_RELAXED) == 0)
+            __atomic_sub_fetch(&g_serverContext.changePush.monitoredTags, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    if (__atomic_add_fetch(&context->monitorCount, 1, __ATOMIC_RELAXED) == 1)
+        __atomic_add_fetch(&g_serverContext.changePush.monitoredTags, 1, __ATOMIC_RELAXED);
+    if (g_serverContext.observedSet.enabled)
+        observedSetRequest(context, simulationTime());
+}
+
 // ==================== 资源管理 ====================
 static void cleanupVariableContext(VariableContext *context)
 {
     if (!context)
         return;
 
-    pthread_mutex_destroy(&context->mutex);
-
     if (context->type == &UA_TYPES[UA_TYPES_STRING])
     {
-        UA_String_clear((UA_String *)context->value);
+        UA_String_delete(context->cell.string);
+        context->cell.string = NULL;
+    }
+
+    UA_NodeId_clear(&context->nodeId);
+}
+
+static void cleanupTagRegistry(TagRegistry *registry)
+{
+    for (size_t i = 0; i < registry->count; i++)
+    {
+        cleanupVariableContext(tagRegistryAt(registry, i));
     }
 
-    UA_free(context->value);
-    UA_free(context);
+    for (size_t c = 0; c < registry->chunkCount; c++)
+    {
+        if (registry->shared)
+            munmap(registry->chunks[c], TAG_CHUNK_SIZE * sizeof(VariableContext));
+        else
+            free(registry->chunks[c]);
+    }
+
+    UA_free(registry->chunks);
+    UA_free(registry->hashSlots);
+    memset(registry, 0, sizeof(TagRegistry));
+}
+
+// 指针数组按需倍增扩容
+static UA_Boolean ensureArrayCapacity(void **array, int *capacity, int needed, size_t elementSize)
+{
+    if (needed <= *capacity)
+        return true;
+
+    int newCapacity = *capacity ? *capacity * 2 : 16;
+    while (newCapacity < needed)
+        newCapacity *= 2;
+
+    void *grown = UA_realloc(*array, (size_t)newCapacity * elementSize);
+    if (!grown)
+        return false;
+
+    *array = grown;
+    *capacity = newCapacity;
+    return true;
 }
 
 // ==================== 节点创建函数 ====================
-static UA_NodeId addVariable(UA_Server *server,
-                             UA_UInt16 nsIndex,
-                             const char *nodeName,
-                             const UA_DataType *type,
-                             void *value,
-                             SimulationType simulation,
-                             double param1, double param2, double param3)
+// 模拟量的工程单位范围：正弦波为偏移±振幅，随机值为[最小值, 最大值]，高斯噪声取均值±3倍标准差；
+// 百分比死区按该范围换算为绝对死区，其他模拟方式没有确定的范围
+static UA_Boolean tagEURange(const VariableContext *context, UA_Range *range)
+{
+    if (!UA_DataType_isNumeric(context->type))
+        return false;
+
+    switch (context->simulation)
+    {
+    case SIMULATION_SINE_WAVE:
+        range->low = context->simulationParam3 - fabs(context->simulationParam2);
+        range->high = context->simulationParam3 + fabs(context->simulationParam2);
+        break;
+    case SIMULATION_RANDOM:
+        range->low = context->simulationParam2;
+        range->high = context->simulationParam3;
+        break;
+    case SIMULATION_GAUSSIAN_NOISE:
+        range->low = context->simulationParam2 - 3.0 * fabs(context->simulationParam3);
+        range->high = context->simulationParam2 + 3.0 * fabs(context->simulationParam3);
+        break;
+    default:
+        return false;
+    }
+    return range->high > range->low;
+}
+
+// 为模拟量变量添加EURange属性，NodeId由变量的NodeId派生（如 SineWave.EURange），
+// 服务器自动分配的数值标识会与之后显式添加的数值NodeId冲突
+static UA_StatusCode addEURangeProperty(UA_Server *server, UA_NodeId variableNodeId, const UA_Range *range)
 {
+    char identifier[128];
+    if (variableNodeId.identifierType == UA_NODEIDTYPE_STRING)
+        snprintf(identifier, sizeof(identifier), "%.*s.EURange", (int)variableNodeId.identifier.string.length,
+                 (const char *)variableNodeId.identifier.string.data);
+    else if (variableNodeId.identifierType == UA_NODEIDTYPE_NUMERIC)
+        snprintf(identifier, sizeof(identifier), "%u.EURange", (unsigned)variableNodeId.identifier.numeric);
+    else
+        return UA_STATUSCODE_BADNODEIDINVALID;
 
-    if (g_serverContext.variableCount >= MAX_VARIABLES)
-    {
-        logMessage(LOG_LEVEL_ERROR, "变量数量已达到最大值");
-        return UA_NODEID_NULL;
-    }
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Variant_setScalar(&attr.value, (void *)(uintptr_t)range, &UA_TYPES[UA_TYPES_RANGE]);
+    attr.dataType = UA_TYPES[UA_TYPES_RANGE].typeId;
+    attr.valueRank = UA_VALUERANK_SCALAR;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "EURange");
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    attr.userAccessLevel = UA_ACCESSLEVELMASK_READ;
+
+    return UA_Server_addVariableNode(server,
+                                     UA_NODEID_STRING(variableNodeId.namespaceIndex, identifier),
+                                     variableNodeId,
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_HASPROPERTY),
+                                     UA_QUALIFIEDNAME(0, "EURange"),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_PROPERTYTYPE),
+                                     attr, NULL, NULL);
+}
 
+// 在ObjectsFolder下添加以变量记录为上下文的数据源变量节点
+static UA_StatusCode addTagNode(UA_Server *server, UA_NodeId variableNodeId, const char *nodeName, void *value,
+                                VariableContext *context)
+{
     UA_VariableAttributes attr = UA_VariableAttributes_default;
-    UA_Variant_setScalar(&attr.value, value, type);
+    UA_Variant_setScalar(&attr.value, value, context->type);
     attr.displayName = UA_LOCALIZEDTEXT("zh-CN", nodeName);
     attr.description = UA_LOCALIZEDTEXT("zh-CN", nodeName);
     attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
     attr.userAccessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
 
-    UA_NodeId variableNodeId = UA_NODEID_STRING(nsIndex, nodeName);
-
-    VariableContext *context = (VariableContext *)UA_malloc(sizeof(VariableContext));
-
-    // 根据类型分配并复制值
-    if (type == &UA_TYPES[UA_TYPES_INT32])
+    UA_DataSource dataSource;
+    dataSource.read = onReadCallBack;
+    dataSource.write = onWriteCallback;
+
+    UA_StatusCode retval = UA_Server_addDataSourceVariableNode(server,
+                                                               variableNodeId,
+                                                               UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                                               UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                                               UA_QUALIFIEDNAME(variableNodeId.namespaceIndex, (char *)nodeName),
+                                                               UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                                               attr, dataSource, context, NULL);
+    if (retval != UA_STATUSCODE_GOOD)
     {
-        context->value = UA_malloc(sizeof(UA_Int32));
-        *(UA_Int32 *)context->value = *(UA_Int32 *)value;
+        logMessage(LOG_LEVEL_ERROR, "添加变量节点失败 %s: %s", nodeName, UA_StatusCode_name(retval));
+        return retval;
     }
-    else if (type == &UA_TYPES[UA_TYPES_UINT32])
+
+    UA_Range range;
+    if (tagEURange(context, &range))
     {
-        context->value = UA_malloc(sizeof(UA_UInt32));
-        *(UA_UInt32 *)context->value = *(UA_UInt32 *)value;
+        retval = addEURangeProperty(server, variableNodeId, &range);
+        if (retval != UA_STATUSCODE_GOOD)
+        {
+            logMessage(LOG_LEVEL_ERROR, "添加EURange属性失败 %s: %s", nodeName, UA_StatusCode_name(retval));
+            UA_Server_deleteNode(server, variableNodeId, true);
+        }
     }
-    else if (type == &UA_TYPES[UA_TYPES_FLOAT])
+    return retval;
+}
+
+static UA_NodeId addVariableNode(UA_Server *server,
+                                 UA_NodeId variableNodeId,
+                                 const char *nodeName,
+                                 const UA_DataType *type,
+                                 void *value,
+                                 SimulationType simulation,
+                                 double param1, double param2, double param3)
+{
+
+    // 多反应器共享变量记录：已注册的变量在其他反应器中以同一记录作为节点上下文，
+    // 在同一服务器中重复添加时由open62541返回节点已存在
+    VariableContext *context = tagRegistryFind(&g_serverContext.tags, &variableNodeId);
+    if (context)
     {
-        context->value = UA_malloc(sizeof(UA_Float));
-        *(UA_Float *)context->value = *(UA_Float *)value;
+        if (context->type != type)
+        {
+            logMessage(LOG_LEVEL_ERROR, "变量已存在: %s", nodeName);
+            return UA_NODEID_NULL;
+        }
+        return addTagNode(server, variableNodeId, nodeName, value, context) == UA_STATUSCODE_GOOD ? variableNodeId
+                                                                                                 : UA_NODEID_NULL;
     }
-    else if (type == &UA_TYPES[UA_TYPES_DOUBLE])
+
+    // 值单元只能容纳定长标量和字符串
+    if (type != &UA_TYPES[UA_TYPES_STRING] &&
+        (!type->pointerFree || type->memSize > sizeof(ScalarValue)))
     {
-        context->value = UA_malloc(sizeof(UA_Double));
-        *(UA_Double *)context->value = *(UA_Double *)value;
+        logMessage(LOG_LEVEL_ERROR, "不支持的变量类型: %s", type->typeName);
+        return UA_NODEID_NULL;
     }
-    else if (type == &UA_TYPES[UA_TYPES_BOOLEAN])
+
+    context = tagRegistryAllocate(&g_serverContext.tags);
+    if (!context)
     {
-        context->value = UA_malloc(sizeof(UA_Boolean));
-        *(UA_Boolean *)context->value = *(UA_Boolean *)value;
+        logMessage(LOG_LEVEL_ERROR, "变量注册表内存不足");
+        return UA_NODEID_NULL;
     }
-    else if (type == &UA_TYPES[UA_TYPES_STRING])
+
+    // 根据类型初始化值单元
+    if (type == &UA_TYPES[UA_TYPES_STRING])
     {
-        context->value = UA_malloc(sizeof(UA_String));
-        UA_String_copy((UA_String *)value, (UA_String *)context->value);
+        context->cell.string = UA_String_new();
+        UA_String_copy((UA_String *)value, context->cell.string);
     }
-    else if (type == &UA_TYPES[UA_TYPES_DATETIME])
+    else
     {
-        context->value = UA_malloc(sizeof(UA_DateTime));
-        *(UA_DateTime *)context->value = *(UA_DateTime *)value;
+        memcpy(&context->cell.scalar, value, type->memSize);
     }
 
     context->type = type;
@@ -633,59 +3221,70 @@ static UA_NodeId addVariable(UA_Server *server,
     context->simulationParam1 = param1;
     context->simulationParam2 = param2;
     context->simulationParam3 = param3;
+    context->updatePeriodMs = SIMULATION_INTERVAL_MS;
+    context->lazyStep = simulationStepAt(context, simulationTime());
     context->lastUpdate = time(NULL);
     context->hasAlarm = false;
     context->alarmThreshold = 0.0;
     context->alarmState = false;
 
-    if (pthread_mutex_init(&context->mutex, NULL) != 0)
+    if (addTagNode(server, variableNodeId, nodeName, value, context) != UA_STATUSCODE_GOOD)
     {
-        logMessage(LOG_LEVEL_ERROR, "互斥锁初始化失败");
-        UA_free(context);
+        cleanupVariableContext(context);
+        tagRegistryDiscardLast(&g_serverContext.tags);
         return UA_NODEID_NULL;
     }
 
-    UA_StatusCode retval = UA_Server_addVariableNode(server,
-                                                     variableNodeId,
-                                                     UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
-                                                     UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
-                                                     UA_QUALIFIEDNAME(nsIndex, nodeName),
-                                                     UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
-                                                     attr, NULL, &variableNodeId);
+    // 建立NodeId索引
+    tagRegistryCommit(&g_serverContext.tags, context, &variableNodeId);
 
-    if (retval != UA_STATUSCODE_GOOD)
-    {
-        logMessage(LOG_LEVEL_ERROR, "添加变量节点失败: %s", UA_StatusCode_name(retval));
-        cleanupVariableContext(context);
-        return UA_NODEID_NULL;
-    }
+    // 加入批量模拟分组（不支持的组合在批量模式下保持不变，与逐个计算一致）
+    // 观察集合模式下在变量被观察时才加入
+    if (simulation != SIMULATION_NONE && !g_serverContext.observedSet.enabled)
+        simulationEngineAdd(&g_serverContext.simulationEngine, context);
 
-    UA_ValueCallback callback;
-    callback.onRead = onReadCallBack;
-    callback.onWrite = onWriteCallback;
+    logMessage(LOG_LEVEL_INFO, "成功添加变量: %s (模拟类型: %d)", nodeName, simulation);
+    return variableNodeId;
+}
 
-    retval = UA_Server_setVariableNode_valueCallback(server, variableNodeId, callback);
-    if (retval != UA_STATUSCODE_GOOD)
+// 设置变量的模拟更新周期（需在模拟线程启动前调用）
+static UA_StatusCode setVariableUpdatePeriod(const UA_NodeId *nodeId, UA_UInt32 periodMs)
+{
+    VariableContext *context = tagRegistryFind(&g_serverContext.tags, nodeId);
+    if (!context)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    if (periodMs == 0)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    context->updatePeriodMs = periodMs;
+    context->lazyStep = simulationStepAt(context, simulationTime());
+    // 周期是批量分组的一部分，需要重新分组
+    if (context->simulationGroup >= 0)
     {
-        logMessage(LOG_LEVEL_ERROR, "设置变量回调失败: %s", UA_StatusCode_name(retval));
-        cleanupVariableContext(context);
-        return UA_NODEID_NULL;
+        simulationEngineRemove(&g_serverContext.simulationEngine, context);
+        simulationEngineAdd(&g_serverContext.simulationEngine, context);
     }
+    return UA_STATUSCODE_GOOD;
+}
 
-    UA_Server_setNodeContext(server, variableNodeId, context);
-
-    // 保存到全局上下文
-    g_serverContext.variables[g_serverContext.variableCount++] = context;
-
-    logMessage(LOG_LEVEL_INFO, "成功添加变量: %s (模拟类型: %d)", nodeName, simulation);
-    return variableNodeId;
+static UA_NodeId addVariable(UA_Server *server,
+                             UA_UInt16 nsIndex,
+                             const char *nodeName,
+                             const UA_DataType *type,
+                             void *value,
+                             SimulationType simulation,
+                             double param1, double param2, double param3)
+{
+    return addVariableNode(server, UA_NODEID_STRING(nsIndex, (char *)nodeName), nodeName,
+                           type, value, simulation, param1, param2, param3);
 }
 
 static UA_NodeId addObject(UA_Server *server, UA_UInt16 nsIndex, const char *objectName)
 {
-    if (g_serverContext.objectCount >= MAX_OBJECTS)
+    if (!ensureArrayCapacity((void **)&g_serverContext.objects, &g_serverContext.objectCapacity,
+                             g_serverContext.objectCount + 1, sizeof(ObjectContext *)))
     {
-        logMessage(LOG_LEVEL_ERROR, "对象数量已达到最大值");
+        logMessage(LOG_LEVEL_ERROR, "对象列表内存不足");
         return UA_NODEID_NULL;
     }
 
@@ -709,6 +3308,10 @@ static UA_NodeId addObject(UA_Server *server, UA_UInt16 nsIndex, const char *obj
         return UA_NODEID_NULL;
     }
 
+    // 对象列表只记录主服务器的节点，附加反应器中的同一节点不再记录
+    if (server != g_serverContext.server)
+        return objectNodeId;
+
     ObjectContext *context = (ObjectContext *)UA_malloc(sizeof(ObjectContext));
     context->nodeId = objectNodeId;
     strncpy(context->name, objectName, sizeof(context->name) - 1);
@@ -728,9 +3331,10 @@ static UA_NodeId addMethod(UA_Server *server, UA_UInt16 nsIndex, UA_NodeId paren
                            size_t outputArgumentsSize, const UA_Argument *outputArguments)
 {
 
-    if (g_serverContext.methodCount >= MAX_METHODS)
+    if (!ensureArrayCapacity((void **)&g_serverContext.methods, &g_serverContext.methodCapacity,
+                             g_serverContext.methodCount + 1, sizeof(MethodContext *)))
     {
-        logMessage(LOG_LEVEL_ERROR, "方法数量已达到最大值");
+        logMessage(LOG_LEVEL_ERROR, "方法列表内存不足");
         return UA_NODEID_NULL;
     }
 
@@ -758,6 +3362,9 @@ static UA_NodeId addMethod(UA_Server *server, UA_UInt16 nsIndex, UA_NodeId paren
         return UA_NODEID_NULL;
     }
 
+    if (server != g_serverContext.server)
+        return methodNodeId;
+
     MethodContext *context = (MethodContext *)UA_malloc(sizeof(MethodContext));
     context->nodeId = methodNodeId;
     strncpy(context->name, methodName, sizeof(context->name) - 1);
@@ -770,86 +3377,197 @@ static UA_NodeId addMethod(UA_Server *server, UA_UInt16 nsIndex, UA_NodeId paren
     return methodNodeId;
 }
 
+// ==================== 网络层 ====================
+// 每个连接占用一个文件描述符，按连接上限提高进程的描述符限制
+static void raiseFileLimit(rlim_t wanted)
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur >= wanted)
+        return;
+    limit.rlim_cur = (limit.rlim_max != RLIM_INFINITY && limit.rlim_max < wanted) ? limit.rlim_max : wanted;
+    if (setrlimit(RLIMIT_NOFILE, &limit) != 0)
+        logMessage(LOG_LEVEL_WARNING, "提高文件描述符上限失败");
+}
+
+static const char *networkModeName(NetworkMode mode)
+{
+    static const char *names[] = {"select", "epoll", "io_uring"};
+    return names[mode];
+}
+
+// 用epoll或io_uring网络层替换默认的select网络层，沿用原有的端口和连接缓冲区配置。
+// 内核不支持io_uring时退回epoll，epoll也无法创建时保留select。返回实际使用的网络层。
+// 必须在服务器启动和设置唤醒描述符之前调用
+static NetworkMode useNetworkLayer(UA_ServerConfig *config, NetworkMode mode, UA_UInt16 port,
+                                   UA_UInt16 maxConnections)
+{
+    if (mode == NETWORK_MODE_SELECT || config->networkLayersSize == 0)
+        return NETWORK_MODE_SELECT;
+    if (mode == NETWORK_MODE_URING && !UA_ServerNetworkLayerTCPUring_supported())
+    {
+        logMessage(LOG_LEVEL_WARNING, "内核不支持io_uring网络层，使用epoll");
+        mode = NETWORK_MODE_EPOLL;
+    }
+
+    UA_ConnectionConfig connectionConfig = config->networkLayers[0].localConnectionConfig;
+    UA_ServerNetworkLayer layer = mode == NETWORK_MODE_URING
+                                      ? UA_ServerNetworkLayerTCPUring(connectionConfig, port, maxConnections)
+                                      : UA_ServerNetworkLayerTCPEpoll(connectionConfig, port, maxConnections);
+    if (!layer.handle)
+    {
+        logMessage(LOG_LEVEL_WARNING, "%s网络层创建失败，使用select", networkModeName(mode));
+        return NETWORK_MODE_SELECT;
+    }
+    config->networkLayers[0].clear(&config->networkLayers[0]);
+    config->networkLayers[0] = layer;
+
+    config->maxSecureChannels = maxConnections;
+    config->maxSessions = maxConnections;
+    raiseFileLimit((rlim_t)maxConnections + 64);
+    return mode;
+}
+
+// select和epoll网络层的收发缓冲区取自缓冲区池，稳定运行时收发消息不再分配内存。
+// io_uring网络层使用自己的注册缓冲区，不受影响。必须在服务器启动之前调用
+static void useBufferPool(UA_ServerConfig *config, NetworkMode mode, size_t maxRetainedBytes,
+                          UA_Boolean hugePages)
+{
+    if (mode == NETWORK_MODE_URING || config->networkLayersSize == 0)
+        return;
+    UA_ServerNetworkLayerTCP_setBufferPool(&config->networkLayers[0], maxRetainedBytes, hugePages);
+}
+
 // ==================== 服务器初始化 ====================
-static UA_StatusCode initializeServer()
+static void initializeServerContext()
 {
-    // 初始化全局上下文
+    // 初始化全局上下文（需在解析命令行参数之前完成）
     memset(&g_serverContext, 0, sizeof(ServerContext));
     g_serverContext.running = true;
+    g_serverContext.simulationEpoch = &g_simulationEpoch;
     g_serverContext.logLevel = LOG_LEVEL_INFO;
+    g_serverContext.readMode = READ_MODE_ZERO_COPY;
+    g_serverContext.simulationEngineMode = SIMULATION_ENGINE_BATCH;
     g_serverContext.enableDiagnostics = true;
     g_serverContext.startTime = time(NULL);
+    g_serverContext.runSeed = (UA_UInt64)time(NULL);
+    g_serverContext.simulationThreads = defaultSimulationThreads();
+    g_serverContext.observedSet.windowMs = 10000;
+    pthread_mutex_init(&g_serverContext.observedSet.lock, NULL);
+    g_serverContext.changePush.wakeupFd = -1;
+    g_serverContext.bufferPoolBytes = (size_t)BUFFER_POOL_DEFAULT_KIB * 1024;
+    g_serverContext.publishGranularityMs = PUBLISH_GRANULARITY_DEFAULT_MS;
+    g_serverContext.reactors.count = 1;
+    g_serverContext.reactors.addressAffinity = true;
+}
 
-    // 创建服务器
-    g_serverContext.server = UA_Server_new();
-    if (!g_serverContext.server)
+// 主服务器和附加反应器共用的配置：共享采样与编码、网络层、收发缓冲区池、批量发送和端口共享。返回实际使用的网络层
+static NetworkMode configureServer(UA_ServerConfig *config)
+{
+    config->monitoredItemRegisterCallback = onMonitoredItemRegister;
+    // 所有会话的读取权限相同，相同的监视项可以共用一次采样
+    config->shareMonitoredItemSampling = !g_serverContext.noSharedSampling;
+    // 同一采样值只编码一次，所有订阅的发布应答复制编码结果
+    config->shareNotificationEncoding = !g_serverContext.noSharedEncoding;
+    // 发布间隔相同且周期起点相近的订阅共用一个发布回调，一轮中发往同一连接的发布应答合并发送
+    config->publishingGranularity = g_serverContext.publishGranularityMs;
+    NetworkMode mode = g_serverContext.networkMode;
+    if (mode != NETWORK_MODE_SELECT)
+        mode = useNetworkLayer(config, mode, SERVER_PORT, NETWORK_MAX_CONNECTIONS);
+    useBufferPool(config, mode, g_serverContext.bufferPoolBytes, g_serverContext.hugePages);
+    // io_uring网络层使用注册缓冲区逐块提交发送，不参与合并
+    if (mode != NETWORK_MODE_URING && config->networkLayersSize > 0)
+        UA_ServerNetworkLayerTCP_setSendBatching(&config->networkLayers[0], !g_serverContext.noSendBatching);
+    // 附加反应器或工作进程各自以SO_REUSEPORT监听同一端口
+    int listeners = g_serverContext.processes.count > 1 ? g_serverContext.processes.count
+                                                        : g_serverContext.reactors.count;
+    if (listeners > 1 && config->networkLayersSize > 0)
     {
-        logMessage(LOG_LEVEL_ERROR, "创建服务器失败");
-        return UA_STATUSCODE_BADINTERNALERROR;
+        UA_ServerNetworkLayerTCP_setReusePort(&config->networkLayers[0], true,
+                                              g_serverContext.reactors.addressAffinity ? (UA_UInt16)listeners : 0);
     }
+    return mode;
+}
 
-    UA_ServerConfig_setDefault(UA_Server_getConfig(g_serverContext.server));
-
+// 构建地址空间。主服务器和每个附加反应器按相同顺序调用，因此命名空间序号一致
+static void buildAddressSpace(UA_Server *server)
+{
     // 添加命名空间
     const char *nsUriBasic = "http://opcua.demo/basic";
     const char *nsUriSimulation = "http://opcua.demo/simulation";
     const char *nsUriObjects = "http://opcua.demo/objects";
     const char *nsUriMethods = "http://opcua.demo/methods";
 
-    UA_UInt16 nsBasic = UA_Server_addNamespace(g_serverContext.server, nsUriBasic);
-    UA_UInt16 nsSimulation = UA_Server_addNamespace(g_serverContext.server, nsUriSimulation);
-    UA_UInt16 nsObjects = UA_Server_addNamespace(g_serverContext.server, nsUriObjects);
-    UA_UInt16 nsMethods = UA_Server_addNamespace(g_serverContext.server, nsUriMethods);
+    UA_UInt16 nsBasic = UA_Server_addNamespace(server, nsUriBasic);
+    UA_UInt16 nsSimulation = UA_Server_addNamespace(server, nsUriSimulation);
+    UA_UInt16 nsObjects = UA_Server_addNamespace(server, nsUriObjects);
+    UA_UInt16 nsMethods = UA_Server_addNamespace(server, nsUriMethods);
 
     // 添加基本变量
     UA_Int32 int32Value = 42;
-    addVariable(g_serverContext.server, nsBasic, "Int32Variable", &UA_TYPES[UA_TYPES_INT32],
+    addVariable(server, nsBasic, "Int32Variable", &UA_TYPES[UA_TYPES_INT32],
                 &int32Value, SIMULATION_NONE, 0, 0, 0);
 
     UA_UInt32 uint32Value = 123;
-    addVariable(g_serverContext.server, nsBasic, "UInt32Variable", &UA_TYPES[UA_TYPES_UINT32],
+    addVariable(server, nsBasic, "UInt32Variable", &UA_TYPES[UA_TYPES_UINT32],
                 &uint32Value, SIMULATION_COUNTER, 1, 0, 0);
 
     UA_Float floatValue = 3.14f;
-    addVariable(g_serverContext.server, nsBasic, "FloatVariable", &UA_TYPES[UA_TYPES_FLOAT],
+    addVariable(server, nsBasic, "FloatVariable", &UA_TYPES[UA_TYPES_FLOAT],
                 &floatValue, SIMULATION_NONE, 0, 0, 0);
 
     UA_Double doubleValue = 2.71828;
-    addVariable(g_serverContext.server, nsBasic, "DoubleVariable", &UA_TYPES[UA_TYPES_DOUBLE],
+    addVariable(server, nsBasic, "DoubleVariable", &UA_TYPES[UA_TYPES_DOUBLE],
                 &doubleValue, SIMULATION_NONE, 0, 0, 0);
 
     UA_Boolean boolValue = true;
-    addVariable(g_serverContext.server, nsBasic, "BooleanVariable", &UA_TYPES[UA_TYPES_BOOLEAN],
+    addVariable(server, nsBasic, "BooleanVariable", &UA_TYPES[UA_TYPES_BOOLEAN],
                 &boolValue, SIMULATION_SQUARE_WAVE, 10, 0, 0);
 
     UA_String stringValue = UA_STRING_ALLOC("Hello OPC UA World!");
-    addVariable(g_serverContext.server, nsBasic, "StringVariable", &UA_TYPES[UA_TYPES_STRING],
+    addVariable(server, nsBasic, "StringVariable", &UA_TYPES[UA_TYPES_STRING],
                 &stringValue, SIMULATION_NONE, 0, 0, 0);
 
     UA_DateTime datetimeValue = UA_DateTime_now();
-    addVariable(g_serverContext.server, nsBasic, "DateTimeVariable", &UA_TYPES[UA_TYPES_DATETIME],
+    addVariable(server, nsBasic, "DateTimeVariable", &UA_TYPES[UA_TYPES_DATETIME],
                 &datetimeValue, SIMULATION_NONE, 0, 0, 0);
 
     // 添加模拟变量
     UA_Float sineWave = 0.0f;
-    addVariable(g_serverContext.server, nsSimulation, "SineWave", &UA_TYPES[UA_TYPES_FLOAT],
+    addVariable(server, nsSimulation, "SineWave", &UA_TYPES[UA_TYPES_FLOAT],
                 &sineWave, SIMULATION_SINE_WAVE, 0.1, 10.0, 0.0);
 
     UA_Int32 randomInt = 0;
-    addVariable(g_serverContext.server, nsSimulation, "RandomInteger", &UA_TYPES[UA_TYPES_INT32],
+    addVariable(server, nsSimulation, "RandomInteger", &UA_TYPES[UA_TYPES_INT32],
                 &randomInt, SIMULATION_RANDOM, 0, 0, 100);
 
     UA_Float randomFloat = 0.0f;
-    addVariable(g_serverContext.server, nsSimulation, "RandomFloat", &UA_TYPES[UA_TYPES_FLOAT],
+    addVariable(server, nsSimulation, "RandomFloat", &UA_TYPES[UA_TYPES_FLOAT],
                 &randomFloat, SIMULATION_RANDOM, 0, 0.0, 1.0);
 
     UA_Int32 counter = 0;
-    addVariable(g_serverContext.server, nsSimulation, "Counter", &UA_TYPES[UA_TYPES_INT32],
+    addVariable(server, nsSimulation, "Counter", &UA_TYPES[UA_TYPES_INT32],
                 &counter, SIMULATION_COUNTER, 1, 0, 0);
 
+    // 不同更新周期的模拟变量：10ms振动信号与10s温度
+    UA_Double vibration = 0.0;
+    UA_NodeId vibrationId = addVariable(server, nsSimulation, "Vibration",
+                                        &UA_TYPES[UA_TYPES_DOUBLE], &vibration,
+                                        SIMULATION_SINE_WAVE, 600.0, 1.0, 0.0);
+    setVariableUpdatePeriod(&vibrationId, 10);
+
+    UA_Double tankTemperature = 25.0;
+    UA_NodeId tankTemperatureId = addVariable(server, nsSimulation, "TankTemperature",
+                                              &UA_TYPES[UA_TYPES_DOUBLE], &tankTemperature,
+                                              SIMULATION_SINE_WAVE, 0.5, 5.0, 25.0);
+    setVariableUpdatePeriod(&tankTemperatureId, 10000);
+
+    UA_Double gaussianNoise = 50.0;
+    addVariable(server, nsSimulation, "GaussianNoise", &UA_TYPES[UA_TYPES_DOUBLE],
+                &gaussianNoise, SIMULATION_GAUSSIAN_NOISE, 0, 50.0, 2.0);
+
     // 添加对象
-    UA_NodeId motorObjectId = addObject(g_serverContext.server, nsObjects, "Motor");
-    UA_NodeId temperatureObjectId = addObject(g_serverContext.server, nsObjects, "Temperature");
+    UA_NodeId motorObjectId = addObject(server, nsObjects, "Motor");
+    UA_NodeId temperatureObjectId = addObject(server, nsObjects, "Temperature");
 
     // 添加方法
     UA_Argument inputArgument;
@@ -866,7 +3584,7 @@ static UA_StatusCode initializeServer()
     outputArgument.dataType = UA_TYPES[UA_TYPES_STRING].typeId;
     outputArgument.valueRank = UA_VALUERANK_SCALAR;
 
-    addMethod(g_serverContext.server, nsMethods, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+    addMethod(server, nsMethods, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
               "HelloMethod", helloMethodCallback, 1, &inputArgument, 1, &outputArgument);
 
     // 计算方法
@@ -890,12 +3608,101 @@ static UA_StatusCode initializeServer()
     calcOutputArg.dataType = UA_TYPES[UA_TYPES_DOUBLE].typeId;
     calcOutputArg.valueRank = UA_VALUERANK_SCALAR;
 
-    addMethod(g_serverContext.server, nsMethods, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+    addMethod(server, nsMethods, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
               "CalculateMethod", calculateMethodCallback, 2, calcInputArgs, 1, &calcOutputArg);
 
     // 清理字符串
     UA_String_clear(&stringValue);
 
+}
+
+// 创建附加反应器：配置与主服务器相同，地址空间中的变量节点引用主服务器创建的变量记录。
+// 创建失败时减少反应器数（按客户端地址分配时超出的序号由内核退回按连接分配）
+static void reactorsCreate(Reactors *reactors)
+{
+    int created = 1;
+    reactors->list = (Reactor *)calloc((size_t)reactors->count, sizeof(Reactor));
+    if (reactors->list)
+    {
+        reactors->list[0].server = g_serverContext.server;
+        while (created < reactors->count)
+        {
+            UA_Server *server = UA_Server_new();
+            if (!server)
+                break;
+            UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+            configureServer(UA_Server_getConfig(server));
+            buildAddressSpace(server);
+            reactors->list[created++].server = server;
+        }
+    }
+    reactors->count = created;
+}
+
+static UA_StatusCode initializeServer()
+{
+    // 创建服务器
+    g_serverContext.server = UA_Server_new();
+    if (!g_serverContext.server)
+    {
+        logMessage(LOG_LEVEL_ERROR, "创建服务器失败");
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_ServerConfig *config = UA_Server_getConfig(g_serverContext.server);
+    UA_ServerConfig_setDefault(config);
+    NetworkMode requested = g_serverContext.networkMode;
+    g_serverContext.networkMode = configureServer(config);
+    if (requested != NETWORK_MODE_SELECT)
+    {
+        logMessage(LOG_LEVEL_INFO, "网络层: %s (最多 %d 个连接)", networkModeName(g_serverContext.networkMode),
+                   g_serverContext.networkMode == NETWORK_MODE_SELECT ? FD_SETSIZE : NETWORK_MAX_CONNECTIONS);
+    }
+    if (g_serverContext.networkMode != NETWORK_MODE_URING)
+    {
+        if (g_serverContext.noSendBatching)
+            logMessage(LOG_LEVEL_INFO, "批量发送已禁用");
+        if (g_serverContext.bufferPoolBytes > 0)
+            logMessage(LOG_LEVEL_INFO, "收发缓冲区池: 最多保留 %zu KiB%s", g_serverContext.bufferPoolBytes / 1024,
+                       g_serverContext.hugePages ? " (大页)" : "");
+        else
+            logMessage(LOG_LEVEL_INFO, "收发缓冲区池已禁用");
+    }
+    if (g_serverContext.changePush.enabled)
+    {
+        // 模拟变量的变化写入无锁队列，服务器主循环被eventfd唤醒后整批通知监视项
+        if (changePushInit(&g_serverContext.changePush, true) == UA_STATUSCODE_GOOD)
+        {
+            changePushAttach(g_serverContext.server, config);
+        }
+        else
+        {
+            logMessage(LOG_LEVEL_WARNING, "变化推送队列分配失败，使用周期采样");
+            g_serverContext.changePush.enabled = false;
+        }
+    }
+    if (g_serverContext.serviceWorkerCount > 0)
+    {
+        // 只读服务交给工作线程执行，应答就绪后唤醒服务器主循环发送
+        if (serviceWorkersAttach(&g_serverContext.serviceWorkers, config) != UA_STATUSCODE_GOOD)
+        {
+            logMessage(LOG_LEVEL_WARNING, "创建服务工作线程的唤醒eventfd失败，所有服务在服务器线程中执行");
+            g_serverContext.serviceWorkerCount = 0;
+        }
+    }
+
+    buildAddressSpace(g_serverContext.server);
+
+    // 附加反应器与主服务器监听同一端口
+    if (g_serverContext.reactors.count > 1)
+    {
+        int requestedReactors = g_serverContext.reactors.count;
+        reactorsCreate(&g_serverContext.reactors);
+        if (g_serverContext.reactors.count < requestedReactors)
+            logMessage(LOG_LEVEL_WARNING, "只创建了 %d/%d 个反应器", g_serverContext.reactors.count,
+                       requestedReactors);
+    }
+
     logMessage(LOG_LEVEL_INFO, "服务器初始化完成");
     return UA_STATUSCODE_GOOD;
 }
@@ -905,9 +3712,21 @@ static void cleanupServer()
 {
     logMessage(LOG_LEVEL_INFO, "正在清理服务器资源...");
 
-    // 停止线程
+    // 停止线程（服务工作线程可能仍在读取变量，最先停止）
     g_serverContext.running = false;
 
+    if (g_serverContext.serviceWorkers.count > 0)
+    {
+        UA_ServiceWorkerStatistics stats;
+        UA_Server_getServiceWorkerStatistics(g_serverContext.server, &stats);
+        logMessage(LOG_LEVEL_INFO, "服务工作线程: 分派 %llu 个请求, 排队串行执行 %llu 个, 最大排队 %llu",
+                   (unsigned long long)stats.dispatched, (unsigned long long)stats.parked,
+                   (unsigned long long)stats.maxQueued);
+    }
+    serviceWorkersStop(&g_serverContext.serviceWorkers, g_serverContext.server);
+    reactorsStop(&g_serverContext.reactors);
+    processPoolStop(&g_serverContext.processes);
+
     if (g_serverContext.simulationThread)
     {
         pthread_join(g_serverContext.simulationThread, NULL);
@@ -918,14 +3737,11 @@ static void cleanupServer()
         pthread_join(g_serverContext.diagnosticsThread, NULL);
     }
 
-    // 清理变量上下文
-    for (int i = 0; i < g_serverContext.variableCount; i++)
-    {
-        if (g_serverContext.variables[i])
-        {
-            cleanupVariableContext(g_serverContext.variables[i]);
-        }
-    }
+    // 清理变量注册表（之后删除服务器时注销的监视项不再更新观察集合）
+    g_serverContext.observedSet.enabled = false;
+    g_serverContext.changePush.enabled = false;
+    cleanupSimulationEngine(&g_serverContext.simulationEngine);
+    cleanupTagRegistry(&g_serverContext.tags);
 
     // 清理对象上下文
     for (int i = 0; i < g_serverContext.objectCount; i++)
@@ -945,9 +3761,25 @@ static void cleanupServer()
         }
     }
 
+    UA_free(g_serverContext.objects);
+    UA_free(g_serverContext.methods);
+    UA_free(g_serverContext.observedSet.pending);
+    UA_free(g_serverContext.scheduler.fired);
+    cleanupChangePush(&g_serverContext.changePush);
+    pthread_mutex_destroy(&g_serverContext.observedSet.lock);
+
     // 清理服务器
     if (g_serverContext.server)
     {
+        UA_ServerConfig *config = UA_Server_getConfig(g_serverContext.server);
+        if (g_serverContext.networkMode != NETWORK_MODE_URING && config->networkLayersSize > 0)
+        {
+            UA_BufferPoolStatistics stats;
+            UA_ServerNetworkLayerTCP_getBufferPoolStatistics(&config->networkLayers[0], &stats);
+            logMessage(LOG_LEVEL_INFO, "收发缓冲区池: 命中 %llu, 未命中 %llu, 超限释放 %llu, 保留 %zu KiB",
+                       (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+                       (unsigned long long)stats.drops, stats.retainedBytes / 1024);
+        }
         UA_Server_delete(g_serverContext.server);
     }
 
@@ -955,14 +3787,15 @@ static void cleanupServer()
 }
 
 // ==================== 主函数 ====================
+// 基准测试程序 (bench/benchmarks.c) 包含本文件并提供自己的主函数
+#ifndef OPCUA_SERVER_NO_MAIN
 int main(int argc, char *argv[])
 {
     // 设置信号处理
     signal(SIGINT, stopHandler);
     signal(SIGTERM, stopHandler);
 
-    // 初始化随机数生成器
-    srand(time(NULL));
+    initializeServerContext();
 
     logMessage(LOG_LEVEL_INFO, "====================================");
     logMessage(LOG_LEVEL_INFO, "    OPC UA 完整功能服务器模拟器");
@@ -979,12 +3812,214 @@ int main(int argc, char *argv[])
         {
             g_serverContext.enableDiagnostics = false;
         }
+        else if (strcmp(argv[i], "--read-mode") == 0 && i + 1 < argc)
+        {
+            const char *mode = argv[++i];
+            if (strcmp(mode, "copy") == 0)
+            {
+                g_serverContext.readMode = READ_MODE_COPY;
+            }
+            else if (strcmp(mode, "zero-copy") == 0)
+            {
+                g_serverContext.readMode = READ_MODE_ZERO_COPY;
+            }
+            else
+            {
+                printf("未知读取模式: %s\n", mode);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--network") == 0 && i + 1 < argc)
+        {
+            const char *network = argv[++i];
+            if (strcmp(network, "select") == 0)
+            {
+                g_serverContext.networkMode = NETWORK_MODE_SELECT;
+            }
+            else if (strcmp(network, "epoll") == 0)
+            {
+                g_serverContext.networkMode = NETWORK_MODE_EPOLL;
+            }
+            else if (strcmp(network, "uring") == 0)
+            {
+                g_serverContext.networkMode = NETWORK_MODE_URING;
+            }
+            else
+            {
+                printf("未知网络层: %s\n", network);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--buffer-pool") == 0 && i + 1 < argc)
+        {
+            int kib = atoi(argv[++i]);
+            g_serverContext.bufferPoolBytes = kib > 0 ? (size_t)kib * 1024 : 0;
+        }
+        else if (strcmp(argv[i], "--huge-pages") == 0)
+        {
+            g_serverContext.hugePages = true;
+        }
+        else if (strcmp(argv[i], "--no-send-batching") == 0)
+        {
+            g_serverContext.noSendBatching = true;
+        }
+        else if (strcmp(argv[i], "--no-shared-sampling") == 0)
+        {
+            g_serverContext.noSharedSampling = true;
+        }
+        else if (strcmp(argv[i], "--no-shared-encoding") == 0)
+        {
+            g_serverContext.noSharedEncoding = true;
+        }
+        else if (strcmp(argv[i], "--publish-granularity") == 0 && i + 1 < argc)
+        {
+            char *end;
+            double granularityMs = strtod(argv[++i], &end);
+            if (end == argv[i] || *end != '\0' || granularityMs < 0.0)
+            {
+                printf("无效的发布调度粒度: %s\n", argv[i]);
+                return 1;
+            }
+            g_serverContext.publishGranularityMs = granularityMs;
+        }
+        else if (strcmp(argv[i], "--sim-engine") == 0 && i + 1 < argc)
+        {
+            const char *engine = argv[++i];
+            if (strcmp(engine, "scalar") == 0)
+            {
+                g_serverContext.simulationEngineMode = SIMULATION_ENGINE_SCALAR;
+            }
+            else if (strcmp(engine, "batch") == 0)
+            {
+                g_serverContext.simulationEngineMode = SIMULATION_ENGINE_BATCH;
+            }
+            else if (strcmp(engine, "lazy") == 0)
+            {
+                g_serverContext.simulationEngineMode = SIMULATION_ENGINE_LAZY;
+            }
+            else
+            {
+                printf("未知模拟引擎: %s\n", engine);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            g_serverContext.runSeed = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--sim-threads") == 0 && i + 1 < argc)
+        {
+            int threads = atoi(argv[++i]);
+            if (threads <= 0)
+            {
+                printf("无效的模拟线程数: %s\n", argv[i]);
+                return 1;
+            }
+            g_serverContext.simulationThreads = threads;
+        }
+        else if (strcmp(argv[i], "--service-workers") == 0 && i + 1 < argc)
+        {
+            int workers = atoi(argv[++i]);
+            if (workers < 0)
+            {
+                printf("无效的服务工作线程数: %s\n", argv[i]);
+                return 1;
+            }
+            g_serverContext.serviceWorkerCount = workers;
+        }
+        else if (strcmp(argv[i], "--reactors") == 0 && i + 1 < argc)
+        {
+            int reactors = atoi(argv[++i]);
+            if (reactors <= 0 || reactors > UA_UINT16_MAX)
+            {
+                printf("无效的反应器数: %s\n", argv[i]);
+                return 1;
+            }
+            g_serverContext.reactors.count = reactors;
+        }
+        else if (strcmp(argv[i], "--processes") == 0 && i + 1 < argc)
+        {
+            int processes = atoi(argv[++i]);
+            if (processes <= 0 || processes > UA_UINT16_MAX)
+            {
+                printf("无效的工作进程数: %s\n", argv[i]);
+                return 1;
+            }
+            g_serverContext.processes.count = processes;
+        }
+        else if (strcmp(argv[i], "--reactor-affinity") == 0 && i + 1 < argc)
+        {
+            const char *affinity = argv[++i];
+            if (strcmp(affinity, "address") == 0)
+            {
+                g_serverContext.reactors.addressAffinity = true;
+            }
+            else if (strcmp(affinity, "connection") == 0)
+            {
+                g_serverContext.reactors.addressAffinity = false;
+            }
+            else
+            {
+                printf("未知反应器分配方式: %s\n", affinity);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--push-changes") == 0)
+        {
+            g_serverContext.changePush.enabled = true;
+        }
+        else if (strcmp(argv[i], "--observed-only") == 0)
+        {
+            g_serverContext.observedSet.enabled = true;
+        }
+        else if (strcmp(argv[i], "--observed-window") == 0 && i + 1 < argc)
+        {
+            int windowMs = atoi(argv[++i]);
+            if (windowMs <= 0)
+            {
+                printf("无效的观察窗口: %s\n", argv[i]);
+                return 1;
+            }
+            g_serverContext.observedSet.windowMs = (UA_UInt32)windowMs;
+        }
         else if (strcmp(argv[i], "--help") == 0)
         {
             printf("用法: %s [选项]\n", argv[0]);
             printf("选项:\n");
             printf("  --debug           启用调试日志\n");
             printf("  --no-diagnostics  禁用诊断信息\n");
+            printf("  --read-mode <模式> 变量读取模式: zero-copy (默认) 或 copy\n");
+            printf("  --network <网络层> 网络层: select (默认), epoll (边沿触发, 适合大量连接),\n");
+            printf("                    uring (io_uring, 不支持时退回epoll)\n");
+            printf("  --buffer-pool <KiB>\n");
+            printf("                    收发缓冲区池最多保留的内存 (默认 %d, 0 禁用)\n", BUFFER_POOL_DEFAULT_KIB);
+            printf("  --huge-pages      缓冲区池从2MiB大页中划分缓冲区\n");
+            printf("  --no-send-batching\n");
+            printf("                    每个应答块单独发送 (默认合并一条消息的所有块为一次sendmsg)\n");
+            printf("  --no-shared-sampling\n");
+            printf("                    每个监视项各自采样 (默认相同节点、索引范围和采样间隔的监视项共用一次读取)\n");
+            printf("  --no-shared-encoding\n");
+            printf("                    每个订阅的通知各自编码 (默认共用采样或推送的值只编码一次)\n");
+            printf("  --publish-granularity <毫秒>\n");
+            printf("                    发布间隔相同的订阅按此宽度的相位槽共用发布回调，并合并发往同一连接的\n");
+            printf("                    发布应答 (默认 %.0f, 0 每个订阅各自注册回调)\n", PUBLISH_GRANULARITY_DEFAULT_MS);
+            printf("  --sim-engine <引擎> 模拟引擎: batch (默认, SoA批量内核), scalar,\n");
+            printf("                    lazy (读取或采样时求值)\n");
+            printf("  --seed <种子>     模拟随机数种子，相同种子产生相同的随机序列\n");
+            printf("  --sim-threads <数量>\n");
+            printf("                    参与模拟计算的线程数 (默认 CPU核心数-1)\n");
+            printf("  --service-workers <数量>\n");
+            printf("                    在工作线程中执行Read/Browse/Call等只读服务 (默认 0, 全部在服务器线程)\n");
+            printf("  --reactors <数量> 独立事件循环数，各自以SO_REUSEPORT监听同一端口 (默认 1)\n");
+            printf("  --reactor-affinity <方式>\n");
+            printf("                    连接分配到反应器的方式: address (默认, 按客户端地址, 重连回到原会话),\n");
+            printf("                    connection (按连接哈希)\n");
+            printf("  --processes <数量> 预派生的工作进程数，共享变量存储和写时复制的地址空间，\n");
+            printf("                    以SO_REUSEPORT监听同一端口，模拟值由单独的模拟进程计算 (默认 0, 单进程)\n");
+            printf("  --push-changes    模拟值变化时直接通知监视项，不再按采样间隔读取\n");
+            printf("  --observed-only   只周期计算被监视或最近被读取的变量\n");
+            printf("  --observed-window <毫秒>\n");
+            printf("                    读取后保持周期计算的时长 (默认 10000)\n");
             printf("  --version         显示版本信息\n");
             printf("  --help            显示帮助信息\n");
             printf("\n");
@@ -1021,6 +4056,63 @@ int main(int argc, char *argv[])
         }
     }
 
+    logMessage(LOG_LEVEL_INFO, "模拟随机数种子: %llu", (unsigned long long)g_serverContext.runSeed);
+    if (g_serverContext.changePush.enabled &&
+        g_serverContext.simulationEngineMode == SIMULATION_ENGINE_LAZY)
+    {
+        // 惰性模式没有周期计算，监视项仍需按采样间隔读取
+        logMessage(LOG_LEVEL_WARNING, "惰性模拟模式不支持变化推送，使用周期采样");
+        g_serverContext.changePush.enabled = false;
+    }
+    if (g_serverContext.reactors.count > 1)
+    {
+        // 反应器之间不共享会话和监视项，变化推送队列和服务工作线程只服务一个服务器
+        if (g_serverContext.changePush.enabled)
+        {
+            logMessage(LOG_LEVEL_WARNING, "多反应器模式不支持变化推送，使用周期采样");
+            g_serverContext.changePush.enabled = false;
+        }
+        if (g_serverContext.serviceWorkerCount > 0)
+        {
+            logMessage(LOG_LEVEL_WARNING, "多反应器模式不使用服务工作线程");
+            g_serverContext.serviceWorkerCount = 0;
+        }
+    }
+
+    if (g_serverContext.processes.count > 0)
+    {
+        // 工作进程之间只共享变量记录，进程内的队列、线程和观察集合不跨进程
+        if (g_serverContext.reactors.count > 1)
+        {
+            logMessage(LOG_LEVEL_WARNING, "多进程模式不使用多反应器");
+            g_serverContext.reactors.count = 1;
+        }
+        if (g_serverContext.changePush.enabled)
+        {
+            logMessage(LOG_LEVEL_WARNING, "多进程模式不支持变化推送，使用周期采样");
+            g_serverContext.changePush.enabled = false;
+        }
+        if (g_serverContext.serviceWorkerCount > 0)
+        {
+            logMessage(LOG_LEVEL_WARNING, "多进程模式不使用服务工作线程");
+            g_serverContext.serviceWorkerCount = 0;
+        }
+        if (g_serverContext.observedSet.enabled)
+        {
+            logMessage(LOG_LEVEL_WARNING, "多进程模式不支持观察集合，周期计算所有变量");
+            g_serverContext.observedSet.enabled = false;
+        }
+        g_serverContext.tags.shared = true;
+
+        // 主进程阻塞在waitpid中，停止信号需要中断等待而不是自动重启系统调用
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = stopHandler;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+    }
+
     // 初始化服务器
     UA_StatusCode retval = initializeServer();
     if (retval != UA_STATUSCODE_GOOD)
@@ -1029,8 +4121,44 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
-    // 启动模拟线程
-    if (pthread_create(&g_serverContext.simulationThread, NULL, simulationThread, NULL) != 0)
+    // 启动服务工作线程
+    if (g_serverContext.serviceWorkerCount > 0)
+    {
+        int started = serviceWorkersStart(&g_serverContext.serviceWorkers, g_serverContext.server,
+                                          g_serverContext.serviceWorkerCount);
+        if (started < g_serverContext.serviceWorkerCount)
+            logMessage(LOG_LEVEL_WARNING, "只创建了 %d/%d 个服务工作线程", started,
+                       g_serverContext.serviceWorkerCount);
+        else
+            logMessage(LOG_LEVEL_INFO, "服务工作线程: %d", started);
+    }
+
+    // 启动附加反应器，主服务器在主线程中运行
+    if (g_serverContext.reactors.count > 1)
+    {
+        int started = reactorsStart(&g_serverContext.reactors, &g_serverContext.running);
+        logMessage(LOG_LEVEL_INFO, "反应器: %d (%s)", started + 1,
+                   g_serverContext.reactors.addressAffinity ? "按客户端地址分配" : "按连接分配");
+    }
+
+    // 启动模拟线程（多进程模式下派生模拟进程和工作进程，主进程只负责监督）
+    if (g_serverContext.processes.count > 0)
+    {
+        ProcessPool *pool = &g_serverContext.processes;
+        int started = processPoolStart(pool, g_serverContext.server,
+                                       g_serverContext.simulationEngineMode != SIMULATION_ENGINE_LAZY);
+        if (started == 0)
+        {
+            logMessage(LOG_LEVEL_ERROR, "派生工作进程失败");
+            cleanupServer();
+            return EXIT_FAILURE;
+        }
+        if (started < pool->count)
+            logMessage(LOG_LEVEL_WARNING, "只派生了 %d/%d 个工作进程", started, pool->count);
+        else
+            logMessage(LOG_LEVEL_INFO, "工作进程: %d, 共享变量记录: %zu", started, g_serverContext.tags.count);
+    }
+    else if (pthread_create(&g_serverContext.simulationThread, NULL, simulationThread, NULL) != 0)
     {
         logMessage(LOG_LEVEL_ERROR, "创建数据模拟线程失败");
         cleanupServer();
@@ -1038,7 +4166,7 @@ int main(int argc, char *argv[])
     }
 
     // 启动诊断线程
-    if (g_serverContext.enableDiagnostics)
+    if (g_serverContext.enableDiagnostics && g_serverContext.processes.count == 0)
     {
         if (pthread_create(&g_serverContext.diagnosticsThread, NULL, diagnosticsThread, NULL) != 0)
         {
@@ -1060,7 +4188,10 @@ int main(int argc, char *argv[])
     logMessage(LOG_LEVEL_INFO, "====================================");
 
     // 运行服务器
-    retval = UA_Server_run(g_serverContext.server, &g_serverContext.running);
+    if (g_serverContext.processes.count > 0)
+        processPoolSupervise(&g_serverContext.processes, &g_serverContext.running);
+    else
+        retval = UA_Server_run(g_serverContext.server, &g_serverContext.running);
 
     // 清理资源
     cleanupServer();
@@ -1069,4 +4200,5 @@ int main(int argc, char *argv[])
     logMessage(LOG_LEVEL_INFO, "感谢使用 OPC UA 服务器模拟器！");
 
     return retval == UA_STATUSCODE_GOOD ? EXIT_SUCCESS : EXIT_FAILURE;
-}
\ No newline at end of file
+}
+#endif